@@ -4,9 +4,15 @@
 //=============================================================================
 #include "master.h"
 #include "ImageManager.h"
+#include "batch.h"
+#include "watch.h"
 
 using namespace pyrodactyl;
 
+//Size of one atlas page, and the largest image we'll bother packing into one
+#define ATLAS_SIZE	2048
+#define ATLAS_LIMIT	(ATLAS_SIZE / 2)
+
 //Stuff we use throughout the game
 namespace pyrodactyl
 {
@@ -44,10 +50,143 @@ bool ImageManager::Init()
 	//Load common assets
 	LoadMap("core/data/common.xml");
 	invalid_img = map[0];
+	BuildAtlas();
 
 	return true;
 }
 
+//------------------------------------------------------------------------
+// Purpose: Rebuild the atlas when one of the images in it changes on disk
+//------------------------------------------------------------------------
+static void atlas_changed(std::string filename)
+{
+	gImageManager.BuildAtlas();
+}
+
+//------------------------------------------------------------------------
+// Purpose: Pack the loaded images onto shelves in a few big textures.
+// Each image gets a one pixel border copied from its own edge, so filtering
+// never picks up its neighbor. Images too big to pack are drawn from their
+// own texture as before.
+//------------------------------------------------------------------------
+void ImageManager::BuildAtlas()
+{
+	std::vector<Texture*> packed, on_page;
+	std::vector<char> page(ATLAS_SIZE * ATLAS_SIZE * 4);
+	int page_count = 0, shelf_x = 0, shelf_y = 0, shelf_height = 0;
+
+	atlas.clear();
+	for (auto it = map.begin(); it != map.end(); ++it)
+	{
+		Texture *t = it->second;
+		WatchFile(t->Location(), atlas_changed);
+		if (atlas.count(t) > 0)
+			continue;
+
+		AtlasImage a;
+		a.texture = t->Id();
+		a.uv_min = GLvector2(0, 0);
+		a.uv_max = GLvector2(1, 1);
+		atlas[t] = a;
+		if (t->Data() != nullptr && t->Size().x <= ATLAS_LIMIT && t->Size().y <= ATLAS_LIMIT)
+			packed.push_back(t);
+	}
+
+	//Tallest first keeps the shelves from wasting much space
+	std::sort(packed.begin(), packed.end(), [](Texture *a, Texture *b) { return a->Size().y > b->Size().y; });
+
+	auto finish_page = [&]()
+	{
+		Texture *page_texture = TextureFromBuffer(StringSprintf("ui_atlas_%d", page_count), GLcoord2(ATLAS_SIZE, ATLAS_SIZE), &page[0]);
+		for (auto t : on_page)
+			atlas[t].texture = page_texture->Id();
+		on_page.clear();
+		std::fill(page.begin(), page.end(), 0);
+		page_count++;
+	};
+
+	for (auto t : packed)
+	{
+		GLcoord2 size = t->Size();
+		int cell_w = size.x + 2, cell_h = size.y + 2;
+
+		if (shelf_x + cell_w > ATLAS_SIZE)
+		{
+			shelf_x = 0;
+			shelf_y += shelf_height;
+			shelf_height = 0;
+		}
+		if (shelf_y + cell_h > ATLAS_SIZE)
+		{
+			finish_page();
+			shelf_x = shelf_y = shelf_height = 0;
+		}
+
+		//Copy the rows over, repeating the first and last row and column into the border
+		const char *src = t->Data();
+		for (int y = -1; y <= size.y; y++)
+		{
+			int src_y = clamp(y, 0, size.y - 1);
+			char *dest = &page[((shelf_y + 1 + y) * ATLAS_SIZE + shelf_x + 1) * 4];
+			memcpy(dest, src + src_y * size.x * 4, size.x * 4);
+			memcpy(dest - 4, src + src_y * size.x * 4, 4);
+			memcpy(dest + size.x * 4, src + (src_y * size.x + size.x - 1) * 4, 4);
+		}
+
+		AtlasImage &a = atlas[t];
+		on_page.push_back(t);
+		a.uv_min = GLvector2((shelf_x + 1) / (float)ATLAS_SIZE, (shelf_y + 1) / (float)ATLAS_SIZE);
+		a.uv_max = GLvector2((shelf_x + 1 + size.x) / (float)ATLAS_SIZE, (shelf_y + 1 + size.y) / (float)ATLAS_SIZE);
+		shelf_x += cell_w;
+		shelf_height = std::max(shelf_height, cell_h);
+	}
+	if (!packed.empty())
+		finish_page();
+	Console("ImageManager: Packed %d of %d images into %d atlas pages.", packed.size(), atlas.size(), page_count);
+}
+
+//------------------------------------------------------------------------
+// Purpose: Find where a texture lives in the atlas
+//------------------------------------------------------------------------
+AtlasImage ImageManager::AtlasFind(Texture *t)
+{
+	auto it = atlas.find(t);
+	if (it != atlas.end())
+		return it->second;
+
+	AtlasImage a;
+	a.texture = t->Id();
+	a.uv_min = GLvector2(0, 0);
+	a.uv_max = GLvector2(1, 1);
+	return a;
+}
+
+//------------------------------------------------------------------------
+// Purpose: Queue an image with the batch instead of drawing it now
+//------------------------------------------------------------------------
+void ImageManager::BatchDraw(Texture *t, const int &x, const int &y, const int &w, const int &h, const GLrgba &color, const SDL_Rect* clip)
+{
+	AtlasImage a = AtlasFind(t);
+	GLvector2 start(0, 0), end(1, 1), uv[4];
+
+	if (clip != nullptr)
+	{
+		start = GLvector2(clip->x / (float)t->Size().x, clip->y / (float)t->Size().y);
+		end = GLvector2((clip->x + clip->w) / (float)t->Size().x, (clip->y + clip->h) / (float)t->Size().y);
+	}
+
+	GLvector2 range = a.uv_max - a.uv_min;
+	start = a.uv_min + start * range;
+	end = a.uv_min + end * range;
+
+	//Same corners as RenderTexture: the top of the screen is the top of the image
+	uv[0] = GLvector2(start.x, end.y);
+	uv[1] = end;
+	uv[2] = GLvector2(end.x, start.y);
+	uv[3] = start;
+	BatchQuad(a.texture, GLvector2((float)x, (float)y), GLvector2((float)(x + w), (float)(y + h)), uv, color);
+}
+
 //------------------------------------------------------------------------
 // Purpose: Get texture for a particular id
 //------------------------------------------------------------------------
@@ -72,18 +211,31 @@ bool ImageManager::ValidTexture(const ImageKey &id)
 //------------------------------------------------------------------------
 void ImageManager::Draw(const int &x, const int &y, const int &w, const int &h, const ImageKey &id, const SDL_Rect* clip)
 {
-	RenderTexture(GetTexture(id), x, y, w, h, clip);
+	if (BatchActive())
+		BatchDraw(GetTexture(id), x, y, w, h, GLrgba(1, 1, 1), clip);
+	else
+		RenderTexture(GetTexture(id), x, y, w, h, clip);
 }
 
 void ImageManager::CircleDraw(const int &x, const int &y, const ImageKey &id, const int &start_angle, const int &end_angle, const float &radius)
 {
 	GLcoord2 pos(x, y);
-	RenderCircularBar(GetTexture(id), start_angle, end_angle, radius, pos);
+
+	if (BatchActive())
+	{
+		AtlasImage a = AtlasFind(GetTexture(id));
+		BatchFan(a.texture, GLvector2((float)x, (float)y), radius, start_angle, end_angle, a.uv_min, a.uv_max, GLrgba(1, 1, 1));
+	}
+	else
+		RenderCircularBar(GetTexture(id), start_angle, end_angle, radius, pos);
 }
 
 void ImageManager::Draw(const int &x, const int &y, const int &w, const int &h, const ImageKey &id, const float &fade, const SDL_Rect* clip)
 {
-	RenderTexture(GetTexture(id), x, y, w, h, fade, clip);
+	if (BatchActive())
+		BatchDraw(GetTexture(id), x, y, w, h, GLrgba(fade, fade, fade, fade), clip);
+	else
+		RenderTexture(GetTexture(id), x, y, w, h, fade, clip);
 }
 
 //------------------------------------------------------------------------
@@ -91,6 +243,7 @@ void ImageManager::Draw(const int &x, const int &y, const int &w, const int &h,
 //------------------------------------------------------------------------
 void ImageManager::Quit()
 {
+	atlas.clear();
 	for (auto it = map.begin(); it != map.end(); ++it)
 		it->second->Destroy();
 
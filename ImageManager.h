@@ -21,6 +21,15 @@ namespace pyrodactyl
 	//We store images here
 	typedef std::unordered_map<ImageKey, Texture*> TextureMap;
 
+	//Where an image ended up after being packed into an atlas page
+	struct AtlasImage
+	{
+		unsigned texture;
+		GLvector2 uv_min, uv_max;
+	};
+
+	typedef std::unordered_map<Texture*, AtlasImage> AtlasMap;
+
 	class ImageManager
 	{
 		//Assets are stored in images
@@ -30,6 +39,13 @@ namespace pyrodactyl
 		//The default image for all invalid image names
 		Texture* invalid_img;
 
+		//Small images share a few big textures, so the batch can draw a whole
+		//screen of widgets without switching textures
+		AtlasMap atlas;
+
+		AtlasImage AtlasFind(Texture *t);
+		void BatchDraw(Texture *t, const int &x, const int &y, const int &w, const int &h, const GLrgba &color, const SDL_Rect* clip);
+
 	public:
 		ImageManager(){}
 		~ImageManager(){ Quit(); }
@@ -44,6 +60,9 @@ namespace pyrodactyl
 		//Load all images specified in an XML file in a map
 		void LoadMap(const std::string &filename);
 
+		//Pack every loaded image into atlas pages
+		void BuildAtlas();
+
 		void FreeTexture(const ImageKey &id) { map[id]->Destroy(); }
 		Texture* GetTexture(const ImageKey &id);
 		bool ValidTexture(const ImageKey &id);
@@ -0,0 +1,33 @@
+//=============================================================================
+// Purpose:  Keeps the interface layout files parsed, so menus can be built
+//           and rebuilt without going back to the disk
+//=============================================================================
+#include "master.h"
+#include "LayoutCache.h"
+
+namespace pyrodactyl
+{
+	//XMLDoc can't be copied (rapidxml points into the text), so we keep pointers
+	static std::unordered_map<std::string, XMLDoc*> layouts;
+
+	const XMLDoc& LayoutDoc(const std::string &filename)
+	{
+		auto i = layouts.find(filename);
+		if (i != layouts.end())
+			return *i->second;
+
+		XMLDoc *doc = new XMLDoc(filename);
+		layouts[filename] = doc;
+		return *doc;
+	}
+
+	void LayoutForget(const std::string &filename)
+	{
+		auto i = layouts.find(filename);
+		if (i != layouts.end())
+		{
+			delete i->second;
+			layouts.erase(i);
+		}
+	}
+}
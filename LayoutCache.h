@@ -0,0 +1,19 @@
+//=============================================================================
+// Purpose:  Keeps the interface layout files parsed, so menus can be built
+//           and rebuilt without going back to the disk
+//=============================================================================
+#pragma once
+
+#include "common_header.h"
+#include "XMLDoc.h"
+
+namespace pyrodactyl
+{
+	//The parsed layout in filename, loaded the first time anyone asks for it.
+	//The document stays around until the program exits, so don't hold on to
+	//nodes from it past a call to LayoutForget.
+	const XMLDoc& LayoutDoc(const std::string &filename);
+
+	//The file changed on disk. The next LayoutDoc call will load it again.
+	void LayoutForget(const std::string &filename);
+}
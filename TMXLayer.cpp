@@ -12,7 +12,7 @@ bool Layer::Load(rapidxml::xml_node<char> *node)
 	return false;
 }
 
-bool MapLayer::Load(const std::string &path, rapidxml::xml_node<char> *node)
+bool MapLayer::Load(const std::string &path, rapidxml::xml_node<char> *node, RandomStream &random)
 {
 	if (Layer::Load(node))
 	{
@@ -51,7 +51,7 @@ bool MapLayer::Load(const std::string &path, rapidxml::xml_node<char> *node)
 			}
 
 			//We've loaded our layer, now it's time to spin the flipping wheel
-			ApplyVariant();
+			ApplyVariant(random);
 
 			return true;
 		}
@@ -60,7 +60,7 @@ bool MapLayer::Load(const std::string &path, rapidxml::xml_node<char> *node)
 	return false;
 }
 
-void MapLayer::ApplyVariant()
+void MapLayer::ApplyVariant(RandomStream &random)
 {
 	//Pick a random value out of the ones we are allowed
 	std::vector<int> allow;
@@ -69,7 +69,7 @@ void MapLayer::ApplyVariant()
 		if (allowed_flip[i])
 			allow.push_back(i);
 
-	int val = RandomVal(allow.size());
+	int val = random.Val(allow.size());
 	variant = static_cast<LayerVariant>(allow.at(val));
 
 	switch (variant)
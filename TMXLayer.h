@@ -3,6 +3,7 @@
 #include "master.h"
 #include "common_header.h"
 #include "TileInfo.h"
+#include "random.h"
 
 namespace pyrodactyl
 {
@@ -62,7 +63,7 @@ namespace pyrodactyl
 		//Find out which ones we're allowed to have
 		bool allowed_flip[V_TOTAL];
 
-		void ApplyVariant();
+		void ApplyVariant(RandomStream &random);
 
 	public:
 		//The tiles in the layer
@@ -77,6 +78,6 @@ namespace pyrodactyl
 				allowed_flip[i] = true;
 		}
 
-		bool Load(const std::string &path, rapidxml::xml_node<char> *node);
+		bool Load(const std::string &path, rapidxml::xml_node<char> *node, RandomStream &random);
 	};
 }
\ No newline at end of file
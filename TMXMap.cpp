@@ -1,7 +1,7 @@
 #include "master.h"
 #include "TMXMap.h"
 #include "loaders.h"
-#include "page.h"
+#include "page_layout.h"
 #include "random.h"
 
 using namespace pyrodactyl;
@@ -15,7 +15,7 @@ TMXMap::TMXMap()
 //------------------------------------------------------------------------
 // Purpose: Load stuff via a .tmx file set to XML storage (no compression)
 //------------------------------------------------------------------------
-void TMXMap::Load(const std::string &path, std::string filename)
+void TMXMap::Load(const std::string &path, std::string filename, RandomStream &random)
 {
 	XMLDoc conf(path + filename);
 	if (conf.ready())
@@ -29,7 +29,7 @@ void TMXMap::Load(const std::string &path, std::string filename)
 			if (NodeValid("layer", node))
 			{
 				rapidxml::xml_node<char> *groupnode = node->first_node("layer");
-				layer.Load(path, groupnode);
+				layer.Load(path, groupnode, random);
 			}
 		}
 	}
@@ -39,17 +39,17 @@ void TMXMap::Load(const std::string &path, std::string filename)
 // Purpose: Copy our TMX data to the game's map format
 // The weird declaration exists to enforce array size
 //------------------------------------------------------------------------
-void TMXMap::Copy(unsigned char(&map)[PAGE_SIZE][PAGE_SIZE])
+void TMXMap::Copy(unsigned char(&map)[PAGE_SIZE][PAGE_SIZE], RandomStream &random)
 {
 	//Roll the dice once for tile id 5 and 6
 	//These tiles are synchronized on/off
 	int dice[2] = { 0, 0 };
-	dice[0] = RandomVal(2);
-	dice[1] = RandomVal(2);
+	dice[0] = random.Val(2);
+	dice[1] = random.Val(2);
 
 	//Roll the dice for tile 7
 	//Tile 8 is the inverse of tile 7
-	int dice2 = RandomVal(2);
+	int dice2 = random.Val(2);
 
 	for (int x = 0; x < PAGE_SIZE; x++)
 	{
@@ -66,7 +66,7 @@ void TMXMap::Copy(unsigned char(&map)[PAGE_SIZE][PAGE_SIZE])
 				break;
 			case 4:
 				//Randomly decide to either make this solid or open
-				if (RandomVal(2) == 0) map[x][y] = MAP_SOLID; else map[x][y] = MAP_OPEN;
+				if (random.Val(2) == 0) map[x][y] = MAP_SOLID; else map[x][y] = MAP_OPEN;
 				break;
 			case 5:
 			case 6:
@@ -19,8 +19,8 @@ namespace pyrodactyl
 		TMXMap();
 		~TMXMap(){}
 
-		void Load(const std::string &path, std::string filename);
-		void Copy(unsigned char(&map)[PAGE_SIZE][PAGE_SIZE]);
+		void Load(const std::string &path, std::string filename, RandomStream &random);
+		void Copy(unsigned char(&map)[PAGE_SIZE][PAGE_SIZE], RandomStream &random);
 		void CreateDoor(const PageTraverse &dir, unsigned char(&map)[PAGE_SIZE][PAGE_SIZE]);
 	};
 }
\ No newline at end of file
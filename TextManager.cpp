@@ -1,9 +1,13 @@
 #include "master.h"
 #include "XMLDoc.h"
 #include "TextManager.h"
+#include "font.h"
 
 using namespace pyrodactyl;
 
+//How much memory the cached text layouts may use before old ones get dropped
+#define LAYOUT_BUDGET	(256 * 1024)
+
 namespace pyrodactyl
 {
 	TextManager gTextManager;
@@ -18,22 +22,49 @@ void TextManager::Init()
 }
 
 //------------------------------------------------------------------------
-// Purpose: Draw text
+// Purpose: Find the layout for this text, building it if we haven't seen
+// it lately. Old layouts are thrown out once we go over budget.
 //------------------------------------------------------------------------
-void TextManager::Draw(
-	const int &x, int y,
-	const std::string &text,
-	const int &color,
-	const FontKey &font,
-	const TextAlign &align,
-	const int &line_width, const int &line_height,
-	const bool &background,
-	const bool &use_custom_alpha, const float &alpha)
+const TextLayout& TextManager::Layout(const Font *f, const std::string &text, const int &line_width, const int &line_height, const int &flags)
 {
+	size_t hash = std::hash<std::string>()(text);
+	hash ^= std::hash<const void*>()(f) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<int>()(line_width) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<int>()(line_height) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<int>()(flags) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+	auto found = layout_index.find(hash);
+	if (found != layout_index.end())
+	{
+		TextLayout &l = *found->second;
+
+		//The font is rebuilt when the window changes size, which moves everything
+		if (l.font == f && l.font_height == f->Height() && l.line_width == line_width &&
+			l.line_height == line_height && l.flags == flags && l.text == text)
+		{
+			layouts.splice(layouts.begin(), layouts, found->second);
+			return layouts.front();
+		}
+
+		layout_bytes -= l.bytes;
+		layouts.erase(found->second);
+		layout_index.erase(found);
+	}
+
+	TextLayout l;
+	l.hash = hash;
+	l.font = f;
+	l.font_height = f->Height();
+	l.line_width = line_width;
+	l.line_height = line_height;
+	l.flags = flags;
+	l.text = text;
+
+	int y = 0;
 	for (int start_pos = 0, len = text.length(); start_pos < len; y += line_height)
 	{
 		int end_pos = start_pos + 1, last_interrupt = -1;
-		std::string word;
+		TextLayout::Line line;
 
 		while (end_pos - start_pos <= line_width)
 		{
@@ -51,37 +82,83 @@ void TextManager::Draw(
 
 		if (last_interrupt >= 0) //wrap a word around
 		{
-			for (int i = 0; i < last_interrupt - start_pos; i++)
-				word += text[start_pos + i];
-
+			line.text = text.substr(start_pos, last_interrupt - start_pos);
 			start_pos = last_interrupt + 1;
 		}
 		else //word bigger than line, just thunk
 		{
-			for (int i = 0; i < end_pos - start_pos; i++)
-				word += text[start_pos + i];
-
+			line.text = text.substr(start_pos, end_pos - start_pos);
 			start_pos += line_width;
 		}
 
-		const Font *f = InterfaceFont(font);
-		GLcoord2 c(x, y);
-		GLrgba col = colpool.Get(color);
-		if (use_custom_alpha)
-			col.alpha = alpha;
+		//Same positioning Font::Print does with these flags
+		int width = f->Width(line.text.c_str());
+		line.offset = GLcoord2(0, y);
+		if (flags & FONTMSG_JUSTIFY_RIGHT)
+			line.offset.x -= width;
+		if (flags & FONTMSG_JUSTIFY_CENTER)
+			line.offset.x -= width / 2;
+		if (flags & FONTMSG_ALIGN_TOP)
+			line.offset.y -= f->Height();
+		if (flags & FONTMSG_ALIGN_CENTER)
+			line.offset.y -= f->Height() / 2;
+
+		l.lines.push_back(line);
+	}
+
+	l.bytes = sizeof(TextLayout) + l.text.capacity();
+	for (auto &line : l.lines)
+		l.bytes += sizeof(TextLayout::Line) + line.text.capacity();
 
-		int flags = 0;
+	layouts.push_front(l);
+	layout_index[hash] = layouts.begin();
+	layout_bytes += l.bytes;
 
-		if (background) flags = FONTMSG_DROPSHADOW;
+	while (layout_bytes > LAYOUT_BUDGET && layouts.size() > 1)
+	{
+		layout_bytes -= layouts.back().bytes;
+		layout_index.erase(layouts.back().hash);
+		layouts.pop_back();
+	}
 
-		if (align.x == ALIGN_LEFT) flags = flags | FONTMSG_JUSTIFY_LEFT;
-		else if (align.x == ALIGN_CENTER) flags = flags | FONTMSG_JUSTIFY_CENTER;
-		else flags = flags | FONTMSG_JUSTIFY_RIGHT;
+	return layouts.front();
+}
 
-		if (align.y == ALIGN_LEFT) flags = flags | FONTMSG_ALIGN_TOP;
-		else if (align.y == ALIGN_CENTER) flags = flags | FONTMSG_ALIGN_CENTER;
-		else flags = flags | FONTMSG_ALIGN_BOTTOM;
+//------------------------------------------------------------------------
+// Purpose: Draw text
+//------------------------------------------------------------------------
+void TextManager::Draw(
+	const int &x, int y,
+	const std::string &text,
+	const int &color,
+	const FontKey &font,
+	const TextAlign &align,
+	const int &line_width, const int &line_height,
+	const bool &background,
+	const bool &use_custom_alpha, const float &alpha)
+{
+	if (text.empty())
+		return;
 
-		f->Print(c, flags, col, word.c_str());
-	}
-}
\ No newline at end of file
+	const Font *f = InterfaceFont(font);
+	GLrgba col = colpool.Get(color);
+	if (use_custom_alpha)
+		col.alpha = alpha;
+
+	int flags = 0;
+
+	if (background) flags = FONTMSG_DROPSHADOW;
+
+	if (align.x == ALIGN_LEFT) flags = flags | FONTMSG_JUSTIFY_LEFT;
+	else if (align.x == ALIGN_CENTER) flags = flags | FONTMSG_JUSTIFY_CENTER;
+	else flags = flags | FONTMSG_JUSTIFY_RIGHT;
+
+	if (align.y == ALIGN_LEFT) flags = flags | FONTMSG_ALIGN_TOP;
+	else if (align.y == ALIGN_CENTER) flags = flags | FONTMSG_ALIGN_CENTER;
+	else flags = flags | FONTMSG_ALIGN_BOTTOM;
+
+	//The layout has already done the lining up, so all that's left for Print is the shadow
+	const TextLayout &l = Layout(f, text, line_width, line_height, flags);
+	for (auto &line : l.lines)
+		f->Print(GLcoord2(x + line.offset.x, y + line.offset.y), flags & FONTMSG_DROPSHADOW, col, line.text.c_str());
+}
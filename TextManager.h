@@ -1,5 +1,7 @@
 #pragma once
 
+#include <list>
+
 #include "common_header.h"
 #include "interface.h"
 #include "vectors.h"
@@ -10,6 +12,31 @@ namespace pyrodactyl
 	//We use this object as the key for all fonts
 	typedef unsigned int FontKey;
 
+	//A string already broken into lines and lined up, so drawing it again
+	//doesn't mean wrapping it again
+	struct TextLayout
+	{
+		struct Line
+		{
+			std::string text;
+
+			//Where this line starts, relative to the position we draw at
+			GLcoord2 offset;
+		};
+
+		//What this layout was built from
+		size_t hash;
+		const Font *font;
+		unsigned font_height;
+		int line_width, line_height, flags;
+		std::string text;
+
+		std::vector<Line> lines;
+
+		//Roughly how much memory this entry holds on to
+		size_t bytes;
+	};
+
 	class TextManager
 	{
 		//The place to store all colors
@@ -18,13 +45,20 @@ namespace pyrodactyl
 		//The rectangle used to store the darkened rectangle coordinates
 		SDL_Rect rect;
 
+		//Recently drawn layouts, most recently used at the front
+		std::list<TextLayout> layouts;
+		std::unordered_map<size_t, std::list<TextLayout>::iterator> layout_index;
+		size_t layout_bytes;
+
+		const TextLayout& Layout(const Font *f, const std::string &text, const int &line_width, const int &line_height, const int &flags);
+
 	public:
-		TextManager(){}
+		TextManager(){ layout_bytes = 0; }
 		~TextManager(){}
 
 		void Init();
 		void Quit(){}
-		void Reset(){}
+		void Reset(){ layouts.clear(); layout_index.clear(); layout_bytes = 0; }
 
 		void Draw(
 			const int &x, int y,
@@ -0,0 +1,144 @@
+/*-----------------------------------------------------------------------------
+
+  Arena.cpp
+
+  A zone-lifetime allocator for the small, short-lived objects that come and
+  go by the hundreds during play. Memory is carved out of large blocks, and
+  freed objects go onto a free list for their size so the next allocation of
+  that size can reuse them. When the zone is torn down, ArenaReset () throws
+  the whole thing away at once without touching the objects one by one. The
+  blocks themselves are kept, so the next zone doesn't need to ask the system
+  for memory again.
+
+  Effects use it through fx's operator new. Robots live by value in the entity
+  list, so it's their legs, weapons and other per-robot lists that come from
+  here, through ArenaAllocator.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include "arena.h"
+#include "console.h"
+
+#define BLOCK_SIZE        (64 * 1024)
+#define GRAIN             16                          //All allocations are rounded up to this.
+#define MAX_CLASS         1024                        //Anything larger than this goes to the system.
+#define CLASSES           (MAX_CLASS / GRAIN)
+
+struct FreeNode
+{
+	FreeNode*     next;
+};
+
+struct ArenaCounters
+{
+	unsigned      allocs;         //Allocations served since the last reset.
+	unsigned      recycled;       //Of those, how many came off a free list.
+	unsigned      oversize;       //Allocations too big for the arena.
+	unsigned      resets;
+	size_t        in_use;         //Bytes currently handed out.
+	size_t        peak;           //Most bytes ever handed out at once.
+};
+
+static vector<char*>      block;
+static unsigned           block_current;
+static size_t             block_used;
+static FreeNode*          free_list[CLASSES];
+static ArenaCounters      stats;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static size_t round_up(size_t size)
+{
+	return (size + GRAIN - 1) & ~(size_t)(GRAIN - 1);
+}
+
+static void* carve(size_t size)
+{
+	void*     result;
+
+	if (block.empty() || block_used + size > BLOCK_SIZE) {
+		//Move on to the next block, keeping the one from a previous zone if we have it.
+		if (!block.empty())
+			block_current++;
+		if (block_current >= block.size())
+			block.push_back(new char[BLOCK_SIZE]);
+		block_used = 0;
+	}
+	result = block[block_current] + block_used;
+	block_used += size;
+	return result;
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+void* ArenaAlloc(size_t size)
+{
+	FreeNode*   node;
+	int         index;
+
+	size = round_up(max(size, sizeof(FreeNode)));
+	if (size > MAX_CLASS) {
+		stats.oversize++;
+		return ::operator new(size);
+	}
+	stats.allocs++;
+	stats.in_use += size;
+	stats.peak = max(stats.peak, stats.in_use);
+	index = (int)(size / GRAIN) - 1;
+	node = free_list[index];
+	if (node) {
+		free_list[index] = node->next;
+		stats.recycled++;
+		return node;
+	}
+	return carve(size);
+}
+
+void ArenaFree(void* ptr, size_t size)
+{
+	FreeNode*   node;
+	int         index;
+
+	if (ptr == NULL)
+		return;
+	size = round_up(max(size, sizeof(FreeNode)));
+	if (size > MAX_CLASS) {
+		::operator delete(ptr);
+		return;
+	}
+	stats.in_use -= size;
+	index = (int)(size / GRAIN) - 1;
+	node = (FreeNode*)ptr;
+	node->next = free_list[index];
+	free_list[index] = node;
+}
+
+//Everything allocated from the arena is gone after this. Only call it once
+//all of the objects have been destroyed.
+void ArenaReset()
+{
+	block_current = 0;
+	block_used = 0;
+	for (int i = 0; i < CLASSES; i++)
+		free_list[i] = NULL;
+	stats.allocs = 0;
+	stats.recycled = 0;
+	stats.oversize = 0;
+	stats.in_use = 0;
+	stats.resets++;
+}
+
+void ArenaStats()
+{
+	Console("Arena: %d blocks (%dk), %d in use this zone.", (int)block.size(), (int)(block.size() * BLOCK_SIZE) / 1024, block_current + (block.empty() ? 0 : 1));
+	Console("Arena: %d bytes live, %d peak.", (int)stats.in_use, (int)stats.peak);
+	Console("Arena: %d allocations, %d recycled, %d oversize, %d resets.", stats.allocs, stats.recycled, stats.oversize, stats.resets);
+}
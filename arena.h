@@ -0,0 +1,31 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+void*     ArenaAlloc(size_t size);
+void      ArenaFree(void* ptr, size_t size);
+void      ArenaReset();
+void      ArenaStats();
+
+//Lets the containers inside zone objects draw from the arena too, so a
+//robot's legs and weapons come and go with the robot rather than the heap.
+//Anything using this must be destroyed before ArenaReset ().
+template <class T>
+struct ArenaAllocator
+{
+	typedef T         value_type;
+
+	ArenaAllocator() {}
+	template <class U> ArenaAllocator(const ArenaAllocator<U>&) {}
+	T*                allocate(size_t n) { return (T*)ArenaAlloc(n * sizeof(T)); }
+	void              deallocate(T* ptr, size_t n) { ArenaFree(ptr, n * sizeof(T)); }
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return false; }
+
+template <class T>
+using ArenaVector = vector<T, ArenaAllocator<T> >;
+
+#endif // ARENA_H
@@ -12,6 +12,7 @@
 #include "master.h"
 #include "audio.h"
 #include "avatar.h"
+#include "gpu.h"
 #include "particle.h"
 #include "random.h"
 #include "render.h"
@@ -105,33 +106,33 @@ void Avatar::Kill()
 		_body[i].active = true;
 		_body[i].angle = 0;
 		_body[i].momentum = _last_momentum;
-		_body[i].momentum += GLvector2(RandomFloat() - 0.5f, -RandomFloat()) * EXPLODE_SPEED;
-		_body[i].spin = RandomVal(10) - 5;
+		_body[i].momentum += GLvector2(RandomChannel(RANDOM_COSMETIC).Float() - 0.5f, -RandomChannel(RANDOM_COSMETIC).Float()) * EXPLODE_SPEED;
+		_body[i].spin = RandomChannel(RANDOM_COSMETIC).Val(10) - 5;
 	}
-	_body[HEAD].momentum.y -= RandomFloat() * EXPLODE_SPEED;
-	_body[PRIMARY].momentum.x -= RandomFloat() * EXPLODE_SPEED;
-	_body[SECONDARY].momentum.x -= RandomFloat() * EXPLODE_SPEED;
+	_body[HEAD].momentum.y -= RandomChannel(RANDOM_COSMETIC).Float() * EXPLODE_SPEED;
+	_body[PRIMARY].momentum.x -= RandomChannel(RANDOM_COSMETIC).Float() * EXPLODE_SPEED;
+	_body[SECONDARY].momentum.x -= RandomChannel(RANDOM_COSMETIC).Float() * EXPLODE_SPEED;
 }
 
 void Avatar::Render()
 {
-	glBlendFunc(GL_ONE, GL_ONE);
-	glDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDepthMask(false);
 	_tail.Render();
-	glDepthMask(true);
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDepthMask(true);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuEnable(GL_TEXTURE_2D);
+	GpuEnable(GL_BLEND);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	for (int i = 0; i < PARTS; i++)
 		_body[i].sprite.Render();
 	RenderQuads ();
 	_body[HEAD].sprite.RenderEye ();
 	RenderQuads ();
-	glDepthFunc (GL_EQUAL);
+	GpuDepthFunc (GL_EQUAL);
 	_body[HEAD].sprite.RenderIris ();
 	RenderQuads ();
-	glDepthFunc (GL_LEQUAL);
+	GpuDepthFunc (GL_LEQUAL);
 
 }
 
@@ -0,0 +1,355 @@
+/*-----------------------------------------------------------------------------
+
+  Batch.cpp
+
+  Collects the flat, textured shapes the interface draws (images, glyphs,
+  circular gauges) and sends them to the card a handful at a time instead of
+  one glBegin per widget.
+
+  Shapes are queued in the order they are drawn. At flush time each one is
+  moved back to join the last run with the same texture and blend, as long
+  as it doesn't overlap anything drawn in between. The result looks exactly
+  the same, but a screen full of buttons and captions comes out as one run
+  per texture.
+
+  Any other drawing or state change that goes through the Gpu layer flushes
+  the queue first, so the batch never gets drawn out of order.
+
+  Flushes are numbered within a frame. If a flush is handed exactly the same
+  shapes as the matching flush last frame (a menu that isn't animating) we
+  skip the sort and draw the runs and buffer that flush left behind. The
+  interface still queues its shapes every frame, so they're compared, but
+  nothing is rebuilt or uploaded until one of them changes.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include "batch.h"
+#include "gpu.h"
+
+#define GL_ARRAY_BUFFER_ARB   0x8892
+#define GL_STREAM_DRAW_ARB    0x88E0
+
+struct BatchVertex
+{
+	float           x, y;
+	float           u, v;
+	unsigned char   color[4];
+};
+
+//One queued shape: a quad or a fan, already cut into triangles.
+struct BatchShape
+{
+	unsigned        texture;
+	GLenum          src, dst;
+	GLbbox2         bounds;
+	int             first;
+	int             count;
+};
+
+//Consecutive shapes that can be drawn with a single call.
+struct BatchRun
+{
+	unsigned        texture;
+	GLenum          src, dst;
+	GLbbox2         bounds;
+	vector<int>     shape;
+	int             first;
+	int             count;
+};
+
+//What a flush was handed and what it sent to the card, so the matching
+//flush next frame can tell if it has the same work to do.
+struct BatchCache
+{
+	unsigned              vbo;
+	vector<BatchVertex>   vertex;
+	vector<BatchShape>    shape;
+	vector<BatchRun>      run;
+};
+
+static bool                 active;
+static bool                 flushing;
+static vector<BatchVertex>  queued;
+static vector<BatchShape>   shape;
+static vector<BatchRun>     run;
+static vector<BatchVertex>  sorted;
+static vector<BatchCache>   cache;
+static unsigned             cache_next;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static bool overlap(const GLbbox2& a, const GLbbox2& b)
+{
+	if (a.pmax.x <= b.pmin.x || b.pmax.x <= a.pmin.x)
+		return false;
+	if (a.pmax.y <= b.pmin.y || b.pmax.y <= a.pmin.y)
+		return false;
+	return true;
+}
+
+static BatchVertex vertex(GLvector2 pos, GLvector2 uv, GLrgba color)
+{
+	BatchVertex   v;
+
+	v.x = pos.x;
+	v.y = pos.y;
+	v.u = uv.x;
+	v.v = uv.y;
+	v.color[0] = (unsigned char)(clamp(color.red, 0.0f, 1.0f) * 255.0f);
+	v.color[1] = (unsigned char)(clamp(color.green, 0.0f, 1.0f) * 255.0f);
+	v.color[2] = (unsigned char)(clamp(color.blue, 0.0f, 1.0f) * 255.0f);
+	v.color[3] = (unsigned char)(clamp(color.alpha, 0.0f, 1.0f) * 255.0f);
+	return v;
+}
+
+static void shape_begin(unsigned texture, GLenum src, GLenum dst)
+{
+	BatchShape    s;
+
+	s.texture = texture;
+	s.src = src;
+	s.dst = dst;
+	s.bounds.Clear();
+	s.first = queued.size();
+	s.count = 0;
+	shape.push_back(s);
+}
+
+static void shape_vertex(const BatchVertex& v)
+{
+	queued.push_back(v);
+	shape.back().bounds.ContainPoint(GLvector2(v.x, v.y));
+	shape.back().count++;
+}
+
+//Walk back through the runs looking for one this shape can join. We can only
+//move it back past runs it doesn't touch.
+static void do_sort()
+{
+	run.clear();
+	for (unsigned s = 0; s < shape.size(); s++) {
+		BatchShape*   bs = &shape[s];
+		int           r;
+
+		for (r = (int)run.size() - 1; r >= 0; r--) {
+			if (run[r].texture == bs->texture && run[r].src == bs->src && run[r].dst == bs->dst)
+				break;
+			if (overlap(run[r].bounds, bs->bounds)) {
+				r = -1;
+				break;
+			}
+		}
+		if (r < 0) {
+			BatchRun    br;
+
+			br.texture = bs->texture;
+			br.src = bs->src;
+			br.dst = bs->dst;
+			br.bounds.Clear();
+			run.push_back(br);
+			r = run.size() - 1;
+		}
+		run[r].shape.push_back(s);
+		run[r].bounds.ContainPoint(bs->bounds.pmin);
+		run[r].bounds.ContainPoint(bs->bounds.pmax);
+	}
+	sorted.clear();
+	for (unsigned r = 0; r < run.size(); r++) {
+		run[r].first = sorted.size();
+		for (unsigned i = 0; i < run[r].shape.size(); i++) {
+			BatchShape*   bs = &shape[run[r].shape[i]];
+
+			sorted.insert(sorted.end(), queued.begin() + bs->first, queued.begin() + bs->first + bs->count);
+		}
+		run[r].count = sorted.size() - run[r].first;
+	}
+}
+
+//Shapes are queued back to back, so if every one has the same texture,
+//blend and size, and the vertices match, the whole queue is the same.
+static bool same_shapes(const BatchCache* c)
+{
+	if (c->vertex.size() != queued.size() || c->shape.size() != shape.size())
+		return false;
+	for (unsigned s = 0; s < shape.size(); s++) {
+		if (c->shape[s].texture != shape[s].texture || c->shape[s].src != shape[s].src || c->shape[s].dst != shape[s].dst)
+			return false;
+		if (c->shape[s].count != shape[s].count)
+			return false;
+	}
+	return !memcmp(&c->vertex[0], &queued[0], queued.size() * sizeof(BatchVertex));
+}
+
+//Find this flush's place in the cache. If it was handed the same shapes as
+//last frame, the runs it left are still good, and so is the buffer if it
+//made one. Otherwise sort the shapes again and refill the buffer.
+static BatchCache* do_cache(bool live)
+{
+	BatchCache*   c;
+
+	if (cache_next >= cache.size()) {
+		BatchCache    bc;
+
+		bc.vbo = 0;
+		cache.push_back(bc);
+	}
+	c = &cache[cache_next++];
+	if (live && !c->vbo)
+		glGenBuffersARB(1, &c->vbo);
+	else if (same_shapes(c)) {
+		if (live)
+			glBindBufferARB(GL_ARRAY_BUFFER_ARB, c->vbo);
+		return c;
+	}
+	do_sort();
+	c->vertex = queued;
+	c->shape = shape;
+	c->run = run;
+	if (live) {
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, c->vbo);
+		glBufferDataARB(GL_ARRAY_BUFFER_ARB, sorted.size() * sizeof(BatchVertex), &sorted[0], GL_STREAM_DRAW_ARB);
+	}
+	return c;
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+bool BatchActive()
+{
+	return active;
+}
+
+//Start collecting. Only valid under the flat 2D projection set up by
+//RenderPushViewport, which has already turned off depth and stencil tests.
+void BatchBegin()
+{
+	BatchFlush();
+	active = true;
+}
+
+void BatchEnd()
+{
+	BatchFlush();
+	active = false;
+}
+
+//Called at the start of every frame, so flushes line up with last frame's.
+void BatchFrame()
+{
+	cache_next = 0;
+}
+
+void BatchQuad(unsigned texture, GLvector2 pos, GLvector2 end, const GLvector2* uv, GLrgba color, GLenum blend_src, GLenum blend_dst)
+{
+	BatchVertex   corner[4];
+
+	corner[0] = vertex(pos, uv[0], color);
+	corner[1] = vertex(GLvector2(end.x, pos.y), uv[1], color);
+	corner[2] = vertex(end, uv[2], color);
+	corner[3] = vertex(GLvector2(pos.x, end.y), uv[3], color);
+	shape_begin(texture, blend_src, blend_dst);
+	shape_vertex(corner[0]);
+	shape_vertex(corner[1]);
+	shape_vertex(corner[2]);
+	shape_vertex(corner[0]);
+	shape_vertex(corner[2]);
+	shape_vertex(corner[3]);
+}
+
+void BatchQuad(unsigned texture, GLvector2 pos, GLvector2 end, const GLvector2* uv, GLrgba color)
+{
+	BatchQuad(texture, pos, end, uv, color, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+//A pie slice of a round image, for circular gauges. The image fills the
+//uv rectangle given, and the slice runs from start_angle to end_angle.
+void BatchFan(unsigned texture, GLvector2 center, float radius, int start_angle, int end_angle, GLvector2 uv_min, GLvector2 uv_max, GLrgba color)
+{
+	BatchVertex   hub;
+	BatchVertex   edge, last;
+	GLvector2     uv_center;
+	GLvector2     uv_half;
+	GLvector2     dir;
+
+	uv_center = (uv_min + uv_max) / 2.0f;
+	uv_half = (uv_max - uv_min) / 2.0f;
+	hub = vertex(center, uv_center, color);
+	if (end_angle < start_angle)
+		end_angle += 360;
+	shape_begin(texture, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	for (int a = start_angle; a <= end_angle; a++) {
+		dir = GLvectorFromAngle((float)(a % 360));
+		edge = vertex(center + dir * radius, uv_center + dir * uv_half, color);
+		if (a != start_angle) {
+			shape_vertex(hub);
+			shape_vertex(last);
+			shape_vertex(edge);
+		}
+		last = edge;
+	}
+	if (!shape.back().count)
+		shape.pop_back();
+}
+
+//Draw everything queued. Whatever state the caller had set up (blend,
+//texture, color) is put back afterwards, since the code that queued these
+//shapes expects to pick up where it left off.
+void BatchFlush()
+{
+	BatchCache*   c;
+	GLenum        src, dst;
+	GLrgba        color;
+	unsigned      texture;
+	bool          textured;
+	bool          live;
+
+	if (flushing || shape.empty())
+		return;
+	//Drawing goes through the Gpu layer, which would otherwise call us again.
+	flushing = true;
+	live = GpuBackendGet() == GPU_BACKEND_GL;
+	c = do_cache(live);
+	GpuBlendGet(&src, &dst);
+	color = GpuColorGet();
+	texture = GpuTextureGet();
+	textured = GpuTextured();
+	if (live) {
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_NORMAL_ARRAY);
+		glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), (void*)offsetof(BatchVertex, x));
+		glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), (void*)offsetof(BatchVertex, u));
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, color));
+	}
+	if (!textured)
+		GpuEnable(GL_TEXTURE_2D);
+	for (unsigned r = 0; r < c->run.size(); r++) {
+		GpuTexture(c->run[r].texture);
+		GpuBlend(c->run[r].src, c->run[r].dst);
+		GpuDrawArrays(GL_TRIANGLES, c->run[r].first, c->run[r].count);
+	}
+	if (live) {
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+	}
+	//Drawing with a color array leaves the current color undefined.
+	GpuColor4fv(&color.red);
+	GpuTexture(texture);
+	if (!textured)
+		GpuDisable(GL_TEXTURE_2D);
+	GpuBlend(src, dst);
+	queued.clear();
+	shape.clear();
+	flushing = false;
+}
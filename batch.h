@@ -0,0 +1,13 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+bool          BatchActive();
+void          BatchBegin();
+void          BatchEnd();
+void          BatchFan(unsigned texture, GLvector2 center, float radius, int start_angle, int end_angle, GLvector2 uv_min, GLvector2 uv_max, GLrgba color);
+void          BatchFlush();
+void          BatchFrame();
+void          BatchQuad(unsigned texture, GLvector2 pos, GLvector2 end, const GLvector2* uv, GLrgba color);
+void          BatchQuad(unsigned texture, GLvector2 pos, GLvector2 end, const GLvector2* uv, GLrgba color, GLenum blend_src, GLenum blend_dst);
+
+#endif // BATCH_H
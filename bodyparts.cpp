@@ -14,6 +14,7 @@
 #include "audio.h"
 #include "bodyparts.h"
 #include "collision.h"
+#include "gpu.h"
 #include "particle.h"
 #include "render.h"
 #include "sprite.h"
@@ -90,26 +91,26 @@ void bodyTail::Render()
 
 	if (_points.size() < 2)
 		return;
-	glBlendFunc(GL_ONE, GL_ONE);
-	glColor3fv(&_color.red);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuColor3fv(&_color.red);
 
 	uv = SpriteMapLookup(SPRITE_TAIL);
 	x1 = uv->uv[0].x;
 	x2 = uv->uv[1].x;
 	y1 = uv->uv[0].y;
 	y2 = uv->uv[2].y - uv->uv[0].y;
-	glBegin(GL_QUAD_STRIP);
+	GpuBegin(GL_QUAD_STRIP);
 	for (unsigned i = 0; i < _points.size(); i++) {
 		yi = y1 + y2 * ((float)i / (float)_points.size());
 
 		if (i == _points.size() - 1)
 			yi = y1;
-		glTexCoord2f(x1, yi);
-		glVertex3f(_points[i].left.x, _points[i].left.y, DEPTH_FX);
-		glTexCoord2f(x2, yi);
-		glVertex3f(_points[i].right.x, _points[i].right.y, DEPTH_FX);
+		GpuTexCoord2f(x1, yi);
+		GpuVertex3f(_points[i].left.x, _points[i].left.y, DEPTH_FX);
+		GpuTexCoord2f(x2, yi);
+		GpuVertex3f(_points[i].right.x, _points[i].right.y, DEPTH_FX);
 	}
-	glEnd();
+	GpuEnd();
 }
 
 /*-----------------------------------------------------------------------------
@@ -231,27 +232,27 @@ void bodyLeg::Render()
 	/*
 	RenderQuads();
 	glFlush();
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glColor3f(0, 0, 0);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuTexture(0);
+	GpuColor3f(0, 0, 0);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	*/
 	RenderTriangle (&_triangles[0]);
 	RenderTriangle (&_triangles[3]);
 	RenderTriangle (&_triangles[6]);
 	/*
-	glBegin(GL_TRIANGLES);
-	glVertex3f(_origin.x, _origin.y - _knee_size, 0);
-	glVertex3f(_knee.corner[0].x, _knee.corner[0].y, 0);
-	glVertex3f(_knee.corner[1].x, _knee.corner[1].y, 0);
-
-	glVertex3f(_origin.x, _origin.y + _knee_size, 0);
-	glVertex3f(_origin.x, _origin.y - _knee_size, 0);
-	glVertex3f(_knee.corner[1].x, _knee.corner[1].y, 0);
-
-	glVertex3f(_knee.corner[2].x, _knee.corner[2].y, 0);
-	glVertex3f(_knee.corner[3].x, _knee.corner[3].y, 0);
-	glVertex3f(_tip.x, _tip.y, 0);
-	glEnd();
+	GpuBegin(GL_TRIANGLES);
+	GpuVertex3f(_origin.x, _origin.y - _knee_size, 0);
+	GpuVertex3f(_knee.corner[0].x, _knee.corner[0].y, 0);
+	GpuVertex3f(_knee.corner[1].x, _knee.corner[1].y, 0);
+
+	GpuVertex3f(_origin.x, _origin.y + _knee_size, 0);
+	GpuVertex3f(_origin.x, _origin.y - _knee_size, 0);
+	GpuVertex3f(_knee.corner[1].x, _knee.corner[1].y, 0);
+
+	GpuVertex3f(_knee.corner[2].x, _knee.corner[2].y, 0);
+	GpuVertex3f(_knee.corner[3].x, _knee.corner[3].y, 0);
+	GpuVertex3f(_tip.x, _tip.y, 0);
+	GpuEnd();
 	*/
 	//glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
 	_sprite_knee.Render();
@@ -297,8 +298,8 @@ void bodyEye::Render()
 	return;
 	//glDepthMask (true);
 
-	glEnable(GL_DEPTH_TEST);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//If we're blinking, we have to render the eye manually because our vertex shader isn't
 	//robust enough to handle partial polys. Note that THIS way isn't robist enough to
 	//rotate them, so an eye can't boith blink and rotate.
@@ -311,15 +312,15 @@ void bodyEye::Render()
 		RenderQuad(_position, _sprite_eye, _color_outer, _size * 2, _angle, DEPTH_EYES, false);
 		RenderQuads();
 	}
-	glDepthFunc(GL_EQUAL);
+	GpuDepthFunc(GL_EQUAL);
 	shift = _look * (_size * 0.5f);
 	shift = SpriteMapVectorRotate(shift, (int)_angle);
 	shift.y *= -1;
 	RenderQuad(shift + _position, _sprite_iris, _color_inner, _size * 2, _angle, DEPTH_EYES, true);
 	RenderQuads();
 
-	glDepthFunc(GL_LEQUAL);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDepthFunc(GL_LEQUAL);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void bodyEye::RenderEye ()
@@ -127,8 +127,8 @@ void CameraUpdate()
 	camera_current.y = clamp(camera_current.y, camera_desired.y - CAMERA_MAX_DRIFT, camera_desired.y + CAMERA_MAX_DRIFT);
 	camera_moved = GLvector2(camera_current.x, camera_current.y) - old_camera;
 	if (shake_power > 0) {
-		camera_shake.x = (RandomFloat () - 0.5f) * SHAKE * shake_power;
-		camera_shake.y = (RandomFloat () - 0.5f) * SHAKE * shake_power;
+		camera_shake.x = (RandomChannel(RANDOM_COSMETIC).Float() - 0.5f) * SHAKE * shake_power;
+		camera_shake.y = (RandomChannel(RANDOM_COSMETIC).Float() - 0.5f) * SHAKE * shake_power;
 		shake_power *= SHAKE_FALLOFF;
 		if (shake_power < 0.001)
 			shake_power = 0;
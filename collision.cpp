@@ -13,8 +13,14 @@
 #include "master.h"
 
 #include "collision.h"
-#include "env.h"
 #include "world.h"
+#ifndef WORLDGEN_HEADLESS
+#include "env.h"
+#include "gpu.h"
+#else
+//The collision test has no settings and nothing to draw the debug points with.
+#define EnvValueb(id)             false
+#endif
 
 #define POINT_DENSITY             50.0f
 #define MAX_POINTS                10
@@ -23,7 +29,38 @@
 #define LEFT_EDGE                 GLvector2 (0.0f, 0.5f)
 #define RIGHT_EDGE                GLvector2 (1.0f, 0.5f)
 #define BOTTOM_EDGE               GLvector2 (0.5f, 1.0f)
+#define FAR_AWAY                  1000000.0f  //Ray distance that will never be reached.
+#define SWEEP_SKIN                0.001f      //How far short of a wall a sweep stops.
+#define SWEEP_PASSES              3           //Most walls we'll slide or bounce off of in one move.
+#define SWEEP_STRETCH             1.0f        //How much of a move to look at the cells under at a time.
+#define SWEEP_PARALLEL            0.000001f   //Moving this slowly towards a wall is moving along it.
+
+#define FLOOR_SEARCH              20          //How many cells below a point we look for a floor.
+
+enum
+{
+	FLOOR_LEFT,     //Points in the west half of a cell.
+	FLOOR_RIGHT,    //Points in the east half.
+	FLOOR_MIDDLE,   //Points exactly in the center, which only flat floors catch.
+	FLOOR_SIDES
+};
+
+struct CellPolygon
+{
+	int         count;
+	GLvector2   corner[5];
+};
 
+struct FloorCell
+{
+	int         row;
+	short       shape;
+};
+
+static vector<FloorCell>        floor_cell;   //Cells with a floor, grouped by column and side and sorted by row.
+static vector<int>              floor_start;  //Where each group begins in floor_cell.
+static GLcoord2                 floor_size;
+static bool                     floor_ready;
 static vector<GLvector2>        circle[MAX_POINTS];
 static vector<GLvector2>        debug_points;
 static int                      frame;
@@ -50,7 +87,10 @@ vector<GLvector2>* get_circle(int points)
 
 -----------------------------------------------------------------------------*/
 
-float CollisionFloor(GLvector2 point)
+//Look down from the given point, one cell at a time, until we find a surface
+//to stand on. This is what the height field below is built to reproduce, and
+//it's still used for points outside of the zone.
+static float floor_walk(GLvector2 point)
 {
 	int       shape;
 	int       steps;
@@ -61,7 +101,7 @@ float CollisionFloor(GLvector2 point)
 	steps = 0;
 	base = floor(point.y);
 	frac = point.x - floor(point.x);
-	while (steps < 20) {
+	while (steps < FLOOR_SEARCH) {
 		base = floor(point.y);
 		shape = WorldCellShape(point);
 		if (shape == 12)  //Flat floor
@@ -80,6 +120,118 @@ float CollisionFloor(GLvector2 point)
 	return base;
 }
 
+//Returns true if the given cell shape has a floor for points on the given side of the cell.
+static bool floor_shape(short shape, int side)
+{
+	if (shape == 12)  //Flat floor
+		return true;
+	if (side == FLOOR_LEFT)
+		return shape == 8 || shape == 14;
+	if (side == FLOOR_RIGHT)
+		return shape == 13 || shape == 4;
+	return false;
+}
+
+//The height of the floor in a cell of the given shape, as worked out by floor_walk ().
+static float floor_height(short shape, float base, float frac)
+{
+	if (shape == 8) //west ramp
+		return base + frac + 0.5f;
+	if (shape == 13)
+		return base + (frac - 0.5f);
+	if (shape == 4)
+		return (1.5f + base) - (frac);
+	if (shape == 14)
+		return (0.5f + base) - (frac);
+	return base + 0.5f;
+}
+
+//Gather up every cell in the zone that can be stood on, by column.
+static void floor_build()
+{
+	GLcoord2  cell;
+	short     shape;
+
+	floor_size = WorldCellSize();
+	floor_cell.clear();
+	floor_start.clear();
+	for (cell.x = 0; cell.x < floor_size.x; cell.x++) {
+		for (int side = 0; side < FLOOR_SIDES; side++) {
+			floor_start.push_back(floor_cell.size());
+			for (cell.y = 0; cell.y < floor_size.y; cell.y++) {
+				shape = WorldCellShape(cell);
+				if (floor_shape(shape, side)) {
+					FloorCell   f;
+
+					f.row = cell.y;
+					f.shape = shape;
+					floor_cell.push_back(f);
+				}
+			}
+		}
+	}
+	floor_start.push_back(floor_cell.size());
+	floor_ready = true;
+}
+
+static bool floor_before(const FloorCell& f, int row)
+{
+	return f.row < row;
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//Call this when the level geometry changes, so the floors can be found again.
+void CollisionClear()
+{
+	floor_ready = false;
+}
+
+//Find the height of the floor below the given point. Rather than looking
+//down one cell at a time, we binary search the cells in this column that
+//have floors.
+float CollisionFloor(GLvector2 point)
+{
+	vector<FloorCell>::iterator   begin;
+	vector<FloorCell>::iterator   end;
+	vector<FloorCell>::iterator   found;
+	float     frac;
+	int       side;
+	int       group;
+	int       row;
+	int       found_row;
+	short     shape;
+
+	if (!floor_ready)
+		floor_build();
+	if (point.x < 0.0f || point.y < 0.0f || point.x >= floor_size.x)
+		return floor_walk(point);
+	frac = point.x - floor(point.x);
+	side = FLOOR_MIDDLE;
+	if (frac < 0.5f)
+		side = FLOOR_LEFT;
+	else if (frac > 0.5f)
+		side = FLOOR_RIGHT;
+	group = (int)point.x * FLOOR_SIDES + side;
+	row = (int)point.y;
+	begin = floor_cell.begin() + floor_start[group];
+	end = floor_cell.begin() + floor_start[group + 1];
+	found = lower_bound(begin, end, row, floor_before);
+	if (found != end) {
+		found_row = found->row;
+		shape = found->shape;
+	}
+	else { //Everything below the zone counts as a flat floor.
+		found_row = max(row, floor_size.y);
+		shape = 12;
+	}
+	if (found_row - row >= FLOOR_SEARCH)
+		return floor(point.y) + (FLOOR_SEARCH - 1);
+	return floor_height(shape, floor(point.y) + (found_row - row), frac);
+}
+
 float CollisionCeiling(GLvector2 point)
 {
 	int       shape;
@@ -384,31 +536,387 @@ bool CollisionLos(GLvector2 start, GLvector2 end, float interval)
 	return true;
 }
 
+//The solid part of every cell shape is one or two half-planes. For each one,
+//this gives the same depth Collision () computes, as a linear function of
+//the position within the cell: depth = x * frac.x + y * frac.y + z.
+//Returns how many planes the shape has.
+static int cell_planes(short shape, GLvector* plane, GLvector2* normal)
+{
+	switch (shape) {
+	case 1: //NW corner
+		plane[0] = GLvector(-1, -1, 0.5f); normal[0] = GLvector2(0.5f, 0.5f);
+		return 1;
+	case 2: //NE corner
+		plane[0] = GLvector(1, -1, -0.5f); normal[0] = GLvector2(-0.5f, 0.5f);
+		return 1;
+	case 3: //north wall
+		plane[0] = GLvector(0, -1, 0.5f); normal[0] = GLvector2(0, 1);
+		return 1;
+	case 4: //SE corner
+		plane[0] = GLvector(1, 1, -1.5f); normal[0] = GLvector2(-0.5f, -0.5f);
+		return 1;
+	case 5: //NW and SE corners
+		plane[0] = GLvector(-1, -1, 0.5f); normal[0] = GLvector2(0.5f, 0.5f);
+		plane[1] = GLvector(1, 1, -1.5f); normal[1] = GLvector2(-0.5f, -0.5f);
+		return 2;
+	case 6: //East wall
+		plane[0] = GLvector(1, 0, -0.5f); normal[0] = GLvector2(-1, 0);
+		return 1;
+	case 7: //SW gap
+		plane[0] = GLvector(1, -1, 0.5f); normal[0] = GLvector2(-0.5f, 0.5f);
+		return 1;
+	case 8: //SW corner
+		plane[0] = GLvector(-1, 1, -0.5f); normal[0] = GLvector2(0.5f, -0.5f);
+		return 1;
+	case 9: //West wall
+		plane[0] = GLvector(-1, 0, 0.5f); normal[0] = GLvector2(1, 0);
+		return 1;
+	case 10: //NE and SW corners
+		plane[0] = GLvector(-1, 1, -0.5f); normal[0] = GLvector2(0.5f, -0.5f);
+		plane[1] = GLvector(1, -1, -0.5f); normal[1] = GLvector2(-0.5f, 0.5f);
+		return 2;
+	case 11: //SE gap
+		plane[0] = GLvector(-1, -1, 1.5f); normal[0] = GLvector2(0.5f, 0.5f);
+		return 1;
+	case 12: //South wall
+		plane[0] = GLvector(0, 1, -0.5f); normal[0] = GLvector2(0, -1);
+		return 1;
+	case 13: //NE gap
+		plane[0] = GLvector(-1, 1, 0.5f); normal[0] = GLvector2(0.5f, -0.5f);
+		return 1;
+	case 14: //NW gap
+		plane[0] = GLvector(1, 1, -0.5f); normal[0] = GLvector2(-0.5f, -0.5f);
+		return 1;
+	case 15: //Solid
+		plane[0] = GLvector(0, 0, 1); normal[0] = GLvector2(-0.0f, -1.0f);
+		return 1;
+	}
+	return 0;
+}
+
+//Walk the grid from start along delta one cell at a time, intersecting the
+//line with the shape of each cell it crosses, so the result is exact and the
+//cost is the number of cells crossed. On a hit, returns true and fills in
+//how far along delta (0 to 1) the wall was met, and the same normal
+//Collision () would report there. If entering is set, walls the line is
+//already moving out of are ignored, so something embedded in a wall can
+//still back out of it.
+static bool ray_cast(GLvector2 start, GLvector2 delta, bool entering, float* time, GLvector2* normal)
+{
+	GLcoord2    cell;
+	GLcoord2    cell_step;
+	GLvector2   t_delta;
+	GLvector2   t_next;
+	GLvector    plane[2];
+	GLvector2   plane_normal[2];
+	float       t_enter;
+	float       t_exit;
+	float       t_hit;
+	int         planes;
+
+	cell = GLcoord2((int)floor(start.x), (int)floor(start.y));
+	cell_step.x = delta.x < 0 ? -1 : 1;
+	cell_step.y = delta.y < 0 ? -1 : 1;
+	//How far along the segment (0 to 1) we travel to cross one whole cell on each axis,
+	//and how far until we cross the next cell boundary.
+	t_delta.x = delta.x != 0.0f ? fabs(1.0f / delta.x) : FAR_AWAY;
+	t_delta.y = delta.y != 0.0f ? fabs(1.0f / delta.y) : FAR_AWAY;
+	if (delta.x == 0.0f)
+		t_next.x = FAR_AWAY;
+	else if (delta.x > 0)
+		t_next.x = ((float)(cell.x + 1) - start.x) * t_delta.x;
+	else
+		t_next.x = (start.x - (float)cell.x) * t_delta.x;
+	if (delta.y == 0.0f)
+		t_next.y = FAR_AWAY;
+	else if (delta.y > 0)
+		t_next.y = ((float)(cell.y + 1) - start.y) * t_delta.y;
+	else
+		t_next.y = (start.y - (float)cell.y) * t_delta.y;
+	t_enter = 0.0f;
+	while (t_enter <= 1.0f) {
+		t_exit = min(min(t_next.x, t_next.y), 1.0f);
+		planes = cell_planes(WorldCellShape(cell), plane, plane_normal);
+		t_hit = FAR_AWAY;
+		for (int i = 0; i < planes; i++) {
+			float   depth_start;
+			float   depth_rate;
+			float   t;
+
+			//Depth along the segment, relative to this cell.
+			depth_start = plane[i].x * (start.x - cell.x) + plane[i].y * (start.y - cell.y) + plane[i].z;
+			depth_rate = plane[i].x * delta.x + plane[i].y * delta.y;
+			if (entering && depth_rate <= 0.0f)
+				continue;
+			if (depth_start + depth_rate * t_enter > 0.0f)
+				t = t_enter;
+			else if (depth_rate > 0.0f)
+				t = -depth_start / depth_rate;
+			else
+				continue;
+			if (t <= t_exit && t < t_hit) {
+				t_hit = t;
+				*normal = plane_normal[i];
+			}
+		}
+		if (t_hit != FAR_AWAY) {
+			*time = t_hit;
+			return true;
+		}
+		//Step into whichever neighbor the line crosses into first.
+		if (t_next.x < t_next.y) {
+			cell.x += cell_step.x;
+			t_enter = t_next.x;
+			t_next.x += t_delta.x;
+		}
+		else {
+			cell.y += cell_step.y;
+			t_enter = t_next.y;
+			t_next.y += t_delta.y;
+		}
+	}
+	return false;
+}
+
+//Find the first point where the segment from start to end enters a wall.
+//On a hit, returns true and fills in the position and the same normal
+//Collision () would report there.
+bool CollisionRay(GLvector2 start, GLvector2 end, GLvector2* hit, GLvector2* normal)
+{
+	float       t;
+
+	if (!ray_cast(start, end - start, false, &t, normal))
+		return false;
+	*hit = start + (end - start) * t;
+	if (EnvValueb(ENV_BUMP))
+		debug_points.push_back(*hit);
+	return true;
+}
+
+//The solid part of a cell, as one or two convex polygons in cell space: the
+//cell square cut down by each of the shape's planes.
+static int cell_polygons(short shape, CellPolygon* polygon)
+{
+	static const GLvector2  square[4] = { GLvector2(0, 0), GLvector2(1, 0), GLvector2(1, 1), GLvector2(0, 1) };
+	GLvector    plane[2];
+	GLvector2   plane_normal[2];
+	int         planes;
+
+	planes = cell_planes(shape, plane, plane_normal);
+	for (int p = 0; p < planes; p++) {
+		CellPolygon*  poly = &polygon[p];
+
+		poly->count = 0;
+		for (int i = 0; i < 4; i++) {
+			GLvector2   a = square[i];
+			GLvector2   b = square[(i + 1) % 4];
+			float       depth_a = plane[p].x * a.x + plane[p].y * a.y + plane[p].z;
+			float       depth_b = plane[p].x * b.x + plane[p].y * b.y + plane[p].z;
+
+			if (depth_a >= 0.0f)
+				poly->corner[poly->count++] = a;
+			//The plane crosses this side of the square.
+			if ((depth_a > 0.0f && depth_b < 0.0f) || (depth_a < 0.0f && depth_b > 0.0f))
+				poly->corner[poly->count++] = a + (b - a) * (depth_a / (depth_a - depth_b));
+		}
+	}
+	return planes;
+}
+
+//Sweep a circle from start along delta against the edge from a to b, which
+//has the solid side opposite out. Touching the flat of the edge counts only
+//if the circle is moving into it, and touching the corner at a only if it's
+//moving towards it, so a circle that starts out touching can always back
+//away. Each corner starts one edge, so the polygon's edges cover them all.
+static bool sweep_edge(GLvector2 start, GLvector2 delta, float radius, GLvector2 a, GLvector2 b, GLvector2 out, float* time, GLvector2* normal)
+{
+	GLvector2   edge;
+	GLvector2   offset;
+	float       approach;
+	float       distance;
+	float       along;
+	float       qa, qb, qc;
+	float       root;
+	float       t;
+	bool        hit;
+
+	hit = false;
+	edge = b - a;
+	approach = GLdot(delta, out);
+	distance = GLdot(start - a, out);
+	if (approach < -SWEEP_PARALLEL && distance >= 0.0f) {
+		t = distance > radius ? (distance - radius) / -approach : 0.0f;
+		along = GLdot(start + delta * t - a, edge) / GLdot(edge, edge);
+		if (t < *time && along >= 0.0f && along <= 1.0f) {
+			*time = t;
+			*normal = out;
+			hit = true;
+		}
+	}
+	//The circle reaches the corner when the center is one radius from it.
+	offset = start - a;
+	qa = GLdot(delta, delta);
+	qb = GLdot(offset, delta);
+	qc = GLdot(offset, offset) - radius * radius;
+	if (qb >= -SWEEP_PARALLEL)
+		return hit;
+	if (qc <= 0.0f)
+		t = 0.0f;
+	else {
+		root = qb * qb - qa * qc;
+		if (root < 0.0f)
+			return hit;
+		t = (-qb - sqrt(root)) / qa;
+	}
+	if (t < *time) {
+		*time = t;
+		*normal = (offset + delta * t).Normalized();
+		hit = true;
+	}
+	return hit;
+}
+
+//Move a circle of the given radius along movement and find the first moment
+//it touches a wall. Every cell the circle passes over is cut into the convex
+//polygons of its solid part, and the circle is swept exactly against their
+//edges and corners, so the whole circle is kept out of the walls and nothing
+//can pass through one no matter how fast it's going. A radius of zero
+//sweeps just the center, with the same grid walk as CollisionRay ().
+//Returns true on a hit, with time (0 to 1) how much of the movement happens
+//before contact, and the outward normal of the wall that stopped us.
+bool CollisionSweep(GLvector2 position, GLvector2 movement, float radius, float* time, GLvector2* normal)
+{
+	CellPolygon   polygon[2];
+	GLvector2     wall;
+	float         t;
+	float         length;
+	int           steps;
+	bool          hit;
+
+	if (movement.IsZero())
+		return false;
+	if (radius <= 0.0f) {
+		if (!ray_cast(position, movement, true, &t, &wall))
+			return false;
+		*time = t;
+		*normal = wall;
+		return true;
+	}
+	hit = false;
+	*time = 1.0f;
+	//Look at the cells under the circle one stretch of the move at a time, so
+	//a long move doesn't look at every cell in a big box around it. A wall met
+	//during one stretch is under that stretch, so once we have a hit before
+	//the end of a stretch, nothing further on can beat it.
+	length = movement.Length();
+	steps = max(1, (int)ceil(length / SWEEP_STRETCH));
+	for (int step = 0; step < steps && *time > (float)step / steps; step++) {
+		GLvector2   from = position + movement * ((float)step / steps);
+		GLvector2   to = position + movement * ((float)(step + 1) / steps);
+		GLcoord2    low((int)floor(min(from.x, to.x) - radius), (int)floor(min(from.y, to.y) - radius));
+		GLcoord2    high((int)floor(max(from.x, to.x) + radius), (int)floor(max(from.y, to.y) + radius));
+
+		for (int y = low.y; y <= high.y; y++) {
+			for (int x = low.x; x <= high.x; x++) {
+				GLvector2   local = position - GLvector2((float)x, (float)y);
+				int         polygons;
+
+				polygons = cell_polygons(WorldCellShape(GLcoord2(x, y)), polygon);
+				for (int p = 0; p < polygons; p++) {
+					CellPolygon*  poly = &polygon[p];
+					GLvector2     middle;
+
+					middle = GLvector2(0, 0);
+					for (int i = 0; i < poly->count; i++)
+						middle += poly->corner[i];
+					middle /= (float)poly->count;
+					for (int i = 0; i < poly->count; i++) {
+						GLvector2   a = poly->corner[i];
+						GLvector2   b = poly->corner[(i + 1) % poly->count];
+						GLvector2   out = (b - a).TurnedRight().Normalized();
+
+						if (GLdot(middle - a, out) > 0.0f)
+							out *= -1.0f;
+						if (sweep_edge(local, movement, radius, a, b, out, time, normal))
+							hit = true;
+					}
+				}
+			}
+		}
+	}
+	if (hit && EnvValueb(ENV_BUMP))
+		debug_points.push_back(position + movement * *time);
+	return hit;
+}
+
+//Move the circle as far as it can go along movement. When it meets a wall,
+//the rest of the move either bounces off (bounce is the fraction of speed
+//kept) or, if bounce is COLLISION_SLIDE, slides along the wall. Either way the rest of
+//the move is swept again, so nothing ever ends up inside a wall. Movement
+//is changed to the velocity we're left with, and wall gets the normal of
+//the last wall we touched. Returns true if we touched one at all.
+bool CollisionMove(GLvector2* position, GLvector2* movement, float radius, float bounce, GLvector2* wall)
+{
+	GLvector2   remain;
+	GLvector2   normal;
+	float       t;
+	float       speed;
+	bool        touched;
+
+	touched = false;
+	remain = *movement;
+	for (int pass = 0; pass < SWEEP_PASSES; pass++) {
+		if (!CollisionSweep(*position, remain, radius, &t, &normal)) {
+			*position += remain;
+			return touched;
+		}
+		touched = true;
+		normal.Normalize();
+		*wall = normal;
+		//Stop just short of the wall, so the next sweep doesn't start inside it.
+		speed = remain.Length();
+		t = max(0.0f, t - SWEEP_SKIN / speed);
+		*position += remain * t;
+		remain *= 1.0f - t;
+		if (bounce != COLLISION_SLIDE) {
+			remain = GLreflect2(remain, normal) * bounce;
+			*movement = GLreflect2(*movement, normal) * bounce;
+		} else {
+			remain -= normal * GLdot(remain, normal);
+			*movement -= normal * GLdot(*movement, normal);
+		}
+	}
+	//Wedged into a corner. Stay where we stopped.
+	return touched;
+}
+
+#ifndef WORLDGEN_HEADLESS
 //Not used in production situations. This just renders all the collision checks
 //that were performed this frame.
 void CollisionRender()
 {
 	if (!EnvValueb(ENV_BUMP))
 		return;
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_DEPTH_TEST);
-	glColor3f(1, 1, 0);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin(GL_QUADS);
+	GpuDisable(GL_TEXTURE_2D);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuColor3f(1, 1, 0);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBegin(GL_QUADS);
 	for (unsigned i = 0; i < debug_points.size(); i++) {
-		glVertex3f(debug_points[i].x - RSIZE, debug_points[i].y - RSIZE, DEPTH_UNITS);
-		glVertex3f(debug_points[i].x + RSIZE, debug_points[i].y - RSIZE, DEPTH_UNITS);
-		glVertex3f(debug_points[i].x + RSIZE, debug_points[i].y + RSIZE, DEPTH_UNITS);
-		glVertex3f(debug_points[i].x - RSIZE, debug_points[i].y + RSIZE, DEPTH_UNITS);
+		GpuVertex3f(debug_points[i].x - RSIZE, debug_points[i].y - RSIZE, DEPTH_UNITS);
+		GpuVertex3f(debug_points[i].x + RSIZE, debug_points[i].y - RSIZE, DEPTH_UNITS);
+		GpuVertex3f(debug_points[i].x + RSIZE, debug_points[i].y + RSIZE, DEPTH_UNITS);
+		GpuVertex3f(debug_points[i].x - RSIZE, debug_points[i].y + RSIZE, DEPTH_UNITS);
 	}
-	glEnd();
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_TEXTURE_2D);
+	GpuEnd();
+	GpuEnable(GL_DEPTH_TEST);
+	GpuEnable(GL_TEXTURE_2D);
 	//Only clear the list every few frames, so we can SEE the dots.
 	frame = (frame + 1) % 5;
 	if (!frame)
 		debug_points.clear();
 }
+#endif
 
 //For the given cell, return a vector containing all the line segments
 //that make up its shape. This is used by the visibility system to generate
@@ -1,15 +1,21 @@
 #ifndef COLLISION_H
 #define COLLISION_H
 
+#define COLLISION_SLIDE   -1.0f   //Pass as the bounce to CollisionMove () to slide along walls.
+
 bool      Collision(GLvector2 point, GLvector2* normal, float* depth);
 bool      Collision(GLvector2 point);
 bool      Collision(GLvector2 position, float radius);
 bool      Collision(GLvector2 position, GLvector2* normal, float* depth, float radius);
 float     CollisionCeiling(GLvector2 point);
+void      CollisionClear();
 float     CollisionFloor(GLvector2 point);
 bool      CollisionLine(GLcoord2 cell, vector<Line2D>& lines);
 bool      CollisionLos(GLvector2 start, GLvector2 end, float interval);
+bool      CollisionMove(GLvector2* position, GLvector2* movement, float radius, float bounce, GLvector2* wall);
+bool      CollisionRay(GLvector2 start, GLvector2 end, GLvector2* hit, GLvector2* normal);
 void      CollisionRender();
 GLvector2 CollisionSlide(GLvector2 wall, GLvector2 movement);
+bool      CollisionSweep(GLvector2 position, GLvector2 movement, float radius, float* time, GLvector2* normal);
 
 #endif // COLLISION_H
\ No newline at end of file
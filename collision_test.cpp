@@ -0,0 +1,439 @@
+/*-----------------------------------------------------------------------------
+
+  Collision_test.cpp
+
+  Command line test for the level collision code. It builds random cell
+  layouts the same way pages do (marching squares over solid and open
+  corners), stands in for the world so collision.cpp can run without the
+  game, and checks the exact routines against the slow ways they replaced:
+  sampling Collision () in tiny steps along a line, and looking down one
+  cell at a time for a floor.
+
+  Sweeps and moves are checked against the true circle, by casting spokes
+  out from the center with CollisionRay (): no wall may reach inside the
+  circle anywhere along a sweep before its hit, or where a move ends. A
+  wall corner can poke in between two spokes, so the spokes only ever miss
+  a failure, never make one up.
+
+  Sampling can step right over a wall that the line only grazes, so a hit
+  the samples missed is counted, not failed. A hit that comes later than the
+  samples found, or one the samples say isn't there at all, is a failure.
+
+  usage: collision_test [layouts] [seed]
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include <stdarg.h>
+
+#include "collision.h"
+#include "random.h"
+#include "world.h"
+
+#define DEFAULT_LAYOUTS   8
+#define GRID_SIZE         48
+#define SOLID_ODDS        35          //Percent of corners that are solid.
+#define RAYS_PER_LAYOUT   2500
+#define BOXES_PER_LAYOUT  2500
+#define FLOORS_PER_LAYOUT 20000
+#define FLOOR_SEARCH      20          //Must match collision.cpp.
+#define SWEEPS_PER_LAYOUT 1000
+#define SWEEP_LENGTH      6.0f        //Longer than a cell, so tunneling would show.
+#define SWEEP_STEP        0.005f      //How finely the path of a sweep is checked.
+#define PATH_SPOKES       48          //Spokes for each step along the path of a sweep.
+#define END_SPOKES        720         //Spokes where a move ends.
+#define RAY_LENGTH        12.0f
+#define SAMPLE_STEP       0.001f      //How finely the old way walks along a line.
+#define TOLERANCE         0.002f      //How far apart (in world units) two answers can be and still agree.
+#define MAX_REPORTS       10
+
+static GLcoord2               grid_size;
+static vector<unsigned char>  corner;         //(grid_size.x + 1) * (grid_size.y + 1), true if solid.
+static int                    failures;
+
+/*-----------------------------------------------------------------------------
+The world, as far as collision.cpp can tell.
+-----------------------------------------------------------------------------*/
+
+static bool corner_solid(int x, int y)
+{
+	return corner[x + y * (grid_size.x + 1)] != 0;
+}
+
+//Same as Zone::CellShape (): the zone is walled in on every side.
+short WorldCellShape(GLvector2 point)
+{
+	GLcoord2  cell((int)point.x, (int)point.y);
+	short     shape;
+
+	if (cell.x < 0)
+		return 9;
+	if (cell.y < 0)
+		return 3;
+	if (cell.x >= grid_size.x)
+		return 6;
+	if (cell.y >= grid_size.y)
+		return 12;
+	shape = 0;
+	if (corner_solid(cell.x, cell.y))
+		shape |= 1;
+	if (corner_solid(cell.x + 1, cell.y))
+		shape |= 2;
+	if (corner_solid(cell.x + 1, cell.y + 1))
+		shape |= 4;
+	if (corner_solid(cell.x, cell.y + 1))
+		shape |= 8;
+	return shape;
+}
+
+GLcoord2 WorldCellSize() { return grid_size; }
+
+static void build_layout(RandomStream& random)
+{
+	grid_size = GLcoord2(GRID_SIZE, GRID_SIZE);
+	corner.resize((grid_size.x + 1) * (grid_size.y + 1));
+	for (int y = 0; y <= grid_size.y; y++) {
+		for (int x = 0; x <= grid_size.x; x++) {
+			bool    edge = x == 0 || y == 0 || x == grid_size.x || y == grid_size.y;
+
+			//Zones are surrounded by solid pages, so nothing inside can reach
+			//the cells past the edge.
+			corner[x + y * (grid_size.x + 1)] = edge || random.Val(100) < SOLID_ODDS ? 1 : 0;
+		}
+	}
+	CollisionClear();
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static void fail(const char* message, ...)
+{
+	va_list   args;
+
+	failures++;
+	if (failures > MAX_REPORTS)
+		return;
+	va_start(args, message);
+	printf("  FAIL: ");
+	vprintf(message, args);
+	printf("\n");
+	va_end(args);
+}
+
+//Somewhere inside the walls around the edge of the layout.
+static GLvector2 random_point(RandomStream& random)
+{
+	return GLvector2(1.0f + random.Float() * (grid_size.x - 2), 1.0f + random.Float() * (grid_size.y - 2));
+}
+
+//The old way of finding a wall along a line: look at points a tiny step
+//apart until one of them is inside something. Returns the distance along
+//the line, or -1 if nothing was found.
+static float sampled_hit(GLvector2 start, GLvector2 end)
+{
+	GLvector2   dir;
+	float       length;
+
+	dir = end - start;
+	length = dir.Length();
+	if (length > 0.0f)
+		dir /= length;
+	for (float d = 0.0f; d <= length; d += SAMPLE_STEP) {
+		if (Collision(start + dir * d))
+			return d;
+	}
+	if (Collision(end))
+		return length;
+	return -1.0f;
+}
+
+/*-----------------------------------------------------------------------------
+CollisionRay
+-----------------------------------------------------------------------------*/
+
+static void test_ray(RandomStream& random, int* rays, int* grazes, int* normals)
+{
+	for (int i = 0; i < RAYS_PER_LAYOUT; i++) {
+		GLvector2   start, end, hit, normal, sample_normal;
+		float       length, sampled, traced;
+		float       depth;
+		bool        found;
+
+		start = random_point(random);
+		end = start + GLvectorFromAngle(random.Float() * 360.0f) * (random.Float() * RAY_LENGTH);
+		length = (end - start).Length();
+		sampled = sampled_hit(start, end);
+		found = CollisionRay(start, end, &hit, &normal);
+		traced = found ? (hit - start).Length() : -1.0f;
+		(*rays)++;
+		if (sampled >= 0.0f && !found) {
+			fail("ray (%f, %f) to (%f, %f) missed a wall the samples found %f along.", start.x, start.y, end.x, end.y, sampled);
+			continue;
+		}
+		if (!found)
+			continue;
+		if (traced > length + TOLERANCE) {
+			fail("ray (%f, %f) to (%f, %f) hit past its end.", start.x, start.y, end.x, end.y);
+			continue;
+		}
+		if (sampled >= 0.0f && traced > sampled + TOLERANCE) {
+			fail("ray (%f, %f) to (%f, %f) hit at %f, but the samples hit at %f.", start.x, start.y, end.x, end.y, traced, sampled);
+			continue;
+		}
+		//The ray found a wall first. Either the samples agree, or they
+		//stepped over a corner the line only just touched.
+		if (sampled < 0.0f || sampled > traced + TOLERANCE) {
+			(*grazes)++;
+			continue;
+		}
+		Collision(start + (end - start) * (sampled / length), &sample_normal, &depth);
+		if (!(sample_normal == normal))
+			(*normals)++;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+GLbbox2::Crosses, which EntityRobotsAlong () uses to pick out robots.
+-----------------------------------------------------------------------------*/
+
+//Does any sample along the line land inside the box, grown by margin?
+static bool sampled_cross(GLvector2 start, GLvector2 end, GLbbox2 box, float margin)
+{
+	GLvector2   dir;
+	float       length;
+
+	box.pmin -= GLvector2(margin, margin);
+	box.pmax += GLvector2(margin, margin);
+	dir = end - start;
+	length = dir.Length();
+	if (length > 0.0f)
+		dir /= length;
+	for (float d = 0.0f; d <= length; d += SAMPLE_STEP) {
+		if (box.Contains(start + dir * d))
+			return true;
+	}
+	return box.Contains(end);
+}
+
+static void test_boxes(RandomStream& random, int* boxes, int* grazes)
+{
+	for (int i = 0; i < BOXES_PER_LAYOUT; i++) {
+		GLvector2   start, end, center, size;
+		GLbbox2     box;
+		bool        crosses;
+
+		center = random_point(random);
+		size = GLvector2(0.1f + random.Float() * 2.0f, 0.1f + random.Float() * 2.0f);
+		box.Clear();
+		box.ContainPoint(center - size / 2);
+		box.ContainPoint(center + size / 2);
+		start = center + random.Vector2() * 4.0f;
+		end = start + GLvectorFromAngle(random.Float() * 360.0f) * (random.Float() * RAY_LENGTH);
+		crosses = box.Crosses(start, end);
+		(*boxes)++;
+		if (sampled_cross(start, end, box, 0.0f)) {
+			if (!crosses)
+				fail("segment (%f, %f) to (%f, %f) passes through a box Crosses () missed.", start.x, start.y, end.x, end.y);
+			continue;
+		}
+		if (!crosses)
+			continue;
+		if (!sampled_cross(start, end, box, TOLERANCE))
+			fail("segment (%f, %f) to (%f, %f) misses a box Crosses () reported.", start.x, start.y, end.x, end.y);
+		else
+			(*grazes)++;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+CollisionFloor
+-----------------------------------------------------------------------------*/
+
+//The old linear scan: look down from the point one cell at a time until
+//we find something to stand on.
+static float walked_floor(GLvector2 point)
+{
+	int       shape;
+	int       steps;
+	float     frac;
+	float     base;
+
+	shape = 0;
+	steps = 0;
+	base = floor(point.y);
+	frac = point.x - floor(point.x);
+	while (steps < FLOOR_SEARCH) {
+		base = floor(point.y);
+		shape = WorldCellShape(point);
+		if (shape == 12)  //Flat floor
+			return base + 0.5f;
+		if (shape == 8 && frac < 0.5f) //west ramp
+			return base + frac + 0.5f;
+		if (shape == 13 && frac>0.5f)
+			return base + (frac - 0.5f);
+		if (shape == 4 && frac > 0.5f)
+			return (1.5f + base) - (frac);
+		if (shape == 14 && frac < 0.5f)
+			return (0.5f + base) - (frac);
+		point.y += 1.0f;
+		steps++;
+	}
+	return base;
+}
+
+static void test_floor(RandomStream& random, int* floors)
+{
+	for (int i = 0; i < FLOORS_PER_LAYOUT; i++) {
+		GLvector2   point;
+		float       searched, walked;
+
+		//Mostly inside the zone, but some points off every edge too.
+		point = GLvector2(random.Float() * (grid_size.x + 8) - 4, random.Float() * (grid_size.y + 8) - 4);
+		//Every so often, land exactly on the middle of a cell or a cell edge.
+		if (random.Roll(10))
+			point.x = floor(point.x) + random.Val(3) * 0.5f;
+		searched = CollisionFloor(point);
+		walked = walked_floor(point);
+		(*floors)++;
+		if (fabs(searched - walked) > 0.0001f)
+			fail("floor under (%f, %f) is %f, but looking down finds %f.", point.x, point.y, searched, walked);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+CollisionSweep and CollisionMove
+-----------------------------------------------------------------------------*/
+
+static const float    sweep_radius[] = { 0.0f, 0.12f, 0.25f, 0.4f, 0.8f, 1.5f };
+
+#define SWEEP_RADII       (sizeof (sweep_radius) / sizeof (float))
+
+//How far the deepest wall reaches into the circle, looking along the given
+//number of spokes from the center.
+static float penetration(GLvector2 center, float radius, int spokes)
+{
+	float     deepest = 0.0f;
+
+	if (Collision(center))
+		return max(radius, TOLERANCE * 2);
+	for (int i = 0; i < spokes && radius > 0.0f; i++) {
+		GLvector2   edge, hit, normal;
+
+		edge = center + GLvectorFromAngle(i * 360.0f / spokes) * radius;
+		if (CollisionRay(center, edge, &hit, &normal))
+			deepest = max(deepest, radius - (hit - center).Length());
+	}
+	return deepest;
+}
+
+//Collision () truncates to find a cell and the grid walk rounds down, so
+//they only agree on which cell a point is in at positive coordinates.
+//Nothing in the game gets past the walls at the edge of the zone, so keep
+//the movers inside it.
+static bool inside_layout(GLvector2 center, float radius)
+{
+	return center.x - radius > 0.0f && center.y - radius > 0.0f && center.x + radius < grid_size.x && center.y + radius < grid_size.y;
+}
+
+static void test_sweep(RandomStream& random, int* sweeps, int* grazes, int* moves, float* worst)
+{
+	for (int i = 0; i < SWEEPS_PER_LAYOUT; i++) {
+		GLvector2   start, movement, normal, wall;
+		GLvector2   position, velocity;
+		float       radius, length, t, end, after, deepest;
+		bool        hit;
+		int         which;
+
+		which = random.Val(SWEEP_RADII);
+		radius = sweep_radius[which];
+		start = random_point(random);
+		if (penetration(start, radius, END_SPOKES) > 0.0f)
+			continue;
+		movement = GLvectorFromAngle(random.Float() * 360.0f) * (0.01f + random.Float() * SWEEP_LENGTH);
+		if (!inside_layout(start, radius) || !inside_layout(start + movement, radius))
+			continue;
+		length = movement.Length();
+		(*sweeps)++;
+		//Nothing along the way may touch a wall before the sweep says it does.
+		hit = CollisionSweep(start, movement, radius, &t, &normal);
+		end = hit ? t - TOLERANCE / length : 1.0f;
+		for (float s = 0.0f; s < end; s += SWEEP_STEP / length) {
+			if (penetration(start + movement * s, radius, PATH_SPOKES) > TOLERANCE) {
+				fail("radius %.2f sweep from (%f, %f) by (%f, %f) went into a wall at %f, before the hit at %f.", radius, start.x, start.y, movement.x, movement.y, s, hit ? t : 1.0f);
+				break;
+			}
+		}
+		//And just after the hit, we should be touching it.
+		if (hit) {
+			after = min(t + TOLERANCE / length, 1.0f);
+			if (penetration(start + movement * after, radius, END_SPOKES) <= 0.0f)
+				(*grazes)++;
+		}
+		//Bounce or slide, the move has to end up somewhere we fit, and no
+		//further away than we were trying to go.
+		position = start;
+		velocity = movement;
+		CollisionMove(&position, &velocity, radius, random.Roll(2) ? COLLISION_SLIDE : 0.5f, &wall);
+		(*moves)++;
+		deepest = penetration(position, radius, END_SPOKES);
+		worst[which] = max(worst[which], deepest);
+		if (deepest > TOLERANCE)
+			fail("radius %.2f move from (%f, %f) by (%f, %f) ended at (%f, %f) with a wall %f inside the circle.", radius, start.x, start.y, movement.x, movement.y, position.x, position.y, deepest);
+		if ((position - start).Length() > length + TOLERANCE)
+			fail("radius %.2f move from (%f, %f) by (%f, %f) went further than it was moving.", radius, start.x, start.y, movement.x, movement.y);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+int main(int argc, char** argv)
+{
+	int             layouts;
+	unsigned long   seed;
+	int             rays, ray_grazes, ray_normals;
+	int             boxes, box_grazes;
+	int             floors;
+	int             sweeps, sweep_grazes, moves;
+	float           worst[SWEEP_RADII];
+
+	layouts = argc > 1 ? atoi(argv[1]) : DEFAULT_LAYOUTS;
+	seed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+	if (layouts < 1) {
+		printf("usage: %s [layouts] [seed]\n", argv[0]);
+		return 1;
+	}
+	rays = ray_grazes = ray_normals = 0;
+	boxes = box_grazes = 0;
+	floors = 0;
+	sweeps = sweep_grazes = moves = 0;
+	for (unsigned r = 0; r < SWEEP_RADII; r++)
+		worst[r] = 0.0f;
+	for (int l = 0; l < layouts; l++) {
+		RandomStream  random = RandomStream(seed).Split(l);
+
+		build_layout(random);
+		test_ray(random, &rays, &ray_grazes, &ray_normals);
+		test_boxes(random, &boxes, &box_grazes);
+		test_floor(random, &floors);
+		test_sweep(random, &sweeps, &sweep_grazes, &moves, worst);
+	}
+	printf("CollisionRay: %d rays, %d grazing hits the samples stepped over, %d hits with a different corner normal.\n", rays, ray_grazes, ray_normals);
+	printf("GLbbox2::Crosses: %d segments, %d grazing the edge of a box.\n", boxes, box_grazes);
+	printf("CollisionFloor: %d points.\n", floors);
+	printf("CollisionSweep: %d sweeps, %d grazing hits. CollisionMove: %d moves.\n", sweeps, sweep_grazes, moves);
+	for (unsigned r = 0; r < SWEEP_RADII; r++)
+		printf("  radius %.2f: deepest wall inside the circle where a move ended %.4f\n", sweep_radius[r], worst[r]);
+	if (failures) {
+		printf("%d failures.\n", failures);
+		return 1;
+	}
+	printf("All passed.\n");
+	return 0;
+}
@@ -13,6 +13,7 @@
 
 #include "font.h"
 #include "game.h"
+#include "gpu.h"
 #include "interface.h"
 #include "render.h"
 #include "system.h"
@@ -148,21 +149,21 @@ void ConsoleRender()
 	//Leave a bit of a margin.
 	bottom += font->Height() / 4;
 	//Draw the console background.
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_DEPTH_TEST);
-	glDepthMask(false);
-	glColor4fv(&color_console.red);
-	glBegin(GL_QUADS);
-	glVertex2i(0, 0);
-	glVertex2i(size.x, 0);
-	glVertex2i(size.x, bottom);
-	glVertex2i(0, bottom);
-	glEnd();
-	glColor4fv(&color_border.red);
-	glBegin(GL_LINES);
-	glVertex2i(0, bottom);
-	glVertex2i(size.x, bottom);
-	glEnd();
+	GpuDisable(GL_TEXTURE_2D);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDepthMask(false);
+	GpuColor4fv(&color_console.red);
+	GpuBegin(GL_QUADS);
+	GpuVertex2i(0, 0);
+	GpuVertex2i(size.x, 0);
+	GpuVertex2i(size.x, bottom);
+	GpuVertex2i(0, bottom);
+	GpuEnd();
+	GpuColor4fv(&color_border.red);
+	GpuBegin(GL_LINES);
+	GpuVertex2i(0, bottom);
+	GpuVertex2i(size.x, bottom);
+	GpuEnd();
 	//Draw the contents of the console.
 	pos = GLcoord2();
 	for (int i = 0; i < display_lines; i++) {
@@ -179,9 +180,9 @@ void ConsoleRender()
 	pos.x += font->Print(pos, input.characters);
 	font->Print(pos, "_");
 	font->PopScreen();
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_DEPTH_TEST);
-	glDepthMask(true);
+	GpuEnable(GL_TEXTURE_2D);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuDepthMask(true);
 }
 
 void ConsoleUpdate()
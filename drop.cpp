@@ -143,7 +143,7 @@ void DropLoot (string name, GLvector2 pos)
     item = &d->_items[i];
     //a value of 1 or lower always passes...
     if (item->_chance > 1) {
-      if (!RandomRoll (item->_chance))
+      if (!RandomChannel(RANDOM_LOOT).Roll(item->_chance))
         continue; //Nope, don't drop this, whatever it is.
     }
     if (item->_type == DROP_COINS)
@@ -158,7 +158,7 @@ void DropLoot (string name, GLvector2 pos)
     }
     if (item->_type == DROP_POOL) {
       vector<int>   list = LootpoolFromName (item->_id);
-      int   roll = RandomVal (list.size ());
+      int   roll = RandomChannel(RANDOM_LOOT).Val(list.size ());
       fxPickup*   p = new fxPickup;
       p->InitGun (pos, list[roll]);
       EntityFxAdd (p);
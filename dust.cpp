@@ -0,0 +1,42 @@
+/*-----------------------------------------------------------------------------
+
+  Dust.cpp
+
+  Where the background dust motes are at a given moment. A mote's place is
+  worked out from where it started and how long it's been drifting, rather
+  than being moved a little every frame. fxDust uses this when shaders are
+  off, and dust.cg has to do exactly the same math when they're on. It
+  doesn't touch OpenGL, so it can be checked without the game.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include "dust.h"
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//Drift from the starting point, then wrap around so the mote stays in the
+//field that starts at corner and is span across.
+GLvector2 DustPosition(GLvector2 origin, GLvector2 drift, float time, GLvector2 corner, GLvector2 span)
+{
+	GLvector2     pos;
+
+	pos = origin + drift * time - corner;
+	pos.x = pos.x - span.x * floor(pos.x / span.x);
+	pos.y = pos.y - span.y * floor(pos.y / span.y);
+	return pos + corner;
+}
+
+//The mote's spin, kept within 0 to 360.
+float DustAngle(float angle, float spin, float time)
+{
+	float         result;
+
+	result = angle + spin * time;
+	return result - 360.0f * floor(result / 360.0f);
+}
@@ -0,0 +1,9 @@
+#ifndef DUST_H
+#define DUST_H
+
+#define DUST_RATE           0.25f   //Motes drift one step every four frames.
+
+GLvector2   DustPosition(GLvector2 origin, GLvector2 drift, float time, GLvector2 corner, GLvector2 span);
+float       DustAngle(float angle, float spin, float time);
+
+#endif // DUST_H
@@ -0,0 +1,226 @@
+/*-----------------------------------------------------------------------------
+
+  Dust_test.cpp
+
+  Command line test for the dust motes. fxDust used to move a quarter of its
+  motes one step every frame, and wrap any that left the box around the
+  camera back into it. Now a mote's place is worked out from how long it's
+  been drifting (see dust.cpp). This runs the old way alongside the new one,
+  with the camera wandering around, and checks they agree.
+
+  The old motes only moved every fourth frame, so the two can be up to one
+  step apart. A mote the old way hadn't wrapped yet can be a whole field
+  away from the same mote the new way, but that's the same spot on the
+  screen, so positions are compared after wrapping the difference.
+
+  Adding a tiny drift to a large position a few thousand times in single
+  precision loses a lot, so the old way is run in double precision here to
+  keep its rounding out of the comparison.
+
+  usage: dust_test [runs] [seed]
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include <stdarg.h>
+
+#include "dust.h"
+#include "random.h"
+
+#define DEFAULT_RUNS      8
+#define MAX_DUST          400         //Must match fx.h.
+#define DUST_UPDATE       100         //How many motes the old way moved each frame.
+#define DRIFT_SPEED       0.01f       //Must match fx.cpp.
+#define SPIN_SPEED        8.0f        //Must match fx.cpp.
+#define FRAMES            20000
+#define CAMERA_SPEED      0.3f        //Faster than the player ever goes.
+#define CAMERA_RANGE      300.0f
+#define TOLERANCE         0.001f      //Room for single precision in the new way.
+#define MAX_REPORTS       10
+
+struct OldMote
+{
+	double        x, y;
+	double        drift_x, drift_y;
+	double        angle;
+	double        spin;
+};
+
+struct Mote
+{
+	GLvector2     position;
+	GLvector2     drift;
+	float         angle;
+	float         spin;
+};
+
+static int                    failures;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static void fail(const char* message, ...)
+{
+	va_list   args;
+
+	failures++;
+	if (failures > MAX_REPORTS)
+		return;
+	va_start(args, message);
+	printf("  FAIL: ");
+	vprintf(message, args);
+	printf("\n");
+	va_end(args);
+}
+
+//How far apart a and b are, after moving b by whole spans to be nearest a.
+static float wrapped(double a, double b, double span)
+{
+	double    d;
+
+	d = b - a;
+	return (float)fabs(d - span * floor(d / span + 0.5));
+}
+
+//fxDust::Update () as it was: a quarter of the motes take one step, and any
+//that left the box around the camera are moved a field over.
+static void old_update(vector<OldMote>& mote, int* update, GLvector2 camera, GLvector2 field)
+{
+	GLvector2   pmin;
+	GLvector2   pmax;
+
+	pmin = camera - field;
+	pmax = camera + field;
+	*update = (*update + DUST_UPDATE) % MAX_DUST;
+	for (unsigned i = 0; i < DUST_UPDATE; i++) {
+		OldMote*    m = &mote[(*update + i) % MAX_DUST];
+
+		m->x += m->drift_x;
+		m->y += m->drift_y;
+		if (m->x < pmin.x)
+			m->x += field.x * 2;
+		if (m->y < pmin.y)
+			m->y += field.y * 2;
+		if (m->x > pmax.x)
+			m->x -= field.x * 2;
+		if (m->y > pmax.y)
+			m->y -= field.y * 2;
+		m->angle += m->spin;
+	}
+}
+
+static void test_run(RandomStream& random, float* worst_position, float* worst_angle)
+{
+	vector<Mote>      start;
+	vector<OldMote>   mote;
+	GLvector2         field;
+	GLvector2         camera;
+	GLvector2         velocity;
+	GLvector2         origin;
+	int               update;
+
+	//Vision radius times three, at a wide or a square aspect.
+	field.x = (8.0f + random.Float() * 8.0f) * 3.0f;
+	field.y = field.x / (1.0f + random.Float());
+	camera = random.Vector2() * CAMERA_RANGE;
+	origin = camera - field;
+	start.resize(MAX_DUST);
+	mote.resize(MAX_DUST);
+	for (unsigned i = 0; i < MAX_DUST; i++) {
+		//The confetti drifts twice as fast as the dust, so test both.
+		float   speed = DRIFT_SPEED * (i % 2 ? 2.0f : 1.0f);
+
+		start[i].position.x = origin.x + random.Float() * field.x * 2.0f;
+		start[i].position.y = origin.y + random.Float() * field.y * 2.0f;
+		start[i].drift = random.Vector2() * speed;
+		start[i].angle = random.Float() * 360.0f;
+		start[i].spin = (random.Float() - 0.5f) * SPIN_SPEED * 2.0f;
+		mote[i].x = start[i].position.x;
+		mote[i].y = start[i].position.y;
+		mote[i].drift_x = start[i].drift.x;
+		mote[i].drift_y = start[i].drift.y;
+		mote[i].angle = start[i].angle;
+		mote[i].spin = start[i].spin;
+	}
+
+	update = 0;
+	velocity = GLvector2(0, 0);
+	for (int frame = 1; frame <= FRAMES; frame++) {
+		GLvector2   corner;
+		GLvector2   span;
+		float       time;
+
+		//Wander, but stay in range so the old positions keep their precision.
+		velocity += random.Vector2() * 0.05f;
+		if (velocity.Length() > CAMERA_SPEED)
+			velocity = velocity.Normalized() * CAMERA_SPEED;
+		if (fabs(camera.x + velocity.x) > CAMERA_RANGE)
+			velocity.x = -velocity.x;
+		if (fabs(camera.y + velocity.y) > CAMERA_RANGE)
+			velocity.y = -velocity.y;
+		old_update(mote, &update, camera, field);
+		camera += velocity;
+		corner = camera - field;
+		span = field * 2.0f;
+		time = (float)frame * DUST_RATE;
+		for (unsigned i = 0; i < MAX_DUST; i++) {
+			GLvector2   pos;
+			float       angle;
+			float       error;
+			float       allowed;
+
+			pos = DustPosition(start[i].position, start[i].drift, time, corner, span);
+			angle = DustAngle(start[i].angle, start[i].spin, time);
+			if (pos.x < corner.x - TOLERANCE || pos.y < corner.y - TOLERANCE || pos.x > corner.x + span.x + TOLERANCE || pos.y > corner.y + span.y + TOLERANCE)
+				fail("Frame %d, mote %d at %f,%f is outside the field %f,%f to %f,%f.", frame, i, pos.x, pos.y, corner.x, corner.y, corner.x + span.x, corner.y + span.y);
+			//One step behind or ahead of the old way, at most.
+			allowed = start[i].drift.Length() + TOLERANCE;
+			error = max(wrapped(mote[i].x, pos.x, span.x), wrapped(mote[i].y, pos.y, span.y));
+			*worst_position = max(*worst_position, error);
+			if (error > allowed)
+				fail("Frame %d, mote %d: the old way has it at %f,%f and the new way at %f,%f.", frame, i, mote[i].x, mote[i].y, pos.x, pos.y);
+			allowed = fabs(start[i].spin) + TOLERANCE * 360.0f;
+			error = wrapped(mote[i].angle, angle, 360.0f);
+			*worst_angle = max(*worst_angle, error);
+			if (error > allowed)
+				fail("Frame %d, mote %d: the old way has it at %f degrees and the new way at %f.", frame, i, mote[i].angle, angle);
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+int main(int argc, char** argv)
+{
+	int             runs;
+	unsigned long   seed;
+	float           worst_position;
+	float           worst_angle;
+
+	runs = argc > 1 ? atoi(argv[1]) : DEFAULT_RUNS;
+	seed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+	if (runs < 1) {
+		printf("usage: %s [runs] [seed]\n", argv[0]);
+		return 1;
+	}
+	worst_position = worst_angle = 0.0f;
+	for (int r = 0; r < runs; r++) {
+		RandomStream  random = RandomStream(seed).Split(r);
+
+		test_run(random, &worst_position, &worst_angle);
+	}
+	printf("Dust: %d runs of %d motes for %d frames.\n", runs, MAX_DUST, FRAMES);
+	printf("  Furthest from the old way: %.4f units, %.2f degrees (one step is up to %.4f units, %.2f degrees).\n", worst_position, worst_angle, DRIFT_SPEED * 2.0f * sqrt(2.0f), SPIN_SPEED);
+	if (failures) {
+		printf("%d failures.\n", failures);
+		return 1;
+	}
+	printf("All passed.\n");
+	return 0;
+}
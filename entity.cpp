@@ -12,30 +12,50 @@
 
 #include "master.h"
 
+#include "arena.h"
 #include "audio.h"
+#include "camera.h"
 #include "entity.h"
 #include "env.h"
 #include "fx.h"
+#include "gpu.h"
 #include "player.h"
 #include "projectile.h"
 #include "render.h"
+#include "replay.h"
 #include "robot.h"
+#include "spawn.h"
 #include "system.h"
 #include "visible.h"
 #include "world.h"
 
-#define MAX_SHOVES          30
+#define SHOVE_GRID_MAX      4096  //Most cells the shoving grid is allowed to use.
+#define PROJECTILE_OWNERS   (OWNER_ROBOTS + 1)
+#define VIEW_MARGIN         2.0f  //Extra room around the screen for glows, tails, and tilt.
 
 static vector<Robot>        bot;
 static vector<Robot>        bot_queue;
-static fxProjectile         projectiles[MAX_PROJECTILES];
-static int                  projectile_top;
+//Only live projectiles are kept, one list for each owner, so quiet moments cost
+//nothing and the player's shots can look through just the other lists.
+static vector<fxProjectile> projectiles[PROJECTILE_OWNERS];
+static vector<fxProjectile> projectile_queue;
+static int                  projectile_count;
+static bool                 in_projectile_update;
 static int                  active_robots;
 static int                  dead_robots;
 static vector<fx*>          fx_list;
 static vector<fxDevice*>    device_list;
 static bool                 is_calm;     //True if we're on a peaceful screen and not in combat.
 static bool                 in_update;
+static int                  update_bot;
+static float                update_cost;  //How long the last update took, in milliseconds.
+static vector<int>          shove_head;  //First bot in each cell of the shoving grid, or -1.
+static vector<int>          shove_next;  //Next bot in the same cell, or -1.
+static vector<GLcoord2>     shove_cell;  //Which cell each bot landed in.
+//What's on screen this frame. Built once by EntityCull, then used by every render pass.
+static vector<Robot*>       seen_bots;
+static vector<fxDevice*>    seen_devices;
+static vector<fx*>          seen_fx;
 
 /*-----------------------------------------------------------------------------
 
@@ -50,54 +70,88 @@ static void insert_coin(GLvector2 position, int value)
 	EntityFxAdd(c);
 }
 
-static void do_shoving ()
+//If two bots are overlapping, push them apart.
+static void shove_pair (unsigned b1, unsigned b2)
 {
-	static int		current_shover;
-	static int		current_shovee;
-	unsigned			max_shoves;
 	float					allowed_distance;
 	float					distance;
 	GLvector2			delta;
-	int						shoves;
-	int						bots_checked;
-	unsigned			b1, b2;
-	bool					new_shover;
 
-	if (bot.empty ())
+	allowed_distance = bot[b1].Size () + bot[b2].Size ();
+	delta = bot[b1].Position () - bot[b2].Position ();
+	if (fabs (delta.x) > allowed_distance || fabs (delta.y) > allowed_distance)
 		return;
-	shoves = 0;
-	bots_checked = 0;
-	//Have the bots shove each other to keep them from stacking up into a deathball.
-	//All bots...
-	max_shoves = min ((int)bot.size (), MAX_SHOVES);
-	while (shoves < max_shoves) {
-		shoves++;
-		current_shovee++;
-		b1 = current_shover % bot.size ();
-		b2 = current_shovee % bot.size ();
-		new_shover = false;
+	distance = delta.Length ();
+	if (distance < allowed_distance) {
+		float strength = 1.0f - distance / allowed_distance;
+		delta *= strength;
+		bot[b2].Shove (delta * -1);
+		bot[b1].Shove (delta);
+	}
+}
+
+//Have the bots shove each other to keep them from stacking up into a deathball.
+//Bots are sorted into a grid with cells big enough that overlapping bots are
+//always in the same or neighboring cells, so every overlapping pair gets
+//resolved every frame without checking every bot against every other.
+static void do_shoving ()
+{
+	GLbbox2				box;
+	GLcoord2			grid;
+	GLcoord2			cell;
+	GLcoord2			neighbor;
+	float					cell_size;
+
+	box.Clear ();
+	cell_size = 0.0f;
+	for (unsigned b = 0; b < bot.size (); b++) {
+		if (bot[b].Dead ())
+			continue;
+		box.ContainPoint (bot[b].Position ());
+		cell_size = max (cell_size, bot[b].Size () * 2.0f);
+	}
+	if (cell_size <= 0.0f)
+		return;
+	//If the bots are spread thin, use bigger cells rather than a huge, mostly empty grid.
+	do {
+		grid.x = (int)((box.pmax.x - box.pmin.x) / cell_size) + 1;
+		grid.y = (int)((box.pmax.y - box.pmin.y) / cell_size) + 1;
+		if (grid.x * grid.y <= SHOVE_GRID_MAX)
+			break;
+		cell_size *= 2.0f;
+	} while (true);
+	shove_head.assign (grid.x * grid.y, -1);
+	shove_next.assign (bot.size (), -1);
+	shove_cell.resize (bot.size ());
+	for (unsigned b = 0; b < bot.size (); b++) {
+		int   index;
+
+		if (bot[b].Dead ())
+			continue;
+		cell.x = (int)((bot[b].Position ().x - box.pmin.x) / cell_size);
+		cell.y = (int)((bot[b].Position ().y - box.pmin.y) / cell_size);
+		cell.x = clamp (cell.x, 0, grid.x - 1);
+		cell.y = clamp (cell.y, 0, grid.y - 1);
+		shove_cell[b] = cell;
+		index = cell.x + cell.y * grid.x;
+		shove_next[b] = shove_head[index];
+		shove_head[index] = b;
+	}
+	for (unsigned b1 = 0; b1 < bot.size (); b1++) {
 		if (bot[b1].Dead ())
-			new_shover = true;
-		if (b1 == b2) 
-			new_shover = true;
-		if (new_shover) {
-				current_shover++;
-				current_shovee = current_shover;
-				continue;
-		}
-		if (bot[b2].Dead ())
-				continue;
-		allowed_distance = bot[b1].Size () + bot[b2].Size ();
-		delta = bot[b1].Position () - bot[b2].Position ();
-		if (fabs (delta.x) > allowed_distance || fabs (delta.y) > allowed_distance)
 			continue;
-		distance = delta.Length ();
-		if (distance < allowed_distance) {
-			float strength = 1.0f - distance / allowed_distance;
-			//delta.Normalize ();
-			delta *= strength;
-			bot[b2].Shove (delta * -1);
-			bot[b1].Shove (delta);
+		for (neighbor.y = shove_cell[b1].y - 1; neighbor.y <= shove_cell[b1].y + 1; neighbor.y++) {
+			if (neighbor.y < 0 || neighbor.y >= grid.y)
+				continue;
+			for (neighbor.x = shove_cell[b1].x - 1; neighbor.x <= shove_cell[b1].x + 1; neighbor.x++) {
+				if (neighbor.x < 0 || neighbor.x >= grid.x)
+					continue;
+				//Only take pairs one way, so each pair gets shoved once.
+				for (int b2 = shove_head[neighbor.x + neighbor.y * grid.x]; b2 != -1; b2 = shove_next[b2]) {
+					if (b2 > (int)b1)
+						shove_pair (b1, b2);
+				}
+			}
 		}
 	}
 }
@@ -123,11 +177,11 @@ int EntityDeviceCount () { return device_list.size ();  }
 void EntityDeviceRender (bool occluded)
 {
   if (occluded) {
-    for (unsigned f = 0; f < device_list.size (); f++)
-      device_list[f]->RenderOccluded ();
+    for (unsigned f = 0; f < seen_devices.size (); f++)
+      seen_devices[f]->RenderOccluded ();
   } else {
-    for (unsigned f = 0; f < device_list.size (); f++)
-      device_list[f]->Render ();
+    for (unsigned f = 0; f < seen_devices.size (); f++)
+      seen_devices[f]->Render ();
   }
   RenderQuads ();
 }
@@ -146,8 +200,16 @@ void EntityFxAdd(fx* item)
 //This adds a SINGLE projectile. Should be used by projectiles wanting to spawn children.
 void EntityProjectileAdd (fxProjectile p)
 {
-  projectiles[projectile_top] = p;
-  projectile_top = (projectile_top + 1) % MAX_PROJECTILES;
+  //If the screen is already full of bullets, nobody will miss this one.
+  if (projectile_count >= MAX_PROJECTILES)
+    return;
+  projectile_count++;
+  //Projectiles spawned by other projectiles wait until the update is
+  //done, since adding to a list can move everything in it.
+  if (in_projectile_update)
+    projectile_queue.push_back (p);
+  else
+    projectiles[p.Owner ()].push_back (p);
 }
 
 //This will fire a projectile according to the given properties. It will
@@ -166,9 +228,14 @@ void EntityProjectileFire (fxOwner owner, const Projectile* p_info, GLvector2 or
   AudioPlay (p_info->_sound, origin);
 }
 
-fxProjectile* EntityProjectileList () 
+fxProjectile* EntityProjectile (fxOwner owner, int index)
+{
+  return &projectiles[owner][index];
+}
+
+int EntityProjectileCount (fxOwner owner)
 {
-  return projectiles;
+  return projectiles[owner].size ();
 }
 
 void EntityRobotAdd(Robot b)
@@ -227,10 +294,34 @@ void EntityClear()
 		delete fx_list[f];
   for (unsigned f = 0; f < device_list.size (); f++)
     delete device_list[f];
-  for (int i = 0; i < MAX_PROJECTILES; i++)
-    projectiles[i].Retire ();
+  for (int i = 0; i < PROJECTILE_OWNERS; i++)
+    projectiles[i].clear ();
+  projectile_queue.clear ();
+  projectile_count = 0;
+  seen_bots.clear ();
+  seen_devices.clear ();
+  seen_fx.clear ();
 	fx_list.clear();
   device_list.clear ();
+	//All of the effects are gone, so the memory they came from can go all at once.
+	ArenaReset();
+	update_bot = 0;
+	update_cost = 0;
+	SpawnClear();
+}
+
+//Fill the list with the index of every living robot whose bounding box the
+//given segment passes through. Hitscan weapons use this to narrow down which
+//robots are worth checking before they walk along the line.
+void EntityRobotsAlong(GLvector2 start, GLvector2 end, vector<int>& list)
+{
+	list.clear();
+	for (unsigned b = 0; b < bot.size(); b++) {
+		if (bot[b].Dead() || bot[b].Retired())
+			continue;
+		if (bot[b].Bbox().Crosses(start, end))
+			list.push_back(b);
+	}
 }
 
 Robot* EntityRobotFromId (int id)
@@ -245,9 +336,31 @@ Robot* EntityRobotFromId (int id)
 
 void EntityUpdate()
 {
+	Uint64  update_begin = SDL_GetPerformanceCounter();
+
 	in_update = true;
-  for (int i = 0; i < MAX_PROJECTILES; i++)
-    projectiles[i].Update ();
+	SpawnUpdate(update_cost);
+  //Update the projectiles, and swap the dead ones off the end of their lists.
+  in_projectile_update = true;
+  for (int o = 0; o < PROJECTILE_OWNERS; o++) {
+    vector<fxProjectile>& list = projectiles[o];
+
+    for (unsigned i = 0; i < list.size (); ) {
+      list[i].Update ();
+      if (list[i].Active ()) {
+        i++;
+        continue;
+      }
+      if (i < list.size () - 1)
+        list[i] = list.back ();
+      list.pop_back ();
+      projectile_count--;
+    }
+  }
+  in_projectile_update = false;
+  for (unsigned i = 0; i < projectile_queue.size (); i++)
+    projectiles[projectile_queue[i].Owner ()].push_back (projectile_queue[i]);
+  projectile_queue.clear ();
 	//Last update, we queued up any newly added robots to avoid adding to the
 	//list while we were iterating over it. Now put them in play.
 	for (unsigned i = 0; i < bot_queue.size(); i++)
@@ -290,8 +403,8 @@ void EntityUpdate()
 	int	begin = SystemTick ();
 	int	end = begin + 3;
 	int	update_count = 0;
-	static int	update_bot;
-	while (SystemTick () < end && update_count < bot.size ()) {
+	//Replays need the same robots updated every frame no matter how long it takes.
+	while ((ReplayActive () || SystemTick () < end) && update_count < bot.size ()) {
 		update_bot %= bot.size ();
 		bot[update_bot].Update ();
 		update_bot++;
@@ -300,36 +413,77 @@ void EntityUpdate()
 	do_shoving();
   active_robots = active_counter;
 	in_update = false;
+	update_cost = (float)((double)(SDL_GetPerformanceCounter() - update_begin) * 1000.0 / (double)SDL_GetPerformanceFrequency());
+}
+
+//Work out which robots, devices, and effects can be seen this frame, so the
+//render passes below only have to look at those. Call once per frame, before
+//any of them.
+void EntityCull()
+{
+	GLvector    camera = CameraPosition();
+	GLvector2   reach;
+	GLbbox2     view;
+
+	reach.y = camera.z + VIEW_MARGIN;
+	reach.x = camera.z * RenderAspect() + VIEW_MARGIN;
+	view.pmin = GLvector2(camera.x - reach.x, camera.y - reach.y);
+	view.pmax = GLvector2(camera.x + reach.x, camera.y + reach.y);
+	seen_bots.clear();
+	for (unsigned i = 0; i < bot.size(); i++) {
+		GLbbox2   box = bot[i].Bbox();
+
+		if (box.pmax.x < view.pmin.x || box.pmin.x > view.pmax.x)
+			continue;
+		if (box.pmax.y < view.pmin.y || box.pmin.y > view.pmax.y)
+			continue;
+		seen_bots.push_back(&bot[i]);
+	}
+	seen_devices.clear();
+	for (unsigned f = 0; f < device_list.size(); f++) {
+		if (device_list[f]->OnScreen(view))
+			seen_devices.push_back(device_list[f]);
+	}
+	seen_fx.clear();
+	for (unsigned f = 0; f < fx_list.size(); f++) {
+		if (fx_list[f]->OnScreen(view))
+			seen_fx.push_back(fx_list[f]);
+	}
+	for (int o = 0; o < PROJECTILE_OWNERS; o++) {
+		for (unsigned i = 0; i < projectiles[o].size(); i++) {
+			if (projectiles[o][i].OnScreen(view))
+				seen_fx.push_back(&projectiles[o][i]);
+		}
+	}
 }
 
 void EntityRenderRobots (bool hidden)
 {
 	if (hidden) {
-		for (unsigned i = 0; i < bot.size (); i++)
-			bot[i].RenderHidden ();
+		for (unsigned i = 0; i < seen_bots.size (); i++)
+			seen_bots[i]->RenderHidden ();
 	} else {
-		for (unsigned i = 0; i < bot.size (); i++)
-			bot[i].RenderBody ();
+		for (unsigned i = 0; i < seen_bots.size (); i++)
+			seen_bots[i]->RenderBody ();
 		RenderQuads ();
 		RenderTriangles ();
-		for (unsigned i = 0; i < bot.size (); i++)
-			bot[i].RenderEye ();
+		for (unsigned i = 0; i < seen_bots.size (); i++)
+			seen_bots[i]->RenderEye ();
 		RenderQuads ();
-		glDepthFunc (GL_EQUAL);
-		for (unsigned i = 0; i < bot.size (); i++)
-			bot[i].RenderIris ();
+		GpuDepthFunc (GL_EQUAL);
+		for (unsigned i = 0; i < seen_bots.size (); i++)
+			seen_bots[i]->RenderIris ();
 		RenderQuads ();
-		for (unsigned i = 0; i < bot.size (); i++)
-			bot[i].RenderPain ();
-		glDepthFunc (GL_LEQUAL);
+		for (unsigned i = 0; i < seen_bots.size (); i++)
+			seen_bots[i]->RenderPain ();
+		GpuDepthFunc (GL_LEQUAL);
 	}
 }
 
+//Projectiles are drawn with the rest of the effects, after them.
 void EntityRenderFx()
 {
-	glDepthMask(false);
-	for (unsigned f = 0; f < fx_list.size(); f++)
-		fx_list[f]->Render();
-  for (int i = 0; i < MAX_PROJECTILES; i++)
-    projectiles[i].Render ();
+	GpuDepthMask(false);
+	for (unsigned f = 0; f < seen_fx.size(); f++)
+		seen_fx[f]->Render();
 }
\ No newline at end of file
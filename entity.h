@@ -6,6 +6,7 @@
 #define MAX_PROJECTILES     1000
 
 void                EntityClear();
+void                EntityCull();
 void                EntityDeviceAdd (class fxDevice* d);
 int                 EntityDeviceCount ();
 void                EntityDeviceRender (bool occluded);
@@ -13,7 +14,8 @@ void                EntityDeviceRender (bool occluded);
 fxDevice*           EntityDeviceFromId (int id);
 
 void                EntityFxAdd(class fx* item);
-class fxProjectile* EntityProjectileList ();
+class fxProjectile* EntityProjectile (enum fxOwner owner, int index);
+int                 EntityProjectileCount (enum fxOwner owner);
 void                EntityProjectileAdd (class fxProjectile p);
 void                EntityProjectileFire (enum fxOwner owner, const class Projectile* p_info, GLvector2 origin, GLvector2 vector, int damage_level=0);
 void                EntityRenderRobots(bool hidden);
@@ -23,6 +25,7 @@ void                EntityRobotAdd (class Robot b);
 int                 EntityRobotCount ();
 int                 EntityRobotsActive ();
 int									EntityRobotsDead ();
+void                EntityRobotsAlong (GLvector2 start, GLvector2 end, vector<int>& list);
 Robot*              EntityRobotFromId (int id);
 void                EntityUpdate();
 void                EntityXpAdd(GLvector2 position, int xp);
@@ -26,6 +26,7 @@
 #include "robot.h"
 #include "system.h"
 #include "GameProperty.h"
+#include "watch.h"
 #include "XMLDoc.h"
 #include "loaders.h"
 
@@ -42,6 +43,8 @@ using namespace pyrodactyl;
 #define MACHINES_XML            "machines.xml"
 #define PROPERTY_FILE_NORMAL    "core/data/gameplay.xml"
 #define PROPERTY_FILE_EASY      "core/data/gameplay_easy.xml"
+//Room for projectiles and robots added to the data files while the game runs.
+#define RELOAD_SPARE            32
 
 enum EnvType
 {
@@ -149,6 +152,8 @@ static bool                               achievements_enabled;
 typedef vector<int> WeaponList;
 static vector<WeaponList>                 weapons_shop;
 
+static void watch_data();
+
 /*-----------------------------------------------------------------------------
 
 -----------------------------------------------------------------------------*/
@@ -177,6 +182,7 @@ static void do_machine_inventory()
 	XMLDoc      mach_file(ResourceLocation(MACHINES_XML, RESOURCE_DATA));
 	MachineInfo mi;
 
+	machine.clear();
 	if (!mach_file.ready())
 		return;
 
@@ -211,18 +217,35 @@ static int do_map_inventory()
 	return count;
 }
 
+//Shots in flight, robot weapons and the player's guns all point into the
+//projectile list, so a reload overwrites projectiles where they sit. New ones
+//go on the end only while the list has room to grow without moving. Anything
+//removed from the file is left alone until the next restart.
 static void do_projectile_inventory(iniFile &ini)
 {
 	Projectile      p;
 	int							start = SystemTick();
+	bool            first = projectile.empty();
 
-	projectile.clear();
 	for (unsigned i = 0; i < ini.SectionCount(); i++) {
-		if (ini.SectionName(i).length() > 1) {
-			p.Init(ini, ini.SectionName(i));
-			projectile.push_back(p);
+		if (ini.SectionName(i).length() < 2)
+			continue;
+		p.Init(ini, ini.SectionName(i));
+		unsigned  id;
+
+		for (id = 0; id < projectile.size(); id++) {
+			if (!_stricmp(projectile[id]._name.c_str(), p._name.c_str()))
+				break;
 		}
+		if (id < projectile.size())
+			projectile[id] = p;
+		else if (first || projectile.size() < projectile.capacity())
+			projectile.push_back(p);
+		else
+			Console("No room for new projectile '%s'. Restart to add it.", p._name.c_str());
 	}
+	if (first)
+		projectile.reserve(projectile.size() + RELOAD_SPARE);
 	Console("Loaded %d projectiles in %dms.", projectile.size(), SystemTick() - start);
 }
 
@@ -248,10 +271,8 @@ static void var_changed(int id)
 {
 	if (!env_var[id].save)
 		return;
-	iniFile   ini;
-	string    filename;
+	iniFile&  ini = SystemConfig();
 
-	ini.Open(SystemConfigFile());
 	if (env_var[id].type == TYPE_BOOL)
 		ini.IntSet("Settings", env_var[id].command, var[id].vbool ? 1 : 0);
 	else
@@ -291,31 +312,46 @@ static vector<int> load_multiplier_timeout(string input)
 	return result;
 }
 
+//Robots keep a pointer to their config and refer to each other by index, so
+//like the projectiles, a reload keeps every robot in its slot and only adds
+//new ones while the list has room.
 static void do_robot_inventory(iniFile &ini)
 {
-	vector<string>  parse;
+	vector<string>  loaded;
+	bool            first = bot_config.empty();
 
-	bot_name.clear();
-	bot_config.clear();
 	bot_roll_call = "";
 	//First we load in just the NAMES of the robots. We get ALL the names
 	//before we look at the data, since robots refer to each other by name
 	//and we need that data available.
 	for (unsigned i = 0; i < ini.SectionCount(); i++) {
-		if (ini.SectionName(i).length() > 1)
-			bot_name.push_back(StringToLower(ini.SectionName(i)));
-	}
-	for (unsigned i = 0; i < bot_name.size(); i++) {
-		if (i)
+		if (ini.SectionName(i).length() < 2)
+			continue;
+		string  name = StringToLower(ini.SectionName(i));
+
+		if (EnvRobotIndexFromName(name) == ROBOT_INVALID) {
+			if (!first && bot_config.size() == bot_config.capacity()) {
+				Console("No room for new robot '%s'. Restart to add it.", name.c_str());
+				continue;
+			}
+			bot_name.push_back(name);
+			bot_config.push_back(RobotConfig());
+		}
+		if (!loaded.empty())
 			bot_roll_call += ", ";
-		bot_roll_call += bot_name[i];
+		bot_roll_call += name;
+		loaded.push_back(name);
+	}
+	if (first) {
+		bot_name.reserve(bot_name.size() + RELOAD_SPARE);
+		bot_config.reserve(bot_config.size() + RELOAD_SPARE);
 	}
 	//Now load the actual data to go with the name.
-	for (unsigned i = 0; i < bot_name.size(); i++) {
+	for (unsigned i = 0; i < loaded.size(); i++) {
 		RobotConfig   rc;
 
-		rc.Load(ini, bot_name[i]);
-		bot_config.push_back(rc);
+		rc.Load(ini, loaded[i]);
+		bot_config[EnvRobotIndexFromName(loaded[i])] = rc;
 	}
 }
 
@@ -347,6 +383,8 @@ void        EnvValueSetb(EnvId id, bool newval)
 		return;
 	var[id].Set(newval);
 	var_changed(id);
+	if (id == ENV_CHEATS && newval)
+		watch_data();
 }
 
 void        EnvValueSetf(EnvId id, float newval)
@@ -647,7 +685,7 @@ void EnvLoadDifficulty()
 	}
 }
 
-void EnvReloadData()
+static void load_projectiles()
 {
 	iniFile         ini;
 	string          filename;
@@ -656,18 +694,23 @@ void EnvReloadData()
 	Console("GameReloadData: Loading settings from %s", filename.c_str());
 	ini.Open(filename);
 	do_projectile_inventory(ini);
+}
 
-	EnvLoadDifficulty();
+static void load_robots()
+{
+	iniFile         ini;
+	string          filename;
 
 	filename = ResourceLocation(ROBOTS_FILE, RESOURCE_DATA);
 	Console("GameReloadData: Loading settings from %s", filename.c_str());
 	ini.Open(filename);
 	do_robot_inventory(ini);
-	do_machine_inventory();
-	filename = ResourceLocation(GAMEPLAY_FILE, RESOURCE_DATA);
-	Console("GameReloadData: Loading settings from %s", filename.c_str());
-	//Now that we have ALL projectiles and robots, go back and fill in
-	//the robot weapon data.
+}
+
+//Now that we have ALL projectiles and robots, go back and fill in
+//the robot weapon data.
+static void link_weapons()
+{
 	for (unsigned i = 0; i < bot_config.size(); i++) {
 		for (unsigned w = 0; w < bot_config[i].weapons.size(); w++) {
 			string payload = bot_config[i].weapons[w].payload_name;
@@ -676,7 +719,15 @@ void EnvReloadData()
 			bot_config[i].weapons[w].robot_id = EnvRobotIndexFromName(payload);
 		}
 	}
+}
+
+static void load_rules()
+{
+	iniFile         ini;
+	string          filename;
 
+	filename = ResourceLocation(GAMEPLAY_FILE, RESOURCE_DATA);
+	Console("GameReloadData: Loading settings from %s", filename.c_str());
 	ini.Open(filename);
 	//Load the various rule values.
 	env.momentum_loss = ini.FloatGet("Gameplay", "MomentumLoss");
@@ -697,8 +748,13 @@ void EnvReloadData()
 	env.music_shop = ini.StringGet("Audio", "MusicShop");
 	env.multiplier_timeout = load_multiplier_timeout(ini.StringGet("Gameplay", "MultiplierTimeout"));
 	env.multiplier_max = env.multiplier_timeout.size() - 1;
+}
+
+static void load_characters()
+{
+	iniFile         ini;
+	string          filename;
 
-	//Load the characters
 	filename = ResourceLocation(CHARACTERS_FILE, RESOURCE_DATA);
 	Console("GameReloadData: Loading characters from %s", filename.c_str());
 	character.clear();
@@ -712,6 +768,72 @@ void EnvReloadData()
 		character.push_back(ch);
 	}
 	Console("GameReloadData: Loaded %d characters", character.size());
+}
+
+/*-----------------------------------------------------------------------------
+These are run by the file watcher when one of our data files changes on disk.
+Each one reloads just the file that changed, plus whatever depends on it.
+-----------------------------------------------------------------------------*/
+
+static void projectiles_changed(string filename)
+{
+	load_projectiles();
+	link_weapons();
+}
+
+static void robots_changed(string filename)
+{
+	load_robots();
+	link_weapons();
+}
+
+static void machines_changed(string filename)
+{
+	do_machine_inventory();
+}
+
+static void rules_changed(string filename)
+{
+	load_rules();
+}
+
+static void characters_changed(string filename)
+{
+	load_characters();
+	PlayerReload();
+}
+
+static void difficulty_changed(string filename)
+{
+	EnvLoadDifficulty();
+}
+
+//Reloading game data mid-game is a cheat like the "reload" command, so we
+//only start watching once cheats are on.
+static void watch_data()
+{
+	WatchFile(ResourceLocation(PROJECTILES_FILE, RESOURCE_DATA), projectiles_changed);
+	WatchFile(ResourceLocation(ROBOTS_FILE, RESOURCE_DATA), robots_changed);
+	WatchFile(ResourceLocation(MACHINES_XML, RESOURCE_DATA), machines_changed);
+	WatchFile(ResourceLocation(GAMEPLAY_FILE, RESOURCE_DATA), rules_changed);
+	WatchFile(ResourceLocation(CHARACTERS_FILE, RESOURCE_DATA), characters_changed);
+	WatchFile(PROPERTY_FILE_NORMAL, difficulty_changed);
+	WatchFile(PROPERTY_FILE_EASY, difficulty_changed);
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+void EnvReloadData()
+{
+	load_projectiles();
+	EnvLoadDifficulty();
+	load_robots();
+	do_machine_inventory();
+	link_weapons();
+	load_rules();
+	load_characters();
 	PlayerReload();
 }
 
@@ -737,14 +859,12 @@ int EnvCharacterIndexFromName(string name)
 
 void EnvInit()
 {
-	iniFile   ini;
-	string    filename;
+	iniFile&  ini = SystemConfig();
 
 	EnvReloadData();
 
 	map_count = do_map_inventory();
 
-	ini.Open(SystemConfigFile());
 	if (!ini.BoolGet("Settings", "Setup")) {
 		ini.BoolSet("Settings", "Setup", true);
 		EnvValueSetf(ENV_VOLUME_MUSIC, 0.5f);
@@ -752,7 +872,6 @@ void EnvInit()
 		EnvValueSetf(ENV_MOUSE_SPEED, 1.0f);
 		EnvValueSetb(ENV_FULLSCREEN, false);
 		EnvValueSetb(ENV_NOTILT, false);
-		ini.Open(SystemConfigFile());
 	}
 	for (unsigned i = 0; i < ENV_COUNT; i++) {
 		if (env_var[i].save)
@@ -781,6 +900,8 @@ void EnvInit()
 	var[ENV_FPS].Set(false);
 	var[ENV_AI].Set(true);
 #endif
+	if (var[ENV_CHEATS].vbool)
+		watch_data();
 }
 
 const Projectile* EnvProjectileFromId(int id)
@@ -0,0 +1,165 @@
+/*-----------------------------------------------------------------------------
+
+  FlowField.cpp
+
+  A breadth-first distance map over the open cells of the zone, spreading
+  out from the player. Every cell it reaches remembers which neighbor is
+  one step closer to the player, so a robot chasing the player can find
+  its way around walls with a single lookup instead of feeling its way
+  along them with collision checks. The field is rebuilt when the player
+  moves into a different cell, and only out to a fixed range, so the cost
+  doesn't depend on how many robots are using it.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include "flowfield.h"
+#include "player.h"
+#include "world.h"
+#include "zone.h"
+
+#define FLOW_RANGE        (PAGE_SIZE * 2) //How far from the player, in steps, the field reaches.
+#define FLOW_NEAR         2               //Robots this close to the player just head straight for them.
+#define STEPS             (sizeof (step) / sizeof (GLcoord2))
+
+//Straight steps come first, so ties are broken in favor of straight lines.
+//Opposite steps are paired, so (i ^ 1) is the reverse of step i.
+static const GLcoord2   step[] =
+{
+	GLcoord2(1, 0), GLcoord2(-1, 0), GLcoord2(0, 1), GLcoord2(0, -1),
+	GLcoord2(1, 1), GLcoord2(-1, -1), GLcoord2(-1, 1), GLcoord2(1, -1),
+};
+
+static GLvector2                step_direction[STEPS];
+static GLcoord2                 size;
+static GLcoord2                 player_cell;
+static vector<bool>             open;       //True if robots can fly through this cell.
+static vector<unsigned>         stamp;      //The build that last reached each cell.
+static vector<unsigned short>   cost;       //Steps from each cell to the player.
+static vector<unsigned char>    heading;    //Index into step[] of the way towards the player.
+static vector<int>              frontier;
+static unsigned                 build;
+static bool                     ready;
+static bool                     valid;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static int cell_index(GLcoord2 cell)
+{
+	return cell.x + cell.y * size.x;
+}
+
+static bool cell_inside(GLcoord2 cell)
+{
+	return cell.x >= 0 && cell.y >= 0 && cell.x < size.x && cell.y < size.y;
+}
+
+//Take stock of the zone's open space. This is done once per zone.
+static void do_zone()
+{
+	Zone*     z = WorldZone();
+	GLcoord2  cell;
+
+	size = z->CellSize();
+	open.assign(size.x * size.y, false);
+	stamp.assign(size.x * size.y, 0);
+	cost.resize(size.x * size.y);
+	heading.resize(size.x * size.y);
+	for (cell.y = 0; cell.y < size.y; cell.y++) {
+		for (cell.x = 0; cell.x < size.x; cell.x++)
+			open[cell_index(cell)] = z->CellShape(cell) == 0;
+	}
+	for (unsigned i = 0; i < STEPS; i++)
+		step_direction[i] = GLvector2((float)step[i].x, (float)step[i].y).Normalized();
+	build = 0;
+	ready = true;
+}
+
+static void do_build(GLcoord2 origin)
+{
+	unsigned  next;
+	int       index;
+
+	build++;
+	frontier.clear();
+	index = cell_index(origin);
+	stamp[index] = build;
+	cost[index] = 0;
+	heading[index] = 0;
+	frontier.push_back(index);
+	for (next = 0; next < frontier.size(); next++) {
+		GLcoord2        cell(frontier[next] % size.x, frontier[next] / size.x);
+		unsigned short  dist = cost[frontier[next]] + 1;
+
+		if (dist > FLOW_RANGE)
+			break;
+		for (unsigned i = 0; i < STEPS; i++) {
+			GLcoord2  n = cell + step[i];
+
+			if (!cell_inside(n))
+				continue;
+			index = cell_index(n);
+			if (stamp[index] == build || !open[index])
+				continue;
+			//Don't cut corners. A diagonal step needs both of the cells beside it open.
+			if (step[i].x && step[i].y) {
+				if (!open[cell_index(GLcoord2(n.x, cell.y))] || !open[cell_index(GLcoord2(cell.x, n.y))])
+					continue;
+			}
+			stamp[index] = build;
+			cost[index] = dist;
+			//We got here by taking step i, so heading back is the opposite step.
+			heading[index] = (unsigned char)(i ^ 1);
+			frontier.push_back(index);
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//Call when the zone changes, so the field is rebuilt from the new geometry.
+void FlowFieldClear()
+{
+	ready = false;
+	valid = false;
+}
+
+void FlowFieldUpdate()
+{
+	GLvector2   pos;
+	GLcoord2    cell;
+
+	if (!ready)
+		do_zone();
+	pos = PlayerPosition();
+	cell = GLcoord2((int)pos.x, (int)pos.y);
+	if (valid && cell == player_cell)
+		return;
+	player_cell = cell;
+	valid = cell_inside(cell);
+	if (valid)
+		do_build(cell);
+}
+
+//Gives the way to go from the given position to reach the player. Returns false if
+//the position is out of range, cut off from the player, or close enough to go straight there.
+bool FlowFieldDirection(GLvector2 position, GLvector2* direction)
+{
+	GLcoord2  cell((int)position.x, (int)position.y);
+	int       index;
+
+	if (!valid || !cell_inside(cell))
+		return false;
+	index = cell_index(cell);
+	if (stamp[index] != build || cost[index] <= FLOW_NEAR)
+		return false;
+	*direction = step_direction[heading[index]];
+	return true;
+}
@@ -0,0 +1,8 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+void      FlowFieldClear();
+bool      FlowFieldDirection(GLvector2 position, GLvector2* direction);
+void      FlowFieldUpdate();
+
+#endif // FLOWFIELD_H
@@ -15,8 +15,10 @@
 #include FT_GLYPH_H
 #include FT_TRIGONOMETRY_H
 
+#include "batch.h"
 #include "bodyparts.h"
 #include "font.h"
+#include "gpu.h"
 
 static FT_Library     library;
 static vector<Font*>  font_list;
@@ -125,6 +127,8 @@ void Font::Generate()
 	//Initialize everything.
 	memset(&_width, 0, sizeof(_width));
 	memset(&_textures, 0, sizeof(_textures));
+	memset(&_offset, 0, sizeof(_offset));
+	memset(&_size, 0, sizeof(_size));
 	//Create and initilize a freetype font library.
 	if (FT_Init_FreeType(&library)) {
 		Console("FT_Init_FreeType failed");
@@ -157,18 +161,20 @@ void Font::AddChar(uchar id, int width, unsigned texture, GLuvFrame frame)
 	_width[id] = width;
 	_textures[id] = texture;
 	_uv[id] = frame;
-	glNewList(_list_base + id, GL_COMPILE);
+	_offset[id] = GLcoord2(0, 0);
+	_size[id] = GLcoord2(width, _height);
+	GpuNewList(_list_base + id);
 	glPushMatrix();
-	glBindTexture(GL_TEXTURE_2D, _textures[id]);
-	glBegin(GL_QUADS);
-	glTexCoord2fv(&_uv[id].uv[0].x);  glVertex2i(0, 0);
-	glTexCoord2fv(&_uv[id].uv[1].x);  glVertex2i(width, 0);
-	glTexCoord2fv(&_uv[id].uv[2].x);  glVertex2i(width, _height);
-	glTexCoord2fv(&_uv[id].uv[3].x);  glVertex2i(0, _height);
-	glEnd();
+	GpuTexture(_textures[id]);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2fv(&_uv[id].uv[0].x);  GpuVertex2i(0, 0);
+	GpuTexCoord2fv(&_uv[id].uv[1].x);  GpuVertex2i(width, 0);
+	GpuTexCoord2fv(&_uv[id].uv[2].x);  GpuVertex2i(width, _height);
+	GpuTexCoord2fv(&_uv[id].uv[3].x);  GpuVertex2i(0, _height);
+	GpuEnd();
 	glPopMatrix();
 	glTranslated(_width[id], 0, 0);
-	glEndList();
+	GpuEndList();
 }
 
 //Create a display list coresponding to the given character.
@@ -211,6 +217,7 @@ void Font::BuildList(void* face_in, unsigned char ch)
 	}
 	//Create the GL texture.
 	glBindTexture(GL_TEXTURE_2D, _textures[ch]);
+	GpuForget();
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -219,8 +226,8 @@ void Font::BuildList(void* face_in, unsigned char ch)
 	delete[] expanded_data;
 
 	//So now we can create the display list
-	glNewList(_list_base + ch, GL_COMPILE);
-	glBindTexture(GL_TEXTURE_2D, _textures[ch]);
+	GpuNewList(_list_base + ch);
+	GpuTexture(_textures[ch]);
 	glPushMatrix();
 	//Ajust the postion of the polygon to allow for proper character spacing.
 	glyph_offset.x = bitmap_glyph->left;
@@ -228,6 +235,8 @@ void Font::BuildList(void* face_in, unsigned char ch)
 	glyph_offset.y = _height - bitmap_glyph->bitmap.rows;
 	//This is important for "dropped" letters like g and y, which sit below the line.
 	glyph_offset.y -= bitmap_glyph->top - bitmap->rows;
+	_offset[ch] = glyph_offset;
+	_size[ch] = GLcoord2(bitmap->width, bitmap->rows);
 	//Now move to the calculated position and draw the polygon.
 	glTranslated(glyph_offset.x, glyph_offset.y, 0);
 	//Our texture was padded out to the nearest power of 2. Adjust the UV's
@@ -238,45 +247,79 @@ void Font::BuildList(void* face_in, unsigned char ch)
 	_uv[ch].uv[1] = GLvector2(uv.x, 0);
 	_uv[ch].uv[2] = GLvector2(uv.x, uv.y);
 	_uv[ch].uv[3] = GLvector2(0, uv.y);
-	glBegin(GL_QUADS);
-	glTexCoord2fv(&_uv[ch].uv[0].x);  glVertex2i(0, 0);
-	glTexCoord2fv(&_uv[ch].uv[1].x);  glVertex2i(bitmap->width, 0);
-	glTexCoord2fv(&_uv[ch].uv[2].x);  glVertex2i(bitmap->width, bitmap->rows);
-	glTexCoord2fv(&_uv[ch].uv[3].x);  glVertex2i(0, bitmap->rows);
-	glEnd();
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2fv(&_uv[ch].uv[0].x);  GpuVertex2i(0, 0);
+	GpuTexCoord2fv(&_uv[ch].uv[1].x);  GpuVertex2i(bitmap->width, 0);
+	GpuTexCoord2fv(&_uv[ch].uv[2].x);  GpuVertex2i(bitmap->width, bitmap->rows);
+	GpuTexCoord2fv(&_uv[ch].uv[3].x);  GpuVertex2i(0, bitmap->rows);
+	GpuEnd();
 	glPopMatrix();
 	//Now move to the end of the character and store the width for future
 	//formatting calculations.
 	_width[ch] = face->glyph->advance.x / 64;
 	glTranslated(_width[ch], 0, 0);
-	glEndList();
+	GpuEndList();
+}
+
+//Queue one glyph with the batch. This is the same quad its display list draws.
+void Font::BatchChar(GLcoord2 pos, uchar ch, GLrgba color, GLenum blend_src, GLenum blend_dst) const
+{
+	GLvector2   corner;
+
+	if (!_size[ch].x || !_size[ch].y)
+		return;
+	corner = GLvector2((float)(pos.x + _offset[ch].x), (float)(pos.y + _offset[ch].y));
+	BatchQuad(_textures[ch], corner, corner + GLvector2((float)_size[ch].x, (float)_size[ch].y), _uv[ch].uv, color, blend_src, blend_dst);
+}
+
+//Queue the glyphs with the batch instead of calling the display lists.
+int Font::PrintBatch(GLcoord2 pos, const char* msg, GLrgba color, GLenum blend_src, GLenum blend_dst) const
+{
+	uchar       ch;
+	int         width;
+
+	width = 0;
+	for (unsigned i = 0; msg[i]; i++) {
+		ch = msg[i];
+		BatchChar(pos + GLcoord2(width, 0), ch, color, blend_src, blend_dst);
+		width += _width[ch];
+	}
+	return width;
 }
 
 int Font::Print(GLcoord2 pos, const char* msg) const
 {
-	float   modelview_matrix[16];
-	int     prev_texture;
+	float     modelview_matrix[16];
+	unsigned  prev_texture;
+
+	if (BatchActive()) {
+		GLrgba    color;
+		GLenum    src, dst;
 
+		color = GpuColorGet();
+		GpuBlendGet(&src, &dst);
+		return PrintBatch(pos, msg, color, src, dst);
+	}
 	//SAVE ALL THE STATES.
-	glPushAttrib(GL_LIST_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TRANSFORM_BIT);
+	GpuPushAttrib(GL_LIST_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TRANSFORM_BIT);
 	glMatrixMode(GL_MODELVIEW);
-	glDisable(GL_LIGHTING);
-	glEnable(GL_TEXTURE_2D);
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_BLEND);
+	GpuDisable(GL_LIGHTING);
+	GpuEnable(GL_TEXTURE_2D);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuEnable(GL_BLEND);
 	glListBase(_list_base);
 	glGetFloatv(GL_MODELVIEW_MATRIX, modelview_matrix);
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
+	prev_texture = GpuTextureGet();
 	//Begin drawing.
 	glPushMatrix();
 	//glLoadIdentity();
 	glTranslated(pos.x, pos.y, 0);
 	//glMultMatrixf(modelview_matrix);
-	glCallLists(strlen(msg), GL_UNSIGNED_BYTE, msg);
+	GpuCallLists(strlen(msg), GL_UNSIGNED_BYTE, msg);
 	//RESTORE ALL THE STATES
 	glPopMatrix();
-	glPopAttrib();
-	glBindTexture(GL_TEXTURE_2D, prev_texture);
+	GpuPopAttrib();
+	GpuTexture(prev_texture);
 	return Width(msg);
 }
 
@@ -297,33 +340,55 @@ int Font::Print(GLcoord2 pos, unsigned flags, GLrgba color, const char* msg) con
     origin.y -= size.y;
   if (flags & FONTMSG_ALIGN_CENTER)
     origin.y -= size.y / 2;
+  if (BatchActive()) {
+    GLenum    src, dst;
+
+    if (flags & FONTMSG_DROPSHADOW) {
+      PrintBatch(origin + GLcoord2(2, 2), msg, GLrgba(0, 0, 0), GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      return PrintBatch(origin, msg, color, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    //Setting the color would flush the batch, so hand it over directly.
+    GpuBlendGet(&src, &dst);
+    return PrintBatch(origin, msg, color, src, dst);
+  }
   if (flags & FONTMSG_DROPSHADOW) {
-    glColor3f (0, 0, 0);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GpuColor3f (0, 0, 0);
+    GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     Print(origin + GLcoord2(2, 2), msg);
   }
-  glColor3fv (&color.red);
+  GpuColor3fv (&color.red);
   return Print(origin, msg);
 }
 
 
 int Font::Print(GLcoord2 pos, vector<FontChar> f) const
 {
-	float   modelview_matrix[16];
-	int     prev_texture;
-	int     width;
-
+	float     modelview_matrix[16];
+	unsigned  prev_texture;
+	int       width;
+
+	if (BatchActive()) {
+		GLenum    src, dst;
+
+		GpuBlendGet(&src, &dst);
+		width = 0;
+		for (unsigned i = 0; i < f.size(); i++) {
+			BatchChar(pos + GLcoord2(width, 0), f[i].ascii, GLrgba(f[i].color.red, f[i].color.green, f[i].color.blue), src, dst);
+			width += _width[f[i].ascii];
+		}
+		return width;
+	}
 	//SAVE ALL THE STATES.
-	glPushAttrib(GL_LIST_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TRANSFORM_BIT);
+	GpuPushAttrib(GL_LIST_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TRANSFORM_BIT);
 	glMatrixMode(GL_MODELVIEW);
-	glDisable(GL_LIGHTING);
-	glEnable(GL_TEXTURE_2D);
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_BLEND);
+	GpuDisable(GL_LIGHTING);
+	GpuEnable(GL_TEXTURE_2D);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuEnable(GL_BLEND);
 	//glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glListBase(_list_base);
 	glGetFloatv(GL_MODELVIEW_MATRIX, modelview_matrix);
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
+	prev_texture = GpuTextureGet();
 	//Begin drawing.
 	glPushMatrix();
 	//glLoadIdentity();
@@ -331,15 +396,15 @@ int Font::Print(GLcoord2 pos, vector<FontChar> f) const
 	//glMultMatrixf(modelview_matrix);
 	width = 0;
 	for (unsigned i = 0; i < f.size(); i++) {
-		glColor3fv(&f[i].color.red);
+		GpuColor3fv(&f[i].color.red);
 		width += _width[f[i].ascii];
-		glCallLists(1, GL_UNSIGNED_BYTE, &f[i].ascii);
+		GpuCallLists(1, GL_UNSIGNED_BYTE, &f[i].ascii);
 	}
 	//RESTORE ALL THE STATES
 	glTranslated(-pos.x, -pos.y, 0);
 	glPopMatrix();
-	glPopAttrib();
-	glBindTexture(GL_TEXTURE_2D, prev_texture);
+	GpuPopAttrib();
+	GpuTexture(prev_texture);
 	return width;
 }
 
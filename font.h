@@ -34,9 +34,13 @@ class Font
 	unsigned          _textures[MAX_CHARS];	  //Holds the texture id's
 	unsigned          _width[MAX_CHARS];      //Width of each character.
 	GLuvFrame         _uv[MAX_CHARS];         //The uv rectangles of ech character.
+	GLcoord2          _offset[MAX_CHARS];     //Where each glyph sits relative to the pen.
+	GLcoord2          _size[MAX_CHARS];       //Size of each glyph's quad.
 	int               _list_base;	            //Holds the first display list id
 
 	void              BuildList(void* face, unsigned char ch);
+	void              BatchChar(GLcoord2 pos, uchar ch, GLrgba color, GLenum blend_src, GLenum blend_dst) const;
+	int               PrintBatch(GLcoord2 pos, const char* msg, GLrgba color, GLenum blend_src, GLenum blend_dst) const;
 public:
 	void              AddChar(uchar id, int width, unsigned texture, GLuvFrame frame);
 	unsigned          Height() const { return _height; }
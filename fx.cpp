@@ -12,14 +12,17 @@
 
 #include "master.h"
 
+#include "arena.h"
 #include "audio.h"
 #include "bodyparts.h"
 #include "camera.h"
 #include "collision.h"
+#include "dust.h"
 #include "entity.h"
 #include "env.h"
 #include "fx.h"
 #include "game.h"
+#include "gpu.h"
 #include "hud.h"
 #include "interface.h"
 #include "menu.h"
@@ -58,6 +61,32 @@
 #define PICKUP_SIZE             0.2f
 
 static int                      fx_id;
+static RandomStream&            cosmetic = RandomChannel(RANDOM_COSMETIC);  //For anything that only changes how things look.
+
+/*-----------------------------------------------------------------------------
+Base class
+-----------------------------------------------------------------------------*/
+
+void* fx::operator new(size_t size)
+{
+	return ArenaAlloc(size);
+}
+
+void fx::operator delete(void* ptr, size_t size)
+{
+	ArenaFree(ptr, size);
+}
+
+//True if something drawn at position, reaching this far in every direction,
+//would touch the view.
+bool fx::InView(const GLbbox2& view, GLvector2 position, float reach)
+{
+	if (position.x + reach < view.pmin.x || position.x - reach > view.pmax.x)
+		return false;
+	if (position.y + reach < view.pmin.y || position.y - reach > view.pmax.y)
+		return false;
+	return true;
+}
 
 /*-----------------------------------------------------------------------------
 Explosion class
@@ -185,15 +214,15 @@ void fxExplosion::Update()
 		points = (int)(circum / (_size / 8));
 		points = max(points, 1);
 		step = 360 / points;
-		angle_offset = RandomVal(360);
+		angle_offset = cosmetic.Val(360);
 		for (int a = 0; a < 360; a += step) {
 			float     size;
 			color = flip ? _color_main : _color_wave;
 			pos = SpriteMapVectorFromAngle(a + angle_offset);
-			size = _size * (RandomFloat() + 0.5f) * 0.5f;
-			ParticleBloom(_origin + pos*size, color, size, (EXPLOSION_TIME - elapsed) + RandomVal(100));
+			size = _size * (cosmetic.Float() + 0.5f) * 0.5f;
+			ParticleBloom(_origin + pos*size, color, size, (EXPLOSION_TIME - elapsed) + cosmetic.Val(100));
 			if (flip && _frame > 4)
-				ParticleSmoke(_origin + SpriteMapVectorFromAngle(a - angle_offset)*_size*RandomFloat(), _size, 1);
+				ParticleSmoke(_origin + SpriteMapVectorFromAngle(a - angle_offset)*_size*cosmetic.Float(), _size, 1);
 			flip = !flip;
 		}
 		ParticleSmoke(_origin, _size * 3, 1);
@@ -334,7 +363,7 @@ void fxPowerup::Init(GLvector2 position, PowerupType type, int value)
 	_type = type;
 	_value = value;
 	_begin = GameTick();
-	_animate_offset = RandomVal(99999);
+	_animate_offset = cosmetic.Val(99999);
 	_origin = position;
 	_active = true;
 	_gathering = false;
@@ -545,14 +574,14 @@ void fxMessage::Update()
 
 void fxMessage::Render()
 {
-	int     prev_texture;
+	unsigned  prev_texture;
 
 	if (!_active)
 		return;
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	prev_texture = GpuTextureGet();
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
 	glPushMatrix();
 	glTranslatef(_scroll.x, _scroll.y, MESSAGE_DEPTH);
 	glScalef(MESSAGE_TEXT_SIZE * _fade, MESSAGE_TEXT_SIZE, MESSAGE_TEXT_SIZE);
@@ -560,9 +589,9 @@ void fxMessage::Render()
 	RenderListCall(_id, _render_list);
 	//RenderQuad (_origin, SPRITE_SHOCKWAVE, GLrgba (1,1,1), 1, 0, MESSAGE_DEPTH, true);
 	glPopMatrix();
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_STENCIL_TEST);
-	glBindTexture(GL_TEXTURE_2D, prev_texture);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuEnable(GL_STENCIL_TEST);
+	GpuTexture(prev_texture);
 }
 
 /*-----------------------------------------------------------------------------
@@ -570,6 +599,11 @@ Projectile class - intended to supersede and unify old missile/bullet/beam types
 -----------------------------------------------------------------------------*/
 
 #define PROJECTILE_MAX_STEP 0.08
+#define BEAM_STEP           0.1f
+#define BEAM_STEPS          1000
+#define BEAM_STANDOFF       0.1f  //Beams stop this far short of the wall they hit.
+
+static vector<int>        targets;  //Robots that might be in the path of the current shot.
 
 void fxProjectile::Init(fxOwner owner, const Projectile* type, GLvector2 pos, GLvector2 vector, int damage_level)
 {
@@ -650,7 +684,7 @@ void fxProjectile::BoltInit()
 		_has_tail = true;
 	}
 	if (Shootable())
-		_disabled_spin = ((RandomFloat() - 0.5f) * 20.0f) + ((RandomFloat() - 0.5f) * 20.0f);
+		_disabled_spin = ((cosmetic.Float() - 0.5f) * 20.0f) + ((cosmetic.Float() - 0.5f) * 20.0f);
 }
 
 void fxProjectile::BoltVector(GLvector2 vector)
@@ -733,6 +767,9 @@ void fxProjectile::BoltUpdate()
 			_steps_per_frame *= 2;
 		}
 	}
+	//Only robots whose bounding boxes are along our path this frame can be hit.
+	if (_owner != OWNER_ROBOTS)
+		EntityRobotsAlong(_origin, _origin + _movement_step * (float)_steps_per_frame, targets);
 	//Break our movement into small steps.
 	for (int i = 0; i < _steps_per_frame; i++) {
 		_origin += _movement_step;
@@ -741,10 +778,10 @@ void fxProjectile::BoltUpdate()
 			Robot*      bot;
 			GLvector2   delta;
 
-			for (int b = 0; b < EntityRobotCount(); b++) {
+			for (unsigned t = 0; t < targets.size(); t++) {
 				bool  take_damage;
 
-				bot = EntityRobot(b);
+				bot = EntityRobot(targets[t]);
 				if (bot->Dead())
 					continue;
 				if (bot->Id() == _last_robot_hit)
@@ -801,35 +838,39 @@ void fxProjectile::BoltUpdate()
 		}
 	}
 	//See if we shot down any "missiles". Only player shots can do this.
+	//Projectiles are kept in lists by owner, so we can skip right past the
+	//player's own.
 	if (_owner == OWNER_PLAYER) {
-		fxProjectile*   p = EntityProjectileList();
-		for (int i = 0; i < MAX_PROJECTILES; i++) {
-			if (!p[i].Active() || p[i].Disabled())
-				continue;
-			if (!p[i].Shootable()) //Don't try to shoot non-shootable things.
-				continue;
-			if (p[i].Owner() == _owner) //Please don't shoot down friendly missiles.
-				continue;
-			GLvector2 delta = _origin - p[i].Origin();
+		const fxOwner   hostile[] = { OWNER_NONE, OWNER_ROBOTS };
+		for (int h = 0; h < 2; h++) {
+			for (int i = 0; i < EntityProjectileCount(hostile[h]); i++) {
+				fxProjectile*   p = EntityProjectile(hostile[h], i);
 
-			//Discard if it's not in the missile's bounding box.
-			if (abs(delta.x) > p[i].Radius() || abs(delta.y) > p[i].Radius())
-				continue;
-			if (delta.Length() < p[i].Radius()) {
-				//If the player shot down a projectile...
-				if (_owner == OWNER_PLAYER)
-					Player()->TriviaModify(TRIVIA_MISSILES_DESTROYED, 1);
-				AudioPlay("hit", _origin);
-				p[i].Disable();
-				ParticleDebris(_origin, 0.1f, 3, _projectile->_speed, _movement*0.25f);
-
-				_hits--;
-				if (_hits <= 0)
-				{
-					BoltEnd();
-					_active = false;
+				if (!p->Active() || p->Disabled())
+					continue;
+				if (!p->Shootable()) //Don't try to shoot non-shootable things.
+					continue;
+				GLvector2 delta = _origin - p->Origin();
+
+				//Discard if it's not in the missile's bounding box.
+				if (abs(delta.x) > p->Radius() || abs(delta.y) > p->Radius())
+					continue;
+				if (delta.Length() < p->Radius()) {
+					//If the player shot down a projectile...
+					if (_owner == OWNER_PLAYER)
+						Player()->TriviaModify(TRIVIA_MISSILES_DESTROYED, 1);
+					AudioPlay("hit", _origin);
+					p->Disable();
+					ParticleDebris(_origin, 0.1f, 3, _projectile->_speed, _movement*0.25f);
+
+					_hits--;
+					if (_hits <= 0)
+					{
+						BoltEnd();
+						_active = false;
+					}
+					return;
 				}
-				return;
 			}
 		}
 	}
@@ -1045,18 +1086,29 @@ void fxProjectile::BeamInit()
 	GLvector2   scan;
 	GLvector2   wall_normal;
 	GLvector2   from_camera;
+	GLvector2   far_end;
+	GLvector2   wall;
 	bool        terminate;
 	bool				hit_robot;
 	float       max_range;
+	float       wall_range;
 
 	max_range = CameraPosition().z * 2.0f;
 	_beam_bounce = GLvector2(0, 1);
 	_tick_end = _tick_begin + _projectile->_tick_fadeout;
-	//Starting from our origin, trace our path until we hit a wall.
-	step = _vector * 0.1f;
+	step = _vector * BEAM_STEP;
 	scan = _beam_end = _origin;
 	wall_normal = GLvector2(0, 1);
-	for (int i = 0; i < 1000; i++) {
+	//Find the wall at the end of the line in one go, and which robots are along the way.
+	far_end = _origin + step * BEAM_STEPS;
+	if (CollisionRay(_origin, far_end, &wall, &wall_normal))
+		far_end = wall;
+	else
+		wall_normal = GLvector2(0, 1);
+	wall_range = GLvector2(far_end - _origin).Length() - BEAM_STANDOFF;
+	if (_owner != OWNER_ROBOTS)
+		EntityRobotsAlong(_origin, far_end, targets);
+	for (int i = 0; i < BEAM_STEPS; i++) {
 		scan += step;
 		//Create a trail of fluffy glowing particles along the path of the beam.
 		ParticleBloom(scan, _sprite_color, 0.33f, _projectile->_tick_lifespan * 2);
@@ -1066,6 +1118,10 @@ void fxProjectile::BeamInit()
 			_can_bounce = false;
 			break;
 		}
+		if (GLvector2(scan - _origin).Length() >= wall_range) {
+			_beam_bounce = GLreflect2(_vector.Normalized(), wall_normal.Normalized());
+			break;
+		}
 		//See if we hit something.
 		if (BeamHit(scan, &wall_normal, &terminate, &hit_robot)) {
 			if (terminate)
@@ -1114,25 +1170,22 @@ void fxProjectile::BeamUpdate()
 	}
 }
 
+//Walls are handled by BeamInit (), so this only looks for things that can be damaged.
 bool fxProjectile::BeamHit(GLvector2 pos, GLvector2* normal, bool* terminate, bool* hit_robot)
 {
-	float       ignore;
-
 	//We set this to true if we want the beam to end HERE, with no further bouncing.
 	//Basically, it's for when we hit a target that should absorb rather than reflect.
 	*terminate = false;
 	*hit_robot = false;
-	if (Collision(pos, normal, &ignore, 0.1f))
-		return true;
 	//If this isn't a robot beam, see if it hit a robot
 	if (_owner != OWNER_ROBOTS) {
 		Robot*      bot;
 		GLvector2   delta;
 
-		for (int b = 0; b < EntityRobotCount(); b++) {
+		for (unsigned t = 0; t < targets.size(); t++) {
 			bool  take_damage;
 
-			bot = EntityRobot(b);
+			bot = EntityRobot(targets[t]);
 			if (bot->Dead())
 				continue;
 			//As we pass through a given robot, we should only deal damage to it ONCE.
@@ -1219,6 +1272,11 @@ void fxDoor::Init(GLvector2 position, DoorFacing direction, SpriteEntry sprite_i
 	_sprite = sprite_in;
 }
 
+bool fxDoor::OnScreen(const GLbbox2& view)
+{
+	return InView(view, _current_position, DOOR_HEIGHT);
+}
+
 void fxDoor::Render()
 {
 	RenderQuad(_current_position, SPRITE_DOOR, GLrgba(1, 1, 1), DOOR_HEIGHT, _angle, DEPTH_DOORS, false);
@@ -1350,8 +1408,8 @@ void fxPickup::InitGun(GLvector2 position, int id)
 	_sprite_color = p_info->_color;
 	_sprite_position = _origin;
 	_sprite_size = 0.5f;
-	_sprite_angle = -15.0f + RandomFloat() * 30.0f;
-	_bob_cycle = RandomFloat();
+	_sprite_angle = -15.0f + cosmetic.Float() * 30.0f;
+	_bob_cycle = cosmetic.Float();
 	_touching_player = TouchingPlayer();
 	_can_grab = false; //You can't pick it up until we have one frame of NOT touching.
 	AudioPlay("drop", _origin);
@@ -1462,13 +1520,38 @@ bool fxPickup::TouchingPlayer()
 /*-----------------------------------------------------------------------------
 Dust class - Unlike other fx objects, this one should only be instanced ONCE.
 It maintains a field of floating dust motes to give the game a certain visual
-depth.
+depth. A mote's position is a function of where it started, how long it's
+been drifting, and where the camera is, so nothing needs to be simulated per
+frame. With shaders on, dust.cg does the math on the GPU from a buffer that
+only changes when the field is re-seeded. MoteAt () is the same math on the
+CPU, and is what's drawn when shaders are off.
 -----------------------------------------------------------------------------*/
 
 #define DRIFT_SPEED         0.01f
 #define SPIN_SPEED          8.0f
-#define DUST_UPDATE         100
 #define DUST_SIZE           0.13f
+#define DUST_UV_MIN         0.01f   //Same texture inset as the sprite quads in render.cpp
+#define DUST_UV_MAX         0.98f
+
+//One corner of one mote, as it goes into the dust shader.
+struct DustVertex
+{
+	GLvector2     corner;
+	GLvector2     uv;
+	GLrgba        color;
+	GLvector      origin;   //Starting position and depth.
+	GLvector2     drift;
+	GLvector      spin;     //Starting angle, spin, and size.
+	GLvector      atlas;
+};
+
+fxDust::fxDust()
+{
+	_frame = 0;
+	_celebrating = false;
+	_buffer = 0;
+	_buffer_dirty = true;
+}
 
 void fxDust::Init()
 {
@@ -1481,78 +1564,163 @@ void fxDust::Init()
 	min_depth = -3.0f;// DEPTH_BG_NEAR;
 	_field.x = EnvPlayerVisionRadius() * 3.0f;
 	_field.y = _field.x / RenderAspect();
-	_update = 0;
+	_frame = 0;
+	_celebrating = false;
+	_buffer_dirty = true;
 	depth_range = max_depth - min_depth;
 	for (unsigned i = 0; i < MAX_DUST; i++) {
-		_mote[i].position.x = RandomFloat() * _field.x * 2.0f;
-		_mote[i].position.y = RandomFloat() * _field.y * 2.0f;
-		scale = RandomFloat();
+		_mote[i].position.x = cosmetic.Float() * _field.x * 2.0f;
+		_mote[i].position.y = cosmetic.Float() * _field.y * 2.0f;
+		scale = cosmetic.Float();
 		//Place the mote within our range. Not too close to the camera, not too far into the screen.
 		_mote[i].depth = scale * depth_range + min_depth;
 		//Scale it so distant motes are twice the size of close ones, so we can still see them.
 		_mote[i].size = (2.0f - scale * 1.0f) * DUST_SIZE;
-		_mote[i].drift.x = (RandomFloat() - 0.5f) * DRIFT_SPEED;
-		_mote[i].drift.y = (RandomFloat() - 0.125f) * DRIFT_SPEED;
-		_mote[i].angle = RandomFloat() * 360.0f;
-		_mote[i].spin = (RandomFloat() - 0.5f) * SPIN_SPEED;
+		_mote[i].drift.x = (cosmetic.Float() - 0.5f) * DRIFT_SPEED;
+		_mote[i].drift.y = (cosmetic.Float() - 0.125f) * DRIFT_SPEED;
+		_mote[i].angle = cosmetic.Float() * 360.0f;
+		_mote[i].spin = (cosmetic.Float() - 0.5f) * SPIN_SPEED;
 		_mote[i].color = GLrgba(0.5f, 0.5f, 0.5f);
 		_mote[i].sprite = SPRITE_MOTE;
 	}
 }
 
-void fxDust::Update()
+//Where the given mote is this frame. dust.cg must match this exactly.
+void fxDust::MoteAt(int index, GLvector2* position, float* angle)
 {
-	Mote*     m;
-	GLbbox    screen;
-	bool			moved;
+	Mote*         m;
+	float         time;
+
+	m = &_mote[index];
+	time = (float)_frame * DUST_RATE;
+	*position = DustPosition(m->position, m->drift, time, CameraPosition2D() - _field, _field * 2.0f);
+	*angle = DustAngle(m->angle, m->spin, time);
+}
 
-	screen.Clear();
-	screen.ContainPoint(CameraPosition2D() - _field);
-	screen.ContainPoint(CameraPosition2D() + _field);
+void fxDust::Update()
+{
 	_field.x = EnvPlayerVisionRadius() * 3.0f;
 	_field.y = _field.x / RenderAspect();
-	_update = (_update + DUST_UPDATE) % MAX_DUST;
-	for (unsigned i = 0; i < DUST_UPDATE; i++) {
-		m = &_mote[(_update + i) % MAX_DUST];
-		m->position += m->drift;
-		moved = false;
-		if (m->position.x < screen.pmin.x) {
-			moved = true;
-			m->position.x += _field.x * 2;
-		}
-		if (m->position.y < screen.pmin.y) {
-			moved = true;
-			m->position.y += _field.y * 2;
-		}
-		if (m->position.x > screen.pmax.x) {
-			m->position.x -= _field.x * 2;
-			moved = true;
-		}
-		if (m->position.y > screen.pmax.y) {
-			m->position.y -= _field.y * 2;
-			moved = true;
-		}
-		if (moved && WorldFinalBossKilled()) {
-			m->color = GLrgbaUnique(GameTick());
+	_frame++;
+	//Once the final boss is dead, the dust turns into confetti. Start the motes
+	//over from wherever they are now, with their new colors and speeds.
+	if (WorldFinalBossKilled() && !_celebrating) {
+		for (unsigned i = 0; i < MAX_DUST; i++) {
+			Mote*     m = &_mote[i];
+			float     angle;
+
+			MoteAt(i, &m->position, &angle);
+			m->angle = angle;
+			m->color = GLrgbaUnique(GameTick() + i);
 			m->sprite = SPRITE_NOVA;
-			m->size = (2.2f - RandomFloat()) * DUST_SIZE;
-			m->drift.x = (RandomFloat() - 0.5f) * DRIFT_SPEED * 2;
-			m->drift.y = (RandomFloat() + 0.25f) * DRIFT_SPEED * 2;
-			m->spin = (RandomFloat() - 0.5f) * SPIN_SPEED * 2;
+			m->size = (2.2f - cosmetic.Float()) * DUST_SIZE;
+			m->drift.x = (cosmetic.Float() - 0.5f) * DRIFT_SPEED * 2;
+			m->drift.y = (cosmetic.Float() + 0.25f) * DRIFT_SPEED * 2;
+			m->spin = (cosmetic.Float() - 0.5f) * SPIN_SPEED * 2;
+		}
+		_frame = 0;
+		_celebrating = true;
+		_buffer_dirty = true;
+	}
+}
+
+//Fill the vertex buffer for the dust shader. This only happens when the motes are re-seeded.
+void fxDust::Upload()
+{
+	static const GLvector2  corner[] = { GLvector2(-0.5f, -0.5f), GLvector2(0.5f, -0.5f), GLvector2(0.5f, 0.5f), GLvector2(-0.5f, 0.5f) };
+	static const GLvector2  uv[] = { GLvector2(DUST_UV_MIN, DUST_UV_MIN), GLvector2(DUST_UV_MAX, DUST_UV_MIN), GLvector2(DUST_UV_MAX, DUST_UV_MAX), GLvector2(DUST_UV_MIN, DUST_UV_MAX) };
+	vector<DustVertex>      vertex;
+
+	vertex.resize(MAX_DUST * 4);
+	for (unsigned i = 0; i < MAX_DUST; i++) {
+		Mote*           m = &_mote[i];
+		const AtlasRef* atlas = SpriteAtlasRef(m->sprite);
+
+		for (int c = 0; c < 4; c++) {
+			DustVertex*   v = &vertex[i * 4 + c];
+
+			v->corner = corner[c];
+			v->uv = uv[c];
+			v->color = m->color;
+			v->origin = GLvector(m->position.x, m->position.y, m->depth);
+			v->drift = m->drift;
+			v->spin = GLvector(m->angle, m->spin, m->size);
+			v->atlas = GLvector(atlas->col, atlas->row, atlas->scale);
 		}
-		m->angle += m->spin;
 	}
+	if (!_buffer)
+		glGenBuffersARB(1, &_buffer);
+	glBindBufferARB(GL_ARRAY_BUFFER, _buffer);
+	glBufferDataARB(GL_ARRAY_BUFFER, vertex.size() * sizeof(DustVertex), &vertex[0], GL_STATIC_DRAW);
+	glBindBufferARB(GL_ARRAY_BUFFER, 0);
+	_buffer_dirty = false;
+}
+
+void fxDust::RenderShader(GLrgba c)
+{
+	GLvector2   corner;
+	GLvector2   span;
+	GLint       origin, drift, spin, atlas;
+	unsigned    dust_program;
+
+	dust_program = RenderDustProgram();
+	if (_buffer_dirty)
+		Upload();
+	corner = CameraPosition2D() - _field;
+	span = _field * 2.0f;
+	GpuProgram(dust_program);
+	glUniform1fARB(glGetUniformLocationARB(dust_program, "uni_time"), (float)_frame * DUST_RATE);
+	glUniform4fARB(glGetUniformLocationARB(dust_program, "uni_field"), corner.x, corner.y, span.x, span.y);
+	glUniform4fARB(glGetUniformLocationARB(dust_program, "uni_tint"), c.red, c.green, c.blue, c.alpha);
+	origin = glGetAttribLocation(dust_program, "attrib_origin");
+	drift = glGetAttribLocation(dust_program, "attrib_drift");
+	spin = glGetAttribLocation(dust_program, "attrib_spin");
+	atlas = glGetAttribLocation(dust_program, "attrib_atlas");
+	glBindBufferARB(GL_ARRAY_BUFFER, _buffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(DustVertex), (void*)offsetof(DustVertex, corner));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(DustVertex), (void*)offsetof(DustVertex, uv));
+	glColorPointer(4, GL_FLOAT, sizeof(DustVertex), (void*)offsetof(DustVertex, color));
+	glEnableVertexAttribArray(origin);
+	glEnableVertexAttribArray(drift);
+	glEnableVertexAttribArray(spin);
+	glEnableVertexAttribArray(atlas);
+	glVertexAttribPointer(origin, 3, GL_FLOAT, GL_FALSE, sizeof(DustVertex), (void*)offsetof(DustVertex, origin));
+	glVertexAttribPointer(drift, 2, GL_FLOAT, GL_FALSE, sizeof(DustVertex), (void*)offsetof(DustVertex, drift));
+	glVertexAttribPointer(spin, 3, GL_FLOAT, GL_FALSE, sizeof(DustVertex), (void*)offsetof(DustVertex, spin));
+	glVertexAttribPointer(atlas, 3, GL_FLOAT, GL_FALSE, sizeof(DustVertex), (void*)offsetof(DustVertex, atlas));
+	//Dust is drawn as glow, like the quads it replaces.
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDrawArrays(GL_QUADS, 0, MAX_DUST * 4);
+	glDisableVertexAttribArray(origin);
+	glDisableVertexAttribArray(drift);
+	glDisableVertexAttribArray(spin);
+	glDisableVertexAttribArray(atlas);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBufferARB(GL_ARRAY_BUFFER, 0);
+	GpuProgram(0);
 }
 
 void fxDust::Render(GLrgba c)
 {
 	Mote*     m;
+	GLvector2 position;
+	float     angle;
 
 	if (!EnvValueb(ENV_RENDER_DUST))
 		return;
+	if (RenderShaderActive()) {
+		RenderShader(c);
+		return;
+	}
 	for (unsigned i = 0; i < MAX_DUST; i++) {
 		m = &_mote[i];
-		RenderQuad(m->position, m->sprite, c * m->color, m->size, m->angle, m->depth, true);
+		MoteAt(i, &position, &angle);
+		RenderQuad(position, m->sprite, c * m->color, m->size, angle, m->depth, true);
 	}
 }
 
@@ -1659,10 +1827,10 @@ void fxForcefield::Render()
 	if (!_on)
 		return;
 	if (EnvValueb(ENV_BBOX)) {
-		glColor3f(1, 1, 1);
-		glDisable(GL_TEXTURE_2D);
+		GpuColor3f(1, 1, 1);
+		GpuDisable(GL_TEXTURE_2D);
 		_bbox.Render();
-		glEnable(GL_TEXTURE_2D);
+		GpuEnable(GL_TEXTURE_2D);
 	}
 	RenderQuad(_position[0], SPRITE_BEAM, _color, _size, 0, 0, true);
 	RenderQuad(_position[1], SPRITE_BEAM, _color, _size, 90, 0, true);
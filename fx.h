@@ -29,10 +29,17 @@ protected:
 	int                 _frame;
 	int                 _id;
 	bool                _active;
+
+	static bool         InView(const GLbbox2& view, GLvector2 position, float reach);
 public:
 	virtual             ~fx()     {}
+	//Effects live no longer than the zone, so they come from the zone arena.
+	static void*        operator new(size_t size);
+	static void         operator delete(void* ptr, size_t size);
 	bool                Active() { return _active; }
 	void                Retire() { _active = false; }
+	//Anything that doesn't know where it draws is always drawn.
+	virtual bool        OnScreen(const GLbbox2& view) { return true; }
 	virtual void        Update() = 0;
 	virtual void        Render() = 0;
 	virtual fxType      Type() = 0;
@@ -83,6 +90,7 @@ class fxPowerup : public fx
 
 public:
 	void              Init(GLvector2 position, PowerupType type, int value = 0);
+	bool              OnScreen(const GLbbox2& view) { return InView(view, _origin, _size); }
 	void              Render();
 	GLvector2         Position() { return _origin; }
 	int               Value() { return _value; }
@@ -106,6 +114,7 @@ class fxShieldHit : public fx
 public:
 	void              Init(GLrgba color, int timestamp, float size);
 	void              HitAngle(int angle);
+	bool              OnScreen(const GLbbox2& view) { return InView(view, _origin, _size); }
 	void              Update();
 	void              Render();
 	fxType            Type() { return FX_SHIELDHIT; }
@@ -134,6 +143,7 @@ public:
 	void              Init(fxOwner own, GLvector2 origin, int damage, float radius);
 	bool              Collide(GLvector2 pos, GLvector2* pushback);
 	void              ColorSet(GLrgba color1, GLrgba color2);
+	bool              OnScreen(const GLbbox2& view) { return InView(view, _origin, max(_size * 2, _size_max)); }
 	void              Render();
 	void              Update();
 	void              SizeSet(float size);
@@ -209,6 +219,7 @@ class fxPickup : public fx
 	bool              PlayerAlreadyHasThis();
 public:
 	void              InitGun(GLvector2 position, int gun_id);
+	bool              OnScreen(const GLbbox2& view) { return InView(view, _sprite_position, _sprite_size); }
 	void              Render();
 	void              Update();
 	fxType            Type() { return FX_POWERUP; }
@@ -272,6 +283,7 @@ public:
 	bool              Disabled() { return _is_disabled; }
 	GLvector2         Origin() { return _origin; }
 	fxOwner           Owner() { return _owner; }
+	bool              OnScreen(const GLbbox2& view) { return InView(view, _sprite_position, _sprite_radius); }
 	void              Render();
 	float             Radius() { return _sprite_radius; }
 	bool              Shootable();
@@ -295,11 +307,19 @@ struct Mote
 
 class fxDust
 {
-	Mote                      _mote[MAX_DUST];
+	Mote                      _mote[MAX_DUST];    //Where each mote started, and how it moves.
 	GLvector2                 _field;
-	int                       _update;
+	int                       _frame;             //Frames since the motes were placed.
+	bool                      _celebrating;       //The final boss is dead and we've switched to party mode.
+	unsigned                  _buffer;            //Static vertex buffer for the dust shader.
+	bool                      _buffer_dirty;
+
+	void                      MoteAt(int index, GLvector2* position, float* angle);
+	void                      RenderShader(GLrgba c);
+	void                      Upload();
 
 public:
+	fxDust();
 	void                      Init();
 	void                      Render(GLrgba c);
 	void                      Update();
@@ -313,14 +333,6 @@ public:
 	virtual void              Hit(GLvector2 pos, int damage) = 0;
 };
 
-enum DoorFacing
-{
-	DOOR_UP,
-	DOOR_DOWN,
-	DOOR_RIGHT,
-	DOOR_LEFT,
-};
-
 class fxDoor : public fxDevice
 {
 	GLvector2         _move_direction;      //The direction the door will slide when opened.
@@ -344,6 +356,7 @@ public:
 	void              Hit(GLvector2 pos, int damage);
 	void              Init(GLvector2 position, DoorFacing direction, SpriteEntry se, int destination, bool locked);
 	Line2D            Line() { return _line; }
+	bool              OnScreen(const GLbbox2& view);
 	void              Render();
 	void              RenderOccluded();
 	void              Update();
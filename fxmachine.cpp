@@ -20,6 +20,7 @@ the kid's table in fx.cpp.
 #include "drop.h"
 #include "entity.h"
 #include "fx.h"
+#include "gpu.h"
 #include "loaders.h"
 #include "fxmachine.h"
 #include "menu.h"
@@ -27,11 +28,13 @@ the kid's table in fx.cpp.
 #include "player.h"
 #include "random.h"
 #include "render.h"
+#include "spawn.h"
 #include "world.h"
 #include "zone.h"
 
 #define SPAWN_RATE      200
 #define LONG_COOLDOWN   4000
+#define LOS_KEEP        500   //How long a line of sight check stays good.
 
 using namespace pyrodactyl;
 
@@ -194,6 +197,8 @@ void fxMachine::Init(GLvector2 position, GLcoord2 page, const MachineInfo* info)
 	_bbox.Clear();
 	_bbox.ContainPoint(_origin);
 	_factory_next = 0;
+	_los_expires = 0;
+	_los_clear = false;
 	_on = true;
 	_spawner = position;
 	_hitpoints = _info->_hitpoints;
@@ -254,7 +259,7 @@ void fxMachine::Destroy ()
 			fxExplosion* e = new fxExplosion;
 			e->Init (OWNER_NONE, _origin + p->position, 1, p->size / 1.4f);
 			EntityFxAdd (e);
-			ParticleDebris (_origin + p->position, p->size / 4.0f, 3, 1.0f + RandomFloat () * 7.0f);
+			ParticleDebris (_origin + p->position, p->size / 4.0f, 3, 1.0f + RandomChannel(RANDOM_COSMETIC).Float() * 7.0f);
 		}
 	}
 	//Drop stuff.
@@ -345,6 +350,10 @@ void fxMachine::FactoryUpdate()
 	//Limit the rate at which we spawn robots.
 	if (GameTick() < _factory_next)
 		return;
+	//The spawn director only lets a few factories look around each frame.
+	//If it's not our turn, we'll ask again next frame.
+	if (!SpawnTurn())
+		return;
 	_factory_next = GameTick() + SPAWN_RATE;
 
 	int           robot_id;
@@ -371,14 +380,24 @@ void fxMachine::FactoryUpdate()
 		return;
 	}
 	//If the population is too high, put this spawner on a long cooldown
-	//before we try again.
-	if (EntityRobotsActive() > _info->_max_active_robots) {
+	//before we try again. If the director is just busy, try at the usual rate.
+	switch (SpawnAsk(_info->_max_active_robots)) {
+	case SPAWN_CROWDED:
 		_factory_next += LONG_COOLDOWN;
 		return;
+	case SPAWN_BUSY:
+		return;
+	default:
+		break;
 	}
 	//Don't make robots unless there's a clear line of sight to the player,
-	//to avoid spawning robots or behind walls.
-	if (!CollisionLos(_origin + _parts[0].position, PlayerPosition(), 0.5f))
+	//to avoid spawning robots or behind walls. The answer is good for a
+	//little while, since the walls don't move and the player doesn't go far.
+	if (GameTick() >= _los_expires) {
+		_los_clear = CollisionLos(_origin + _parts[0].position, PlayerPosition(), 0.5f);
+		_los_expires = GameTick() + LOS_KEEP;
+	}
+	if (!_los_clear)
 		return;
 	robot_id = WorldZone()->RobotSpawnId(_page);
 	//If RobotSpawnId returns ROBOT_INVALID, then the current location is
@@ -395,6 +414,7 @@ void fxMachine::FactoryUpdate()
 	b.Init(_bbox.Center(), robot_id);
 	b.Launch(launch_vector);
 	EntityRobotAdd(b);
+	SpawnMade();
 	//Make some particle effects to cover the spawn.
 	ParticleBloom (_bbox.Center (), GLrgba (1, 1, 1), 1.0f, 500);
 	AudioPlay ("skate", _bbox.Center ());
@@ -421,13 +441,13 @@ void fxMachine::Render()
 	}
 	if (EnvValueb(ENV_BBOX)) {
 		if (_destroyed)
-			glColor3f(1, 0, 0);
+			GpuColor3f(1, 0, 0);
 		else
-			glColor3f (0, 1, 0);
-		glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glDisable(GL_TEXTURE_2D);
+			GpuColor3f (0, 1, 0);
+		GpuBlend (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GpuDisable(GL_TEXTURE_2D);
 		_bbox.Render();
-		glEnable(GL_TEXTURE_2D);
+		GpuEnable(GL_TEXTURE_2D);
 	}
 }
 
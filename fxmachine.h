@@ -90,6 +90,8 @@ class fxMachine : public fxDevice
 	GLvector2             _spawner;       ///When spawning the player, they will appear here.
 	GLvector2             _dropoff;       ///When spawning stuff, it will appear here.
 	unsigned              _factory_next;  ///The next game tick when we can pop out a bot.
+	unsigned              _los_expires;   ///When the saved line of sight check needs to be done again.
+	bool                  _los_clear;     ///If the player could be seen from the spawner last time we checked.
 	bool                  _on;            ///If false, the machine should stop doing whatever it does.
   bool                  _destroyed;     ///If it's been blown up by gunfire.
 	bool									_humming;				///If the machine is humming because the player is close.
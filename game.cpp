@@ -11,6 +11,7 @@
 
 #include "master.h"
 
+#include "arena.h"
 #include "audio.h"
 #include "bodyparts.h"
 #include "character.h"
@@ -19,6 +20,7 @@
 #include "env.h"
 #include "file.h"
 #include "game.h"
+#include "gpu.h"
 #include "hud.h"
 #include "ini.h"
 #include "input.h"
@@ -28,7 +30,9 @@
 #include "player.h"
 #include "random.h"
 #include "render.h"
+#include "replay.h"
 #include "robot.h"
+#include "stats.h"
 #include "system.h"
 #include "world.h"
 
@@ -81,6 +85,9 @@ void GameCommand(const char* message, ...)
 		Console ("EnvInit: Robot roll call:");
 		Console ("%s", EnvRobotRollCall ());
 	}
+	if (!_stricmp (cmd, "arena")) {
+		ArenaStats ();
+	}
 	if (!_stricmp (cmd, "hud")) {
 		if (words.size () > 1) {
 			if (words[1] == "on")
@@ -90,10 +97,16 @@ void GameCommand(const char* message, ...)
 		} else
 			HudToggleVisible ();
 	}
+	if (GpuHandleCommand (words))
+		return;
+	if (StatsHandleCommand (words))
+		return;
 	if (EnvHandleCommand (words))
 		return;
 	if (!EnvValueb (ENV_CHEATS))
 		return;
+	if (ReplayHandleCommand (words))
+		return;
 	if (!_stricmp(cmd, "reload"))
 		EnvReloadData();
 	if (!_stricmp(cmd, "compile"))
@@ -248,11 +261,16 @@ string GameSaveFile(eGameMode gm)
 
 void GameEnd()
 {
+	//Replays start their own game, and shouldn't touch the player's saves.
+	if (ReplayActive())
+		return;
 	FileDelete(GameSaveFile(Player()->GameMode()));
 }
 
 void GameSave()
 {
+	if (ReplayActive())
+		return;
 	Player()->Save(GameSaveFile(Player()->GameMode()));
 }
 
@@ -274,12 +292,8 @@ void GameLoad(eGameMode gm)
 void GameTerm()
 {
 	if (game_running) {
-		iniFile   f;
-
 		GameSave();
-
-		f.Open(SystemConfigFile());
-		f.IntSet("Settings", "LastSave", Player()->Id());
+		SystemConfig().IntSet("Settings", "LastSave", Player()->Id());
 	}
 }
 
@@ -342,10 +356,7 @@ void GameRender()
 void GameInit()
 {
 #ifdef _DEBUG
-	iniFile   f;
-
-	f.Open(SystemConfigFile());
-	autoload = f.IntGet("Settings", "LastSave");
+	autoload = SystemConfig().IntGet("Settings", "LastSave");
 	//autoload = 0;
 #endif
 }
\ No newline at end of file
@@ -281,6 +281,44 @@ void GLvector::Normalize()
 	z /= len;
 }
 
+/*-----------------------------------------------------------------------------
+GLbbox2
+-----------------------------------------------------------------------------*/
+
+//Slab test: does the segment from start to end pass through the box?
+bool GLbbox2::Crosses(GLvector2 start, GLvector2 end) const
+{
+	float     t_min;
+	float     t_max;
+	float     lo, hi;
+	float     inv;
+
+	t_min = 0.0f;
+	t_max = 1.0f;
+	for (int axis = 0; axis < 2; axis++) {
+		float   from = axis ? start.y : start.x;
+		float   delta = axis ? end.y - start.y : end.x - start.x;
+		float   box_min = axis ? pmin.y : pmin.x;
+		float   box_max = axis ? pmax.y : pmax.x;
+
+		if (delta == 0.0f) {
+			if (from < box_min || from > box_max)
+				return false;
+			continue;
+		}
+		inv = 1.0f / delta;
+		lo = (box_min - from) * inv;
+		hi = (box_max - from) * inv;
+		if (lo > hi)
+			SWAPF(lo, hi);
+		t_min = max(t_min, lo);
+		t_max = min(t_max, hi);
+		if (t_min > t_max)
+			return false;
+	}
+	return true;
+}
+
 /*-----------------------------------------------------------------------------
 GLmesh
 -----------------------------------------------------------------------------*/
@@ -378,6 +416,8 @@ void GLmesh::Normalize()
 		_normal[i].Normalize();
 }
 
+#ifndef WORLDGEN_HEADLESS
+
 void GLmesh::Render()
 {
 	unsigned      i;
@@ -394,6 +434,8 @@ void GLmesh::Render()
 	glEnd();
 }
 
+#endif
+
 void GLmesh::operator+= (const GLmesh& c)
 {
 	unsigned      index;
@@ -476,6 +518,66 @@ void GLmesh::Clear()
 	_color.clear();
 }
 
+/*-----------------------------------------------------------------------------
+GLflatMesh
+-----------------------------------------------------------------------------*/
+
+//Vectors keep their capacity when cleared, so a mesh that gets rebuilt
+//over and over (like the zone layers) stops allocating after the first time.
+void GLflatMesh::Clear()
+{
+	_bbox.Clear();
+	_vertex.clear();
+	_index.clear();
+	_use_color = false;
+}
+
+void GLflatMesh::Reserve(unsigned quads)
+{
+	_vertex.reserve(quads * 4);
+	_index.reserve(quads * 6);
+}
+
+//Same winding as GLmesh: the last 4 verts, in the order they were added.
+void GLflatMesh::PushQuad()
+{
+	unsigned  i;
+
+	i = _vertex.size() - 4;
+	_index.push_back(i + 2);
+	_index.push_back(i + 1);
+	_index.push_back(i + 0);
+	_index.push_back(i + 3);
+	_index.push_back(i + 2);
+	_index.push_back(i + 0);
+}
+
+void GLflatMesh::PushVertex(GLvector2 vert, GLvector2 uv)
+{
+	GLflatVertex  v;
+
+	_bbox.ContainPoint(vert);
+	v.x = vert.x;
+	v.y = vert.y;
+	memset(v.color, 255, 4);
+	v.uv[0] = (unsigned short)(clamp(uv.x, 0.0f, 1.0f) * GLFLAT_UV_SCALE + 0.5f);
+	v.uv[1] = (unsigned short)(clamp(uv.y, 0.0f, 1.0f) * GLFLAT_UV_SCALE + 0.5f);
+	_vertex.push_back(v);
+}
+
+void GLflatMesh::PushVertex(GLvector2 vert, GLrgba color, GLvector2 uv)
+{
+	GLflatVertex* v;
+
+	PushVertex(vert, uv);
+	v = &_vertex.back();
+	v->color[0] = (unsigned char)(clamp(color.red, 0.0f, 1.0f) * 255.0f);
+	v->color[1] = (unsigned char)(clamp(color.green, 0.0f, 1.0f) * 255.0f);
+	v->color[2] = (unsigned char)(clamp(color.blue, 0.0f, 1.0f) * 255.0f);
+	v->color[3] = (unsigned char)(clamp(color.alpha, 0.0f, 1.0f) * 255.0f);
+	_use_color = true;
+}
+
 void GLmesh::RecalculateBoundingBox()
 {
 	_bbox.Clear();
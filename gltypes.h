@@ -339,11 +339,13 @@ struct GLbbox2
 			return true;
 		return false;
 	}
+	bool        Crosses(GLvector2 start, GLvector2 end) const;
 	void        Clear(void)
 	{
 		pmax = GLvector2(-MAX_VALUE, -MAX_VALUE);
 		pmin = GLvector2(MAX_VALUE, MAX_VALUE);
 	}
+#ifndef WORLDGEN_HEADLESS
 	void        Render()
 	{
 		glBegin(GL_LINE_STRIP);
@@ -354,6 +356,7 @@ struct GLbbox2
 		glVertex2f(pmin.x, pmin.y);
 		glEnd();
 	}
+#endif
 	GLvector2   Size() { return pmax - pmin; }
 };
 
@@ -387,6 +390,7 @@ struct GLbbox
 		pmax = GLvector(-MAX_VALUE, -MAX_VALUE, -MAX_VALUE);
 		pmin = GLvector(MAX_VALUE, MAX_VALUE, MAX_VALUE);
 	}
+#ifndef WORLDGEN_HEADLESS
 	void        Render()
 	{
 		//Bottom of box (Assuming z = up)
@@ -420,6 +424,7 @@ struct GLbbox
 		glVertex3f(pmin.x, pmax.y, pmax.z);
 		glEnd();
 	}
+#endif
 };
 
 /*-----------------------------------------------------------------------------
@@ -559,6 +564,41 @@ struct GLmesh
 	void    operator+= (const GLmesh& c);
 };
 
+/*-----------------------------------------------------------------------------
+GLflatMesh
+-----------------------------------------------------------------------------*/
+
+//Interleaved vertex for flat geometry: a 2D position, an RGBA8 color, and
+//UVs stored as 16-bit fractions of the texture. The whole mesh sits at one
+//depth. Bump GLFLAT_VERSION whenever this layout changes.
+#define GLFLAT_VERSION    1
+#define GLFLAT_UV_SCALE   65535.0f
+
+struct GLflatVertex
+{
+	float             x, y;
+	unsigned char     color[4];
+	unsigned short    uv[2];
+};
+
+struct GLflatMesh
+{
+	GLbbox2                 _bbox;
+	float                   _depth;
+	bool                    _use_color;
+	vector<GLflatVertex>    _vertex;
+	vector<unsigned>        _index;
+
+	GLflatMesh() { _depth = 0.0f; _use_color = false; _bbox.Clear(); }
+	void              Clear();
+	void              PushQuad();
+	void              PushVertex(GLvector2 vert, GLvector2 uv);
+	void              PushVertex(GLvector2 vert, GLrgba color, GLvector2 uv);
+	void              Reserve(unsigned quads);
+	unsigned          Triangles() const { return _index.size() / 3; }
+	unsigned          Vertices() const { return _vertex.size(); }
+};
+
 //Get an angle between two given points on a grid
 float     Angle2D(float x1, float y1, float x2, float y2);
 //difference between two angles
@@ -0,0 +1,495 @@
+/*-----------------------------------------------------------------------------
+
+  Gpu.cpp
+
+  A thin layer between the renderer and OpenGL. Draws and state changes go
+  through here so they can be counted, per frame and per pass. The null
+  backend counts everything and draws nothing, which is handy for measuring
+  what a frame costs in calls without the GPU getting in the way.
+
+  The headless build has no OpenGL at all. Only the null backend exists
+  there, so the counts can be tested without a window or a GPU.
+
+  The layer also remembers the blend, color and texture it last set, so
+  the code above can read them back without stalling on a glGet.
+
+  Everything drawn each frame comes through here. Matrices, shader uniforms
+  and vertex array setup still go straight to OpenGL, as does creating
+  textures, buffers and lists, since none of those draw anything.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#ifndef WORLDGEN_HEADLESS
+#include "batch.h"
+#endif
+#include "console.h"
+#include "gpu.h"
+
+#ifdef WORLDGEN_HEADLESS
+#define GL_CALL(call)
+#else
+#define GL_CALL(call)       if (live()) call
+#endif
+
+#ifdef WORLDGEN_HEADLESS
+static GpuBackend           backend = GPU_BACKEND_NULL;
+#else
+static GpuBackend           backend;
+#endif
+static vector<GpuStats>     current;
+static vector<GpuStats>     last;
+static bool                 in_begin;
+static bool                 compiling;
+static GpuStats             uncounted;
+//What was last set through here, so it can be read back without asking
+//the driver. Calling a list or popping attributes can change any of it
+//behind our back, so after either one (and at startup) it's asked for
+//again the first time it's wanted.
+static GLenum               blend_source = GL_SRC_ALPHA;
+static GLenum               blend_dest = GL_ONE_MINUS_SRC_ALPHA;
+static bool                 blend_known;
+static GLrgba               color = GLrgba(1, 1, 1);
+static bool                 color_known;
+static unsigned             texture;
+static bool                 texture_known;
+static bool                 textured;
+static bool                 textured_known;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+#ifndef WORLDGEN_HEADLESS
+static bool live()
+{
+	return backend == GPU_BACKEND_GL;
+}
+#endif
+
+//Every command comes through here. Anything the interface batch is holding
+//was drawn before this command, so it has to go out first. Commands going
+//into a list aren't counted until the list is called.
+static GpuStats* stats()
+{
+	if (compiling)
+		return &uncounted;
+#ifndef WORLDGEN_HEADLESS
+	if (!in_begin)
+		BatchFlush();
+#endif
+	if (current.empty())
+		GpuPass("Frame");
+	return &current.back();
+}
+
+//Nothing set while building a list happens until the list is called.
+static bool track()
+{
+	return !compiling;
+}
+
+static void count_state()
+{
+	stats()->states++;
+}
+
+static void count_vertex()
+{
+	stats()->vertices++;
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+GpuBackend GpuBackendGet()
+{
+	return backend;
+}
+
+//The headless build can only count.
+void GpuBackendSet(GpuBackend b)
+{
+#ifndef WORLDGEN_HEADLESS
+	backend = b;
+#endif
+}
+
+//Called at the start of every frame. Keeps the counts from the frame that just ended.
+void GpuFrame()
+{
+	last = current;
+	current.clear();
+}
+
+//Everything drawn from here on is counted as part of the named pass.
+//The name should be a string constant.
+void GpuPass(const char* name)
+{
+	GpuStats    s;
+
+	s.pass = name;
+	s.draws = 0;
+	s.states = 0;
+	s.vertices = 0;
+	current.push_back(s);
+}
+
+const vector<GpuStats>& GpuStatsLast()
+{
+	return last;
+}
+
+//For code that changes state straight through OpenGL, like binding a
+//texture to load it. Everything we were keeping track of gets asked for again.
+void GpuForget()
+{
+	blend_known = false;
+	color_known = false;
+	texture_known = false;
+	textured_known = false;
+}
+
+#ifndef WORLDGEN_HEADLESS
+bool GpuHandleCommand(const vector<string> &words)
+{
+	GpuStats    total;
+
+	if (words.empty() || _stricmp(words[0].c_str(), "gpu"))
+		return false;
+	if (words.size() > 1) {
+		if (!_stricmp(words[1].c_str(), "null"))
+			GpuBackendSet(GPU_BACKEND_NULL);
+		else if (!_stricmp(words[1].c_str(), "gl"))
+			GpuBackendSet(GPU_BACKEND_GL);
+		Console("Gpu: %s backend.", backend == GPU_BACKEND_NULL ? "null" : "OpenGL");
+		return true;
+	}
+	total.draws = total.states = total.vertices = 0;
+	for (unsigned i = 0; i < last.size(); i++) {
+		Console("%-12s %5d draws %5d states %7d verts", last[i].pass, last[i].draws, last[i].states, last[i].vertices);
+		total.draws += last[i].draws;
+		total.states += last[i].states;
+		total.vertices += last[i].vertices;
+	}
+	Console("%-12s %5d draws %5d states %7d verts", "Total", total.draws, total.states, total.vertices);
+	return true;
+}
+#endif
+
+/*-----------------------------------------------------------------------------
+Drawing
+-----------------------------------------------------------------------------*/
+
+void GpuBegin(GLenum mode)
+{
+	stats()->draws++;
+	in_begin = true;
+	GL_CALL(glBegin(mode));
+}
+
+void GpuEnd()
+{
+	in_begin = false;
+	GL_CALL(glEnd());
+}
+
+//Everything between these goes into the list instead of being drawn, and is
+//counted when the list is called. With the null backend nothing is
+//recorded, so a list built then stays empty.
+void GpuNewList(unsigned list)
+{
+	compiling = true;
+	GL_CALL(glNewList(list, GL_COMPILE));
+}
+
+void GpuEndList()
+{
+	GL_CALL(glEndList());
+	compiling = false;
+}
+
+void GpuCallList(unsigned list)
+{
+	stats()->draws++;
+	GL_CALL(glCallList(list));
+	GpuForget();
+}
+
+//Each list counts as a draw, since that's how the font sends its letters.
+void GpuCallLists(int count, GLenum type, const void* lists)
+{
+	stats()->draws += count;
+	GL_CALL(glCallLists(count, type, lists));
+	GpuForget();
+}
+
+void GpuDrawArrays(GLenum mode, int first, int count)
+{
+	stats()->draws++;
+	stats()->vertices += count;
+	GL_CALL(glDrawArrays(mode, first, count));
+}
+
+void GpuDrawElements(GLenum mode, int count, GLenum type, const void* indices)
+{
+	stats()->draws++;
+	stats()->vertices += count;
+	GL_CALL(glDrawElements(mode, count, type, indices));
+}
+
+static void set_color(GLrgba c)
+{
+	color = c;
+	color_known = true;
+}
+
+//Color is a state change outside of Begin / End, and per-vertex data inside.
+void GpuColor3f(float r, float g, float b)
+{
+	if (!in_begin)
+		count_state();
+	if (track())
+		set_color(GLrgba(r, g, b));
+	GL_CALL(glColor3f(r, g, b));
+}
+
+void GpuColor3fv(const float* c)
+{
+	if (!in_begin)
+		count_state();
+	if (track())
+		set_color(GLrgba(c[0], c[1], c[2]));
+	GL_CALL(glColor3fv(c));
+}
+
+void GpuColor4f(float r, float g, float b, float a)
+{
+	if (!in_begin)
+		count_state();
+	if (track())
+		set_color(GLrgba(r, g, b, a));
+	GL_CALL(glColor4f(r, g, b, a));
+}
+
+void GpuColor4fv(const float* c)
+{
+	if (!in_begin)
+		count_state();
+	if (track())
+		set_color(GLrgba(c[0], c[1], c[2], c[3]));
+	GL_CALL(glColor4fv(c));
+}
+
+void GpuTexCoord2f(float u, float v)
+{
+	GL_CALL(glTexCoord2f(u, v));
+}
+
+void GpuTexCoord2fv(const float* uv)
+{
+	GL_CALL(glTexCoord2fv(uv));
+}
+
+void GpuVertex2d(double x, double y)
+{
+	count_vertex();
+	GL_CALL(glVertex2d(x, y));
+}
+
+void GpuVertex2f(float x, float y)
+{
+	count_vertex();
+	GL_CALL(glVertex2f(x, y));
+}
+
+void GpuVertex2fv(const float* v)
+{
+	count_vertex();
+	GL_CALL(glVertex2fv(v));
+}
+
+void GpuVertex2i(int x, int y)
+{
+	count_vertex();
+	GL_CALL(glVertex2i(x, y));
+}
+
+void GpuVertex3f(float x, float y, float z)
+{
+	count_vertex();
+	GL_CALL(glVertex3f(x, y, z));
+}
+
+void GpuVertex3fv(const float* v)
+{
+	count_vertex();
+	GL_CALL(glVertex3fv(v));
+}
+
+/*-----------------------------------------------------------------------------
+State
+-----------------------------------------------------------------------------*/
+
+void GpuBlend(GLenum source, GLenum dest)
+{
+	count_state();
+	if (track()) {
+		blend_source = source;
+		blend_dest = dest;
+		blend_known = true;
+	}
+	GL_CALL(glBlendFunc(source, dest));
+}
+
+//The blend mode last set through GpuBlend.
+void GpuBlendGet(GLenum* source, GLenum* dest)
+{
+#ifndef WORLDGEN_HEADLESS
+	if (!blend_known && live()) {
+		GLint     s, d;
+
+		glGetIntegerv(GL_BLEND_SRC, &s);
+		glGetIntegerv(GL_BLEND_DST, &d);
+		blend_source = s;
+		blend_dest = d;
+	}
+#endif
+	blend_known = true;
+	*source = blend_source;
+	*dest = blend_dest;
+}
+
+void GpuColorMask(bool r, bool g, bool b, bool a)
+{
+	count_state();
+	GL_CALL(glColorMask(r, g, b, a));
+}
+
+void GpuDepthFunc(GLenum func)
+{
+	count_state();
+	GL_CALL(glDepthFunc(func));
+}
+
+void GpuDepthMask(bool write)
+{
+	count_state();
+	GL_CALL(glDepthMask(write));
+}
+
+void GpuDisable(GLenum capability)
+{
+	count_state();
+	if (capability == GL_TEXTURE_2D && track()) {
+		textured = false;
+		textured_known = true;
+	}
+	GL_CALL(glDisable(capability));
+}
+
+void GpuEnable(GLenum capability)
+{
+	count_state();
+	if (capability == GL_TEXTURE_2D && track()) {
+		textured = true;
+		textured_known = true;
+	}
+	GL_CALL(glEnable(capability));
+}
+
+void GpuProgram(unsigned program)
+{
+	count_state();
+	GL_CALL(glUseProgramObjectARB(program));
+}
+
+void GpuStencilFunc(GLenum func, int ref, unsigned mask)
+{
+	count_state();
+	GL_CALL(glStencilFunc(func, ref, mask));
+}
+
+void GpuStencilMask(unsigned mask)
+{
+	count_state();
+	GL_CALL(glStencilMask(mask));
+}
+
+void GpuStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
+{
+	count_state();
+	GL_CALL(glStencilOp(fail, zfail, zpass));
+}
+
+void GpuTexture(unsigned id)
+{
+	count_state();
+	if (track()) {
+		texture = id;
+		texture_known = true;
+	}
+	GL_CALL(glBindTexture(GL_TEXTURE_2D, id));
+}
+
+//Saving attributes changes nothing. Restoring them is one state change,
+//and can put back anything we were keeping track of.
+void GpuPushAttrib(unsigned mask)
+{
+	GL_CALL(glPushAttrib(mask));
+}
+
+void GpuPopAttrib()
+{
+	count_state();
+	GL_CALL(glPopAttrib());
+	if (track())
+		GpuForget();
+}
+
+/*-----------------------------------------------------------------------------
+Reading back state
+-----------------------------------------------------------------------------*/
+
+//The color last set, which is what GL_CURRENT_COLOR would give. Drawing
+//with a color array leaves the GL color undefined, so after that this is
+//the color to put back.
+GLrgba GpuColorGet()
+{
+#ifndef WORLDGEN_HEADLESS
+	if (!color_known && live())
+		glGetFloatv(GL_CURRENT_COLOR, &color.red);
+#endif
+	color_known = true;
+	return color;
+}
+
+//The texture last bound.
+unsigned GpuTextureGet()
+{
+#ifndef WORLDGEN_HEADLESS
+	if (!texture_known && live()) {
+		GLint     id;
+
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &id);
+		texture = id;
+	}
+#endif
+	texture_known = true;
+	return texture;
+}
+
+//Whether GL_TEXTURE_2D is enabled.
+bool GpuTextured()
+{
+#ifndef WORLDGEN_HEADLESS
+	if (!textured_known && live())
+		textured = glIsEnabled(GL_TEXTURE_2D) != 0;
+#endif
+	textured_known = true;
+	return textured;
+}
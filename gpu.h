@@ -0,0 +1,80 @@
+#ifndef GPU_H
+#define GPU_H
+
+#ifdef WORLDGEN_HEADLESS
+//There are no GL headers in the headless build, where the Gpu layer only
+//counts. It still needs these names.
+typedef unsigned int  GLenum;
+#define GL_SRC_ALPHA            0x0302
+#define GL_ONE_MINUS_SRC_ALPHA  0x0303
+#define GL_TEXTURE_2D           0x0DE1
+#endif
+
+//Which implementation the drawing commands go to.
+enum GpuBackend
+{
+	GPU_BACKEND_GL,     //Pass everything on to OpenGL.
+	GPU_BACKEND_NULL,   //Count everything, draw nothing.
+};
+
+//What got sent to the GPU during one named part of the frame.
+struct GpuStats
+{
+	const char*   pass;
+	int           draws;
+	int           states;
+	int           vertices;
+};
+
+GpuBackend    GpuBackendGet();
+void          GpuBackendSet(GpuBackend backend);
+void          GpuForget();
+void          GpuFrame();
+bool          GpuHandleCommand(const vector<string> &words);
+void          GpuPass(const char* name);
+const vector<GpuStats>& GpuStatsLast();
+
+//Drawing. Each Begin / End block, list, or array counts as one draw.
+void          GpuBegin(GLenum mode);
+void          GpuEnd();
+void          GpuNewList(unsigned list);
+void          GpuEndList();
+void          GpuCallList(unsigned list);
+void          GpuCallLists(int count, GLenum type, const void* lists);
+void          GpuDrawArrays(GLenum mode, int first, int count);
+void          GpuDrawElements(GLenum mode, int count, GLenum type, const void* indices);
+void          GpuColor3f(float r, float g, float b);
+void          GpuColor3fv(const float* c);
+void          GpuColor4f(float r, float g, float b, float a);
+void          GpuColor4fv(const float* c);
+void          GpuTexCoord2f(float u, float v);
+void          GpuTexCoord2fv(const float* uv);
+void          GpuVertex2d(double x, double y);
+void          GpuVertex2f(float x, float y);
+void          GpuVertex2fv(const float* v);
+void          GpuVertex2i(int x, int y);
+void          GpuVertex3f(float x, float y, float z);
+void          GpuVertex3fv(const float* v);
+
+//State changes.
+void          GpuBlend(GLenum source, GLenum dest);
+void          GpuBlendGet(GLenum* source, GLenum* dest);
+void          GpuColorMask(bool r, bool g, bool b, bool a);
+void          GpuDepthFunc(GLenum func);
+void          GpuDepthMask(bool write);
+void          GpuDisable(GLenum capability);
+void          GpuEnable(GLenum capability);
+void          GpuPopAttrib();
+void          GpuProgram(unsigned program);
+void          GpuPushAttrib(unsigned mask);
+void          GpuStencilFunc(GLenum func, int ref, unsigned mask);
+void          GpuStencilMask(unsigned mask);
+void          GpuStencilOp(GLenum fail, GLenum zfail, GLenum zpass);
+void          GpuTexture(unsigned id);
+
+//The state last set above, read back without asking the driver.
+GLrgba        GpuColorGet();
+unsigned      GpuTextureGet();
+bool          GpuTextured();
+
+#endif // GPU_H
@@ -0,0 +1,433 @@
+/*-----------------------------------------------------------------------------
+
+  Gpu_test.cpp
+
+  Command line test for the draw and state counts the Gpu layer keeps. The
+  headless build of gpu.cpp has no OpenGL, only the null backend, so this
+  runs anywhere. It draws one frame counted by hand, then sends the layer
+  random frames of commands while keeping its own tally, and checks that
+  every pass of every frame comes out the same.
+
+  Commands sent while a list is being built aren't counted, since nothing
+  is drawn until the list is called.
+
+  It also checks that the blend, color and texture the layer reports are the
+  ones last set outside of a list, since the interface batch reads them back
+  instead of asking OpenGL.
+
+  usage: gpu_test [frames] [seed]
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include <stdarg.h>
+
+#include "gpu.h"
+#include "random.h"
+
+//Stand-ins for the GL names used below. The null backend never looks at them.
+#define GL_ONE                1
+#define GL_QUADS              0x0007
+#define GL_TRIANGLES          0x0004
+#define GL_UNSIGNED_BYTE      0x1401
+#define GL_UNSIGNED_INT       0x1405
+#define GL_BLEND              0x0BE2
+#define GL_DEPTH_TEST         0x0B71
+#define GL_EQUAL              0x0202
+#define GL_KEEP               0x1E00
+#define GL_CURRENT_BIT        0x00000001
+
+#define DEFAULT_FRAMES        2000
+#define STATE_CHANGES         100         //State changes per frame in the readback test.
+#define MAX_COMMANDS          200         //Most commands in one random frame.
+#define MAX_VERTS             64          //Most vertices in one Begin / End block.
+#define MAX_REPORTS           10
+
+//What the layer should report back after a run of state changes.
+struct GpuState
+{
+	GLenum        src, dst;
+	GLrgba        color;
+	unsigned      texture;
+	bool          textured;
+};
+
+enum
+{
+	SET_BLEND,
+	SET_COLOR3,
+	SET_COLOR4,
+	SET_TEXTURE,
+	SET_TEXTURED,
+	SET_OTHER,
+	SET_LIST,
+	SET_CALL,
+	SET_ATTRIB,
+	SET_COUNT
+};
+
+enum
+{
+	CMD_PASS,
+	CMD_BEGIN,
+	CMD_COLOR,
+	CMD_STATE,
+	CMD_ARRAYS,
+	CMD_ELEMENTS,
+	CMD_LIST,
+	CMD_LISTS,
+	CMD_BUILD_LIST,
+	CMD_COUNT
+};
+
+static const char*            pass_name[] = { "Sky", "Zone", "Robots", "Fx", "Hud" };
+
+#define PASS_NAMES            (sizeof (pass_name) / sizeof (const char*))
+
+static int                    failures;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static void fail(const char* message, ...)
+{
+	va_list   args;
+
+	failures++;
+	if (failures > MAX_REPORTS)
+		return;
+	va_start(args, message);
+	printf("  FAIL: ");
+	vprintf(message, args);
+	printf("\n");
+	va_end(args);
+}
+
+//The pass that commands are counted against, starting one if there isn't one yet.
+static GpuStats* tally(vector<GpuStats>& expect)
+{
+	if (expect.empty()) {
+		GpuStats    s;
+
+		s.pass = "Frame";
+		s.draws = s.states = s.vertices = 0;
+		expect.push_back(s);
+	}
+	return &expect.back();
+}
+
+static void check_frame(int frame, const vector<GpuStats>& expect)
+{
+	const vector<GpuStats>&   got = GpuStatsLast();
+
+	if (got.size() != expect.size()) {
+		fail("Frame %d has %d passes, but %d were drawn.", frame, (int)got.size(), (int)expect.size());
+		return;
+	}
+	for (unsigned i = 0; i < got.size(); i++) {
+		if (strcmp(got[i].pass, expect[i].pass))
+			fail("Frame %d pass %d is called %s, not %s.", frame, i, got[i].pass, expect[i].pass);
+		if (got[i].draws != expect[i].draws || got[i].states != expect[i].states || got[i].vertices != expect[i].vertices)
+			fail("Frame %d pass %s counted %d draws, %d states and %d vertices, not %d, %d and %d.", frame, expect[i].pass, got[i].draws, got[i].states, got[i].vertices, expect[i].draws, expect[i].states, expect[i].vertices);
+	}
+}
+
+//One random state change. Returns how many it sent.
+static int random_state(RandomStream& random)
+{
+	switch (random.Val(10)) {
+	case 0: GpuBlend(GL_ONE, GL_ONE); break;
+	case 1: GpuEnable(GL_BLEND); break;
+	case 2: GpuDisable(GL_DEPTH_TEST); break;
+	case 3: GpuTexture(random.Val(8)); break;
+	case 4: GpuDepthMask(random.Roll(2)); break;
+	case 5: GpuDepthFunc(GL_EQUAL); break;
+	case 6: GpuColorMask(true, true, true, random.Roll(2)); break;
+	case 7: GpuProgram(random.Val(3)); break;
+	case 8: GpuStencilFunc(GL_EQUAL, 1, 0xFF); break;
+	default: GpuStencilOp(GL_KEEP, GL_KEEP, GL_KEEP); break;
+	}
+	return 1;
+}
+
+//A Begin / End block, with colors and texture coordinates on the vertices.
+//Returns how many vertices it sent.
+static int random_block(RandomStream& random)
+{
+	int     verts = random.Val(MAX_VERTS);
+
+	GpuBegin(random.Roll(2) ? GL_QUADS : GL_TRIANGLES);
+	for (int v = 0; v < verts; v++) {
+		GpuColor4f(1, 1, 1, random.Float());
+		GpuTexCoord2f(random.Float(), random.Float());
+		switch (random.Val(6)) {
+		case 0: GpuVertex2f(random.Float(), random.Float()); break;
+		case 1: GpuVertex2i(v, v); break;
+		case 2: GpuVertex2d(v, v); break;
+		case 3: GpuVertex3f(random.Float(), random.Float(), 0); break;
+		default: {
+			float   xyz[3] = { random.Float(), random.Float(), 0 };
+
+			if (random.Roll(2))
+				GpuVertex2fv(xyz);
+			else
+				GpuVertex3fv(xyz);
+			}
+		}
+	}
+	GpuEnd();
+	return verts;
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//A small frame, counted by hand.
+static void test_known()
+{
+	vector<GpuStats>  expect;
+	GpuStats          s;
+	unsigned char     letters[3] = { 'a', 'b', 'c' };
+	GLenum            src, dst;
+
+	GpuFrame();
+	//Before any pass, things are counted as part of the frame.
+	GpuEnable(GL_TEXTURE_2D);
+	GpuPass("Zone");
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuTexture(3);
+	GpuColor3f(1, 0, 0);
+	GpuBegin(GL_QUADS);
+	GpuColor3f(0, 1, 0);
+	GpuVertex2i(0, 0); GpuVertex2i(1, 0); GpuVertex2i(1, 1); GpuVertex2i(0, 1);
+	GpuEnd();
+	GpuDrawArrays(GL_TRIANGLES, 0, 6);
+	GpuPass("Hud");
+	GpuNewList(1);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBegin(GL_QUADS);
+	GpuVertex2i(0, 0); GpuVertex2i(1, 0); GpuVertex2i(1, 1); GpuVertex2i(0, 1);
+	GpuEnd();
+	GpuEndList();
+	GpuCallList(1);
+	GpuCallLists(3, GL_UNSIGNED_BYTE, letters);
+	GpuDrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_INT, NULL);
+	GpuFrame();
+	s.pass = "Frame"; s.draws = 0; s.states = 1; s.vertices = 0;
+	expect.push_back(s);
+	s.pass = "Zone"; s.draws = 2; s.states = 3; s.vertices = 10;
+	expect.push_back(s);
+	s.pass = "Hud"; s.draws = 5; s.states = 0; s.vertices = 12;
+	expect.push_back(s);
+	check_frame(0, expect);
+	if (GpuBackendGet() != GPU_BACKEND_NULL)
+		fail("The headless build should only have the null backend.");
+	//The blend set inside the list doesn't happen until it's called.
+	GpuBlendGet(&src, &dst);
+	if (src != GL_ONE || dst != GL_ONE)
+		fail("The last blend set was (%d, %d), but GpuBlendGet says (%d, %d).", GL_ONE, GL_ONE, src, dst);
+}
+
+static bool same_color(GLrgba a, GLrgba b)
+{
+	return a.red == b.red && a.green == b.green && a.blue == b.blue && a.alpha == b.alpha;
+}
+
+//Random state changes, checking after each one that the layer reports
+//the last of each thing set. Nothing set while building a list counts, and
+//with no OpenGL to ask, calling a list or popping attributes changes nothing.
+static void test_state(RandomStream& random, int frame)
+{
+	GpuState    expect;
+	GLenum      src, dst;
+	GLrgba      c;
+
+	GpuFrame();
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuColor3f(1, 1, 1);
+	GpuTexture(0);
+	GpuDisable(GL_TEXTURE_2D);
+	expect.src = GL_SRC_ALPHA;
+	expect.dst = GL_ONE_MINUS_SRC_ALPHA;
+	expect.color = GLrgba(1, 1, 1);
+	expect.texture = 0;
+	expect.textured = false;
+	for (int i = 0; i < STATE_CHANGES; i++) {
+		switch (random.Val(SET_COUNT)) {
+		case SET_BLEND:
+			expect.src = random.Roll(2) ? GL_ONE : GL_SRC_ALPHA;
+			expect.dst = random.Roll(2) ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA;
+			GpuBlend(expect.src, expect.dst);
+			break;
+		case SET_COLOR3:
+			expect.color = GLrgba(random.Float(), random.Float(), random.Float());
+			if (random.Roll(2))
+				GpuColor3f(expect.color.red, expect.color.green, expect.color.blue);
+			else
+				GpuColor3fv(&expect.color.red);
+			break;
+		case SET_COLOR4:
+			expect.color = GLrgba(random.Float(), random.Float(), random.Float(), random.Float());
+			if (random.Roll(2))
+				GpuColor4f(expect.color.red, expect.color.green, expect.color.blue, expect.color.alpha);
+			else
+				GpuColor4fv(&expect.color.red);
+			break;
+		case SET_TEXTURE:
+			expect.texture = random.Val(8);
+			GpuTexture(expect.texture);
+			break;
+		case SET_TEXTURED:
+			expect.textured = random.Roll(2);
+			if (expect.textured)
+				GpuEnable(GL_TEXTURE_2D);
+			else
+				GpuDisable(GL_TEXTURE_2D);
+			break;
+		case SET_OTHER:
+			if (random.Roll(2))
+				GpuEnable(GL_BLEND);
+			else
+				GpuDisable(GL_DEPTH_TEST);
+			break;
+		case SET_LIST:
+			GpuNewList(random.Val(100));
+			GpuBlend(GL_ONE, GL_ONE);
+			GpuColor4f(random.Float(), random.Float(), random.Float(), random.Float());
+			GpuTexture(100 + random.Val(8));
+			GpuEnable(GL_TEXTURE_2D);
+			GpuDisable(GL_TEXTURE_2D);
+			random_block(random);
+			GpuEndList();
+			break;
+		case SET_CALL:
+			GpuCallList(random.Val(100));
+			break;
+		case SET_ATTRIB:
+			GpuPushAttrib(GL_CURRENT_BIT);
+			GpuPopAttrib();
+			break;
+		}
+		GpuBlendGet(&src, &dst);
+		if (src != expect.src || dst != expect.dst)
+			fail("Frame %d change %d: blend is (%d, %d), not (%d, %d).", frame, i, src, dst, expect.src, expect.dst);
+		c = GpuColorGet();
+		if (!same_color(c, expect.color))
+			fail("Frame %d change %d: color is (%g, %g, %g, %g), not (%g, %g, %g, %g).", frame, i, c.red, c.green, c.blue, c.alpha, expect.color.red, expect.color.green, expect.color.blue, expect.color.alpha);
+		if (GpuTextureGet() != expect.texture)
+			fail("Frame %d change %d: texture is %d, not %d.", frame, i, GpuTextureGet(), expect.texture);
+		if (GpuTextured() != expect.textured)
+			fail("Frame %d change %d: texturing is %s, not %s.", frame, i, GpuTextured() ? "on" : "off", expect.textured ? "on" : "off");
+	}
+	GpuFrame();
+}
+
+static void test_frame(RandomStream& random, int frame, int* commands)
+{
+	vector<GpuStats>  expect;
+	unsigned char     letters[8];
+	int               count;
+
+	GpuFrame();
+	count = random.Val(MAX_COMMANDS);
+	for (int c = 0; c < count; c++) {
+		switch (random.Val(CMD_COUNT)) {
+		case CMD_PASS: {
+			GpuStats    s;
+
+			s.pass = pass_name[random.Val(PASS_NAMES)];
+			s.draws = s.states = s.vertices = 0;
+			GpuPass(s.pass);
+			expect.push_back(s);
+			break;
+			}
+		case CMD_BEGIN:
+			tally(expect)->vertices += random_block(random);
+			tally(expect)->draws++;
+			break;
+		case CMD_COLOR:
+			GpuColor3f(random.Float(), random.Float(), random.Float());
+			tally(expect)->states++;
+			break;
+		case CMD_STATE:
+			tally(expect)->states += random_state(random);
+			break;
+		case CMD_ARRAYS: {
+			int     verts = random.Val(1000);
+
+			GpuDrawArrays(GL_QUADS, 0, verts);
+			tally(expect)->draws++;
+			tally(expect)->vertices += verts;
+			break;
+			}
+		case CMD_ELEMENTS: {
+			int     verts = random.Val(1000);
+
+			GpuDrawElements(GL_TRIANGLES, verts, GL_UNSIGNED_INT, NULL);
+			tally(expect)->draws++;
+			tally(expect)->vertices += verts;
+			break;
+			}
+		case CMD_LIST:
+			GpuCallList(random.Val(100));
+			tally(expect)->draws++;
+			break;
+		case CMD_LISTS: {
+			int     n = random.Val(sizeof (letters));
+
+			GpuCallLists(n, GL_UNSIGNED_BYTE, letters);
+			tally(expect)->draws += n;
+			break;
+			}
+		case CMD_BUILD_LIST:
+			//None of this counts until the list is called.
+			GpuNewList(random.Val(100));
+			for (int i = random.Val(8); i > 0; i--) {
+				if (random.Roll(2))
+					random_state(random);
+				else
+					random_block(random);
+			}
+			GpuEndList();
+			break;
+		}
+		(*commands)++;
+	}
+	GpuFrame();
+	check_frame(frame, expect);
+}
+
+int main(int argc, char** argv)
+{
+	int             frames;
+	unsigned long   seed;
+	int             commands;
+
+	frames = argc > 1 ? atoi(argv[1]) : DEFAULT_FRAMES;
+	seed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+	if (frames < 1) {
+		printf("usage: %s [frames] [seed]\n", argv[0]);
+		return 1;
+	}
+	test_known();
+	commands = 0;
+	for (int f = 1; f <= frames; f++) {
+		RandomStream  random = RandomStream(seed).Split(f);
+
+		test_frame(random, f, &commands);
+		test_state(random, f);
+	}
+	printf("Gpu: one frame counted by hand, then %d random frames of %d commands.\n", frames, commands);
+	printf("Gpu: %d state changes read back.\n", frames * STATE_CHANGES);
+	if (failures) {
+		printf("%d failures.\n", failures);
+		return 1;
+	}
+	printf("All passed.\n");
+	return 0;
+}
@@ -13,9 +13,11 @@
 #include "avatar.h"
 #include "entity.h"
 #include "env.h"
+#include "gpu.h"
 #include "page.h"
 #include "particle.h"
 #include "system.h"
+#include "watch.h"
 #include "world.h"
 
 #define CURSOR_SIZE           0.15f
@@ -23,12 +25,8 @@
 static vector<SpriteBox>  sprites;
 static string             message;
 static bool               have_message;
-static int                gl_list_hud;
 static int                hud_height;
-static int                xp_flash_end;
-static bool               xp_flashing;
 static bool               flash_on;
-static GLcoord2           last_screen_size;
 static float              flash_fade;
 static GLrgba             flash_color;
 static int                fps_next;
@@ -56,7 +54,7 @@ static void do_stats()
 	pg.y = (int)position.y / PAGE_SIZE;
 	InterfacePrint("Position: %1.1f %1.1f", position.x, position.y);
 	InterfacePrint("Page: %d %d", pg.x, pg.y);
-	InterfacePrint("TMX: %s", WorldPage(pg)->Pattern());
+	InterfacePrint("TMX: %s", WorldPage(pg) ? WorldPage(pg)->Pattern() : "none");
 	InterfacePrint("Checkpoint: Map %d Zone %d Room %d", WorldPlayerLocation().x, WorldPlayerLocation().y, WorldRoomFromPosition(position));
 	InterfacePrint("LocationID %d", WorldLocationId());
 	InterfacePrint("Zone list: [complete] {current} (undiscovered)");
@@ -85,11 +83,11 @@ static void do_fps(const Font* f, GLcoord2 pos)
 	if (!EnvValueb(ENV_FPS))
 		return;
 	if (fps_count_last < 50)
-		glColor3f(1, 0, 0);
+		GpuColor3f(1, 0, 0);
 	else if (fps_count_last < 60)
-		glColor3f(1, 1, 0);
+		GpuColor3f(1, 1, 0);
 	else
-		glColor3f(0, 1, 0);
+		GpuColor3f(0, 1, 0);
 	f->Print(pos, StringSprintf("FPS: %d", fps_count_last).c_str());
 }
 
@@ -100,22 +98,23 @@ static void do_flash(GLcoord2 size)
 	float				fade;
 
 	uv = SpriteMapLookup(SPRITE_FLASH);
-	glBlendFunc(GL_ONE, GL_ONE);
+	GpuTexture(SpriteMapTexture());
+	GpuBlend(GL_ONE, GL_ONE);
 	fade = clamp (flash_fade * 2.0f, 0.0f, 1.0f);
 	color = flash_color * fade;
 	flash_fade -= 0.01f;
-	glColor3fv(&color.red);
-	glBegin(GL_QUADS);
-	glTexCoord2fv(&uv->uv[0].x);   glVertex2i(0, 0);
-	glTexCoord2fv(&uv->uv[1].x);   glVertex2i(size.x, 0);
-	glTexCoord2fv(&uv->uv[2].x);   glVertex2i(size.x, size.y);
-	glTexCoord2fv(&uv->uv[3].x);   glVertex2i(0, size.y);
-
-	glTexCoord2fv (&uv->uv[0].x);   glVertex2i (0, 0);
-	glTexCoord2fv (&uv->uv[1].x);   glVertex2i (size.x, 0);
-	glTexCoord2fv (&uv->uv[2].x);   glVertex2i (size.x, size.y);
-	glTexCoord2fv (&uv->uv[3].x);   glVertex2i (0, size.y);
-	glEnd ();
+	GpuColor3fv(&color.red);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2fv(&uv->uv[0].x);   GpuVertex2i(0, 0);
+	GpuTexCoord2fv(&uv->uv[1].x);   GpuVertex2i(size.x, 0);
+	GpuTexCoord2fv(&uv->uv[2].x);   GpuVertex2i(size.x, size.y);
+	GpuTexCoord2fv(&uv->uv[3].x);   GpuVertex2i(0, size.y);
+
+	GpuTexCoord2fv (&uv->uv[0].x);   GpuVertex2i (0, 0);
+	GpuTexCoord2fv (&uv->uv[1].x);   GpuVertex2i (size.x, 0);
+	GpuTexCoord2fv (&uv->uv[2].x);   GpuVertex2i (size.x, size.y);
+	GpuTexCoord2fv (&uv->uv[3].x);   GpuVertex2i (0, size.y);
+	GpuEnd ();
 }
 
 /*-----------------------------------------------------------------------------
@@ -153,10 +152,17 @@ void  HudToggleVisible()
 	HudVisible(!hud_visible);
 }
 
+static void layout_changed(string filename)
+{
+	hud_objects = pyrodactyl::HUD();
+	hud_objects.Load(filename);
+	hud_objects.SetUI();
+}
+
 void HudInit()
 {
-	gl_list_hud = glGenLists(1);
 	hud_objects.Load("core/data/ui_hud.xml");
+	WatchFile("core/data/ui_hud.xml", layout_changed);
 	HudVisible(true);
 }
 
@@ -183,19 +189,19 @@ void HudRender()
 	if (!GameActive())
 		return;
 	aim = PlayerAim();
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glDepthMask(false);
-	glBlendFunc(GL_ONE, GL_ONE);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
 	for (unsigned i = 0; i < sprites.size(); i++)
 		sprites[i].Render();
 	//render aiming cursor
 	if (!PlayerIgnore () && hud_visible)
 		RenderQuad(aim, SPRITE_TARGET, GLrgba(1, 1, 1), Env().cursor_size, 0, 0, false);
 	RenderQuads();
-	glDepthMask(true);
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_STENCIL_TEST);
+	GpuDepthMask(true);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuEnable(GL_STENCIL_TEST);
 }
 
 void HudRender2D()
@@ -211,37 +217,22 @@ void HudRender2D()
 	GLcoord2          bar_corner;
 	int               bar_top;
 	const Font*       font;
-	bool              recompile;
 
 	if (!GameActive())
 		return;
-	recompile = false;
-	if (GameTick() < xp_flash_end)
-		xp_flashing = true;
-	else if (xp_flashing) {
-		xp_flashing = false;
-		recompile = true;
-	}
 	if (SystemTick() > fps_next) {
 		fps_next = SystemTick() + 1000;
 		fps_count_last = fps_count;
 		fps_count = 0;
-		recompile = true;
 	}
 	font = InterfaceFont(FONT_HUD);
 	bar_top = font->Height() + 4;
 	size = RenderViewportSize();
 	if (flash_fade > 0)
 		do_flash(size);
-	if (size != last_screen_size)
-		recompile = true;
-	last_screen_size = size;
-	if (recompile) {
-		glNewList(gl_list_hud, GL_COMPILE);
-		do_fps(font, GLcoord2(0, size.y - font->Height()));
-		glEndList();
-	}
-	glCallList(gl_list_hud);
+	//The counter goes in with the rest of the interface text, so there's
+	//nothing to gain from keeping it in a display list.
+	do_fps(font, GLcoord2(0, size.y - font->Height()));
 
 	hud_objects.Draw();
 
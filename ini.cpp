@@ -30,11 +30,11 @@ struct IniFile
 
 int iniFile::SectionKey(int sect, string key)
 {
-	for (unsigned i = 0; i < _section[sect].keyval.size(); i++) {
-		if (key == _section[sect].keyval[i].key)
-			return i;//_section[sect].keyval[i].line_number;
-	}
-	return -1;
+	unordered_map<string, int>::iterator  i = _section[sect].index.find(key);
+
+	if (i == _section[sect].index.end())
+		return -1;
+	return i->second;
 }
 
 void iniFile::StringSet(string section, string key, string value)
@@ -47,21 +47,16 @@ void iniFile::StringSet(string section, string key, string value)
 	key = StringToLower(key);
 	sect = SectionGet(section);
 	key_num = SectionKey(sect, key);
-	if (key_num >= 0) { //This key/value pair exists in the file and must be replaced.
-		line = _section[sect].keyval[key_num].line_number;
-		for (unsigned i = 0; i < _file_lines.size(); i++) {
-			if ((int)i == line) {
-				out += _section[sect].keyval[key_num].original_key;
-				out += "=";
-				out += value;
-			}
-			else {
-				out += _file_lines[i];
-			}
-			out += "\n";
-		}
+	if (key_num >= 0) { //This key/value pair exists in the file and only that line changes.
+		iniValue&   kv = _section[sect].keyval[key_num];
+
+		if (kv.value == value)
+			return;
+		kv.value = value;
+		_file_lines[kv.line_number] = kv.original_key + "=" + value;
 	}
 	else { //Key/value pair is new to file and should be inserted.
+		//This shifts every line below it, so rebuild the text and parse it again.
 		line = _section[sect].line_number + 1;
 		for (unsigned i = 0; i <= _file_lines.size(); i++) {
 			if ((int)i == line) {
@@ -75,9 +70,26 @@ void iniFile::StringSet(string section, string key, string value)
 				out += "\n";
 			}
 		}
+		Parse(out);
+	}
+	_dirty = true;
+	if (!_deferred)
+		Save();
+}
+
+void iniFile::Save()
+{
+	string  out;
+
+	if (!_dirty)
+		return;
+	for (unsigned i = 0; i < _file_lines.size(); i++) {
+		out += _file_lines[i];
+		out += "\n";
 	}
 	FileSave(_filename, out.c_str(), out.size());
-	ReloadFile();
+	_original = out;
+	_dirty = false;
 }
 
 void iniFile::IntSet(string section, string key, int value)
@@ -119,13 +131,13 @@ GLvector iniFile::VectorGet(string section, string entry)
 string iniFile::StringGet(string section, string entry)
 {
 	int   sect;
+	int   key_num;
 
 	sect = SectionGet(section);
-	for (unsigned i = 0; i < _section[sect].keyval.size(); i++) {
-		if (!_stricmp (_section[sect].keyval[i].key.c_str (), entry.c_str ()))
-			return _section[sect].keyval[i].value;
-	}
-	return "";
+	key_num = SectionKey(sect, StringToLower(entry));
+	if (key_num < 0)
+		return "";
+	return _section[sect].keyval[key_num].value;
 }
 
 unsigned iniFile::SectionKeys(string section)
@@ -185,16 +197,15 @@ int iniFile::SectionGet(string section_in, int line_number)
     if (!stricmp (_section[_last_section_lookup].name.c_str (), section_in.c_str ()))
       return _last_section_lookup;
   }
-  for (unsigned i = 0; i < _section.size (); i++) {
-    if (!stricmp (_section[i].name.c_str (), section_in.c_str ())) {
-      _last_section_lookup = i;
-      return i;
-    }
-  }
 
 	iniSection  new_section;
 
   new_section.name = StringToLower (section_in);
+  unordered_map<string, int>::iterator  i = _section_index.find (new_section.name);
+  if (i != _section_index.end ()) {
+    _last_section_lookup = i->second;
+    return i->second;
+  }
 	new_section.original_name = section_in;
 
 	if (line_number == -1) {
@@ -206,10 +217,11 @@ int iniFile::SectionGet(string section_in, int line_number)
 		new_section.line_number = line_number;
 	}
 	_section.push_back(new_section);
+	_section_index[new_section.name] = _section.size() - 1;
 	return _section.size() - 1;
 }
 
-void iniFile::ReloadFile()
+void iniFile::Parse(string text)
 {
 	string          contents;
 	int             equals;
@@ -219,12 +231,14 @@ void iniFile::ReloadFile()
 	iniSection      default_section;
 
 	_section.clear();
+	_section_index.clear();
   _last_section_lookup = 0;
-	_original = FileContents(_filename);
+	_original = text;
 	_file_lines = StringSplit(_original, "\r\n");
 	//A default section to catch any entries not under a [Heading]
 	default_section.line_number = 0;
 	_section.push_back(default_section);
+	_section_index[default_section.name] = 0;
 	current_section = 0;
 	for (unsigned line = 0; line < _file_lines.size(); line++) {
 		contents = _file_lines[line];
@@ -248,11 +262,20 @@ void iniFile::ReloadFile()
 			new_value.value = contents.substr(equals + 1);
 			StringTrim(new_value.value);
 			new_value.line_number = line;
+			//Like a linear scan, the first occurrence of a duplicate key wins.
+			if (!_section[current_section].index.count(new_value.key))
+				_section[current_section].index[new_value.key] = _section[current_section].keyval.size();
 			_section[current_section].keyval.push_back(new_value);
 		}
 	}
 }
 
+void iniFile::ReloadFile()
+{
+	Parse(FileContents(_filename));
+	_dirty = false;
+}
+
 void iniFile::Open(string filename)
 {
 	_filename = filename;
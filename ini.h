@@ -1,6 +1,8 @@
 #ifndef INI_H
 #define INI_H
 
+#include <unordered_map>
+
 struct iniValue
 {
 	int                 line_number;
@@ -15,6 +17,7 @@ struct iniSection
 	string              name;
 	string              original_name;
 	vector<iniValue>    keyval;
+	unordered_map<string, int> index; //lowercase key -> keyval
 };
 
 class iniFile
@@ -23,12 +26,17 @@ class iniFile
 	string              _original;
 	vector<iniSection>  _section;
 	vector<string>      _file_lines;
+	unordered_map<string, int> _section_index;
   int                 _last_section_lookup;
+	bool                _dirty;
+	bool                _deferred;
 
 	int                 SectionGet(string section, int line_number = -1);
 	int                 SectionKey(int sect, string key);
+	void                Parse(string contents);
 	void                ReloadFile();
 public:
+	iniFile() { _last_section_lookup = 0; _dirty = false; _deferred = false; }
 	string              Filename() { return _filename; }
 	void                Open(string filename);
 	string              Contents() { return _original; }
@@ -49,6 +57,11 @@ public:
 	void                StringSet(string section, string entry, string value);
 	void                IntSet(string section, string entry, int value);
 	void                BoolSet(string section, string entry, bool value);
+
+	//Deferred files keep changes in memory until Save () is called.
+	void                Defer(bool deferred) { _deferred = deferred; }
+	bool                Dirty() { return _dirty; }
+	void                Save();
 };
 
 #endif // INI_H
\ No newline at end of file
@@ -19,13 +19,7 @@
 #define JOY_DEAD_ZONE				10000
 #define STICK_MAX           32768
 
-struct Control
-{
-	bool            down;
-	bool            pressed;
-	int             value;
-	float           valuef;
-};
+typedef InputControl Control;
 
 static GLcoord2   mouse;
 static Control    control[MAX_KEYS];
@@ -265,6 +259,41 @@ bool InputAnyKeyPressed()
 	return (last_pressed != 0);
 }
 
+/*-----------------------------------------------------------------------------
+Raw state access, used to record and replay input.
+-----------------------------------------------------------------------------*/
+
+InputControl InputControlGet(int id)
+{
+	return *control_from_id(id);
+}
+
+void InputControlSet(int id, InputControl c)
+{
+	*control_from_id(id) = c;
+}
+
+void InputJoystickActiveSet(bool val)
+{
+	joystick_active = val;
+}
+
+void InputLastPressedSet(int id)
+{
+	last_pressed = id;
+}
+
+//Mouse movement that has arrived but hasn't been read by InputMouseMovement () yet.
+GLcoord2 InputMousePending()
+{
+	return mouse;
+}
+
+void InputMousePendingSet(GLcoord2 delta)
+{
+	mouse = delta;
+}
+
 void InputClearState ()
 {
 	for (int i = 0; i < MAX_KEYS; i++) {
@@ -61,6 +61,15 @@ enum
 #define INPUT_MOUSE_MOVED     512
 #define MAX_KEYS              513
 
+//The complete state of one control, for saving and restoring input.
+struct InputControl
+{
+	bool            down;
+	bool            pressed;
+	int             value;
+	float           valuef;
+};
+
 void			InputClearState();
 void      InputAxisMove(int axis, int position);
 int       InputAxis(int axis);
@@ -77,6 +86,13 @@ bool      InputKeyPressed(int id);
 int       InputLastPressed();
 bool      InputAnyKeyPressed();
 
+InputControl  InputControlGet(int id);
+void          InputControlSet(int id, InputControl c);
+void          InputJoystickActiveSet(bool val);
+void          InputLastPressedSet(int id);
+GLcoord2      InputMousePending();
+void          InputMousePendingSet(GLcoord2 delta);
+
 bool      InputMouselook();
 void      InputMouselookSet(bool val);
 void      InputMouseMove(int x, int y);
@@ -12,6 +12,7 @@
 #include "master.h"
 
 #include "font.h"
+#include "gpu.h"
 #include "hud.h"
 #include "interface.h"
 #include "render.h"
@@ -49,24 +50,24 @@ void InterfaceRender2D()
 	f = InterfaceFont(FONT_FIXEDWIDTH);
 	size = RenderViewportSize();
   pos.y = size.y - print.size () * f->Height ();
-  glColor4f (0.06f, 0, 0.12f, 0.75f);
+  GpuColor4f (0.06f, 0, 0.12f, 0.75f);
   matte_size *= f->Height ();
-  glDisable (GL_TEXTURE_2D);
-  glBegin (GL_QUADS);
-  glVertex2d (0, pos.y);
-  glVertex2d (matte_size.x, pos.y);
-  glVertex2d (matte_size.x, size.y);
-  glVertex2d (0, size.y);
-  glEnd ();
+  GpuDisable (GL_TEXTURE_2D);
+  GpuBegin (GL_QUADS);
+  GpuVertex2d (0, pos.y);
+  GpuVertex2d (matte_size.x, pos.y);
+  GpuVertex2d (matte_size.x, size.y);
+  GpuVertex2d (0, size.y);
+  GpuEnd ();
   matte_size = GLcoord2 ();
-  glColor3f(1, 1, 1);
+  GpuColor3f(1, 1, 1);
   //pos.y = f->Height ();
 	for (unsigned i = 0; i < print.size(); i++) {
 		f->Print(pos, print[i].c_str());
 		pos.y += f->Height();
 	}
 	print.clear();
-  glEnable (GL_TEXTURE_2D);
+  GpuEnable (GL_TEXTURE_2D);
 }
 
 void InterfaceInit()
@@ -70,6 +70,7 @@ namespace pyrodactyl
 		return true;
 	}
 
+#ifndef WORLDGEN_HEADLESS
 	bool LoadRect(SDL_Rect &rect, rapidxml::xml_node<char> *node, const bool &echo,
 		const std::string &x_name, const std::string &y_name, const std::string &w_name, const std::string &h_name)
 	{
@@ -78,6 +79,7 @@ namespace pyrodactyl
 			return true;
 		return false;
 	}
+#endif
 
 	bool LoadColor(GLrgba &col, rapidxml::xml_node<char> *node, const bool &echo,
 		const std::string &r_name, const std::string &g_name, const std::string &b_name, const std::string &a_name)
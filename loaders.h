@@ -66,9 +66,11 @@ namespace pyrodactyl
 		return true;
 	}
 
+#ifndef WORLDGEN_HEADLESS
 	//Load Rectangle
 	bool LoadRect(SDL_Rect &rect, rapidxml::xml_node<char> *node, const bool &echo = true,
 		const std::string &x_name = "x", const std::string &y_name = "y", const std::string &w_name = "w", const std::string &h_name = "h");
+#endif
 
 	//Load Color
 	bool LoadColor(GLrgba &col, rapidxml::xml_node<char> *node, const bool &echo = true,
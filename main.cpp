@@ -28,11 +28,14 @@
 #include "player.h"
 #include "random.h"
 #include "render.h"
+#include "replay.h"
 #include "sprite.h"
+#include "stats.h"
 #include "system.h"
 #include "texture.h"
 #include "trivia.h"
 #include "visible.h"
+#include "watch.h"
 #include "world.h"
 #include "steam_data.h"
 #include "TMXMap.h"
@@ -71,6 +74,7 @@ static int              profile_test;
 static void init()
 { 
 	SystemInit();
+	WatchInit();
 	ilInit();         //Must come after system.
 	SpriteMapInit();  //Must come after iL (Image library.)
 	AudioInit();
@@ -93,6 +97,7 @@ static void init()
 	HudInit();
 	SteamAPI_Init();
 	SteamUserInit();
+	StatsInit();     //Must come after SteamUserInit.
 }
 
 static void run()
@@ -110,33 +115,48 @@ static void run()
 		AudioUpdate();
 		GameUpdate();
 		MenuUpdate();
+		ReplayTime(REPLAY_TIME_GAME);
 		PlayerUpdate();
 		HudUpdate();
 		CameraUpdate();
 		TriviaUpdate();
+		ReplayTime(REPLAY_TIME_PLAYER);
 		VisibleUpdate();
 		ParticleUpdate();
+		ReplayTime(REPLAY_TIME_PARTICLES);
 		WorldUpdate();
+		ReplayTime(REPLAY_TIME_WORLD);
 		SystemUpdate();
+		ReplayInput();
+		WatchUpdate();
 		TextureUpdate();
 		FontUpdate();
 		ConsoleUpdate();
+		ReplayTime(REPLAY_TIME_SYSTEM);
 		Render();
+		ReplayTime(REPLAY_TIME_RENDER);
 		SteamAPI_RunCallbacks();
+		StatsUpdate();
 		leftover = next_frame - SystemTick();
 		if (leftover > 0)
 			time_counter += leftover;
 
 		SystemSwapBuffers();
+		ReplayTime(REPLAY_TIME_SWAP);
 
-		if (!EnvValueb(ENV_FPSUNCAP) && fps.Ticks() < UPDATE_INTERVAL)
+		//Replays run as fast as they can, since they're used for benchmarking.
+		if (!EnvValueb(ENV_FPSUNCAP) && !ReplayPlaying() && fps.Ticks() < UPDATE_INTERVAL)
 			SDL_Delay(UPDATE_INTERVAL - fps.Ticks());
 	}
 }
 
 static void term()
 {
+	ReplayStop();
+	WatchTerm();
 	GameTerm();
+	StatsTerm();
+	SystemConfigSave();
 }
 
 /*-----------------------------------------------------------------------------
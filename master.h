@@ -51,7 +51,9 @@ typedef unsigned char uchar;
 #include <direct.h>
 #include <io.h>
 #include <sys/utime.h>
+#ifndef WORLDGEN_HEADLESS
 #include <steam/steam_api.h>
+#endif
 #elif defined(__linux__) || defined(__APPLE__)
 #include <unistd.h>
 #define _stricmp strcasecmp
@@ -74,6 +76,9 @@ typedef unsigned char uchar;
 #include <math.h>
 #include <sstream>
 
+//The worldgen library is built without any of the graphics, audio or
+//platform libraries, so it can run on machines that have none of them.
+#ifndef WORLDGEN_HEADLESS
 #include <SDL.h>
 #include "glew/include/GL/glew.h"
 #if defined(__APPLE__)
@@ -86,6 +91,7 @@ typedef unsigned char uchar;
 #ifdef _WIN32
 #include "glew/include/GL/wglew.h"
 #endif
+#endif
 
 using namespace std;
 using namespace boost::filesystem;
@@ -224,6 +230,14 @@ enum PageTraverse
 	DIRECTION_UP,   //Probably not going to be used.
 };
 
+enum DoorFacing
+{
+	DOOR_UP,
+	DOOR_DOWN,
+	DOOR_RIGHT,
+	DOOR_LEFT,
+};
+
 struct PageInfo
 {
 	GLcoord2              grid;
@@ -19,6 +19,7 @@
 #include "render.h"
 #include "system.h"
 #include "hud.h"
+#include "watch.h"
 
 //For the "add to high score list"
 #include "player.h"
@@ -29,6 +30,7 @@
 #include "ui_gameover.h"
 #include "ui_store.h"
 #include "ui_hatshop.h"
+#include "LayoutCache.h"
 #include "steam_data.h"
 
 pyrodactyl::MainMenu     menu_main;
@@ -38,6 +40,7 @@ pyrodactyl::StoreMenu    menu_store;
 pyrodactyl::HatShopMenu  menu_hat;
 
 static int               current_menu;
+static bool              built[MENU_COUNT];      //Menus are only built the first time they're opened.
 /*-----------------------------------------------------------------------------
 
 -----------------------------------------------------------------------------*/
@@ -64,6 +67,54 @@ void MenuLoadLeaderboards()
 	menu_main.FindLeaderboards();
 }
 
+//Build the given menu from its layout, if that hasn't happened yet.
+static void build(int menu)
+{
+	using namespace pyrodactyl;
+
+	if (menu <= MENU_NONE || menu >= MENU_COUNT || built[menu])
+		return;
+	switch (menu)
+	{
+	case MENU_MAIN: menu_main.Init(); break;
+	case MENU_UPGRADE: menu_upgrade.Init(); break;
+	case MENU_STORE: menu_store.Init(); break;
+	case MENU_GAMEOVER: menu_gameover.Init("core/data/ui_gameover.xml"); break;
+	case MENU_WIN: menu_win.Init("core/data/ui_win.xml"); break;
+	case MENU_HAT: menu_hat.Init(); break;
+	default: break;
+	}
+	built[menu] = true;
+}
+
+//One of the menu layouts changed on disk. Start that menu over from scratch,
+//since loading a layout on top of an old one would double up the elements.
+//Menus that haven't been opened yet will pick up the new layout when they are.
+static void layout_changed(string filename)
+{
+	using namespace pyrodactyl;
+
+	LayoutForget(filename);
+	if (filename == "core/data/ui_upgrade.xml") {
+		menu_upgrade = UpgradeMenu();
+		built[MENU_UPGRADE] = false;
+	} else if (filename == "core/data/ui_gameover.xml") {
+		menu_gameover = GameOverMenu();
+		built[MENU_GAMEOVER] = false;
+	} else if (filename == "core/data/ui_win.xml") {
+		menu_win = GameOverMenu();
+		built[MENU_WIN] = false;
+	} else if (filename == "core/data/ui_store.xml") {
+		menu_store = StoreMenu();
+		built[MENU_STORE] = false;
+	} else if (filename == "core/data/ui_hat.xml") {
+		menu_hat = HatShopMenu();
+		built[MENU_HAT] = false;
+	}
+	build(current_menu);
+	MenuResize();
+}
+
 void MenuInit()
 {
 	//Pyrodactyl stuff
@@ -72,13 +123,18 @@ void MenuInit()
 		gImageManager.Init();
 		gTextManager.Init();
 		gInput.Init();
-		menu_main.Init();
-		menu_upgrade.Init();
-		menu_gameover.Init("core/data/ui_gameover.xml");
-		menu_win.Init("core/data/ui_win.xml");
-		menu_store.Init();
-		menu_hat.Init();
 	}
+	//The main menu is built right away, since it's the first thing on screen
+	//and it holds the mouse pointer and the high scores. The rest wait until
+	//they're opened, since most sessions never see half of them.
+	build(MENU_MAIN);
+	//The main menu is left out, since starting it over would lose the
+	//high scores and leaderboards it's holding.
+	WatchFile("core/data/ui_upgrade.xml", layout_changed);
+	WatchFile("core/data/ui_gameover.xml", layout_changed);
+	WatchFile("core/data/ui_win.xml", layout_changed);
+	WatchFile("core/data/ui_store.xml", layout_changed);
+	WatchFile("core/data/ui_hat.xml", layout_changed);
 	current_menu = MENU_NONE;
 }
 
@@ -100,6 +156,7 @@ void MenuReset()
 //IF YOU WANT TO RESIZE OR REPOSITION WINDOWS, THIS IS THE FUNCTION
 void MenuOpen(int menu_num)
 {
+	build(menu_num);
 	current_menu = menu_num;
 	InputClearState();
 	MenuResize();
@@ -12,7 +12,9 @@
 
 #include "master.h"
 #include "noise.h"
+#ifndef WORLDGEN_HEADLESS
 #include "texture.h"
+#endif
 
 #define SQRT2             1.41421356
 #define USE_BILINEAR      1
@@ -145,32 +147,39 @@ void NoiseSeed(int seed)
 	shift.z %= 16384;
 }
 
-void NoiseInit()
+//Build the noise table from the red channel of an RGBA image.
+void NoiseLoad(const unsigned char* pixels, GLcoord2 image_size)
 {
-	GLcoord2        image_size;
 	int             index;
-	Texture*        img;
-	const unsigned char*  temp;
 
-	img = new Texture("noise3.png");
-	image_size = img->Size();
-	//temp = (unsigned char*)TextureData ("noise3.png", &image_size);
-	temp = (const unsigned char*)img->Data();
 	size_val = MIN(image_size.x, image_size.y);
+	delete[] buffer;
 	buffer = new unsigned char[size_val * size_val];
 	index = 0;
 	for (int x = 0; x < size_val; x++) {
 		for (int y = 0; y < size_val; y++) {
-			buffer[index] = temp[(x + y * image_size.x) * 4];
+			buffer[index] = pixels[(x + y * image_size.x) * 4];
 			index++;
 		}
 	}
+	NoiseSeed(1);
+}
+
+#ifndef WORLDGEN_HEADLESS
+
+void NoiseInit()
+{
+	Texture*        img;
+
+	img = new Texture("noise3.png");
+	NoiseLoad((const unsigned char*)img->Data(), img->Size());
 	img->Destroy();
 	delete img;
 	Console("NoiseInit: %dx%d noise map loaded.", size_val, size_val);
-	NoiseSeed(1);
 }
 
+#endif
+
 float Noisef(int seed)
 {
 	return (float)Noisei(seed) / 255.0f;
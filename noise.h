@@ -74,6 +74,7 @@ struct Octant
 };
 
 void  NoiseInit();
+void  NoiseLoad(const unsigned char* pixels, GLcoord2 size);
 float Noisef(Octant pos, int freq = FREQ_ALL);
 int   Noisei(Octant pos);
 int   Noisei(int seed);
@@ -0,0 +1,98 @@
+#ifndef PAGE_LAYOUT_H
+#define PAGE_LAYOUT_H
+
+#include "random.h"
+#include "TMXMap.h"  //for Doomhammer! (TMXMap)
+
+#define CONNECT_NONE    0
+#define CONNECT_UP      1
+#define CONNECT_DOWN    2
+#define CONNECT_LEFT    4
+#define CONNECT_RIGHT   8
+
+#define DOORS_UP        16
+#define DOORS_DOWN      32
+#define DOORS_LEFT      64
+#define DOORS_RIGHT     128
+
+#define LAYER_INNER     1
+#define LAYER_OUTER     2
+#define LAYER_PLAY      4
+
+#define SHAPE_INVALID   16
+
+enum
+{
+	MAP_OPEN,
+	MAP_SOLID,
+};
+
+struct MarchMap
+{
+	unsigned char map[PAGE_SIZE][PAGE_SIZE];
+};
+
+struct DoorInfo
+{
+	GLvector2       position;
+	enum DoorFacing facing;
+};
+
+//Everything we know about one cell, packed into a single word.
+struct PageCell
+{
+	unsigned short  solid   : 1;                        //MAP_SOLID or MAP_OPEN
+	unsigned short  access  : 1;                        //True if this spot can be pathed to.
+	unsigned short  blocked : 1;                        //True if a machine has been placed here.
+	unsigned short  shape   : 5;                        //Marching square pattern, for collision. SHAPE_INVALID until known.
+	unsigned short  variant : 8;                        //Which tile variation is used for this cell.
+};
+
+//The cells of one screen, and the places worth knowing about within it.
+//This is everything level generation produces. The game adds geometry and
+//robots on top of it in Page.
+class PageLayout
+{
+protected:
+	GLcoord2          _grid;                            //The origin of the NW corner, whole number
+	GLvector2         _origin;                          //The origin of the NW corner of screen as vector
+	GLvector2         _landing_pos;                     //Where the checkpoint will be placed, if present.
+	GLvector2         _machine_pos;                     //Where to put a machine on this page.
+	GLbbox2           _bbox;                            //The bounding rectangle that contains this room.
+	PageCell          _cell[PAGE_SIZE][PAGE_SIZE];
+	bool              _initialized;
+	short             _connect;                         //How this screen connects to neighbors
+	std::string       _pattern;                         //What kind of shapes to use for the playspace
+	int               _screen_index;                    //Pages are numbered incrementally through a level.
+	int               _desired_doors;
+	vector<GLcoord2>  _spawn_slots;
+	vector<DoorInfo>  _door_info;
+	GLcoord2          _debug_point;
+	RandomStream      _random;                          //Only used while building the pattern.
+
+	void              DoDoors(int doors, pyrodactyl::TMXMap &tmx);
+	void              DoSpawns();
+	void              DoAccess();
+	void              DoLocations();
+	void              Dig(int x, int y, bool add_spawn = false, int size = 1);
+	void              Fill(int x, int y);
+	bool              NeedAccess(int x, int y);
+	bool              MachineSafe(GLcoord2 local);
+
+public:
+	PageLayout() { _initialized = false; }
+	virtual ~PageLayout() {}
+	void              BuildFiller(int tile_variants);
+	void              BuildPattern(RandomStream random, int tile_variants);
+	bool              Contains(GLvector2 p) const { return _bbox.Contains(p); }
+	vector<DoorInfo>  DoorList() { return _door_info; };
+	virtual void      Init(GLcoord2 grid_pos, int screen, int connect, std::string pattern, int doors);
+	GLvector2         Landing() { return _landing_pos; }
+	GLvector2         Machine() { return _machine_pos; }
+	int               PageNumber() { return _screen_index; };
+	const char*       Pattern() const { return _pattern.c_str (); }
+	bool              Solid(int local_x, int local_y) const { return _cell[local_x][local_y].solid == MAP_SOLID; }
+	int               SpawnSlots() const { return _spawn_slots.size(); }
+};
+
+#endif // PAGE_LAYOUT_H
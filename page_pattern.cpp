@@ -3,7 +3,9 @@
   Page_pattern.cpp
 
   This module is a container for the massive level-generating code, which was
-  too large and ungainly to exist with the rest of the Page class.
+  too large and ungainly to exist with the rest of the Page class. Nothing
+  here knows about rendering or the rest of the game, so it can be built on
+  its own as part of the worldgen library.
 
   Good Robot
   (c) 2013 Shamus Young
@@ -12,10 +14,7 @@
 
 #include "master.h"
 
-#include "env.h"
-#include "fx.h"
-#include "noise.h"
-#include "page.h"
+#include "page_layout.h"
 #include "random.h"
 #include "TMXMap.h"
 
@@ -23,7 +22,254 @@
 
 -----------------------------------------------------------------------------*/
 
-void Page::BuildPattern()
+//Clear out a specific point of the grid to make it open.
+void PageLayout::Dig(int x, int y, bool add_spawn, int size)
+{
+	if (x<0 || x>PAGE_EDGE)
+		return;
+	if (y<0 || y>PAGE_EDGE)
+		return;
+	for (int xx = 0; xx < size; xx++) {
+		for (int yy = 0; yy < size; yy++) {
+			int   safe_x = clamp(x + xx, 0, PAGE_EDGE);
+			int   safe_y = clamp(y + yy, 0, PAGE_EDGE);
+			_cell[safe_x][safe_y].solid = MAP_OPEN;
+		}
+	}
+	if (add_spawn)
+		_spawn_slots.push_back(GLcoord2(x, y));
+}
+
+//The opposite of dig. Usually one loop will use dig to open up some area of
+//the page, and then fill is used to add blocks back in.
+void PageLayout::Fill(int x, int y)
+{
+	if (x<0 || x>PAGE_EDGE)
+		return;
+	if (y<0 || y>PAGE_EDGE)
+		return;
+	_cell[x][y].solid = MAP_SOLID;
+}
+
+void PageLayout::Init(GLcoord2 grid_pos, int screen, int connect, std::string pattern, int doors)
+{
+	int       x, y;
+	GLcoord2  world;
+
+	_grid = grid_pos;
+	world = _grid * PAGE_SIZE;
+	_connect = (short)connect;
+	_pattern = pattern;
+	_screen_index = screen;
+	_initialized = true;
+	_origin = GLvector2((float)_grid.x * PAGE_SIZE, (float)_grid.y * PAGE_SIZE);
+	_desired_doors = doors;
+	_spawn_slots.clear();
+	_door_info.clear();
+	_bbox.Clear();
+	_bbox.ContainPoint(world);
+	_bbox.ContainPoint(GLvector2(world) + GLvector2(PAGE_SIZE, PAGE_SIZE));
+	//Clear the marching squares grid.
+	for (x = 0; x < PAGE_SIZE; x++)  {
+		for (y = 0; y < PAGE_SIZE; y++) {
+			_cell[x][y].shape = SHAPE_INVALID;
+			_cell[x][y].access = false;
+			_cell[x][y].blocked = false;
+		}
+	}
+}
+
+bool PageLayout::MachineSafe(GLcoord2 local)
+{
+	//scan
+	for (int x = -1; x <= 1; x++) {
+		//The spaces overhead must be open.
+		if (_cell[local.x + x][local.y + 0].solid == MAP_SOLID)
+			return false;
+		//The spaces we're occupying must be open.
+		if (_cell[local.x + x][local.y + 1].solid == MAP_SOLID)
+			return false;
+		//The spaces under us must be solid.
+		if (_cell[local.x + x][local.y + 2].solid == MAP_OPEN)
+			return false;
+	}
+	return true;
+}
+
+//Stick the machines just a tiny bit into the floor to hide their corner seams.
+#define MACHINE_DISPLACE    0.25f
+
+///Scan the pages and figure out where important things need to go.
+void PageLayout::DoLocations()
+{
+	bool    machine_done;
+	//Figure out where to put a machine.
+	//We want a flat area 3 spaces wide, with 2 open spaces of vertical clearance.
+	//We want this point to be as high as possible.
+	machine_done = false;
+	//For insurance, just set a dumb broken spot right in the center of the page.
+	_machine_pos = _origin + GLcoord2(PAGE_HALF, PAGE_HALF);
+	for (int y = 1; y < PAGE_SIZE && !machine_done; y++) {
+		for (int x = 1; x < PAGE_EDGE - 1; x++) {
+			if (MachineSafe(GLcoord2(x, y))) {
+				_machine_pos = _origin + GLcoord2(x, y) + GLvector2(0, MACHINE_DISPLACE);
+				machine_done = true;
+				break;
+			}
+		}
+	}
+
+	//Next we pick a spawn point.
+	if (_spawn_slots.empty()) {
+		_landing_pos = _origin + GLcoord2(PAGE_HALF, PAGE_EDGE - 5);
+		return;
+	}
+	_landing_pos = _origin + _spawn_slots[0];
+	return;
+}
+
+bool PageLayout::NeedAccess(int x, int y)
+{
+	//Make sure this point is in bounds
+	if (x < 0 || x > PAGE_EDGE)
+		return false;
+	if (y < 0 || y > PAGE_EDGE)
+		return false;
+	//Solid rock doesn't need spawn / movement access.
+	if (_cell[x][y].solid != MAP_OPEN)
+		return false;
+	//Don't need access if you already have it.
+	if (_cell[x][y].access)
+		return false;
+	return true;
+}
+
+//Perform  brute-force flood fill on this screen to identify which
+//cells are reachable and which aren't.
+void PageLayout::DoAccess()
+{
+	GLcoord2              start;
+	vector<GLcoord2>      flood;
+	GLcoord2              pos;
+
+	//First identify our starting point.
+	if (_pattern == "solid")
+		return;
+	if (_connect & CONNECT_LEFT)
+		start = GLcoord2(0, PAGE_HALF);
+	else if (_connect & CONNECT_RIGHT)
+		start = GLcoord2(PAGE_EDGE, PAGE_HALF);
+	else if (_connect & CONNECT_UP)
+		start = GLcoord2(PAGE_HALF, 0);
+	else
+		start = GLcoord2(PAGE_HALF, PAGE_EDGE);
+	_debug_point = start;
+	flood.push_back(start);
+	//Flood fill.
+	for (unsigned i = 0; i < flood.size(); i++) {
+		pos = flood[i];
+		if (_cell[pos.x][pos.y].access == true)
+			continue;
+		_cell[pos.x][pos.y].access = true;
+		//Check all 8 ordinal neighbors.
+		if (NeedAccess(pos.x, pos.y - 1))
+			flood.push_back(GLcoord2(pos.x, pos.y - 1));
+		if (NeedAccess(pos.x, pos.y + 1))
+			flood.push_back(GLcoord2(pos.x, pos.y + 1));
+		if (NeedAccess(pos.x + 1, pos.y))
+			flood.push_back(GLcoord2(pos.x + 1, pos.y));
+		if (NeedAccess(pos.x - 1, pos.y))
+			flood.push_back(GLcoord2(pos.x - 1, pos.y));
+		if (NeedAccess(pos.x - 1, pos.y - 1))
+			flood.push_back(GLcoord2(pos.x - 1, pos.y - 1));
+		if (NeedAccess(pos.x + 1, pos.y + 1))
+			flood.push_back(GLcoord2(pos.x + 1, pos.y + 1));
+		if (NeedAccess(pos.x + 1, pos.y - 1))
+			flood.push_back(GLcoord2(pos.x + 1, pos.y - 1));
+		if (NeedAccess(pos.x - 1, pos.y + 1))
+			flood.push_back(GLcoord2(pos.x - 1, pos.y + 1));
+	}
+	//Examine the map, fine open areas where a machine will fit.
+	for (int x = 0; x < PAGE_SIZE; x++) {
+		for (int y = 0; y < PAGE_SIZE; y++) {
+			_cell[x][y].blocked = false;
+		}
+	}
+}
+
+//Scan the space and look for likely places to spawn enemies.
+void PageLayout::DoSpawns()
+{
+	unsigned    i;
+
+	//Pass over the entire page and look for places where we could put a robot.
+	for (int y = 1; y < PAGE_EDGE; y++) {
+		for (int x = 1; x < PAGE_EDGE; x++) {
+			if (_cell[x][y].solid != MAP_OPEN)
+				continue;
+			if (_cell[x - 1][y].solid != MAP_OPEN)
+				continue;
+			if (_cell[x + 1][y].solid != MAP_OPEN)
+				continue;
+			if (_cell[x][y + 1].solid != MAP_OPEN)
+				continue;
+			if (_cell[x][y - 1].solid != MAP_OPEN)
+				continue;
+			if (!_cell[x][y].access)
+				continue;
+			_spawn_slots.push_back(GLcoord2(x, y));
+		}
+	}
+	//Go through the list and make sure they're in bounds.
+	i = 0;
+	while (i < _spawn_slots.size()) {
+		if (_spawn_slots[i].x <= 0 || _spawn_slots[i].x > PAGE_EDGE) {
+			_spawn_slots.erase(_spawn_slots.begin() + i);
+			continue;
+		}
+		if (_spawn_slots[i].y <= 0 || _spawn_slots[i].y > PAGE_EDGE) {
+			_spawn_slots.erase(_spawn_slots.begin() + i);
+			continue;
+		}
+		i++;
+	}
+	//Now go through list of ALL spawns and make sure they're reachable.
+	for (i = 0; i < _spawn_slots.size(); i++) {
+		//If it's unreachable, kill it.
+		if (!_cell[_spawn_slots[i].x][_spawn_slots[i].y].access)
+			_spawn_slots.erase(_spawn_slots.begin() + i);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//Pages off the path are solid rock and nothing else. They're only needed
+//when it's time to build geometry, so they're made on the fly and thrown away.
+//The tile art comes from the position instead of the random number stream,
+//so the same spot always looks the same no matter when it was built.
+void PageLayout::BuildFiller(int tile_variants)
+{
+	int           x, y;
+	GLcoord2      world;
+	unsigned      h;
+
+	world = _grid * PAGE_SIZE;
+	for (x = 0; x < PAGE_SIZE; x++) {
+		for (y = 0; y < PAGE_SIZE; y++) {
+			h = (unsigned)(world.x + x) * 73856093u ^ (unsigned)(world.y + y) * 19349663u;
+			_cell[x][y].solid = MAP_SOLID;
+			_cell[x][y].variant = tile_variants > 0 ? (unsigned char)((h >> 8) % tile_variants) : 0;
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+void PageLayout::BuildPattern(RandomStream random, int tile_variants)
 {
 	using namespace pyrodactyl;
 
@@ -31,20 +277,22 @@ void Page::BuildPattern()
 	GLcoord2          world;
 	int               column, row;
 	vector<DoorInfo>  door_positions;
+	MarchMap          m;                                //TMX maps work on plain bytes, so they're copied into the cells after.
 	TMXMap tmx;
 
+	_random = random;
 	world = _grid * PAGE_SIZE;
 	column = _grid.x;
 	row = _grid.y;
 	for (x = 0; x < PAGE_SIZE; x++) {
 		for (y = 0; y < PAGE_SIZE; y++) {
-			_variant[x][y] = (unsigned char)RandomVal(Env().tile_variants);
+			_cell[x][y].variant = (unsigned char)_random.Val(tile_variants);
 		}
 	}
 	//Fill in with solid mass. We'll dig tunnels in this below.
 	for (x = 0; x < PAGE_SIZE; x++) {
 		for (y = 0; y < PAGE_SIZE; y++) {
-			_map[x][y] = MAP_SOLID;
+			_cell[x][y].solid = MAP_SOLID;
 		}
 	}
 	if (_pattern == "invalid")
@@ -82,39 +330,44 @@ void Page::BuildPattern()
 			}
 		}
 		int platform_width = PAGE_HALF / 3;
-		int platform_bottom = PAGE_HALF + 2 + RandomVal (2);
+		int platform_bottom = PAGE_HALF + 2 + _random.Val(2);
 
 		for (y = PAGE_HALF; y <= platform_bottom; y++) {
 			for (x = -platform_width; x <= platform_width; x++) {
 				//If we're on the underside, then leave pieces off randomly to make it uneven.
 				if (abs (x) == platform_width || y == platform_bottom) {
-					if (RandomVal (3) != 0)
+					if (_random.Val(3) != 0)
 						continue;
 				}
 				Fill (PAGE_HALF + x, y);
 			}
-			platform_width -= 1 + RandomVal (2);
+			platform_width -= 1 + _random.Val(2);
 		}
 	} else {//Not a door, load a TMX file.
 		boost::filesystem::path file_path(LEVELS_DIR + _pattern + LEVELS_EXT);
 		if (exists(file_path)) {
 			//Load the TMX file specified
-			tmx.Load(LEVELS_DIR, _pattern + LEVELS_EXT);
+			tmx.Load(LEVELS_DIR, _pattern + LEVELS_EXT, _random);
 		} else {
 			//Load the default file
-			tmx.Load(LEVELS_DIR, LEVELS_DEFAULT);
+			tmx.Load(LEVELS_DIR, LEVELS_DEFAULT, _random);
 		}
-		tmx.Copy(_map);
+		tmx.Copy(m.map, _random);
 		//Bore tunnels to connect this level with the one above or below it.
 		if (_connect) {
 			if (_connect & CONNECT_LEFT)
-				tmx.CreateDoor (DIRECTION_LEFT, _map);
+				tmx.CreateDoor (DIRECTION_LEFT, m.map);
 			if (_connect & CONNECT_RIGHT)
-				tmx.CreateDoor (DIRECTION_RIGHT, _map);
+				tmx.CreateDoor (DIRECTION_RIGHT, m.map);
 			if (_connect & CONNECT_UP)
-				tmx.CreateDoor (DIRECTION_UP, _map);
+				tmx.CreateDoor (DIRECTION_UP, m.map);
 			if (_connect & CONNECT_DOWN)
-				tmx.CreateDoor (DIRECTION_DOWN, _map);
+				tmx.CreateDoor (DIRECTION_DOWN, m.map);
+		}
+		for (x = 0; x < PAGE_SIZE; x++) {
+			for (y = 0; y < PAGE_SIZE; y++) {
+				_cell[x][y].solid = m.map[x][y];
+			}
 		}
 	}
 
@@ -126,15 +379,15 @@ void Page::BuildPattern()
 	for (int x = 1; x < PAGE_EDGE; x++) {
 		for (int y = 1; y < PAGE_EDGE; y++) {
 			short shape = 0;
-			if (_map[x][y])
+			if (_cell[x][y].solid)
 				shape |= 1;
-			if (_map[x + 1][y])
+			if (_cell[x + 1][y].solid)
 				shape |= 2;
-			if (_map[x + 1][y + 1])
+			if (_cell[x + 1][y + 1].solid)
 				shape |= 4;
-			if (_map[x][y + 1])
+			if (_cell[x][y + 1].solid)
 				shape |= 8;
-			_shape[x][y] = shape;
+			_cell[x][y].shape = shape;
 		}
 	}
 	DoLocations();
@@ -156,7 +409,7 @@ enum Doorways
 	DOOR_LEFT3,
 };
 
-void Page::DoDoors(int doors, pyrodactyl::TMXMap &tmx)
+void PageLayout::DoDoors(int doors, pyrodactyl::TMXMap &tmx)
 {
 	vector<Doorways>  ways;
 	vector<Doorways>  chosen;
@@ -189,7 +442,7 @@ void Page::DoDoors(int doors, pyrodactyl::TMXMap &tmx)
 		return;
 	//Now choose a few from the ones available.
 	for (int i = 0; i < doors; i++) {
-		int rando = RandomVal(ways.size());
+		int rando = _random.Val(ways.size());
 		chosen.push_back(ways[rando]);
 		ways.erase(ways.begin() + rando);
 	}
@@ -19,10 +19,12 @@
 #include "player.h"
 #include "random.h"
 #include "render.h"
+#include "simd.h"
 #include "system.h"
 
 #define PARTICLE_LIMIT				2500
-#define MAX_UPDATE						2000
+#define PARTICLE_DRAG         0.97f
+#define PARTICLE_MARGIN       1.0f  //How far past the edge of the screen a particle can still show.
 #define DEBRIS_LIFESPAN				2000
 #define PARTICLE_COUNT_BOOST	1			//ONLY FOR TESTING. Uselessly multiplies the number of particles.
 
@@ -53,6 +55,10 @@ class Particle
 
 public:
 	bool        Dead() { return _dead; }
+	void        Kill() { _dead = true; }
+	float       Fall() const { return _gravity ? GRAVITY : 0.0f; }
+	GLvector2   Position() const { return _position; }
+	GLvector2   Velocity() const { return _velocity; }
 	void        Init(SpriteEntry sprite, GLrgba color, GLvector2 position, bool gravity, bool glow, int lifespan, float size, float scatter, float spin);
 	void        Accelerate(GLvector2 accel) { _velocity += accel; }
   void        CollisionSet (bool enable) { _collision = enable; }
@@ -60,12 +66,20 @@ public:
 	void        TrailSet(bool enable) { _trail = enable; }
 	void        ScaleSet(float start, float end) { _size_start = start; _size_end = end; }
 	void        VelocitySet(GLvector2 v) { _velocity = v; }
-	void        Update();
-	void        Render();
+	void        Update(int now, GLvector2& position, GLvector2& velocity);
+	void        Render(GLvector2 position);
 };
 
 static vector<Particle>     queue;
 static vector<Particle>     particle;
+//Position and motion of each particle, kept in separate arrays in the same
+//order as the particle list so the Simd functions can move them all at once.
+static vector<float>        pos_x;
+static vector<float>        pos_y;
+static vector<float>        vel_x;
+static vector<float>        vel_y;
+static vector<float>        fall;
+static vector<unsigned char> outside;
 static GLuvFrame*           smoke;
 static GLuvFrame*           spark;
 static GLuvFrame*           glow[2];
@@ -73,7 +87,7 @@ static GLuvFrame*           debris[2];
 static GLuvFrame*           rubble[2];
 static int                  next_cleanup;
 static int                  live_particles;
-static int									update_particle;
+static RandomStream&        cosmetic = RandomChannel(RANDOM_COSMETIC);  //Particles never touch the gameplay random numbers.
 
 /*-----------------------------------------------------------------------------
 
@@ -86,6 +100,40 @@ static bool overloaded ()
 	return false;
 }
 
+static void add(const Particle& p)
+{
+	GLvector2   position = p.Position();
+	GLvector2   velocity = p.Velocity();
+
+	particle.push_back(p);
+	pos_x.push_back(position.x);
+	pos_y.push_back(position.y);
+	vel_x.push_back(velocity.x);
+	vel_y.push_back(velocity.y);
+	fall.push_back(p.Fall());
+}
+
+//Drop the particle at index by moving the last one into its place.
+static void discard(unsigned index)
+{
+	unsigned   last = particle.size() - 1;
+
+	if (index < last) { //If we're not at the end of the list.
+		particle[index] = particle[last];
+		pos_x[index] = pos_x[last];
+		pos_y[index] = pos_y[last];
+		vel_x[index] = vel_x[last];
+		vel_y[index] = vel_y[last];
+		fall[index] = fall[last];
+	}
+	particle.pop_back();
+	pos_x.pop_back();
+	pos_y.pop_back();
+	vel_x.pop_back();
+	vel_y.pop_back();
+	fall.pop_back();
+}
+
 /*-----------------------------------------------------------------------------
 Module stuff
 -----------------------------------------------------------------------------*/
@@ -122,7 +170,7 @@ void ParticleSmoke(GLvector2 origin, float size, int count)
 		return;
 	count *= PARTICLE_COUNT_BOOST;
 	for (int i = 0; i < count; i++) {
-		p.Init(SPRITE_SMOKE, GLrgba(), origin, false, false, 1500 + RandomVal() % 1000, size, 0.01f, 1);
+		p.Init(SPRITE_SMOKE, GLrgba(), origin, false, false, 1500 + cosmetic.Val() % 1000, size, 0.01f, 1);
 		p.Accelerate(GLvector2(0, -0.01f));
 		p.FadeSet(true);
 		queue.push_back(p);
@@ -172,12 +220,12 @@ void ParticleGlow(GLvector2 origin, GLvector2 movement, GLrgba color1, GLrgba co
 		return;
 	count *= PARTICLE_COUNT_BOOST;
 	for (int i = 0; i < count; i++) {
-		p.Init(SPRITE_GLOW, color1, origin, false, true, 250 + RandomVal() % 1500, size, 0.01f, 3);
+		p.Init(SPRITE_GLOW, color1, origin, false, true, 250 + cosmetic.Val() % 1500, size, 0.01f, 3);
 		p.Accelerate(movement);
 		p.FadeSet(true);
 		queue.push_back(p);
 		seed--;
-		p.Init(SPRITE_SPARK, color2, origin, false, true, 250 + RandomVal() % 1500, size, 0.01f, 14);
+		p.Init(SPRITE_SPARK, color2, origin, false, true, 250 + cosmetic.Val() % 1500, size, 0.01f, 14);
 		p.Accelerate(movement);
 		p.FadeSet(true);
 		queue.push_back(p);
@@ -192,7 +240,7 @@ void ParticleSparks(GLvector2 origin, GLvector2 movement, GLrgba color, int coun
 		return;
 	count *= PARTICLE_COUNT_BOOST;
 	for (int i = 0; i < count; i++) {
-		p.Init(SPRITE_SPARK, color, origin, false, true, 250 + RandomVal() % 1500, 0.07f+RandomFloat()*0.15f, 0.05f, 10);
+		p.Init(SPRITE_SPARK, color, origin, false, true, 250 + cosmetic.Val() % 1500, 0.07f+cosmetic.Float()*0.15f, 0.05f, 10);
 		p.Accelerate(movement);
 		p.FadeSet(true);
 		queue.push_back(p);
@@ -207,7 +255,7 @@ void ParticleSparks(GLvector2 origin, GLrgba color, int count)
 		return;
 	count *= PARTICLE_COUNT_BOOST;
 	for (int i = 0; i < count; i++) {
-		p.Init(SPRITE_SPARK, color, origin, false, true, 1000 + RandomVal() % 1000, 0.16f, 0.01f, 10);
+		p.Init(SPRITE_SPARK, color, origin, false, true, 1000 + cosmetic.Val() % 1000, 0.16f, 0.01f, 10);
 		queue.push_back(p);
 	}
 }
@@ -225,7 +273,7 @@ void ParticleDebris(GLvector2 origin, float size, int count, float speed)
 			sprite = SPRITE_DEBRIS1;
 		else
 			sprite = SPRITE_DEBRIS2;
-    p.Init (sprite, GLrgba (), origin, true, false, DEBRIS_LIFESPAN + RandomVal () % DEBRIS_LIFESPAN, size, 0.05f*speed, 3);
+    p.Init (sprite, GLrgba (), origin, true, false, DEBRIS_LIFESPAN + cosmetic.Val() % DEBRIS_LIFESPAN, size, 0.05f*speed, 3);
     p.CollisionSet (true);
 		queue.push_back(p);
 	}
@@ -244,8 +292,8 @@ void ParticleDebris (GLvector2 origin, float size, int count, float speed, GLvec
       sprite = SPRITE_DEBRIS1;
     else
       sprite = SPRITE_DEBRIS2;
-    p.Init (sprite, GLrgba (), origin, true, false, DEBRIS_LIFESPAN + RandomVal () % DEBRIS_LIFESPAN, (RandomFloat ()+0.33f) * size, 0.05f*speed, 3);
-    p.VelocitySet (direction+GLvector2 (RandomFloat () - 0.5f, RandomFloat () - 0.5f)*speed);
+    p.Init (sprite, GLrgba (), origin, true, false, DEBRIS_LIFESPAN + cosmetic.Val() % DEBRIS_LIFESPAN, (cosmetic.Float()+0.33f) * size, 0.05f*speed, 3);
+    p.VelocitySet (direction+GLvector2 (cosmetic.Float() - 0.5f, cosmetic.Float() - 0.5f)*speed);
     p.CollisionSet (true);
     queue.push_back (p);
   }
@@ -267,9 +315,9 @@ void ParticleBlood (GLvector2 origin, GLrgba color, float size, int count, float
 	size = clamp (size, 0.05f, 0.1f);
 	sprite = SpriteEntryLookup ("Circle");
 	for (int i = 0; i < count; i++) {
-		color_blood = Lerp (color_dark, color_light, RandomFloat ());
-		p.Init (sprite, color_blood, origin, true, true, DEBRIS_LIFESPAN + RandomVal () % DEBRIS_LIFESPAN, (RandomFloat () + 0.33f) * size, 0.01f, (RandomFloat () - 0.5f) * 100.0f);
-		p.VelocitySet (direction * speed + (RandomFloat () - 0.5f)*speed);
+		color_blood = Lerp (color_dark, color_light, cosmetic.Float());
+		p.Init (sprite, color_blood, origin, true, true, DEBRIS_LIFESPAN + cosmetic.Val() % DEBRIS_LIFESPAN, (cosmetic.Float() + 0.33f) * size, 0.01f, (cosmetic.Float() - 0.5f) * 100.0f);
+		p.VelocitySet (direction * speed + (cosmetic.Float() - 0.5f)*speed);
 		p.CollisionSet (true);
 		queue.push_back (p);
 	}
@@ -296,17 +344,19 @@ void ParticleRubble(GLvector2 origin, float size, int count)
 
 void ParticleUpdate()
 {
+	GLvector    camera;
+	GLvector2   position;
+	GLvector2   velocity;
+	int         count;
+	int         now;
+
 	if (GamePaused())
 		return;
 	//We need to do a run of the list and pull out any members that have died.
 	if (GameTick() > next_cleanup) {
 		for (unsigned i = 0; i < particle.size(); i++) {
-			if (particle[i].Dead()) {
-				unsigned   last = particle.size() - 1;
-				if (i < last) //If we're not at the end of the list.
-					particle[i] = particle[last];
-				particle.pop_back();
-			}
+			if (particle[i].Dead())
+				discard(i--);
 		}
 		next_cleanup = GameTick() + 1000;
 	}
@@ -315,29 +365,41 @@ void ParticleUpdate()
 	//in the middle of an update. So we stick new particles in a queue.
 	//Here we take the queue from the previous frame and add them.
 	if (!queue.empty() && live_particles < PARTICLE_LIMIT) {
-		particle.insert(particle.end(), queue.begin(), queue.end());
+		for (unsigned i = 0; i < queue.size(); i++)
+			add(queue[i]);
 	}
 	queue.clear();
 	//Update the particles, and we're done.
 	if (particle.empty ())
 		return;
-	if (update_particle >= particle.size ())
-		update_particle = 0;
-	
-	int			update_count = 0;
-	int			first_particle = update_particle;
-
+	count = particle.size();
+	now = GameTick();
+	camera = CameraPosition();
+	//Anything that wandered too far from the camera is gone.
+	outside.resize(count);
+	SimdOutside(&pos_x[0], &pos_y[0], GLvector2(camera.x, camera.y), camera.z * 2.5f, &outside[0], count);
+	//Move everything at once. Dead particles move too, but nobody sees them.
+	SimdAdd(&vel_y[0], &fall[0], count);
+	SimdAdd(&pos_x[0], &vel_x[0], count);
+	SimdAdd(&pos_y[0], &vel_y[0], count);
+	//Now the things that are different for every particle.
 	live_particles = 0;
-	while (update_count < MAX_UPDATE) {
-		if (!particle[update_particle].Dead ()) {
-			live_particles++;
-			particle[update_particle].Update ();
-		}
-		update_count++;
-		update_particle = (update_particle + 1) % particle.size ();
-		if (update_particle == first_particle)
-			break;
+	for (int i = 0; i < count; i++) {
+		if (outside[i])
+			particle[i].Kill();
+		if (particle[i].Dead())
+			continue;
+		position = GLvector2(pos_x[i], pos_y[i]);
+		velocity = GLvector2(vel_x[i], vel_y[i]);
+		particle[i].Update(now, position, velocity);
+		pos_x[i] = position.x;
+		pos_y[i] = position.y;
+		vel_x[i] = velocity.x;
+		vel_y[i] = velocity.y;
+		live_particles++;
 	}
+	SimdScale(&vel_x[0], PARTICLE_DRAG, count);
+	SimdScale(&vel_y[0], PARTICLE_DRAG, count);
 }
 
 unsigned ParticleCount()
@@ -347,10 +409,24 @@ unsigned ParticleCount()
 
 void ParticleRender()
 {
+	GLvector    camera;
+	int         count;
+
   if (!EnvValueb (ENV_RENDER_PARTICLES))
     return;
-	for (unsigned i = 0; i < particle.size(); i++)
-		particle[i].Render();
+	count = particle.size();
+	if (!count)
+		return;
+	//Particles live well past the edges of the screen. Skip the ones that
+	//are out there. This is a square as wide as the view, so it's generous
+	//up and down.
+	camera = CameraPosition();
+	outside.resize(count);
+	SimdOutside(&pos_x[0], &pos_y[0], GLvector2(camera.x, camera.y), camera.z * RenderAspect() + PARTICLE_MARGIN, &outside[0], count);
+	for (int i = 0; i < count; i++) {
+		if (!outside[i])
+			particle[i].Render(GLvector2(pos_x[i], pos_y[i]));
+	}
 	RenderQuads();
 }
 
@@ -380,40 +456,28 @@ void Particle::Init(SpriteEntry sprite, GLrgba color, GLvector2 position, bool g
 	_dead = false;
 }
 
-void Particle::Render()
+void Particle::Render(GLvector2 position)
 {
 	GLquad    q;
 
 	q = SpriteMapQuad((int)_fangle);
 	if (_dead)
 		return;
-	RenderQuad(_position, _sprite, _color_render, _size, _fangle, _glow ? DEPTH_FX_GLOW : DEPTH_FX, _glow);
+	RenderQuad(position, _sprite, _color_render, _size, _fangle, _glow ? DEPTH_FX_GLOW : DEPTH_FX, _glow);
 }
 
-void Particle::Update()
+//Position and velocity live in the module arrays, and have already been moved
+//for this frame. We get them here in case we hit a wall.
+void Particle::Update(int now, GLvector2& position, GLvector2& velocity)
 {
-	int       now;
-	GLvector2 distance;
-  GLvector2 old_position;
-	GLvector  camera;
-	float     max_distance;
 	float     delta;
 
 	_frame++;
-	now = GameTick();
-	camera = CameraPosition();
-	delta = (float)(now - _time_begin) / (float)_lifespan;
-	distance = _position - GLvector2(camera.x, camera.y);
-	max_distance = camera.z * 2.5f;
-	if (abs(distance.x) > max_distance || abs(distance.y) > max_distance)
+	if (now > _time_end) {
 		_dead = true;
-	if (now > _time_end)
-		_dead = true;
-	if (_dead)
 		return;
-
-	if (_gravity)
-		_velocity.y += GRAVITY;
+	}
+	delta = (float)(now - _time_begin) / (float)_lifespan;
 	if (_fade) {
 		float diminish;
 		diminish = 1.0f - delta;
@@ -423,21 +487,20 @@ void Particle::Update()
 			_color_render.alpha = diminish / 3.0f;
 	}
 	if (_trail && (_frame % 8) == 0)
-		ParticleSparks(_position, GLvector2(), _color, 1);
+		ParticleSparks(position, GLvector2(), _color, 1);
 	_size = Lerp(_size_start, _size_end, delta);
 	_fangle += _spin;
-  old_position = _position;
-	_position += _velocity;
   //Collision only applies to walls.
   if (_collision) {
     GLvector2   wall;
-    if (Collision (_position, &wall, NULL)) {
-      _velocity = GLreflect2 (_velocity, wall);
-      _position = old_position + _velocity;
+    if (Collision (position, &wall, NULL)) {
+      GLvector2   old_position = position - velocity;
+
+      velocity = GLreflect2 (velocity, wall);
+      position = old_position + velocity;
       //lose vertical momentum when colliding, or else they act like
       //bouncy balls.
-      _velocity.y *= 0.5f;
+      velocity.y *= 0.5f;
     }
   }
-	_velocity *= 0.97f;
 }
\ No newline at end of file
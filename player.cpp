@@ -18,6 +18,7 @@
 #include "camera.h"
 #include "collision.h"
 #include "entity.h"
+#include "gpu.h"
 #include "hud.h"
 #include "input.h"
 #include "InputManager.h"
@@ -39,6 +40,7 @@ using namespace pyrodactyl;
 
 #define RECHARGE_INTERVAL     600
 #define PLAYER_SIZE           0.5f
+#define PLAYER_RADIUS         0.12f     //How big the player is, as far as walls are concerned.
 #define SHIELD_INTERVAL       200
 #define DEATH_FADE_TIME       3000
 #define DEATH_MENU_WAIT       1500
@@ -309,76 +311,36 @@ static void do_incoming()
 	incoming.clear();
 }
 
+//Move the player, bouncing off of any walls along the way. This sweeps the
+//whole move, so the player can't pass through a wall no matter how fast.
 static GLvector2 do_collision(GLvector2 position, GLvector2* movement_in)
 {
-	GLvector    surface3D;
-	GLvector    movement3D;
-	GLvector    new_movement;
 	GLvector2   wall;
-	GLvector2   new_pos;
 	GLvector2   movement;
-	float       depth;
-	float       dot;
+	float       bounce_velocity;
+	int         damage;
 
 	if (EnvValueb(ENV_NOCLIP))
 		return position + *movement_in;
 	movement = *movement_in;
-	//Make sure we don't move too fast.
 	current_speed = movement.Length();
+	damage = WorldZone()->WallDamage();
+	bounce_velocity = Env().bounce_velocity;
+	if (damage > 0) //If walls are electrified.
+		bounce_velocity = 0.98f;
+	if (!CollisionMove(&position, &movement, PLAYER_RADIUS, bounce_velocity, &wall))
+		return position;
 	*movement_in = movement;
-	new_pos = position + movement;
-	if (!Collision(new_pos, &wall, &depth, 0.12f)) {
-		return new_pos;
-	}
-	//Set up some 3D vectors for reflection.
-	surface3D = GLvector(wall.x, wall.y, 0.0f).Normalized();
-	movement3D = GLvector(movement.x, movement.y, 0).Normalized();
-	dot = GLdot(movement3D, surface3D);
-	//Only bounce if we're running INTO the wall, not away. Otherwise, glitching
-	//slightly into the surface for one frame would suck us INTO the wall.
-	if (dot < 0) {
-		//if we have the powerup, slide along the wall.
-		/*if (stats.Ability(ABILITY_GLIDE)) {
-			ParticleGlow(new_pos, movement * -1, stats.Color(), stats.Color(), 1, 0.1f);
-			//We nudge the actor out of the wall before we try to bounce off of it.
-			new_pos += wall * depth * 1.1f;
-			new_movement = GLreflect2(movement3D, surface3D).Normalized();
-			new_movement = CollisionSlide(wall, GLvector2(new_movement.x, new_movement.y));
-			movement = GLvector2(new_movement.x, new_movement.y);
-			movement.Normalize();
-			movement *= current_speed;
-			if (GameTick() > skate_sound_cooldown) {
-			skate_sound_cooldown = GameTick() + 1000;
-			AudioPlay(SOUND_SKATE);
-			}
-			}
-			else*/
-		{ //bounce off the wall
-			float bounce_velocity = Env().bounce_velocity;
-			int   damage = WorldZone()->WallDamage();
-
-			if (damage > 0) { //If walls are electrified.
-				bounce_velocity = 0.98f;
-				AudioPlay("forcefield_bounce.wav", 1.0f);
-				ParticleSparks(position, WorldZone()->Color(COLOR_FOREGROUND), 5);
-				PlayerDamage(damage);
-			}
-			else { //Just bounce off normally
-				ParticleRubble(PlayerPosition(), 0.08f, 4);
-				AudioPlay("collide");
-			}
-
-			//We nudge the actor out of the wall before we try to bounce off of it.
-			new_pos += wall * depth * 1.1f;
-			new_movement = GLreflect2(movement3D, surface3D).Normalized();
-			movement = GLvector2(new_movement.x, new_movement.y);
-			movement.Normalize();
-			movement *= current_speed * bounce_velocity;
-		}
+	if (damage > 0) {
+		AudioPlay("forcefield_bounce.wav", 1.0f);
+		ParticleSparks(position, WorldZone()->Color(COLOR_FOREGROUND), 5);
+		PlayerDamage(damage);
 	}
-	new_pos += movement;
-	*movement_in = movement;
-	return new_pos;
+	else { //Just bounce off normally
+		ParticleRubble(PlayerPosition(), 0.08f, 4);
+		AudioPlay("collide");
+	}
+	return position;
 }
 
 static void do_fire()
@@ -831,7 +793,7 @@ void PlayerUpdate()
 		cooldown = 150 + stats.Shields() * 3;
 		cooldown = max(cooldown, 20);
 		smoke_cooldown = now + cooldown;
-		ParticleSmoke(position, avatar.Size()*(RandomFloat() + 1.0f), 2);
+		ParticleSmoke(position, avatar.Size()*(RandomChannel(RANDOM_COSMETIC).Float() + 1.0f), 2);
 	}
 	last_position = position;
 	//if (EnvValueb(ENV_CHEATS))
@@ -876,7 +838,7 @@ void PlayerRender()
 {
 	if (TransitionActive())
 		return;
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	avatar.Render();
 	if (Player()->Hat())
 		my_hat.Render();
@@ -892,13 +854,13 @@ void PlayerRender()
 	}
 	if (avatar.Dead())
 		return;
-	glDepthMask(false);
-	glBlendFunc(GL_ONE, GL_ONE);
+	GpuDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
 	GLrgba weapon_color;
 	weapon_color = stats.Weapon(PLAYER_WEAPON_SECONDARY)->Color();
-	glColor3fv(&weapon_color.red);
+	GpuColor3fv(&weapon_color.red);
 	RenderCircularBar(180, 180 + (int)360.0f * stats.Weapon(PLAYER_WEAPON_SECONDARY)->Cooldown(), PlayerSize(), PlayerPosition(), SPRITE_SHOCKWAVE);
-	glDepthMask(true);
+	GpuDepthMask(true);
 	if (access_available)
 		do_access();
 	if (Player()->Ability(ABILITY_TARGET_LASER)) {
@@ -910,8 +872,8 @@ void PlayerRender()
 		GLuvFrame*    uv;
 		GLrgba        color;
 
-		glBlendFunc(GL_ONE, GL_ONE);
-		glDepthMask(false);
+		GpuBlend(GL_ONE, GL_ONE);
+		GpuDepthMask(false);
 		color = GLrgba(1, 0, 0.3f);
 		start = avatar.OriginLaser();
 		vec = aim - avatar.OriginLaser();
@@ -920,18 +882,18 @@ void PlayerRender()
 		side *= 0.05f;
 		end = avatar.OriginLaser() + vec * 16;
 		uv = SpriteMapLookup(SPRITE_BEAM);
-		glColor3fv(&color.red);
-		glBegin(GL_QUADS);
-		glTexCoord2fv(&uv->uv[1].x);
-		glVertex3f(start.x - side.x, start.y - side.y, 0);
-		glTexCoord2fv(&uv->uv[2].x);
-		glVertex3f(start.x + side.x, start.y + side.y, 0);
-		glTexCoord2fv(&uv->uv[3].x);
-		glVertex3f(end.x + side.x, end.y + side.y, 0);
-		glTexCoord2fv(&uv->uv[0].x);
-		glVertex3f(end.x - side.x, end.y - side.y, 0);
-		glEnd();
-		glDepthMask(true);
+		GpuColor3fv(&color.red);
+		GpuBegin(GL_QUADS);
+		GpuTexCoord2fv(&uv->uv[1].x);
+		GpuVertex3f(start.x - side.x, start.y - side.y, 0);
+		GpuTexCoord2fv(&uv->uv[2].x);
+		GpuVertex3f(start.x + side.x, start.y + side.y, 0);
+		GpuTexCoord2fv(&uv->uv[3].x);
+		GpuVertex3f(end.x + side.x, end.y + side.y, 0);
+		GpuTexCoord2fv(&uv->uv[0].x);
+		GpuVertex3f(end.x - side.x, end.y - side.y, 0);
+		GpuEnd();
+		GpuDepthMask(true);
 	}
 }
 
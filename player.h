@@ -46,6 +46,8 @@ class PlayerStats
 	PlayerWeapon    _weapon[PLAYER_WEAPON_COUNT];
 	bool            _ability[ABILITY_TYPES];
 	long            _trivia[TRIVIA_COUNT];
+	//One bit per trivia that changed since the last achievement check.
+	unsigned        _trivia_dirty;
 
 	long             _score_points;
 	long             _money;
@@ -111,6 +113,7 @@ class PlayerStats
 	int             _multiplier;
 	int             _multiplier_timeout;
 
+	void            TriviaChanged(PlayerTrivia index, long change);
 	void            TriviaCheckAch(PlayerTrivia index);
 	void            SkillCheckAch(PlayerSkill cat);
 	void            ScoreCheckAch();
@@ -140,8 +143,8 @@ public:
 	int             Character() const { return _character; }
 
 	long            Trivia(PlayerTrivia index) const { return _trivia[index]; }
-	void            TriviaSet(PlayerTrivia index, int value) { _trivia[index] = value; TriviaCheckAch(index); }
-	void            TriviaModify(PlayerTrivia index, int change) { _trivia[index] += change; TriviaCheckAch(index); }
+	void            TriviaSet(PlayerTrivia index, int value) { TriviaChanged(index, value - _trivia[index]); _trivia[index] = value; }
+	void            TriviaModify(PlayerTrivia index, int change) { _trivia[index] += change; TriviaChanged(index, change); }
 
 	int             Skill(PlayerSkill index) const { return _skill[index]; }
 	void            SkillSet(PlayerSkill index, int val);
@@ -198,6 +198,12 @@ void PlayerStats::Update()
 	if (GameTick() > _multiplier_timeout) {
 		_multiplier = 0;
 	}
+	//Only look at achievements for the trivia that actually changed.
+	for (int i = 0; _trivia_dirty && i < TRIVIA_COUNT; i++) {
+		if (_trivia_dirty & (1 << i))
+			TriviaCheckAch((PlayerTrivia)i);
+	}
+	_trivia_dirty = 0;
 }
 
 void PlayerStats::ScorePoints(int pts)
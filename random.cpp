@@ -9,6 +9,10 @@
 
   This algorithm is public domain.
 
+  This is the gameplay generator, and replays depend on it. Everything else
+  gets a RandomStream of its own, derived from the same seed, so drawing
+  particles (say) never changes what the robots do.
+
   -----------------------------------------------------------------------------*/
 
 #include "master.h"
@@ -30,6 +34,40 @@
 static int              k = 1;
 static unsigned long    mag01[2] = { 0x0, MATRIX_A };
 static unsigned long    ptgfsr[N];
+static unsigned long    master_seed;
+static RandomStream     channel[RANDOM_CHANNELS];
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//Scramble a 64 bit value so that nearby inputs give unrelated outputs. (SplitMix64)
+static unsigned long long mix(unsigned long long z)
+{
+	z += 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+void RandomStream::Seed(unsigned long long seed, unsigned long long sequence)
+{
+	_seed = seed;
+	_state = 0;
+	//The increment picks which of 2^63 sequences we're on. It has to be odd.
+	_inc = (mix(sequence) << 1) | 1;
+	Val();
+	_state += mix(seed);
+	Val();
+}
+
+RandomStream RandomStream::Split(unsigned long long key) const
+{
+	RandomStream  result;
+
+	result.Seed(mix(_seed ^ mix(key)), key);
+	return result;
+}
 
 /*-----------------------------------------------------------------------------
 
@@ -95,6 +133,9 @@ float RandomFloat()
 
 void RandomInit(unsigned long seed)
 {
+	master_seed = seed;
+	for (int i = 0; i < RANDOM_CHANNELS; i++)
+		channel[i].Seed(mix(seed), i + 1);
 	mag01[0] = 0;
 	mag01[1] = MATRIX_A;
 	ptgfsr[0] = seed;
@@ -103,6 +144,30 @@ void RandomInit(unsigned long seed)
 	k = 1;
 }
 
+//The shared stream for one part of the game. Only use these from the main
+//thread. Work done elsewhere should take a RandomFork () with it.
+RandomStream& RandomChannel(eRandomChannel c)
+{
+	return channel[c];
+}
+
+//A stream for one particular thing (a zone, a robot) within a channel. The
+//same id always gives the same stream for a given seed, no matter what else
+//has been drawn.
+RandomStream RandomFork(eRandomChannel c, unsigned long long id)
+{
+	RandomStream  root(master_seed);
+
+	return root.Split(mix(id ^ ((unsigned long long)c << 56)));
+}
+
+//A fingerprint of where the generator is in its sequence, without advancing it.
+//Two runs that have drawn the same numbers will report the same value.
+unsigned long RandomState()
+{
+	return ptgfsr[k % N] ^ (unsigned long)k;
+}
+
 /*-----------------------------------------------------------------------------
 
 -----------------------------------------------------------------------------*/
@@ -1,8 +1,58 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
 #define COIN_FLIP     (RandomVal (2) == 0)
 
+//Everything that draws random numbers for gameplay shares the one generator
+//below, so a replay can reproduce it. Anything else should draw from its
+//own stream, so it can't change what gameplay sees.
+enum eRandomChannel
+{
+	RANDOM_WORLD,       //Zone layouts.
+	RANDOM_LOOT,        //What robots drop.
+	RANDOM_COSMETIC,    //Particles, shake, and anything else that only changes the look of things.
+	RANDOM_CHANNELS
+};
+
+//A small, fast generator (PCG32) that's cheap enough to use per particle and
+//small enough to keep one per zone or per entity. Streams are plain values,
+//so each thread can have its own. Split () makes a new, independent stream
+//from this one's seed, without drawing anything from it.
+class RandomStream
+{
+	unsigned long long  _state;
+	unsigned long long  _inc;
+	unsigned long long  _seed;
+
+public:
+	RandomStream() { Seed(0); }
+	RandomStream(unsigned long long seed) { Seed(seed); }
+	void                Seed(unsigned long long seed, unsigned long long sequence = 0);
+	RandomStream        Split(unsigned long long key) const;
+	float               Float() { return (float)(Val() >> 8) / 16777216.0f; }
+	bool                Roll(int odds) { return odds ? Val(odds) == 0 : false; }
+	unsigned long       Val(int range) { return range ? Val() % (unsigned)range : 0; }
+	GLvector2           Vector2() { return GLvector2(Float() * 2, Float() * 2) - GLvector2(1, 1); }
+	unsigned long       Val()
+	{
+		unsigned long long  old = _state;
+		unsigned            xorshifted, rot;
+
+		_state = old * 6364136223846793005ULL + _inc;
+		xorshifted = (unsigned)(((old >> 18) ^ old) >> 27);
+		rot = (unsigned)(old >> 59);
+		return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+	}
+};
+
 void          RandomInit(unsigned long seed);
+RandomStream& RandomChannel(eRandomChannel channel);
+RandomStream  RandomFork(eRandomChannel channel, unsigned long long id);
+unsigned long RandomState();
 float         RandomFloat();
 bool          RandomRoll(int odds);
 unsigned long RandomVal(int range);
 unsigned long RandomVal(void);
 GLvector2     RandomVector2();
+
+#endif // RANDOM_H
@@ -7,9 +7,11 @@
 #include "master.h"
 
 #include "avatar.h"
+#include "batch.h"
 #include "camera.h"
 #include "file.h"
 #include "font.h"
+#include "gpu.h"
 #include "hud.h"
 #include "input.h"
 #include "interface.h"
@@ -41,6 +43,7 @@
 
 #define VERT_SHADER         "vertex.cg"
 #define FRAG_SHADER         "fragment.cg"
+#define DUST_SHADER         "dust.cg"
 
 struct Qquad
 {
@@ -79,6 +82,7 @@ static GLmesh             one_quad_mesh;
 static GLenum             my_program;
 static GLenum             my_vertex_shader;
 static GLenum             my_fragment_shader;
+static GLenum             dust_program;
 
 static ScratchList        scratch_list[MAX_SCRATCH];
 static int                current_scratch;
@@ -140,6 +144,24 @@ void compile(char* filename, GLenum id)
 		Console("Compiling '%s'... ok.", filename);
 }
 
+//Compile and link a shader program from the given vertex and fragment sources.
+static GLenum shader_program(char* vertex_file, char* fragment_file)
+{
+	GLenum    program;
+	GLenum    vertex;
+	GLenum    fragment;
+
+	program = glCreateProgramObjectARB();
+	vertex = glCreateShaderObjectARB(GL_VERTEX_SHADER_ARB);
+	fragment = glCreateShaderObjectARB(GL_FRAGMENT_SHADER_ARB);
+	compile(vertex_file, vertex);
+	compile(fragment_file, fragment);
+	glAttachObjectARB(program, vertex);
+	glAttachObjectARB(program, fragment);
+	glLinkProgramARB(program);
+	return program;
+}
+
 static void shader_init()
 {
 	//Set up our shaders
@@ -151,9 +173,13 @@ static void shader_init()
 	compile(FRAG_SHADER, my_fragment_shader);
 	glAttachObjectARB(my_program, my_vertex_shader);
 	glAttachObjectARB(my_program, my_fragment_shader);
-	glUseProgramObjectARB(0);
+	GpuProgram(0);
 	glLinkProgramARB(my_program);
-	glUseProgramObjectARB(my_program);
+	GpuProgram(my_program);
+	//The dust field has a vertex shader of its own, but shares our fragment shader.
+	if (dust_program)
+		glDeleteObjectARB(dust_program);
+	dust_program = shader_program(DUST_SHADER, FRAG_SHADER);
 	//Set up the lone quad used by the shader
 	one_quad_mesh.Clear();
 	one_quad_mesh.PushVertex(GLvector(-0.5f, -0.5f, 0), GLvector2(TEX_MIN, TEX_MIN));
@@ -169,6 +195,16 @@ bool use_shader()
 	return EnvValueb(ENV_SHADER) && !rendering_2d;
 }
 
+bool RenderShaderActive()
+{
+	return use_shader();
+}
+
+unsigned RenderDustProgram()
+{
+	return dust_program;
+}
+
 static  GLint       attrib_angle;
 static  GLint       attrib_scale;
 static  GLint       attrib_position;
@@ -182,7 +218,7 @@ inline void draw_quad(const Qquad* q)
 		const AtlasRef* atlas_ref;
 
 		atlas_ref = SpriteAtlasRef(q->sprite);
-		glColor4fv(&q->color.red);
+		GpuColor4fv(&q->color.red);
 		position = GLvector(q->position.x, q->position.y, q->depth);
 		glVertexAttrib1f(attrib_angle, q->angle);
 		glVertexAttrib1f(attrib_blink, q->blink);
@@ -197,13 +233,13 @@ inline void draw_quad(const Qquad* q)
 
 		rect = SpriteMapQuad((int)q->angle);
 		body = SpriteMapLookup(q->sprite);
-		glColor4fv(&q->color.red);
-		glBegin(GL_QUADS);
-		glTexCoord2fv(&body->uv[2].x);  glVertex3f(q->position.x + rect.corner[0].x * q->size.x, q->position.y + rect.corner[0].y * q->size.y, q->depth);
-		glTexCoord2fv(&body->uv[3].x);  glVertex3f(q->position.x + rect.corner[1].x * q->size.x, q->position.y + rect.corner[1].y * q->size.y, q->depth);
-		glTexCoord2fv(&body->uv[0].x);  glVertex3f(q->position.x + rect.corner[2].x * q->size.x, q->position.y + rect.corner[2].y * q->size.y, q->depth);
-		glTexCoord2fv(&body->uv[1].x);  glVertex3f(q->position.x + rect.corner[3].x * q->size.x, q->position.y + rect.corner[3].y * q->size.y, q->depth);
-		glEnd();
+		GpuColor4fv(&q->color.red);
+		GpuBegin(GL_QUADS);
+		GpuTexCoord2fv(&body->uv[2].x);  GpuVertex3f(q->position.x + rect.corner[0].x * q->size.x, q->position.y + rect.corner[0].y * q->size.y, q->depth);
+		GpuTexCoord2fv(&body->uv[3].x);  GpuVertex3f(q->position.x + rect.corner[1].x * q->size.x, q->position.y + rect.corner[1].y * q->size.y, q->depth);
+		GpuTexCoord2fv(&body->uv[0].x);  GpuVertex3f(q->position.x + rect.corner[2].x * q->size.x, q->position.y + rect.corner[2].y * q->size.y, q->depth);
+		GpuTexCoord2fv(&body->uv[1].x);  GpuVertex3f(q->position.x + rect.corner[3].x * q->size.x, q->position.y + rect.corner[3].y * q->size.y, q->depth);
+		GpuEnd();
 	}
 }
 
@@ -215,14 +251,14 @@ verbose, and occasionally obtuse. These functions encapsulate the system.
 //Write to the stencil buffer.
 void RenderStencilImprint(unsigned mask)
 {
-	glEnable(GL_STENCIL_TEST);
+	GpuEnable(GL_STENCIL_TEST);
 	//Enable writing to these stencil bits...
 	//glStencilMask (0xff);
-	glStencilMask(mask);
+	GpuStencilMask(mask);
 	//The comparison logic to use...
-	glStencilFunc(GL_ALWAYS, mask, 0xFF);
+	GpuStencilFunc(GL_ALWAYS, mask, 0xFF);
 	//Actions to take on stencil fail, z fail, z pass.
-	glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE);
+	GpuStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE);
 	//glColorMask (false, false, false, false);
 	//glDepthMask (false);
 }
@@ -232,16 +268,16 @@ void RenderStencilMask(unsigned compare, unsigned mask)
 {
 	if (!EnvValueb(ENV_SHADOWS))
 		return;
-	glStencilMask(0x00);
-	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
-	glEnable(GL_STENCIL_TEST);
-	glStencilFunc(GL_EQUAL, compare, mask);
+	GpuStencilMask(0x00);
+	GpuStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+	GpuEnable(GL_STENCIL_TEST);
+	GpuStencilFunc(GL_EQUAL, compare, mask);
 }
 
 void RenderWrite(bool write)
 {
-	glColorMask(write, write, write, write);
-	glDepthMask(write);
+	GpuColorMask(write, write, write, write);
+	GpuDepthMask(write);
 }
 
 /*-----------------------------------------------------------------------------
@@ -260,14 +296,14 @@ int RenderListCompile(int owner_id)
 
 	index = current_scratch;
 	scratch_list[index].owner = owner_id;
-	glNewList(scratch_list[index].gl_list, GL_COMPILE);
+	GpuNewList(scratch_list[index].gl_list);
 	current_scratch = (current_scratch + 1) % MAX_SCRATCH;
 	return index;
 }
 
 void RenderListEnd()
 {
-	glEndList();
+	GpuEndList();
 }
 
 void RenderListCall(int owner, int index)
@@ -275,7 +311,7 @@ void RenderListCall(int owner, int index)
 	//if the owners don't match, then this list was stolen by another object.
 	if (scratch_list[index].owner != owner)
 		return;
-	glCallList(scratch_list[index].gl_list);
+	GpuCallList(scratch_list[index].gl_list);
 }
 
 void RenderQuads()
@@ -284,7 +320,7 @@ void RenderQuads()
 
 	glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
 	if (use_shader()) {
-		glUseProgramObjectARB(my_program);
+		GpuProgram(my_program);
 		attrib_angle = glGetAttribLocation(my_program, "attrib_angle");
 		attrib_blink = glGetAttribLocation(my_program, "attrib_blink");
 		attrib_scale = glGetAttribLocation(my_program, "attrib_scale");
@@ -293,21 +329,21 @@ void RenderQuads()
 	}
 
 	if (quad_count) {
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		//glDepthMask(true);
 		for (unsigned i = 0; i < quad_count; i++)
 			draw_quad(&quad[i]);
 	}
 	if (quad_glow_count) {
-		glDepthMask(false);
-		glBlendFunc(GL_ONE, GL_ONE);
+		GpuDepthMask(false);
+		GpuBlend(GL_ONE, GL_ONE);
 		for (unsigned i = 0; i < quad_glow_count; i++)
 			draw_quad(&quad_glow[i]);
 	}
-	glDepthMask(depth_mask);
+	GpuDepthMask(depth_mask);
 	quad_count = 0;
 	quad_glow_count = 0;
-	glUseProgramObjectARB(0);
+	GpuProgram(0);
 	if (EnvValueb(ENV_SHADER)) {
 		glVertexAttrib1f(attrib_angle, 0);
 		glVertexAttrib1f(attrib_scale, 1);
@@ -365,9 +401,9 @@ void RenderQuadNow(GLvector2 pos, SpriteEntry sprite, GLrgba color, float size,
 	Qquad   q;
 
 	if (glow)
-		glBlendFunc(GL_ONE, GL_ONE);
+		GpuBlend(GL_ONE, GL_ONE);
 	else
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	q.position = pos;
 	q.sprite = sprite;
 	q.color = color;
@@ -397,23 +433,23 @@ void RenderPushViewport(int width, int height)
 	glPushMatrix();
 	glLoadIdentity();
 	glTranslatef(0, 0, -1.0f);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_FOG);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_LIGHTING);
+	GpuDisable(GL_CULL_FACE);
+	GpuDisable(GL_FOG);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_LIGHTING);
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glDisable(GL_FOG);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDepthMask(false);
-	glDisable(GL_DEPTH_TEST);
-	glColor3f(1, 1, 1);
+	GpuDisable(GL_FOG);
+	GpuEnable(GL_BLEND);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDepthMask(false);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuColor3f(1, 1, 1);
 }
 
 void RenderPopViewport()
 {
-	glEnable(GL_DEPTH_TEST);
-	glDepthMask(true);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuDepthMask(true);
 	glPopMatrix();
 	glMatrixMode(GL_PROJECTION);
 	glPopMatrix();
@@ -467,19 +503,19 @@ void RenderTexture(Texture* t, GLcoord2 pos, GLcoord2 size)
 	GLcoord2    end;
 
 	end = pos + size;
-	glDepthMask(false);
-	glBlendFunc(GL_ONE, GL_ONE);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glColor3f(1, 1, 1);
-	glBindTexture(GL_TEXTURE_2D, t->Id());
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0, 1);  glVertex2i(pos.x, pos.y);
-	glTexCoord2f(1, 1);  glVertex2i(end.x, pos.y);
-	glTexCoord2f(1, 0);  glVertex2i(end.x, end.y);
-	glTexCoord2f(0, 0);  glVertex2i(pos.x, end.y);
-	glEnd();
+	GpuDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuColor3f(1, 1, 1);
+	GpuTexture(t->Id());
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2f(0, 1);  GpuVertex2i(pos.x, pos.y);
+	GpuTexCoord2f(1, 1);  GpuVertex2i(end.x, pos.y);
+	GpuTexCoord2f(1, 0);  GpuVertex2i(end.x, end.y);
+	GpuTexCoord2f(0, 0);  GpuVertex2i(pos.x, end.y);
+	GpuEnd();
 }
 
 void RenderTexture(Texture* t, GLcoord2 c)
@@ -504,19 +540,19 @@ void RenderTexture(Texture* t, int x, int y, SDL_Rect clip)
 	float end_x = (clip.x + clip.w) / (float)t->Size().x;
 	float end_y = (clip.y + clip.h) / (float)t->Size().y;
 
-	glDepthMask(false);
-	glBlendFunc(GL_ONE, GL_ONE);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glColor3f(1, 1, 1);
-	glBindTexture(GL_TEXTURE_2D, t->Id());
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin(GL_QUADS);
-	glTexCoord2f(start_x, end_y);  glVertex2i(pos.x, pos.y);
-	glTexCoord2f(end_x, end_y);  glVertex2i(end.x, pos.y);
-	glTexCoord2f(end_x, start_y);  glVertex2i(end.x, end.y);
-	glTexCoord2f(start_x, start_y);  glVertex2i(pos.x, end.y);
-	glEnd();
+	GpuDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuColor3f(1, 1, 1);
+	GpuTexture(t->Id());
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2f(start_x, end_y);  GpuVertex2i(pos.x, pos.y);
+	GpuTexCoord2f(end_x, end_y);  GpuVertex2i(end.x, pos.y);
+	GpuTexCoord2f(end_x, start_y);  GpuVertex2i(end.x, end.y);
+	GpuTexCoord2f(start_x, start_y);  GpuVertex2i(pos.x, end.y);
+	GpuEnd();
 }
 
 void RenderTexture(class Texture* t, const int x, const int y, const int w, const int h, const SDL_Rect* clip)
@@ -524,22 +560,22 @@ void RenderTexture(class Texture* t, const int x, const int y, const int w, cons
 	GLcoord2 pos(x, y), size(w, h);
 	GLcoord2 end = pos + size;
 
-	glDepthMask(false);
-	glBlendFunc(GL_ONE, GL_ONE);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glColor3f(1, 1, 1);
-	glBindTexture(GL_TEXTURE_2D, t->Id());
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuColor3f(1, 1, 1);
+	GpuTexture(t->Id());
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	if (clip == nullptr) {
 		//Draw the full texture
-		glBegin(GL_QUADS);
-		glTexCoord2f(0, 1);  glVertex2i(pos.x, pos.y);
-		glTexCoord2f(1, 1);  glVertex2i(end.x, pos.y);
-		glTexCoord2f(1, 0);  glVertex2i(end.x, end.y);
-		glTexCoord2f(0, 0);  glVertex2i(pos.x, end.y);
-		glEnd();
+		GpuBegin(GL_QUADS);
+		GpuTexCoord2f(0, 1);  GpuVertex2i(pos.x, pos.y);
+		GpuTexCoord2f(1, 1);  GpuVertex2i(end.x, pos.y);
+		GpuTexCoord2f(1, 0);  GpuVertex2i(end.x, end.y);
+		GpuTexCoord2f(0, 0);  GpuVertex2i(pos.x, end.y);
+		GpuEnd();
 	}
 	else {
 		float tex_start_x = clip->x / (float)t->Size().x;
@@ -548,12 +584,12 @@ void RenderTexture(class Texture* t, const int x, const int y, const int w, cons
 		float tex_end_x = (clip->x + clip->w) / (float)t->Size().x;
 		float tex_end_y = (clip->y + clip->h) / (float)t->Size().y;
 
-		glBegin(GL_QUADS);
-		glTexCoord2f(tex_start_x, tex_end_y);    glVertex2i(pos.x, pos.y);
-		glTexCoord2f(tex_end_x, tex_end_y);      glVertex2i(end.x, pos.y);
-		glTexCoord2f(tex_end_x, tex_start_y);    glVertex2i(end.x, end.y);
-		glTexCoord2f(tex_start_x, tex_start_y);  glVertex2i(pos.x, end.y);
-		glEnd();
+		GpuBegin(GL_QUADS);
+		GpuTexCoord2f(tex_start_x, tex_end_y);    GpuVertex2i(pos.x, pos.y);
+		GpuTexCoord2f(tex_end_x, tex_end_y);      GpuVertex2i(end.x, pos.y);
+		GpuTexCoord2f(tex_end_x, tex_start_y);    GpuVertex2i(end.x, end.y);
+		GpuTexCoord2f(tex_start_x, tex_start_y);  GpuVertex2i(pos.x, end.y);
+		GpuEnd();
 	}
 }
 
@@ -562,22 +598,22 @@ void RenderTexture(class Texture* t, const int x, const int y, const int w, cons
 	GLcoord2 pos(x, y), size(w, h);
 	GLcoord2 end = pos + size;
 
-	glDepthMask(false);
-	glBlendFunc(GL_ONE, GL_ONE);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glColor4f(alpha, alpha, alpha, alpha);
-	glBindTexture(GL_TEXTURE_2D, t->Id());
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuColor4f(alpha, alpha, alpha, alpha);
+	GpuTexture(t->Id());
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	if (clip == nullptr) {
 		//Draw the full texture
-		glBegin(GL_QUADS);
-		glTexCoord2f(0, 1);  glVertex2i(pos.x, pos.y);
-		glTexCoord2f(1, 1);  glVertex2i(end.x, pos.y);
-		glTexCoord2f(1, 0);  glVertex2i(end.x, end.y);
-		glTexCoord2f(0, 0);  glVertex2i(pos.x, end.y);
-		glEnd();
+		GpuBegin(GL_QUADS);
+		GpuTexCoord2f(0, 1);  GpuVertex2i(pos.x, pos.y);
+		GpuTexCoord2f(1, 1);  GpuVertex2i(end.x, pos.y);
+		GpuTexCoord2f(1, 0);  GpuVertex2i(end.x, end.y);
+		GpuTexCoord2f(0, 0);  GpuVertex2i(pos.x, end.y);
+		GpuEnd();
 	}
 	else {
 		float tex_start_x = clip->x / (float)t->Size().x;
@@ -586,12 +622,12 @@ void RenderTexture(class Texture* t, const int x, const int y, const int w, cons
 		float tex_end_x = (clip->x + clip->w) / (float)t->Size().x;
 		float tex_end_y = (clip->y + clip->h) / (float)t->Size().y;
 
-		glBegin(GL_QUADS);
-		glTexCoord2f(tex_start_x, tex_end_y);    glVertex2i(pos.x, pos.y);
-		glTexCoord2f(tex_end_x, tex_end_y);      glVertex2i(end.x, pos.y);
-		glTexCoord2f(tex_end_x, tex_start_y);    glVertex2i(end.x, end.y);
-		glTexCoord2f(tex_start_x, tex_start_y);  glVertex2i(pos.x, end.y);
-		glEnd();
+		GpuBegin(GL_QUADS);
+		GpuTexCoord2f(tex_start_x, tex_end_y);    GpuVertex2i(pos.x, pos.y);
+		GpuTexCoord2f(tex_end_x, tex_end_y);      GpuVertex2i(end.x, pos.y);
+		GpuTexCoord2f(tex_end_x, tex_start_y);    GpuVertex2i(end.x, end.y);
+		GpuTexCoord2f(tex_start_x, tex_start_y);  GpuVertex2i(pos.x, end.y);
+		GpuEnd();
 	}
 }
 
@@ -601,20 +637,24 @@ void RenderSprite(const int x, const int y, const int w, const int h, SpriteEntr
 	GLcoord2 pos(x, y), size(w, h);
 	GLcoord2 end = pos + size;
 
-	glDepthMask(false);
-	glBlendFunc(GL_ONE, GL_ONE);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glColor3fv(&color.red);
-	glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	glBegin(GL_QUADS);
-	glTexCoord2f(uv->uv[0].x, uv->uv[0].y);  glVertex2i(pos.x, pos.y);
-	glTexCoord2f(uv->uv[1].x, uv->uv[1].y);  glVertex2i(end.x, pos.y);
-	glTexCoord2f(uv->uv[2].x, uv->uv[2].y);  glVertex2i(end.x, end.y);
-	glTexCoord2f(uv->uv[3].x, uv->uv[3].y);  glVertex2i(pos.x, end.y);
-	glEnd();
+	if (BatchActive()) {
+		BatchQuad(SpriteMapTexture(), GLvector2((float)pos.x, (float)pos.y), GLvector2((float)end.x, (float)end.y), uv->uv, GLrgba(color.red, color.green, color.blue));
+		return;
+	}
+	GpuDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuColor3fv(&color.red);
+	GpuTexture(SpriteMapTexture());
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2f(uv->uv[0].x, uv->uv[0].y);  GpuVertex2i(pos.x, pos.y);
+	GpuTexCoord2f(uv->uv[1].x, uv->uv[1].y);  GpuVertex2i(end.x, pos.y);
+	GpuTexCoord2f(uv->uv[2].x, uv->uv[2].y);  GpuVertex2i(end.x, end.y);
+	GpuTexCoord2f(uv->uv[3].x, uv->uv[3].y);  GpuVertex2i(pos.x, end.y);
+	GpuEnd();
 }
 
 /*-----------------------------------------------------------------------------
@@ -626,6 +666,16 @@ bool RenderPointVisible(GLvector2 point)
 	return view_bbox.Contains(point);
 }
 
+//Like RenderPointVisible, but with the view expanded by the given margin on all sides.
+bool RenderPointNear(GLvector2 point, float margin)
+{
+	if (point.x < view_bbox.pmin.x - margin || point.x > view_bbox.pmax.x + margin)
+		return false;
+	if (point.y < view_bbox.pmin.y - margin || point.y > view_bbox.pmax.y + margin)
+		return false;
+	return true;
+}
+
 void RenderOverlay(GLcoord2 pos, GLcoord2 size, int texture, float intensity)
 {
 	GLuvFrame*      uv_screen;
@@ -633,45 +683,45 @@ void RenderOverlay(GLcoord2 pos, GLcoord2 size, int texture, float intensity)
 	GLuvFrame       uv_snow;
 	GLcoord2        end;
 
-	glDepthMask(false);
-	glBlendFunc(GL_ONE, GL_ONE);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
+	GpuDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
 	//glBindTexture (GL_TEXTURE_2D, 0);
 	end = pos + size;
 	uv_screen = SpriteMapLookup(SPRITE_SCREEN);
 	uv_scan = SpriteMapLookup(SPRITE_SCANLINES);
 	uv_snow = *SpriteMapLookup(SPRITE_SNOW);
 	if (texture) {
-		glColor3f(1, 1, 1);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glBegin(GL_QUADS);
-		glTexCoord2f(0, 1);  glVertex2i(pos.x, pos.y);
-		glTexCoord2f(1, 1);  glVertex2i(end.x, pos.y);
-		glTexCoord2f(1, 0);  glVertex2i(end.x, end.y);
-		glTexCoord2f(0, 0);  glVertex2i(pos.x, end.y);
-		glEnd();
+		GpuColor3f(1, 1, 1);
+		GpuTexture(texture);
+		GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GpuBegin(GL_QUADS);
+		GpuTexCoord2f(0, 1);  GpuVertex2i(pos.x, pos.y);
+		GpuTexCoord2f(1, 1);  GpuVertex2i(end.x, pos.y);
+		GpuTexCoord2f(1, 0);  GpuVertex2i(end.x, end.y);
+		GpuTexCoord2f(0, 0);  GpuVertex2i(pos.x, end.y);
+		GpuEnd();
 	}
-	glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
+	GpuTexture(SpriteMapTexture());
 	{
 		GLvector2   snow_size;
 		GLvector2   ul, lr;
 
 		snow_size = uv_snow.Size() / 2;
-		ul = uv_snow.uv[0] - snow_size * (GLvector2(RandomFloat(), RandomFloat()) / 2);
+		ul = uv_snow.uv[0] - snow_size * (GLvector2(RandomChannel(RANDOM_COSMETIC).Float(), RandomChannel(RANDOM_COSMETIC).Float()) / 2);
 		lr = ul - snow_size;
 		ul.y = 1 - ul.y;
 		lr.y = 1 - lr.y;
 		uv_snow.Set(ul, lr);
-		glColor3f(intensity, intensity, intensity);
-		glBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
-		glBegin(GL_QUADS);
-		glTexCoord2fv(&uv_snow.uv[0].x);  glVertex2i(pos.x, pos.y);
-		glTexCoord2fv(&uv_snow.uv[1].x);  glVertex2i(end.x, pos.y);
-		glTexCoord2fv(&uv_snow.uv[2].x);  glVertex2i(end.x, end.y);
-		glTexCoord2fv(&uv_snow.uv[3].x);  glVertex2i(pos.x, end.y);
-		glEnd();
+		GpuColor3f(intensity, intensity, intensity);
+		GpuBlend(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+		GpuBegin(GL_QUADS);
+		GpuTexCoord2fv(&uv_snow.uv[0].x);  GpuVertex2i(pos.x, pos.y);
+		GpuTexCoord2fv(&uv_snow.uv[1].x);  GpuVertex2i(end.x, pos.y);
+		GpuTexCoord2fv(&uv_snow.uv[2].x);  GpuVertex2i(end.x, end.y);
+		GpuTexCoord2fv(&uv_snow.uv[3].x);  GpuVertex2i(pos.x, end.y);
+		GpuEnd();
 	}
 	{
 		int   syncline;
@@ -684,32 +734,32 @@ void RenderOverlay(GLcoord2 pos, GLcoord2 size, int texture, float intensity)
 		delta = ((float)syncline / 5000.0f);
 		linepos = pos.y + (int)(delta * (float)size.y);
 		v = Lerp(uv_scan->uv[2].y, uv_scan->uv[0].y, delta);
-		glColor3f(0.3f, 0.3f, 0.3f);
-		glBlendFunc(GL_ONE, GL_ONE);
-		glBegin(GL_LINES);
-		glTexCoord2f(uv_scan->uv[0].x, v);
-		glVertex2i(pos.x, linepos);
-		glTexCoord2f(uv_scan->uv[1].x, v);
-		glVertex2i(end.x, linepos);
-		glEnd();
+		GpuColor3f(0.3f, 0.3f, 0.3f);
+		GpuBlend(GL_ONE, GL_ONE);
+		GpuBegin(GL_LINES);
+		GpuTexCoord2f(uv_scan->uv[0].x, v);
+		GpuVertex2i(pos.x, linepos);
+		GpuTexCoord2f(uv_scan->uv[1].x, v);
+		GpuVertex2i(end.x, linepos);
+		GpuEnd();
 	}
-	glColor3f(intensity, intensity, intensity);
-	glBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
-	glBegin(GL_QUADS);
-	glTexCoord2fv(&uv_scan->uv[0].x);  glVertex2i(pos.x, pos.y);
-	glTexCoord2fv(&uv_scan->uv[1].x);  glVertex2i(end.x, pos.y);
-	glTexCoord2fv(&uv_scan->uv[2].x);  glVertex2i(end.x, end.y);
-	glTexCoord2fv(&uv_scan->uv[3].x);  glVertex2i(pos.x, end.y);
-	glEnd();
-	glBlendFunc(GL_DST_COLOR, GL_SRC_COLOR);
-	glColor3f(1, 1, 1);
-	glBegin(GL_QUADS);
-	glTexCoord2fv(&uv_screen->uv[0].x);  glVertex2i(pos.x, pos.y);
-	glTexCoord2fv(&uv_screen->uv[1].x);  glVertex2i(end.x, pos.y);
-	glTexCoord2fv(&uv_screen->uv[2].x);  glVertex2i(end.x, end.y);
-	glTexCoord2fv(&uv_screen->uv[3].x);  glVertex2i(pos.x, end.y);
-	glEnd();
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuColor3f(intensity, intensity, intensity);
+	GpuBlend(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2fv(&uv_scan->uv[0].x);  GpuVertex2i(pos.x, pos.y);
+	GpuTexCoord2fv(&uv_scan->uv[1].x);  GpuVertex2i(end.x, pos.y);
+	GpuTexCoord2fv(&uv_scan->uv[2].x);  GpuVertex2i(end.x, end.y);
+	GpuTexCoord2fv(&uv_scan->uv[3].x);  GpuVertex2i(pos.x, end.y);
+	GpuEnd();
+	GpuBlend(GL_DST_COLOR, GL_SRC_COLOR);
+	GpuColor3f(1, 1, 1);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2fv(&uv_screen->uv[0].x);  GpuVertex2i(pos.x, pos.y);
+	GpuTexCoord2fv(&uv_screen->uv[1].x);  GpuVertex2i(end.x, pos.y);
+	GpuTexCoord2fv(&uv_screen->uv[2].x);  GpuVertex2i(end.x, end.y);
+	GpuTexCoord2fv(&uv_screen->uv[3].x);  GpuVertex2i(pos.x, end.y);
+	GpuEnd();
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void RenderCircularBar(float start_angle, float end_angle, float radius, GLvector2 pos, SpriteEntry sprite)
@@ -720,9 +770,9 @@ void RenderCircularBar(float start_angle, float end_angle, float radius, GLvecto
 
 	center = (uv->uv[0] + uv->uv[2]) / 2.0f;
 	uv_radius = uv->Size().x / 2.0f;
-	glBegin(GL_TRIANGLE_FAN);
-	glTexCoord2fv(&center.x);
-	glVertex2fv(&pos.x);
+	GpuBegin(GL_TRIANGLE_FAN);
+	GpuTexCoord2fv(&center.x);
+	GpuVertex2fv(&pos.x);
 	if (end_angle < start_angle)
 		end_angle += 360;
 	for (int a = (int)start_angle; a <= (int)end_angle; a++) {
@@ -730,10 +780,10 @@ void RenderCircularBar(float start_angle, float end_angle, float radius, GLvecto
 		if (angle < 0)
 			angle = 360 + angle;
 		uv_edge = center + (radial[angle] * uv_radius);
-		glTexCoord2fv(&uv_edge.x);
-		glVertex2f(pos.x - radial[angle].x*radius, pos.y - radial[angle].y*radius);
+		GpuTexCoord2fv(&uv_edge.x);
+		GpuVertex2f(pos.x - radial[angle].x*radius, pos.y - radial[angle].y*radius);
 	}
-	glEnd();
+	GpuEnd();
 }
 
 void RenderCircularBar(Texture* t, int start_angle, int end_angle, float radius, GLcoord2 pos_in)
@@ -741,24 +791,24 @@ void RenderCircularBar(Texture* t, int start_angle, int end_angle, float radius,
 	GLvector2 pos;
 
 	pos = pos_in;
-	t->Bind();
+	GpuTexture(t->Id());
 
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glColor3f(1, 1, 1);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuColor3f(1, 1, 1);
 
-	glBegin(GL_TRIANGLE_FAN);
-	glTexCoord2f(0.5f, 0.5f);
-	glVertex2fv(&pos.x);
+	GpuBegin(GL_TRIANGLE_FAN);
+	GpuTexCoord2f(0.5f, 0.5f);
+	GpuVertex2fv(&pos.x);
 	if (end_angle < start_angle)
 		end_angle += 360;
 	for (int a = start_angle; a <= end_angle; a++) {
 		int   angle = a % 360;
 		if (angle < 0)
 			angle = 360 + angle;
-		glTexCoord2fv(&radial_uv[angle].x);
-		glVertex2f(pos.x + radial[angle].x*radius, pos.y + radial[angle].y*radius);
+		GpuTexCoord2fv(&radial_uv[angle].x);
+		GpuVertex2f(pos.x + radial[angle].x*radius, pos.y + radial[angle].y*radius);
 	}
-	glEnd();
+	GpuEnd();
 }
 
 void RenderCompile()
@@ -810,23 +860,26 @@ void Render()
 	wglSwapIntervalEXT(EnvValueb(ENV_VSYNC));
 #endif
 
+	GpuFrame();
+	BatchFrame();
+	GpuPass("Setup");
 	quads_this_frame = 0;
 	//Set up all the different OpenGL state variables.
-	glStencilMask(0xff);
+	GpuStencilMask(0xff);
 	glClearStencil(0);
-	glStencilMask(0x0);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_FOG);
-	glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LEQUAL);
+	GpuStencilMask(0x0);
+	GpuDisable(GL_CULL_FACE);
+	GpuDisable(GL_FOG);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuDepthFunc(GL_LEQUAL);
 	glLineWidth(3.0f);
 	glPointSize(4.0f);
 	glAlphaFunc(GL_GREATER, 0.05f);
-	glEnable(GL_ALPHA_TEST);
+	GpuEnable(GL_ALPHA_TEST);
 	glMatrixMode(GL_PROJECTION);
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_DEPTH_TEST);
-	glDepthMask(true);
+	GpuEnable(GL_TEXTURE_2D);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuDepthMask(true);
 	glLoadIdentity();
 	gluPerspective(90, view_aspect, 0.01, 1000);
 	glMatrixMode(GL_MODELVIEW);
@@ -836,21 +889,28 @@ void Render()
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 	GameRender();
 
+	GpuPass("Interface");
 	s = RenderViewportSize();
 	RenderPushViewport(s.x, s.y);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glUseProgramObjectARB(0);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuProgram(0);
 	rendering_2d = true;
+	//Interface images and text are collected and drawn a layer at a time.
+	BatchBegin();
 	WorldRender2D();
+	BatchFlush();
 	HudRender2D();
+	BatchFlush();
 	MenuRender2D();
+	BatchFlush();
 	InterfaceRender2D();
+	BatchEnd();
 	MouseRender();
 	RenderPopViewport();
 	ConsoleRender();
 	rendering_2d = false;
-	glUseProgramObjectARB(my_program);
+	GpuProgram(my_program);
 }
 
 void	RenderTriangle(GLvector* v)
@@ -869,17 +929,17 @@ void	RenderTriangles()
 	if (stri_count == 0)
 		return;
 	glFlush();
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glColor3f(0, 0, 0);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuTexture(0);
+	GpuColor3f(0, 0, 0);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//Enable the vertex array functionality:
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glVertexPointer(3, GL_FLOAT, sizeof(GLvector), stri_vert);
-	glDrawElements(GL_TRIANGLES, //mode
+	GpuDrawElements(GL_TRIANGLES, //mode
 		stri_count * 3,  //count, ie. how many indices
 		GL_UNSIGNED_INT, //type of the index array
 		stri_index);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	stri_count = 0;
-	glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
+	GpuTexture(SpriteMapTexture());
 }
\ No newline at end of file
@@ -16,6 +16,7 @@ void      RenderListEnd();
 void      RenderListCall(int owner, int index);
 void      RenderOverlay(GLcoord2 pos, GLcoord2 size, int texture, float intensity);
 inline bool      RenderPointVisible (GLvector2 point);
+bool      RenderPointNear (GLvector2 point, float margin);
 void      RenderPushViewport(int width, int height);
 void      RenderPopViewport();
 void      RenderQuads();
@@ -27,6 +28,8 @@ void			RenderTriangle (GLvector* v);
 void			RenderTriangles ();
 GLcoord2  RenderViewportSize();
 void      RenderResize(int width, int height);
+bool      RenderShaderActive();
+unsigned  RenderDustProgram();
 void      RenderTexture(class Texture* t, GLcoord2 c);
 void      RenderTexture(class Texture* t, GLcoord2 c, GLcoord2 size);
 void      RenderTexture(class Texture* t, int x, int y);
@@ -0,0 +1,516 @@
+/*-----------------------------------------------------------------------------
+
+  Replay.cpp
+
+  Records a play session (random seed, gameplay settings, and the input state
+  at the end of every frame) and plays it back. During playback, live input
+  is ignored and the main loop is timed section by section, so the same
+  session can be run again and again to compare performance. A hash of the
+  game state is stored at regular checkpoints, so playback can also tell
+  when the simulation has stopped being deterministic.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include "console.h"
+#include "entity.h"
+#include "env.h"
+#include "file.h"
+#include "game.h"
+#include "input.h"
+#include "noise.h"
+#include "player.h"
+#include "random.h"
+#include "replay.h"
+#include "robot.h"
+#include "system.h"
+
+#define REPLAY_MAGIC        "GRRP"
+#define REPLAY_VERSION      2
+#define REPLAY_EXT          ".rep"
+#define REPLAY_CHECKPOINT   (FRAMERATE * 5) //Hash the game state this often.
+
+//Input that isn't part of the control array gets recorded under these ids.
+#define ID_MOUSE_MOVE       (MAX_KEYS + 0)
+#define ID_MOUSE_POS        (MAX_KEYS + 1)
+#define ID_JOYSTICK         (MAX_KEYS + 2)
+#define ID_LAST_PRESSED     (MAX_KEYS + 3)
+#define ID_CONSOLE          (MAX_KEYS + 4)
+
+#define FLAG_DOWN           1
+#define FLAG_PRESSED        2
+
+enum ReplayMode
+{
+	MODE_NONE,
+	MODE_RECORD,
+	MODE_PLAY,
+};
+
+//Settings that change how the game plays, and so must match during playback.
+static EnvId    setting_id[] =
+{
+	ENV_SAFETY,
+	ENV_NODIE,
+	ENV_NODAMAGE,
+	ENV_NOCLIP,
+	ENV_AI,
+	ENV_SHOTS_RELATIVE,
+	ENV_MOUSE_SPEED,
+	ENV_GORG,
+	ENV_KFA,
+	ENV_CONTROLLER_ALT,
+};
+
+#define SETTING_COUNT       (sizeof (setting_id) / sizeof (EnvId))
+
+static const char*    timer_name[REPLAY_TIME_COUNT] =
+{
+	"Game", "Player", "Particles", "World", "System", "Render", "Swap",
+};
+
+struct ReplaySetting
+{
+	int             vbool;
+	float           vfloat;
+	int             vint;
+};
+
+struct ReplayHeader
+{
+	char            magic[4];
+	int             version;
+	unsigned        seed;
+	int             character;
+	int             game_mode;
+	int             difficulty;
+	int             screen_x;
+	int             screen_y;
+	int             frames;
+	int             changes;
+	int             checkpoints;
+	ReplaySetting   setting[SETTING_COUNT];
+};
+
+//One piece of input that changed on the given frame.
+struct ReplayChange
+{
+	int             frame;
+	short           id;
+	short           flags;
+	int             value;
+	int             extra;
+};
+
+struct ReplayCheckpoint
+{
+	int             frame;
+	unsigned        hash;
+};
+
+//Everything the game reads from the input layer.
+struct ReplayState
+{
+	InputControl    control[MAX_KEYS];
+	GLcoord2        mouse_move;
+	GLcoord2        mouse_pos;
+	bool            joystick;
+	int             last_pressed;
+	bool            console;
+};
+
+struct ReplayTiming
+{
+	double          total;
+	double          worst;
+};
+
+static ReplayMode                 mode;
+static string                     replay_file;
+static ReplayHeader               header;
+static vector<ReplayChange>       changes;
+static vector<ReplayCheckpoint>   checkpoints;
+static ReplayState                shadow;
+static ReplaySetting              user_setting[SETTING_COUNT];
+static int                        frame;
+static unsigned                   next_change;
+static unsigned                   next_checkpoint;
+static int                        desync_frame;
+static ReplayTiming               timing[REPLAY_TIME_COUNT];
+static Uint64                     time_mark;
+static Uint64                     time_begin;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static ReplaySetting setting_get(EnvId id)
+{
+	ReplaySetting   s;
+
+	s.vbool = EnvValueb(id) ? 1 : 0;
+	s.vfloat = EnvValuef(id);
+	s.vint = EnvValuei(id);
+	return s;
+}
+
+static void setting_set(EnvId id, ReplaySetting s)
+{
+	EnvValueSetb(id, s.vbool != 0);
+	EnvValueSetf(id, s.vfloat);
+	EnvValueSeti(id, s.vint);
+}
+
+static void state_capture(ReplayState& s)
+{
+	for (int i = 0; i < MAX_KEYS; i++)
+		s.control[i] = InputControlGet(i);
+	s.mouse_move = InputMousePending();
+	s.mouse_pos = SystemMouse();
+	s.joystick = InputJoystickActive();
+	//Reading the last key clears it, so put it back.
+	s.last_pressed = InputLastPressed();
+	InputLastPressedSet(s.last_pressed);
+	s.console = ConsoleIsOpen();
+}
+
+static void state_apply(const ReplayState& s)
+{
+	for (int i = 0; i < MAX_KEYS; i++)
+		InputControlSet(i, s.control[i]);
+	InputMousePendingSet(s.mouse_move);
+	SystemMouseSet(s.mouse_pos);
+	InputJoystickActiveSet(s.joystick);
+	InputLastPressedSet(s.last_pressed);
+	if (ConsoleIsOpen() != s.console)
+		ConsoleToggle();
+}
+
+static void change_add(short id, short flags, int value, int extra)
+{
+	ReplayChange    c;
+
+	c.frame = frame;
+	c.id = id;
+	c.flags = flags;
+	c.value = value;
+	c.extra = extra;
+	changes.push_back(c);
+}
+
+//Store whatever input differs from last frame.
+static void state_diff(ReplayState& prev, const ReplayState& now)
+{
+	for (int i = 0; i < MAX_KEYS; i++) {
+		const InputControl& a = prev.control[i];
+		const InputControl& b = now.control[i];
+		int                 bits;
+
+		if (a.down == b.down && a.pressed == b.pressed && a.value == b.value && a.valuef == b.valuef)
+			continue;
+		memcpy(&bits, &b.valuef, sizeof(bits));
+		change_add(i, (b.down ? FLAG_DOWN : 0) | (b.pressed ? FLAG_PRESSED : 0), b.value, bits);
+	}
+	if (!(prev.mouse_move == now.mouse_move))
+		change_add(ID_MOUSE_MOVE, 0, now.mouse_move.x, now.mouse_move.y);
+	if (!(prev.mouse_pos == now.mouse_pos))
+		change_add(ID_MOUSE_POS, 0, now.mouse_pos.x, now.mouse_pos.y);
+	if (prev.joystick != now.joystick)
+		change_add(ID_JOYSTICK, 0, now.joystick ? 1 : 0, 0);
+	if (prev.last_pressed != now.last_pressed)
+		change_add(ID_LAST_PRESSED, 0, now.last_pressed, 0);
+	if (prev.console != now.console)
+		change_add(ID_CONSOLE, 0, now.console ? 1 : 0, 0);
+	prev = now;
+}
+
+static void change_apply(ReplayState& s, const ReplayChange& c)
+{
+	if (c.id < MAX_KEYS) {
+		InputControl&   ctrl = s.control[c.id];
+
+		ctrl.down = (c.flags & FLAG_DOWN) != 0;
+		ctrl.pressed = (c.flags & FLAG_PRESSED) != 0;
+		ctrl.value = c.value;
+		memcpy(&ctrl.valuef, &c.extra, sizeof(ctrl.valuef));
+		return;
+	}
+	switch (c.id) {
+	case ID_MOUSE_MOVE:   s.mouse_move = GLcoord2(c.value, c.extra); break;
+	case ID_MOUSE_POS:    s.mouse_pos = GLcoord2(c.value, c.extra); break;
+	case ID_JOYSTICK:     s.joystick = c.value != 0; break;
+	case ID_LAST_PRESSED: s.last_pressed = c.value; break;
+	case ID_CONSOLE:      s.console = c.value != 0; break;
+	}
+}
+
+//FNV-1a over the parts of the game state that any desync would disturb.
+static void hash_add(unsigned& hash, const void* data, int size)
+{
+	const unsigned char*  c = (const unsigned char*)data;
+
+	for (int i = 0; i < size; i++) {
+		hash ^= c[i];
+		hash *= 16777619u;
+	}
+}
+
+static unsigned state_hash()
+{
+	unsigned      hash = 2166136261u;
+	GLvector2     pos;
+	unsigned long rand_state;
+	long          score;
+	int           shields;
+	int           count;
+
+	pos = PlayerPosition();
+	hash_add(hash, &pos, sizeof(pos));
+	score = Player()->Score();
+	hash_add(hash, &score, sizeof(score));
+	shields = Player()->Shields();
+	hash_add(hash, &shields, sizeof(shields));
+	rand_state = RandomState();
+	hash_add(hash, &rand_state, sizeof(rand_state));
+	count = EntityRobotCount();
+	hash_add(hash, &count, sizeof(count));
+	for (int i = 0; i < count; i++) {
+		pos = EntityRobot(i)->Position();
+		hash_add(hash, &pos, sizeof(pos));
+	}
+	return hash;
+}
+
+static void do_checkpoint()
+{
+	ReplayCheckpoint    cp;
+
+	cp.frame = frame;
+	cp.hash = state_hash();
+	if (mode == MODE_RECORD) {
+		checkpoints.push_back(cp);
+		return;
+	}
+	if (next_checkpoint >= checkpoints.size())
+		return;
+	if (checkpoints[next_checkpoint].hash != cp.hash && desync_frame < 0) {
+		desync_frame = frame;
+		Console("Replay: Game state diverged from the recording at frame %d.", frame);
+	}
+	next_checkpoint++;
+}
+
+static void do_report()
+{
+	double      seconds;
+	string      report;
+
+	seconds = (double)(SDL_GetPerformanceCounter() - time_begin) / (double)SDL_GetPerformanceFrequency();
+	report = StringSprintf("Replay %s: %d frames in %1.2f seconds (%1.1f fps).\n", replay_file.c_str(), frame, seconds, frame / max(seconds, 0.001));
+	for (int i = 0; i < REPLAY_TIME_COUNT; i++)
+		report += StringSprintf("%-10s avg %6.3fms  worst %6.3fms\n", timer_name[i], timing[i].total / max(frame, 1), timing[i].worst);
+	if (desync_frame < 0)
+		report += StringSprintf("All %d checkpoints matched.\n", next_checkpoint);
+	else
+		report += StringSprintf("DESYNC at frame %d.\n", desync_frame);
+	vector<string> lines = StringSplit(report, "\n");
+	for (unsigned i = 0; i < lines.size(); i++)
+		Console("%s", lines[i].c_str());
+	FileSave(replay_file + ".txt", report.c_str(), report.size());
+}
+
+static bool do_load(string filename)
+{
+	char*     buffer;
+	char*     scan;
+	long      size;
+	long      expected;
+
+	buffer = FileContentsBinary(filename, &size);
+	if (!buffer) {
+		Console("Replay: Unable to open %s.", filename.c_str());
+		return false;
+	}
+	if (size < (long)sizeof(ReplayHeader)) {
+		free(buffer);
+		Console("Replay: %s is not a replay.", filename.c_str());
+		return false;
+	}
+	memcpy(&header, buffer, sizeof(header));
+	expected = sizeof(ReplayHeader) + header.changes * sizeof(ReplayChange) + header.checkpoints * sizeof(ReplayCheckpoint);
+	if (memcmp(header.magic, REPLAY_MAGIC, 4) || header.version != REPLAY_VERSION || size != expected) {
+		free(buffer);
+		Console("Replay: %s is not a compatible replay.", filename.c_str());
+		return false;
+	}
+	scan = buffer + sizeof(ReplayHeader);
+	changes.resize(header.changes);
+	if (header.changes)
+		memcpy(&changes[0], scan, header.changes * sizeof(ReplayChange));
+	scan += header.changes * sizeof(ReplayChange);
+	checkpoints.resize(header.checkpoints);
+	if (header.checkpoints)
+		memcpy(&checkpoints[0], scan, header.checkpoints * sizeof(ReplayCheckpoint));
+	free(buffer);
+	return true;
+}
+
+static void do_save()
+{
+	vector<char>  out;
+
+	header.frames = frame;
+	header.changes = changes.size();
+	header.checkpoints = checkpoints.size();
+	out.insert(out.end(), (char*)&header, (char*)&header + sizeof(header));
+	if (!changes.empty())
+		out.insert(out.end(), (char*)&changes[0], (char*)&changes[0] + changes.size() * sizeof(ReplayChange));
+	if (!checkpoints.empty())
+		out.insert(out.end(), (char*)&checkpoints[0], (char*)&checkpoints[0] + checkpoints.size() * sizeof(ReplayCheckpoint));
+	if (FileSave(replay_file, &out[0], out.size()))
+		Console("Replay: Saved %d frames (%u input changes) to %s.", frame, (unsigned)changes.size(), replay_file.c_str());
+	else
+		Console("Replay: Unable to write %s.", replay_file.c_str());
+}
+
+//Put the game into the same starting state for recording and playback.
+static void do_start()
+{
+	for (unsigned i = 0; i < SETTING_COUNT; i++)
+		user_setting[i] = setting_get(setting_id[i]);
+	if (ConsoleIsOpen())
+		ConsoleToggle();
+	shadow = ReplayState();
+	frame = 0;
+	next_change = 0;
+	next_checkpoint = 0;
+	desync_frame = -1;
+	memset(timing, 0, sizeof(timing));
+	RandomInit(header.seed);
+	NoiseSeed(header.seed);
+	EnvSetDifficulty(header.difficulty != 0);
+	GameNew(header.character, (eGameMode)header.game_mode);
+	time_begin = time_mark = SDL_GetPerformanceCounter();
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+bool ReplayActive() { return mode != MODE_NONE; }
+bool ReplayPlaying() { return mode == MODE_PLAY; }
+
+void ReplayRecord(string filename, unsigned long seed)
+{
+	ReplayStop();
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, REPLAY_MAGIC, 4);
+	header.version = REPLAY_VERSION;
+	header.seed = (unsigned)seed;
+	header.character = GameRunning() ? Player()->Character() : 0;
+	header.game_mode = GameRunning() ? Player()->GameMode() : GAME_STORY;
+	header.difficulty = Player()->DifficultyGet() ? 1 : 0;
+	header.screen_x = SystemSize().x;
+	header.screen_y = SystemSize().y;
+	for (unsigned i = 0; i < SETTING_COUNT; i++)
+		header.setting[i] = setting_get(setting_id[i]);
+	changes.clear();
+	checkpoints.clear();
+	replay_file = filename;
+	do_start();
+	mode = MODE_RECORD;
+	Console("Replay: Recording to %s with seed %d.", filename.c_str(), header.seed);
+}
+
+void ReplayPlay(string filename)
+{
+	ReplayStop();
+	if (!do_load(filename))
+		return;
+	if (header.screen_x != SystemSize().x || header.screen_y != SystemSize().y)
+		Console("Replay: Recorded at %dx%d. Mouse aim may not match at this resolution.", header.screen_x, header.screen_y);
+	replay_file = filename;
+	do_start();
+	for (unsigned i = 0; i < SETTING_COUNT; i++)
+		setting_set(setting_id[i], header.setting[i]);
+	mode = MODE_PLAY;
+	Console("Replay: Playing %s, %d frames.", filename.c_str(), header.frames);
+}
+
+void ReplayStop()
+{
+	if (mode == MODE_RECORD)
+		do_save();
+	if (mode == MODE_PLAY) {
+		do_report();
+		for (unsigned i = 0; i < SETTING_COUNT; i++)
+			setting_set(setting_id[i], user_setting[i]);
+	}
+	mode = MODE_NONE;
+}
+
+//Called once per frame, right after the system has gathered input.
+void ReplayInput()
+{
+	ReplayState   now;
+
+	if (mode == MODE_NONE)
+		return;
+	if (mode == MODE_RECORD) {
+		state_capture(now);
+		state_diff(shadow, now);
+	}
+	else {
+		if (frame >= header.frames) {
+			ReplayStop();
+			return;
+		}
+		while (next_change < changes.size() && changes[next_change].frame <= frame)
+			change_apply(shadow, changes[next_change++]);
+		state_apply(shadow);
+	}
+	if (frame % REPLAY_CHECKPOINT == 0)
+		do_checkpoint();
+	frame++;
+}
+
+//Charge the time since the last call to the given section of the frame.
+void ReplayTime(ReplayTimer section)
+{
+	Uint64    now;
+	double    ms;
+
+	if (mode != MODE_PLAY)
+		return;
+	now = SDL_GetPerformanceCounter();
+	ms = (double)(now - time_mark) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+	time_mark = now;
+	timing[section].total += ms;
+	timing[section].worst = max(timing[section].worst, ms);
+}
+
+bool ReplayHandleCommand(const vector<string> &words)
+{
+	string    filename;
+
+	if (words.empty())
+		return false;
+	if (_stricmp(words[0].c_str(), "record") && _stricmp(words[0].c_str(), "replay"))
+		return false;
+	if (words.size() < 2) {
+		if (ReplayActive())
+			ReplayStop();
+		else
+			Console("Usage: record <name> [seed] / replay <name>");
+		return true;
+	}
+	filename = SystemSavePath() + words[1] + REPLAY_EXT;
+	if (!_stricmp(words[0].c_str(), "record"))
+		ReplayRecord(filename, words.size() > 2 ? atoi(words[2].c_str()) : SystemTick());
+	else
+		ReplayPlay(filename);
+	return true;
+}
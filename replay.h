@@ -0,0 +1,26 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+//Sections of the main loop that are timed during playback.
+enum ReplayTimer
+{
+	REPLAY_TIME_GAME,
+	REPLAY_TIME_PLAYER,
+	REPLAY_TIME_PARTICLES,
+	REPLAY_TIME_WORLD,
+	REPLAY_TIME_SYSTEM,
+	REPLAY_TIME_RENDER,
+	REPLAY_TIME_SWAP,
+	REPLAY_TIME_COUNT
+};
+
+bool          ReplayActive();
+bool          ReplayPlaying();
+bool          ReplayHandleCommand(const vector<string> &words);
+void          ReplayInput();
+void          ReplayPlay(string filename);
+void          ReplayRecord(string filename, unsigned long seed);
+void          ReplayStop();
+void          ReplayTime(ReplayTimer section);
+
+#endif // REPLAY_H
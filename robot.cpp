@@ -15,8 +15,10 @@
 #include "drop.h"
 #include "entity.h"
 #include "env.h"
+#include "flowfield.h"
 #include "fx.h"
 #include "game.h"
+#include "gpu.h"
 #include "particle.h"
 #include "player.h"
 #include "projectile.h"
@@ -24,6 +26,7 @@
 #include "render.h"
 #include "robot.h"
 #include "page.h"
+#include "spawn.h"
 #include "sprite.h"
 #include "world.h"
 
@@ -57,6 +60,13 @@ static float							bob[BOB_CYCLE];
 
 -----------------------------------------------------------------------------*/
 
+//These cores run straight at the player, so they can follow the flow field
+//around walls instead of bumping along them.
+static bool core_follows_flow(AiCore core)
+{
+	return core == AI_BEELINE || core == AI_POUNCE || core == AI_HITNRUN;
+}
+
 static void do_init()
 {
 	GLvector2   corners[4];
@@ -379,6 +389,8 @@ void Robot::Init(GLvector2 position, string type)
 	_is_hanging = false;
 	_is_pained = false;
 	_is_instakilled = false;
+	_is_onscreen = false;
+	_detail = DETAIL_FULL;
 	_ai_state = AI_IDLE;
 	_ai_speed = 0;
 	_xp = _config->xp_value;
@@ -404,6 +416,10 @@ void Robot::Init(GLvector2 position, string type)
 	//Make sure we didn't spawn inside a wall.
 	if (!_is_burrowed && !_is_hanging)
 		FindOpenSpot();
+	//Robots that spawn out of view go dormant and skip the body update, so
+	//bring the body along to wherever we ended up and set the hit box now.
+	DoBodyCoarse();
+	DoBbox();
 }
 
 bool Robot::Hit(GLvector2 pos, bool& take_damage)
@@ -446,8 +462,8 @@ void Robot::DropPowerups()
 		drop_location = _bore_point;
 	drop_coins = _xp;
 	//Drop a few extra coins, just to keep the player guessing.
-	if (RandomRoll(20))
-		drop_coins += RandomVal() % 5;
+	if (RandomChannel(RANDOM_LOOT).Roll(20))
+		drop_coins += RandomChannel(RANDOM_LOOT).Val() % 5;
 	EntityXpAdd(drop_location, drop_coins);
 	/*
 	//If this robot can drop weapons...
@@ -511,7 +527,7 @@ void Robot::Die()
 		particle_count = clamp(particle_count, 2, 10);
 		AudioPlay(_config->sound_die, SoundOrigin());
 		ParticleDebris(_position, _config->size / 1.5f, particle_count, 2.0f + _config->speed * 100.0f);
-		ParticleDebris(_position, _config->size / 1.5f, particle_count, 100.0f * RandomFloat());
+		ParticleDebris(_position, _config->size / 1.5f, particle_count, 100.0f * RandomChannel(RANDOM_COSMETIC).Float());
 	}
 	_legs.clear();
 	_death_momentum = _at_movement;
@@ -630,21 +646,16 @@ void Robot::FaceTarget()
 	_angle = 360 - syMathAngle(_ai_move[MOVE_FORWARD].x, _ai_move[MOVE_FORWARD].y, 0, 0);
 }
 
-bool Robot::TryCollide(GLvector2 new_pos, bool avoid_walls)
+bool Robot::TryCollide(GLvector2 new_pos)
 {
-	//Don't even let us get near walls...
-	if (avoid_walls)
-		return !WorldCellEmpty(new_pos);
-	//Regular collision with walls...
 	return Collision(new_pos);
 }
 
-bool Robot::TryMove(int dir, GLvector2* new_pos)
+//How far moving in the given direction would carry us this tick.
+GLvector2 Robot::MoveVector(int dir)
 {
 	GLvector2 move;
-	float     radius;
 
-	radius = _config->size;
 	move = GLvector2(0, 0);
 	if (dir == AI_FORWARD)
 		move = _ai_move[MOVE_FORWARD];
@@ -664,43 +675,46 @@ bool Robot::TryMove(int dir, GLvector2* new_pos)
 		float  slow = 1.0f - (float)(_cooldown_pain - GameTick()) / PAIN_TIME;
 		move *= 0.3f + slow * 0.7f;
 	}
-	*new_pos = _position + move;
-	if (_config->is_boss)
-		return Collision(*new_pos, radius);
-	return TryCollide(*new_pos, dir == AI_REVERSE);
+	return move;
 }
 
+//Move the way the AI wants to go, sliding along any wall in the way. The
+//whole move is swept, so a fast robot can't skip through a thin wall. If
+//we hit something, we try the next direction on the AI's list next time.
 void Robot::DoMove()
 {
-	GLvector2   new_pos;
+	GLvector2   move;
+	GLvector2   wall;
+	float       radius;
+	int         dir;
 	bool        bump;
-	bool				first_choice;
-	bool				backing_up;
-
-	bump = true;
-	first_choice = true;
-	backing_up = false;
-	if (_ai_state != AI_IDLE)
-		bump = TryMove(_ai_state, &new_pos);
-	if (bump) {
-		for (int j = 0; j < 4; j++) {
-			bump = TryMove(_ai_priorities[j], &new_pos);
-			//If we hit a wall trying to move one way, try the other next time.
-			if (bump && _ai_priorities[j] == AI_SIDE)
-				_ai_flip = !_ai_flip;
-			if (!bump) {
-				//_ai_cooldown = GameTick () + 1000;
-				_ai_state = _ai_priorities[j];
-				if (_ai_priorities[j] == AI_REVERSE)
-					backing_up = true;
-				break;
-			}
-			first_choice = false;
+
+	dir = _ai_state;
+	if (dir == AI_IDLE)
+		dir = _ai_priorities[0];
+	move = MoveVector(dir);
+	//Only bosses are big enough for their size to matter.
+	radius = _config->is_boss ? _config->size : 0.0f;
+	//Backing up keeps us out of cells with any wall in them at all. Bosses
+	//back up like they move any other way.
+	if (dir == AI_REVERSE && !_config->is_boss && !WorldCellEmpty(_position + move))
+		bump = true;
+	else
+		bump = CollisionMove(&_position, &move, radius, COLLISION_SLIDE, &wall);
+	_ai_state = dir;
+	if (!bump)
+		return;
+	//If we hit a wall trying to move one way, try the other next time.
+	if (dir == AI_SIDE)
+		_ai_flip = !_ai_flip;
+	_ai_state = _ai_priorities[0];
+	for (int j = 0; j < 4; j++) {
+		if (_ai_priorities[j] == dir) {
+			_ai_state = _ai_priorities[(j + 1) % 4];
+			break;
 		}
 	}
-	if (!bump)
-		_position = new_pos;
-	if (!first_choice && !backing_up) { //We knocked the wall. Throw off some rubble.
+	if (dir != AI_REVERSE) { //We knocked the wall. Throw off some rubble.
 		//ParticleRubble(_position, 0.1f, 4);
 		AudioPlay("collide", _position);
 	}
@@ -842,8 +856,8 @@ void Robot::DoFire()
 			else { //Launching a robot.
 				Robot       bot;
 
-				//Only spawn a new bot if we're under the limit.
-				if (_children < _config->max_children) {
+				//Only spawn a new bot if we're under the limit, and so is the world.
+				if (_children < _config->max_children && SpawnRoom()) {
 					bot.Init(_position, _pew_pew[i].robot_id);
 					bot.ParentSet(_id);
 					bot.Launch(_ai_move[MOVE_SIDE]);
@@ -898,6 +912,23 @@ void Robot::DoBbox()
 	}
 }
 
+//Move the body parts rigidly along with the head, without any animation or legwork.
+void Robot::DoBodyCoarse()
+{
+	GLvector2     delta;
+
+	if (_is_burrowed || _is_hanging)
+		return;
+	delta = _position - _sprite[0].Position();
+	if (delta.IsZero())
+		return;
+	for (int i = 0; i < _body_part_count; i++)
+		_sprite[i].Move(_sprite[i].Position() + delta, _sprite[i].Angle());
+	for (unsigned i = 0; i < _wp_sprite.size(); i++)
+		_wp_sprite[i].Move(_wp_sprite[i].Position() + delta, _wp_sprite[i].Angle());
+	DoBbox();
+}
+
 void Robot::DoBody()
 {
 	int           i;
@@ -1111,6 +1142,11 @@ void Robot::Update()
 		}
 	}
 
+	DoDetail();
+	//Dormant bots haven't spotted the player and can't until they're onscreen,
+	//so there's nothing for them to do. Damage will still Alert () them.
+	if (_detail == DETAIL_DORMANT)
+		return;
 	if (PlayerIgnore())
 		_ai_state = AI_WANDER;
 	_impact_kick *= KICK_RECOVERY;
@@ -1120,6 +1156,7 @@ void Robot::Update()
 	//Turn this into a small movement and apply it before we do any other thinking.
 	if (!_shove.IsZero()) {
 		GLvector2   nudge;
+		GLvector2   wall;
 
 		_shove.Normalize();
 		_shove *= SHOVE_POWER;
@@ -1133,8 +1170,10 @@ void Robot::Update()
 			if (floor(_position.y) != floor(nudge.y))
 				nudge = _position;
 		}
-		if (!Collision(nudge, _config->size))
-			_position = nudge;
+		//Slide along any wall in the way rather than being stopped dead by it.
+		//Walkers just stop, since sliding could still carry them into a new cell.
+		nudge -= _position;
+		CollisionMove(&_position, &nudge, _config->size, _config->ai_core == AI_WALK ? 0.0f : COLLISION_SLIDE, &wall);
 		_shove = GLvector2();
 	}
 	//Bob up and down slowly.
@@ -1171,18 +1210,26 @@ void Robot::Update()
 	}
 
 	if (_is_alerted && !_is_dead && EnvValueb(ENV_AI)) { //Alerted, do AI stuff
+		GLvector2   flow;
+		bool        follow_flow = false;
+
 		//See if we should be chasing our parent robot...
 		if (_config->is_follower && _parent) {
 			Robot*		momma = EntityRobotFromId(_parent);
 			_ai_move[MOVE_FORWARD] = momma->Position() - _position;
 		}
-		else //Just chase the player
+		else { //Just chase the player
 			_ai_move[MOVE_FORWARD] = PlayerPosition() - _position;
+			if (core_follows_flow(_config->ai_core) && !_config->is_boss)
+				follow_flow = FlowFieldDirection(_position, &flow);
+		}
 		_ai_move[MOVE_WANDER] = ordinal_direction[_id % 8] * _ai_speed;
 		_ai_goal_distance = _ai_move[MOVE_FORWARD].Length();
 		_ai_player_distance = GLvector2(PlayerPosition() - _position).Length();
 		_ai_move[MOVE_FORWARD].Normalize();
 		_at_player = _ai_move[MOVE_FORWARD];
+		if (follow_flow)
+			_ai_move[MOVE_FORWARD] = flow;
 		_ai_move[MOVE_FORWARD] *= _ai_speed;
 		_ai_move[MOVE_REVERSE] = _ai_move[MOVE_FORWARD] * -1;
 		//Some bots prefer to turn right first...
@@ -1212,10 +1259,30 @@ void Robot::Update()
 	_angle += _death_spin;
 	_at_movement = _position - old_pos;
 	_inertia = _position - old_pos;
+	//Offscreen bots don't need to animate. Just carry the body along so we can still be shot,
+	//and it will snap into place once we're back in view.
+	if (_detail != DETAIL_FULL) {
+		DoBodyCoarse();
+		return;
+	}
 	DoBody();
 	MoveEye();
 }
 
+//Decide how much of the update cycle we need this frame.
+void Robot::DoDetail()
+{
+	float     margin;
+
+	margin = _config->size * ROBOT_DETAIL_MARGIN;
+	if (_config->is_boss || RenderPointNear(_position, margin))
+		_detail = DETAIL_FULL;
+	else if (_is_alerted || _is_dead || _parent || _children)
+		_detail = DETAIL_COARSE;
+	else
+		_detail = DETAIL_DORMANT;
+}
+
 //This is called when it's time to make a proximity beep.
 void Robot::DoProximity()
 {
@@ -1320,10 +1387,10 @@ void Robot::RenderBody()
 		RenderQuad(_sprite[0].Position(), SPRITE_GLOW, GLrgba(1, 0.3f, 0.3f), 0.1f, 2, 0, true);
 	}
 	if (EnvValueb(ENV_BBOX)) {
-		glColor3f(1, 1, 0);
-		glDisable(GL_TEXTURE_2D);
+		GpuColor3f(1, 1, 0);
+		GpuDisable(GL_TEXTURE_2D);
 		_bbox.Render();
-		glEnable(GL_TEXTURE_2D);
+		GpuEnable(GL_TEXTURE_2D);
 	}
 #ifdef _DEBUG
 	RenderDebug();
@@ -1350,19 +1417,19 @@ void Robot::RenderPain()
 		return;
 	if (GameFrame() % 2 == 0)
 		return;
-	glDepthMask(true);
-	glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LEQUAL);
-	glColorMask(false, false, false, false);
+	GpuDepthMask(true);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuDepthFunc(GL_LEQUAL);
+	GpuColorMask(false, false, false, false);
 	for (int i = (_config->part_count - 1); i >= 0; i--)
 		RenderQuad(_sprite[i].Position(), _sprite[i].Sprite(), GLrgba(1, 1, 1), _sprite[_pain_sprite].Size() * 1, _sprite[i].Angle(), DEPTH_PAIN + 0.0f, false);
 	RenderQuads();
-	glDepthFunc(GL_EQUAL);
-	glColorMask(true, true, true, true);
+	GpuDepthFunc(GL_EQUAL);
+	GpuColorMask(true, true, true, true);
 	for (int i = (_config->part_count - 1); i >= 0; i--)
 		RenderQuad(_sprite[i].Position(), sprite_square, _body_color * 0.25f, _sprite[i].Size() * 1, _sprite[i].Angle(), DEPTH_PAIN + 0.0f, false);
 	RenderQuads();
-	glDepthFunc(GL_LEQUAL);
+	GpuDepthFunc(GL_LEQUAL);
 }
 
 void Robot::RenderDebug()
@@ -1379,16 +1446,16 @@ void Robot::RenderDebug()
 		GLquad    q;
 		GLvector2 pt;
 
-		glDisable(GL_TEXTURE_2D);
-		glColor3f(1, 1, 0);
-		glBegin(GL_QUADS);
+		GpuDisable(GL_TEXTURE_2D);
+		GpuColor3f(1, 1, 0);
+		GpuBegin(GL_QUADS);
 		q = SpriteQuad(0);
 		pt = _player_predicted;
 		for (int j = 0; j < 4; j++) {
-			glVertex3f(pt.x + q.corner[j].x * 0.1f, pt.y + q.corner[j].y * 0.1f, DEPTH_UNITS);
+			GpuVertex3f(pt.x + q.corner[j].x * 0.1f, pt.y + q.corner[j].y * 0.1f, DEPTH_UNITS);
 		}
-		glEnd();
-		glEnable(GL_TEXTURE_2D);
+		GpuEnd();
+		GpuEnable(GL_TEXTURE_2D);
 }
 #endif
 
@@ -1401,8 +1468,8 @@ void Robot::RenderDebug()
 		GLquad    q;
 		GLvector2 pt;
 
-		glDisable(GL_TEXTURE_2D);
-		glColor3f(1, 0, 0);
+		GpuDisable(GL_TEXTURE_2D);
+		GpuColor3f(1, 0, 0);
 		pt = _config->launch_point[i];
 		RenderQuad(_position + pt, SPRITE_TARGET, GLrgba(1, 1, 1), 0.2f, 0, DEPTH_PROJECTILES, true);
 	}
@@ -1416,17 +1483,17 @@ void Robot::RenderDebug()
 		GLquad    q;
 		GLvector2 pt;
 
-		glDisable(GL_TEXTURE_2D);
-		glColor3f(0, 0, 1);
-		glBegin(GL_QUADS);
+		GpuDisable(GL_TEXTURE_2D);
+		GpuColor3f(0, 0, 1);
+		GpuBegin(GL_QUADS);
 		q = SpriteQuad(0);
 		pt = _config->laser_point[i];
 		RenderQuad(_position + pt, SPRITE_TARGET, GLrgba(1, 1, 1), 0.2f, 0, DEPTH_PROJECTILES, true);
 		for (int j = 0; j < 4; j++) {
-			glVertex3f(_position.x + pt.x + q.corner[j].x * 0.1f, _position.y + pt.y + q.corner[j].y * 0.1f, DEPTH_UNITS);
+			GpuVertex3f(_position.x + pt.x + q.corner[j].x * 0.1f, _position.y + pt.y + q.corner[j].y * 0.1f, DEPTH_UNITS);
 		}
-		glEnd();
-		glEnable(GL_TEXTURE_2D);
+		GpuEnd();
+		GpuEnable(GL_TEXTURE_2D);
 	}
 #endif
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef ROBOT_H
 #define ROBOT_H
 
+#include "arena.h"
 #include "sprite.h"
 #include "bodyparts.h"
 
@@ -14,6 +15,7 @@
 #define KICK_RECOVERY           0.9f
 #define DEFAULT_SPOT_DISTANCE   10
 #define ROBOT_INVALID           (RobotType)-1
+#define ROBOT_DETAIL_MARGIN     4     //Robot sizes beyond the edge of the screen where we stop animating.
 
 enum ePickupType;
 
@@ -200,6 +202,14 @@ enum
 	MOVE_COUNT
 };
 
+//How much of the update cycle a robot gets, based on where it is.
+enum RobotDetail
+{
+	DETAIL_FULL,      //On (or near) the screen. Everything runs.
+	DETAIL_COARSE,    //Offscreen but active. AI and movement run, but not animation or cosmetic particles.
+	DETAIL_DORMANT,   //Offscreen and hasn't spotted the player. Nothing to do until we're seen or shot.
+};
+
 class Robot
 {
 	GLvector2           _position;          //Current location in world coords.
@@ -213,7 +223,7 @@ class Robot
 	GLvector2           _launch_inertia;    //Forced movement, imposed by one bot spawning another and then "shoving" the child away from it to avoid clustering.
 	GLvector2           _inertia;						//The vector of our current movement intertia.
 	GLrgba              _body_color;        //Base of the running lights.
-	vector<PewPew>      _pew_pew;           //A list of projectiles to shoot.
+	ArenaVector<PewPew> _pew_pew;           //A list of projectiles to shoot.
 	string              _type;              //Type of robot.
 	const RobotConfig*  _config;            //A struct holding all the properties of this robot type.
 	GLbbox2             _bbox;              //Bounding box for collision-checking.
@@ -233,6 +243,7 @@ class Robot
 	int									_cooldown_pain;			//Timestamp when we STOP being pained.
 	int                 _last_proximity;		//Last timestamp when we beeped.
 	int									_next_dependant_check;//When we need to look and make sure our parent is still alive.
+	RobotDetail         _detail;            //How much simulation we're getting this frame.
 	bool                _is_retired;        //Dead and waiting to be deleted.
 	bool                _is_alerted;        //Has spotted the player
 	bool                _is_dead;           //Hitpoints at zero, so we're just animating the corpse.
@@ -258,10 +269,10 @@ class Robot
 	GLvector2           _impact_kick;       //Cosmetic shoving of bot in respone to bullets.
 	float               _angle;
 	float               _death_fade;        //1.0 at death, diminishes per-frame.
-	vector<bodyLeg>     _legs;
-	vector<Weakpoint>   _weak_point;
-	vector<SpriteUnit>  _wp_sprite;
-	vector<Weapon>      _weapons;
+	ArenaVector<bodyLeg> _legs;
+	ArenaVector<Weakpoint> _weak_point;
+	ArenaVector<SpriteUnit> _wp_sprite;
+	ArenaVector<Weapon> _weapons;
 
 	int                 _ai_state;
 	int                 _ai_priorities[4];
@@ -291,7 +302,9 @@ class Robot
 	void                DoMove();
 	void                DoFire();
 	void                DoBody();
+	void                DoBodyCoarse();
 	void                DoBbox();
+	void                DoDetail();
 	void                DoProximity();
 
 	//
@@ -307,8 +320,8 @@ class Robot
 	void                FindFloor();
 	void                FindCeiling();
 	void								FindOpenSpot ();
-	bool                TryMove(int dir, GLvector2* new_pos);
-	bool                TryCollide(GLvector2 new_pos, bool avoid_walls = false);
+	GLvector2           MoveVector(int dir);
+	bool                TryCollide(GLvector2 new_pos);
 	void                DropPowerups();
 	bool                CanSeePlayer();
 	void                MoveEye();
@@ -337,6 +350,8 @@ public:
 	bool                Hit(GLvector2 pos, bool& take_damage);
 	///Returns true if the robot can only be harmed by shooting its weak points.
 	bool                HasWeakpoints() { return _config->has_weakpoints; }
+	/// The box around all of our body parts. Nothing outside of it can Hit () us.
+	GLbbox2             Bbox() { return _bbox; }
 	//Id is used by parents and children to find each other in the heap.
 	int                 Id() { return _id; }
 	bool								Invulnerable () { return _config->is_invulnerable; }
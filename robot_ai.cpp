@@ -199,7 +199,8 @@ void Robot::AiTunnel()
 			_weapons[i].next_fire = GameTick() + _weapons[i].cooldown / 2;
 		//Except for melee, which is instantly ready when we start digging.
 		_cooldown_melee = 0;
-		ParticleRubble(_bore_point, _config->size / 3, 1);
+		if (_detail == DETAIL_FULL)
+			ParticleRubble(_bore_point, _config->size / 3, 1);
 		_ai_speed = _config->speed / 2;
 		if (GameTick() > _cooldown_ouch) {
 			_cooldown_ouch = GameTick() + 1000;
@@ -224,7 +225,7 @@ void Robot::AiSentry()
 			_ai_priorities[2] = AI_REVERSE;
 			_ai_priorities[3] = AI_HOLD;
 		}
-		else if (CollisionLos(_position, PlayerPosition(), LOS_STEP)) { //Hold so we can shoot.
+		else if (_detail == DETAIL_FULL && CollisionLos(_position, PlayerPosition(), LOS_STEP)) { //Hold so we can shoot.
 			_ai_priorities[0] = AI_HOLD;
 			_ai_priorities[1] = AI_REVERSE;
 			_ai_priorities[2] = AI_FORWARD;
@@ -258,14 +259,16 @@ void Robot::AiDeath()
 		if (GameTick() > _cooldown_smoke) {
 			_cooldown_smoke = GameTick() + 32;
 			smoke_out = _position + SpriteMapVectorRotate(_exhaust_point, (int)_angle);
-			ParticleSmoke(smoke_out, _config->size * 2, 2);
+			if (_detail == DETAIL_FULL)
+				ParticleSmoke(smoke_out, _config->size * 2, 2);
 		}
 	}
 	else { //We've hit the ground and come to rest.
 		if (GameTick() > _cooldown_smoke) {
 			_cooldown_smoke = GameTick() + 1000;
-			smoke_out = _sprite[RandomVal(_body_part_count)].Position();
-			ParticleSmoke(smoke_out, _config->size * 2, 2);
+			smoke_out = _sprite[RandomChannel(RANDOM_COSMETIC).Val(_body_part_count)].Position();
+			if (_detail == DETAIL_FULL)
+				ParticleSmoke(smoke_out, _config->size * 2, 2);
 		}
 	}
 	_death_fade *= 0.97f;
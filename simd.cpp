@@ -0,0 +1,128 @@
+/*-----------------------------------------------------------------------------
+
+  Simd.cpp
+
+  Simple math over arrays of floats. Things like particles keep their
+  positions and velocities in flat arrays so they can be moved all at once
+  here, rather than one GLvector2 at a time.
+
+  Each function has an SSE2 version, a NEON version, and plain C++ for
+  everything else (and for whatever is left over after the groups of four).
+  They all give the same results, down to the last bit.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include "simd.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//Which set of instructions we were built with, for the console and benchmarks.
+const char* SimdName()
+{
+#if defined(SIMD_SSE2)
+	return "SSE2";
+#elif defined(SIMD_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
+
+//v += add
+void SimdAdd(float* v, const float* add, int count)
+{
+	int     i = 0;
+
+#if defined(SIMD_SSE2)
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(v + i, _mm_add_ps(_mm_loadu_ps(v + i), _mm_loadu_ps(add + i)));
+#elif defined(SIMD_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(v + i, vaddq_f32(vld1q_f32(v + i), vld1q_f32(add + i)));
+#endif
+	for (; i < count; i++)
+		v[i] += add[i];
+}
+
+//v *= scale
+void SimdScale(float* v, float scale, int count)
+{
+	int     i = 0;
+
+#if defined(SIMD_SSE2)
+	__m128  s = _mm_set1_ps(scale);
+
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(v + i, _mm_mul_ps(_mm_loadu_ps(v + i), s));
+#elif defined(SIMD_NEON)
+	float32x4_t s = vdupq_n_f32(scale);
+
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(v + i, vmulq_f32(vld1q_f32(v + i), s));
+#endif
+	for (; i < count; i++)
+		v[i] *= scale;
+}
+
+//Mark every point that's more than range away from center on either axis.
+//This is a box test, not a circle, which is all culling needs. Returns how
+//many were outside.
+int SimdOutside(const float* x, const float* y, GLvector2 center, float range, unsigned char* outside, int count)
+{
+	int     i = 0;
+	int     total = 0;
+
+#if defined(SIMD_SSE2)
+	__m128  cx = _mm_set1_ps(center.x);
+	__m128  cy = _mm_set1_ps(center.y);
+	__m128  r = _mm_set1_ps(range);
+	__m128  sign = _mm_set1_ps(-0.0f);
+
+	for (; i + 4 <= count; i += 4) {
+		__m128  dx = _mm_andnot_ps(sign, _mm_sub_ps(_mm_loadu_ps(x + i), cx));
+		__m128  dy = _mm_andnot_ps(sign, _mm_sub_ps(_mm_loadu_ps(y + i), cy));
+		int     mask = _mm_movemask_ps(_mm_or_ps(_mm_cmpgt_ps(dx, r), _mm_cmpgt_ps(dy, r)));
+
+		for (int j = 0; j < 4; j++) {
+			outside[i + j] = (mask >> j) & 1;
+			total += outside[i + j];
+		}
+	}
+#elif defined(SIMD_NEON)
+	float32x4_t cx = vdupq_n_f32(center.x);
+	float32x4_t cy = vdupq_n_f32(center.y);
+	float32x4_t r = vdupq_n_f32(range);
+
+	for (; i + 4 <= count; i += 4) {
+		float32x4_t dx = vabsq_f32(vsubq_f32(vld1q_f32(x + i), cx));
+		float32x4_t dy = vabsq_f32(vsubq_f32(vld1q_f32(y + i), cy));
+		uint32x4_t  out = vorrq_u32(vcgtq_f32(dx, r), vcgtq_f32(dy, r));
+		uint32_t    lane[4];
+
+		vst1q_u32(lane, out);
+		for (int j = 0; j < 4; j++) {
+			outside[i + j] = lane[j] ? 1 : 0;
+			total += outside[i + j];
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		outside[i] = (fabs(x[i] - center.x) > range || fabs(y[i] - center.y) > range) ? 1 : 0;
+		total += outside[i];
+	}
+	return total;
+}
@@ -0,0 +1,13 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+//Math over whole arrays of floats at once, four at a time where the CPU can.
+//Keep the x and y of a set of vectors in separate arrays, so that vector i is
+//(x[i], y[i]), and these will work on all of them in one call.
+
+void        SimdAdd(float* v, const float* add, int count);
+const char* SimdName();
+int         SimdOutside(const float* x, const float* y, GLvector2 center, float range, unsigned char* outside, int count);
+void        SimdScale(float* v, float scale, int count);
+
+#endif // SIMD_H
@@ -0,0 +1,123 @@
+/*-----------------------------------------------------------------------------
+
+  Simd_bench.cpp
+
+  Command line benchmark for the SIMD array math. Runs the particle movement step
+  two ways: the old way, one GLvector2 at a time, and the SIMD way, with
+  positions and velocities in separate arrays. Reports how long each took
+  and whether they came out the same.
+
+  usage: simd_bench [particles] [frames]
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include <chrono>
+
+#include "simd.h"
+#include "random.h"
+
+#define DEFAULT_COUNT     2500
+#define DEFAULT_FRAMES    20000
+#define DRAG              0.97f
+#define CULL_RANGE        12.0f
+
+struct BenchParticle
+{
+	GLvector2   position;
+	GLvector2   velocity;
+	float       fall;
+};
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+int main(int argc, char** argv)
+{
+	int                     count, frames;
+	int                     culled_aos, culled_soa;
+	int                     mismatch;
+	double                  time_aos, time_soa;
+	RandomStream            random(1);
+	vector<BenchParticle>   aos;
+	vector<float>           x, y, vx, vy, fall;
+	vector<unsigned char>   outside;
+	GLvector2               center;
+
+	count = argc > 1 ? atoi(argv[1]) : DEFAULT_COUNT;
+	frames = argc > 2 ? atoi(argv[2]) : DEFAULT_FRAMES;
+	if (count < 1 || frames < 1) {
+		printf("usage: %s [particles] [frames]\n", argv[0]);
+		return 1;
+	}
+	aos.resize(count);
+	for (int i = 0; i < count; i++) {
+		aos[i].position = random.Vector2() * 10.0f;
+		aos[i].velocity = random.Vector2() * 0.05f;
+		aos[i].fall = random.Roll(2) ? GRAVITY : 0.0f;
+		x.push_back(aos[i].position.x);
+		y.push_back(aos[i].position.y);
+		vx.push_back(aos[i].velocity.x);
+		vy.push_back(aos[i].velocity.y);
+		fall.push_back(aos[i].fall);
+	}
+	outside.resize(count);
+	printf("Moving %d particles for %d frames, using %s.\n", count, frames, SimdName());
+
+	culled_aos = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int f = 0; f < frames; f++) {
+		for (int i = 0; i < count; i++) {
+			BenchParticle&  p = aos[i];
+
+			if (fabs(p.position.x - center.x) > CULL_RANGE || fabs(p.position.y - center.y) > CULL_RANGE)
+				culled_aos++;
+			p.velocity.y += p.fall;
+			p.position += p.velocity;
+			p.velocity *= DRAG;
+		}
+	}
+	time_aos = seconds_since(start);
+
+	culled_soa = 0;
+	start = std::chrono::steady_clock::now();
+	for (int f = 0; f < frames; f++) {
+		culled_soa += SimdOutside(&x[0], &y[0], center, CULL_RANGE, &outside[0], count);
+		SimdAdd(&vy[0], &fall[0], count);
+		SimdAdd(&x[0], &vx[0], count);
+		SimdAdd(&y[0], &vy[0], count);
+		SimdScale(&vx[0], DRAG, count);
+		SimdScale(&vy[0], DRAG, count);
+	}
+	time_soa = seconds_since(start);
+
+	mismatch = 0;
+	for (int i = 0; i < count; i++) {
+		if (aos[i].position.x != x[i] || aos[i].position.y != y[i] || aos[i].velocity.x != vx[i] || aos[i].velocity.y != vy[i])
+			mismatch++;
+	}
+	if (culled_aos != culled_soa)
+		mismatch++;
+	printf("One at a time: %.3f seconds, %.1f ns/particle.\n", time_aos, (time_aos * 1e9) / ((double)count * frames));
+	printf("Batched:       %.3f seconds, %.1f ns/particle.\n", time_soa, (time_soa * 1e9) / ((double)count * frames));
+	printf("Speedup: %.2fx\n", time_aos / time_soa);
+	if (mismatch) {
+		printf("Results differ for %d particles.\n", mismatch);
+		return 1;
+	}
+	printf("Results match.\n");
+	return 0;
+}
@@ -0,0 +1,92 @@
+/*-----------------------------------------------------------------------------
+
+  Spawn.cpp
+
+  The spawn director. Robot factories don't decide for themselves when to
+  make a robot. They ask here, and we keep an eye on the whole zone:
+
+  - Only a few factories get to look around (visibility, line of sight) on
+    any one frame, so a room full of them doesn't do a room full of checks.
+  - Only one robot comes out per frame.
+  - There's a hard limit on robots in the world, no matter how many
+    factories there are.
+  - If updating the entities has been taking too long lately, factories
+    wait until things calm down.
+
+  The frame cost is ignored while a replay is recording or playing, since
+  the robots that come out have to be the same every time.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include "entity.h"
+#include "replay.h"
+#include "spawn.h"
+
+#define CHECKS_PER_FRAME  2       //How many factories can look around each frame.
+#define SPAWNS_PER_FRAME  1
+#define ROBOT_LIMIT       160     //Most robots allowed in the world at once.
+#define COST_LIMIT        6.0f    //Milliseconds of entity update we'll put up with before holding spawns.
+#define COST_SMOOTHING    0.1f    //How fast the measured cost follows the real one.
+
+static int          checks_left;
+static int          spawns_left;
+static float        cost;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//Called once a frame, before the factories update, with how long the last
+//entity update took.
+void SpawnUpdate(float cost_ms)
+{
+	checks_left = CHECKS_PER_FRAME;
+	spawns_left = SPAWNS_PER_FRAME;
+	cost += (cost_ms - cost) * COST_SMOOTHING;
+}
+
+void SpawnClear()
+{
+	checks_left = CHECKS_PER_FRAME;
+	spawns_left = SPAWNS_PER_FRAME;
+	cost = 0;
+}
+
+//A factory wants to look around. Returns false if too many already have this
+//frame, in which case it should try again next frame.
+bool SpawnTurn()
+{
+	if (checks_left <= 0)
+		return false;
+	checks_left--;
+	return true;
+}
+
+//Is there room in the world for one more robot? For anything that adds robots
+//during play, not just factories.
+bool SpawnRoom()
+{
+	return EntityRobotCount() < ROBOT_LIMIT;
+}
+
+//A factory that allows max_active alerted robots at once wants to make one.
+eSpawnAnswer SpawnAsk(int max_active)
+{
+	if (EntityRobotsActive() > max_active || !SpawnRoom())
+		return SPAWN_CROWDED;
+	if (spawns_left <= 0)
+		return SPAWN_BUSY;
+	if (!ReplayActive() && cost > COST_LIMIT)
+		return SPAWN_BUSY;
+	return SPAWN_OK;
+}
+
+//A factory we said yes to actually made its robot.
+void SpawnMade()
+{
+	spawns_left--;
+}
@@ -0,0 +1,19 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+//What the spawn director says when a factory asks to make a robot.
+enum eSpawnAnswer
+{
+	SPAWN_OK,       //Go ahead.
+	SPAWN_CROWDED,  //Too many robots around. Don't ask again for a while.
+	SPAWN_BUSY,     //Not this frame. Try again soon.
+};
+
+eSpawnAnswer  SpawnAsk(int max_active);
+void          SpawnClear();
+void          SpawnMade();
+bool          SpawnRoom();
+bool          SpawnTurn();
+void          SpawnUpdate(float cost_ms);
+
+#endif // SPAWN_H
@@ -13,6 +13,7 @@
 
 #include "bodyparts.h"
 #include "game.h"
+#include "gpu.h"
 #include "random.h"
 #include "render.h"
 #include "sprite.h"
@@ -148,7 +149,7 @@ void SpriteUnit::Render ()
 		return;
 
 	if (_tick_stop_shaking > 0) {
-		GLvector2	shake = GLvector2 (RandomFloat (), RandomFloat ()) - GLvector2 (0.5f, 0.5f);
+		GLvector2	shake = GLvector2 (RandomChannel(RANDOM_COSMETIC).Float(), RandomChannel(RANDOM_COSMETIC).Float()) - GLvector2 (0.5f, 0.5f);
 		GLrgba		color;
 
 		color = _color;
@@ -217,13 +218,13 @@ void SpriteBox::Init(GLvector2 pos, float size, float angle, int sprite_group, i
 
 void SpriteBox::Render()
 {
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	if (_use_color)
-		glColor4fv(&_color.red);
-	glBegin(GL_QUADS);
+		GpuColor4fv(&_color.red);
+	GpuBegin(GL_QUADS);
 	for (unsigned i = 0; i < 4; i++) {
-		glTexCoord2fv(&_uv.uv[i].x);
-		glVertex3f(_quad.corner[i].x, _quad.corner[i].y, DEPTH_UNITS);
+		GpuTexCoord2fv(&_uv.uv[i].x);
+		GpuVertex3f(_quad.corner[i].x, _quad.corner[i].y, DEPTH_UNITS);
 	}
-	glEnd();
+	GpuEnd();
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include "ini.h"
 #include "resource.h"
 #include "texture.h"
+#include "watch.h"
 
 #define SPRITE_FILE     "sprite.ini"
 
@@ -352,6 +353,13 @@ int SpriteMapTexture()
 	return tx->Id();
 }
 
+//The sheet or its map changed on disk. The texture reloads itself, but the
+//sprite list and the alpha mask are built from it and need building again.
+static void spritemap_changed(string filename)
+{
+	SpriteMapInit();
+}
+
 //Convert the given UV value to pixel position, and return if that pixel in
 //our atlas texture is opaque.  This is used for collision checking.
 bool SpriteMapAlpha(GLvector2 uv)
@@ -383,6 +391,7 @@ void SpriteMapInit()
 	//These are entries which MUST exist because they're referenced in the source code.
 	//First, we fill in this based list with dummy values:
 	ini.Open(ResourceLocation(SPRITE_FILE, RESOURCE_DATA));
+	sprites.clear();
 	for (int i = 0; i < SPRITE_COUNT; i++) {
 		Sprite    s;
 
@@ -443,6 +452,7 @@ void SpriteMapInit()
 	//Build an array of bool values for the sprite sheet based on pixel alpha.
 	//This is used for per-pixel hit detection.
 	sheet_size = tx->Size();
+	delete[] sheet_alpha;
 	sheet_alpha = new bool[sheet_size.x * sheet_size.y];
 	for (int x = 0; x < sheet_size.x; x++) {
 		for (int y = 0; y < sheet_size.y; y++) {
@@ -459,6 +469,8 @@ void SpriteMapInit()
 				sheet_alpha[index] = true;
 		}
 	}
+	WatchFile(ResourceLocation(SPRITE_FILE, RESOURCE_DATA), spritemap_changed);
+	WatchFile(tx->Location(), spritemap_changed);
 	//We build a collection of 360 rectangles, all rotated. This is used in rare cases
 	//for rendering things that don't work with our sprite shader. (The player's light
 	//cone flashlight being the biggest example.)
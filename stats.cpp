@@ -0,0 +1,432 @@
+/*-----------------------------------------------------------------------------
+
+  Stats.cpp
+
+  Lifetime stats and achievements. The game reports changes here as they
+  happen, as often as it likes. Nothing goes to the backend right away:
+  changes to the same stat are merged in memory, and at most once a second
+  the whole lot is handed to a worker thread which passes it on to Steam
+  (or to a file in the save folder when Steam isn't running).
+
+  This keeps the number of backend calls bounded no matter how busy combat
+  gets. Achievements we've already seen unlocked are remembered here, so
+  checking one is a lookup instead of a trip to the backend.
+
+  The headless build has no Steam and no threads. Only the local file
+  backend exists there, and each flush is written as soon as it's handed
+  over, so the merging and throttling can be tested on their own.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include <map>
+
+#include "env.h"
+#include "ini.h"
+#include "stats.h"
+#ifndef WORLDGEN_HEADLESS
+#include "steam_data.h"
+#endif
+#include "system.h"
+
+#define FLUSH_INTERVAL    1000
+#define STATS_FILE        "stats.ini"
+#define SECTION_STATS     "Stats"
+#define SECTION_ACH       "Achievements"
+
+struct StatsProgressEntry
+{
+	string          ach_id;
+	int             current;
+	int             max;
+};
+
+//Everything that changed since the last flush.
+struct StatsJob
+{
+	StatsBackend                backend;
+	std::map<string, int>       add;
+	std::map<string, int>       set_int;
+	std::map<string, float>     set_float;
+	vector<string>              unlock;
+	vector<StatsProgressEntry>  progress;
+	bool                        store;
+	int                         reports;
+};
+
+static StatsBackend           backend;
+static std::map<string, bool> achieved;
+static StatsJob               pending;
+static int                    next_flush;
+//The worker's copy. Only the worker touches it while job_ready is set.
+static StatsJob               job;
+static bool                   job_ready;
+static bool                   quitting;
+static bool                   running;
+#ifndef WORLDGEN_HEADLESS
+static SDL_mutex*             job_lock;
+static SDL_cond*              wake;
+static SDL_cond*              done;
+static SDL_Thread*            worker;
+#endif
+static iniFile                local;
+//Counts, for the console.
+static int                    count_reports;
+static int                    count_flushes;
+static int                    count_calls;
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static void lock()
+{
+#ifndef WORLDGEN_HEADLESS
+	SDL_LockMutex(job_lock);
+#endif
+}
+
+static void unlock()
+{
+#ifndef WORLDGEN_HEADLESS
+	SDL_UnlockMutex(job_lock);
+#endif
+}
+
+static void job_clear(StatsJob* j)
+{
+	j->add.clear();
+	j->set_int.clear();
+	j->set_float.clear();
+	j->unlock.clear();
+	j->progress.clear();
+	j->store = false;
+	j->reports = 0;
+}
+
+static bool job_empty(const StatsJob* j)
+{
+	return j->add.empty() && j->set_int.empty() && j->set_float.empty() && j->unlock.empty() && j->progress.empty() && !j->store;
+}
+
+//Stats only count when achievements do. Cheating turns both off.
+static bool enabled()
+{
+	return backend != STATS_BACKEND_NONE && EnvAchievementsEnabled();
+}
+
+static void local_open()
+{
+	local.Open(SystemSavePath() + STATS_FILE);
+	local.Defer(true);
+}
+
+//Hand the job to the backend. This runs on the worker thread, except for the
+//last one at shutdown.
+static int do_flush(StatsJob* j)
+{
+	int               calls;
+
+	calls = 0;
+#ifndef WORLDGEN_HEADLESS
+	if (j->backend == STATS_BACKEND_STEAM) {
+		ISteamUserStats*  steam;
+
+		steam = PlayerSteamStats();
+		if (!steam)
+			return 0;
+		for (auto it = j->add.begin(); it != j->add.end(); ++it) {
+			int32   old_value;
+
+			if (steam->GetStat(it->first.c_str(), &old_value))
+				steam->SetStat(it->first.c_str(), (int32)(old_value + it->second));
+			calls += 2;
+		}
+		for (auto it = j->set_int.begin(); it != j->set_int.end(); ++it, calls++)
+			steam->SetStat(it->first.c_str(), (int32)it->second);
+		for (auto it = j->set_float.begin(); it != j->set_float.end(); ++it, calls++)
+			steam->SetStat(it->first.c_str(), it->second);
+		for (unsigned i = 0; i < j->unlock.size(); i++, calls++)
+			steam->SetAchievement(j->unlock[i].c_str());
+		for (unsigned i = 0; i < j->progress.size(); i++, calls++)
+			steam->IndicateAchievementProgress(j->progress[i].ach_id.c_str(), j->progress[i].current, j->progress[i].max);
+		if (j->store || !j->unlock.empty()) {
+			steam->StoreStats();
+			calls++;
+		}
+	}
+#endif
+	if (j->backend == STATS_BACKEND_LOCAL) {
+		for (auto it = j->add.begin(); it != j->add.end(); ++it)
+			local.IntSet(SECTION_STATS, it->first, local.IntGet(SECTION_STATS, it->first) + it->second);
+		for (auto it = j->set_int.begin(); it != j->set_int.end(); ++it)
+			local.IntSet(SECTION_STATS, it->first, it->second);
+		for (auto it = j->set_float.begin(); it != j->set_float.end(); ++it)
+			local.StringSet(SECTION_STATS, it->first, StringSprintf("%f", it->second));
+		for (unsigned i = 0; i < j->unlock.size(); i++)
+			local.BoolSet(SECTION_ACH, j->unlock[i], true);
+		if (local.Dirty()) {
+			local.Save();
+			calls++;
+		}
+	}
+	return calls;
+}
+
+#ifndef WORLDGEN_HEADLESS
+static int SDLCALL stats_thread(void*)
+{
+	int     calls;
+
+	SDL_LockMutex(job_lock);
+	while (true) {
+		while (!job_ready && !quitting)
+			SDL_CondWait(wake, job_lock);
+		if (!job_ready)
+			break;
+		SDL_UnlockMutex(job_lock);
+		calls = do_flush(&job);
+		SDL_LockMutex(job_lock);
+		count_calls += calls;
+		job_ready = false;
+		SDL_CondBroadcast(done);
+	}
+	SDL_UnlockMutex(job_lock);
+	return 0;
+}
+
+//Block until the worker has finished whatever it's doing.
+static void wait_idle()
+{
+	if (!job_lock)
+		return;
+	SDL_LockMutex(job_lock);
+	while (job_ready)
+		SDL_CondWait(done, job_lock);
+	SDL_UnlockMutex(job_lock);
+}
+#endif
+
+//Give the job to the worker. Called with the lock held.
+static void hand_off()
+{
+	job_ready = true;
+#ifdef WORLDGEN_HEADLESS
+	count_calls += do_flush(&job);
+	job_ready = false;
+#else
+	SDL_CondSignal(wake);
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+StatsBackend StatsBackendGet()
+{
+	return backend;
+}
+
+void StatsBackendSet(StatsBackend b)
+{
+#ifndef WORLDGEN_HEADLESS
+	wait_idle();
+#endif
+	backend = b;
+	achieved.clear();
+	job_clear(&pending);
+	if (backend == STATS_BACKEND_LOCAL) {
+		local_open();
+		for (unsigned i = 0; i < local.SectionKeys(SECTION_ACH); i++)
+			achieved[local.SectionKey(SECTION_ACH, i)] = local.BoolGet(SECTION_ACH, local.SectionKey(SECTION_ACH, i));
+	}
+}
+
+void StatsInit()
+{
+	job_clear(&pending);
+	job_clear(&job);
+	quitting = false;
+	running = true;
+#ifdef WORLDGEN_HEADLESS
+	StatsBackendSet(STATS_BACKEND_LOCAL);
+#else
+	job_lock = SDL_CreateMutex();
+	wake = SDL_CreateCond();
+	done = SDL_CreateCond();
+	if (PlayerSteamStats())
+		StatsBackendSet(STATS_BACKEND_STEAM);
+	else
+		StatsBackendSet(STATS_BACKEND_LOCAL);
+	worker = SDL_CreateThread(stats_thread, "stats_thread", NULL);
+#endif
+	Console("StatsInit: Keeping stats %s.", backend == STATS_BACKEND_STEAM ? "on Steam" : "in " STATS_FILE);
+}
+
+//Stop the worker and write out whatever is still waiting.
+void StatsTerm()
+{
+	if (!running)
+		return;
+	running = false;
+#ifndef WORLDGEN_HEADLESS
+	SDL_LockMutex(job_lock);
+	quitting = true;
+	SDL_CondSignal(wake);
+	SDL_UnlockMutex(job_lock);
+	SDL_WaitThread(worker, NULL);
+	worker = NULL;
+#endif
+	pending.backend = backend;
+	pending.store = true;
+	do_flush(&pending);
+	job_clear(&pending);
+}
+
+void StatsUpdate()
+{
+	if (!running || job_empty(&pending))
+		return;
+	if (SystemTick() < next_flush)
+		return;
+	lock();
+	//Still busy with the last one. The changes keep piling up in pending.
+	if (job_ready) {
+		unlock();
+		return;
+	}
+	next_flush = SystemTick() + FLUSH_INTERVAL;
+	count_flushes++;
+	count_reports += pending.reports;
+	pending.backend = backend;
+	std::swap(job, pending);
+	job_clear(&pending);
+	hand_off();
+	unlock();
+}
+
+//How many reports have been handed to the backend, in how many flushes,
+//and how many calls the backend made for them.
+void StatsCounts(int* reports, int* flushes, int* calls)
+{
+	lock();
+	*reports = count_reports;
+	*flushes = count_flushes;
+	*calls = count_calls;
+	unlock();
+}
+
+void StatsAdd(const char* stat_id, int change)
+{
+	if (!enabled() || !change)
+		return;
+	pending.add[stat_id] += change;
+	pending.reports++;
+}
+
+void StatsSet(const char* stat_id, int value)
+{
+	if (!enabled())
+		return;
+	pending.set_int[stat_id] = value;
+	pending.reports++;
+}
+
+void StatsSet(const char* stat_id, float value)
+{
+	if (!enabled())
+		return;
+	pending.set_float[stat_id] = value;
+	pending.reports++;
+}
+
+//Ask for everything to be committed at the next flush. On Steam this is
+//the call that actually goes over the network.
+void StatsStore()
+{
+	if (!enabled())
+		return;
+	pending.store = true;
+}
+
+bool StatsAchieved(const char* ach_id)
+{
+	bool    unlocked;
+
+	if (!enabled())
+		return false;
+	auto it = achieved.find(ach_id);
+	if (it != achieved.end())
+		return it->second;
+	//First time we've been asked about this one. Steam answers from its
+	//local copy, so this is cheap, and we only do it once.
+	unlocked = false;
+#ifndef WORLDGEN_HEADLESS
+	if (backend == STATS_BACKEND_STEAM && PlayerSteamStats())
+		PlayerSteamStats()->GetAchievement(ach_id, &unlocked);
+#endif
+	achieved[ach_id] = unlocked;
+	return unlocked;
+}
+
+void StatsAchievement(const char* ach_id)
+{
+	if (!enabled() || StatsAchieved(ach_id))
+		return;
+	achieved[ach_id] = true;
+	pending.unlock.push_back(ach_id);
+	pending.reports++;
+}
+
+//Unlock the achievement once value reaches quantity. Returns true if it is
+//(or already was) unlocked.
+bool StatsCheckAch(const char* ach_id, long value, long quantity)
+{
+	if (!enabled())
+		return false;
+	if (StatsAchieved(ach_id))
+		return true;
+	if (value < quantity)
+		return false;
+	StatsAchievement(ach_id);
+	return true;
+}
+
+void StatsProgress(const char* ach_id, int current, int max)
+{
+	StatsProgressEntry  p;
+
+	if (!enabled())
+		return;
+	p.ach_id = ach_id;
+	p.current = current;
+	p.max = max;
+	pending.progress.push_back(p);
+	pending.reports++;
+}
+
+#ifndef WORLDGEN_HEADLESS
+bool StatsHandleCommand(const vector<string> &words)
+{
+	int     reports, flushes, calls;
+
+	if (words.empty() || _stricmp(words[0].c_str(), "stats"))
+		return false;
+	if (words.size() > 1) {
+		if (!_stricmp(words[1].c_str(), "local"))
+			StatsBackendSet(STATS_BACKEND_LOCAL);
+		else if (!_stricmp(words[1].c_str(), "steam") && PlayerSteamStats())
+			StatsBackendSet(STATS_BACKEND_STEAM);
+		else if (!_stricmp(words[1].c_str(), "none"))
+			StatsBackendSet(STATS_BACKEND_NONE);
+	}
+	Console("Stats: %s backend.", backend == STATS_BACKEND_STEAM ? "Steam" : backend == STATS_BACKEND_LOCAL ? "local" : "no");
+	StatsCounts(&reports, &flushes, &calls);
+	Console("Stats: %d reports merged into %d flushes, %d backend calls.", reports, flushes, calls);
+	return true;
+}
+#endif
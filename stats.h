@@ -0,0 +1,28 @@
+#ifndef STATS_H
+#define STATS_H
+
+//Where lifetime stats and achievements end up.
+enum StatsBackend
+{
+	STATS_BACKEND_NONE,   //Nowhere. Changes are thrown away.
+	STATS_BACKEND_STEAM,  //The Steam user stats.
+	STATS_BACKEND_LOCAL,  //A file in the save folder, for when Steam isn't running.
+};
+
+void          StatsAchievement(const char* ach_id);
+bool          StatsAchieved(const char* ach_id);
+void          StatsAdd(const char* stat_id, int change);
+StatsBackend  StatsBackendGet();
+void          StatsBackendSet(StatsBackend backend);
+bool          StatsCheckAch(const char* ach_id, long value, long quantity);
+void          StatsCounts(int* reports, int* flushes, int* calls);
+bool          StatsHandleCommand(const vector<string> &words);
+void          StatsInit();
+void          StatsProgress(const char* ach_id, int current, int max);
+void          StatsSet(const char* stat_id, int value);
+void          StatsSet(const char* stat_id, float value);
+void          StatsStore();
+void          StatsTerm();
+void          StatsUpdate();
+
+#endif // STATS_H
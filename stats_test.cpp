@@ -0,0 +1,286 @@
+/*-----------------------------------------------------------------------------
+
+  Stats_test.cpp
+
+  Command line test for the stats service, using the local file backend. The
+  headless build of stats.cpp has no Steam and no worker thread, and the
+  clock, save folder and achievement switch it asks for are stood in for
+  here, so time can be moved along as fast as we like.
+
+  Each run plays a stretch of random frames, reporting stats as fast as the
+  busiest fight would and calling StatsUpdate every frame. We keep our own
+  totals and check that:
+
+  - Adds to the same stat are summed and the last set wins, both in what
+    the file ends up holding and within a single flush.
+  - An achievement is only reported once.
+  - Nothing is flushed sooner than a second after the last flush.
+  - The backend never makes more than one call per flush, no matter how many
+    reports went into it.
+
+  usage: stats_test [runs] [seed]
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include <stdarg.h>
+
+#include "env.h"
+#include "ini.h"
+#include "random.h"
+#include "stats.h"
+#include "system.h"
+
+#define DEFAULT_RUNS      20
+#define FLUSH_INTERVAL    1000        //Must match stats.cpp.
+#define STATS_FILE        "stats.ini" //Must match stats.cpp.
+#define FRAMES            2000
+#define MAX_FRAME_TIME    50
+#define MAX_REPORTS_FRAME 200         //Reports in one frame of heavy combat.
+#define STAT_NAMES        6
+#define ACH_NAMES         4
+#define TOLERANCE         0.0001f
+#define MAX_REPORTS       10
+
+static const char*            add_name[STAT_NAMES] = { "kills", "shots", "hits", "deaths", "money", "xp" };
+static const char*            set_name[STAT_NAMES] = { "best", "level", "streak", "combo", "depth", "score" };
+static const char*            float_name[STAT_NAMES] = { "accuracy", "rate", "ratio", "speed", "average", "time" };
+static const char*            ach_name[ACH_NAMES] = { "ach_one", "ach_two", "ach_three", "ach_four" };
+
+static int                    failures;
+static long                   now;
+static string                 save_path;
+
+/*-----------------------------------------------------------------------------
+Stand-ins for the parts of the game stats.cpp asks for.
+-----------------------------------------------------------------------------*/
+
+long SystemTick()
+{
+	return now;
+}
+
+string SystemSavePath()
+{
+	return save_path;
+}
+
+const bool EnvAchievementsEnabled()
+{
+	return true;
+}
+
+void ConsoleLog(const char* message, ...)
+{
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static void fail(const char* message, ...)
+{
+	va_list   args;
+
+	failures++;
+	if (failures > MAX_REPORTS)
+		return;
+	va_start(args, message);
+	printf("  FAIL: ");
+	vprintf(message, args);
+	printf("\n");
+	va_end(args);
+}
+
+//One frame's worth of reports. Returns how many were made.
+static int random_reports(RandomStream& random, int* add_total, int* set_last, float* float_last, bool* unlocked)
+{
+	int     count;
+	int     reports;
+
+	count = random.Val(MAX_REPORTS_FRAME);
+	reports = 0;
+	for (int i = 0; i < count; i++) {
+		int     s = random.Val(STAT_NAMES);
+
+		switch (random.Val(4)) {
+		case 0: {
+			int     change = random.Val(5);
+
+			StatsAdd(add_name[s], change);
+			add_total[s] += change;
+			if (change)
+				reports++;
+			break;
+			}
+		case 1:
+			set_last[s] = random.Val(100000);
+			StatsSet(set_name[s], set_last[s]);
+			reports++;
+			break;
+		case 2:
+			float_last[s] = random.Float();
+			StatsSet(float_name[s], float_last[s]);
+			reports++;
+			break;
+		default: {
+			int     a = random.Val(ACH_NAMES);
+
+			StatsAchievement(ach_name[a]);
+			if (!unlocked[a])
+				reports++;
+			unlocked[a] = true;
+			break;
+			}
+		}
+	}
+	return reports;
+}
+
+static void test_run(RandomStream& random, int run, int* total_reports, int* total_flushes)
+{
+	int       add_total[STAT_NAMES];
+	int       set_last[STAT_NAMES];
+	float     float_last[STAT_NAMES];
+	bool      unlocked[ACH_NAMES];
+	int       reports, flushes, calls;
+	int       start_reports, start_flushes, start_calls;
+	int       made;
+	long      last_flush;
+	iniFile   file;
+
+	remove(save_path + STATS_FILE);
+	StatsInit();
+	StatsCounts(&start_reports, &start_flushes, &start_calls);
+	for (int s = 0; s < STAT_NAMES; s++) {
+		add_total[s] = 0;
+		set_last[s] = -1;
+		float_last[s] = -1;
+	}
+	for (int a = 0; a < ACH_NAMES; a++)
+		unlocked[a] = false;
+	made = 0;
+	last_flush = -FLUSH_INTERVAL;
+	for (int f = 0; f < FRAMES; f++) {
+		int     before;
+
+		now += 1 + random.Val(MAX_FRAME_TIME);
+		made += random_reports(random, add_total, set_last, float_last, unlocked);
+		StatsCounts(&reports, &flushes, &calls);
+		before = flushes;
+		StatsUpdate();
+		StatsCounts(&reports, &flushes, &calls);
+		if (flushes != before) {
+			if (now - last_flush < FLUSH_INTERVAL)
+				fail("Run %d flushed at %ld, only %ld after the last flush.", run, now, now - last_flush);
+			last_flush = now;
+		}
+	}
+	StatsCounts(&reports, &flushes, &calls);
+	reports -= start_reports;
+	flushes -= start_flushes;
+	calls -= start_calls;
+	if (reports > made)
+		fail("Run %d made %d reports, but %d were flushed.", run, made, reports);
+	if (calls > flushes)
+		fail("Run %d made %d backend calls for %d flushes.", run, calls, flushes);
+	//Whatever is still waiting gets written on the way out.
+	StatsTerm();
+	file.Open(save_path + STATS_FILE);
+	for (int s = 0; s < STAT_NAMES; s++) {
+		if (file.IntGet("Stats", add_name[s]) != add_total[s])
+			fail("Run %d: %s added up to %d, but the file has %d.", run, add_name[s], add_total[s], file.IntGet("Stats", add_name[s]));
+		if (set_last[s] >= 0 && file.IntGet("Stats", set_name[s]) != set_last[s])
+			fail("Run %d: %s was last set to %d, but the file has %d.", run, set_name[s], set_last[s], file.IntGet("Stats", set_name[s]));
+		if (float_last[s] >= 0 && fabs(file.FloatGet("Stats", float_name[s]) - float_last[s]) > TOLERANCE)
+			fail("Run %d: %s was last set to %f, but the file has %f.", run, float_name[s], float_last[s], file.FloatGet("Stats", float_name[s]));
+	}
+	for (int a = 0; a < ACH_NAMES; a++) {
+		if (file.BoolGet("Achievements", ach_name[a]) != unlocked[a])
+			fail("Run %d: %s is %s, but the file says it's %s.", run, ach_name[a], unlocked[a] ? "unlocked" : "locked", file.BoolGet("Achievements", ach_name[a]) ? "unlocked" : "locked");
+	}
+	*total_reports += made;
+	*total_flushes += flushes;
+}
+
+//Everything reported between two flushes goes out in one, as one call.
+static void test_merge()
+{
+	int       reports, flushes, calls;
+	int       start_reports, start_flushes, start_calls;
+	iniFile   file;
+
+	remove(save_path + STATS_FILE);
+	StatsInit();
+	StatsCounts(&start_reports, &start_flushes, &start_calls);
+	for (int i = 0; i < 100; i++) {
+		StatsAdd("kills", 2);
+		StatsSet("best", i);
+		StatsSet("accuracy", i / 100.0f);
+	}
+	StatsAdd("kills", 0);
+	StatsAchievement("ach_one");
+	StatsAchievement("ach_one");
+	if (!StatsAchieved("ach_one"))
+		fail("An achievement just unlocked should read back as unlocked.");
+	now += FLUSH_INTERVAL;
+	StatsUpdate();
+	//This one is too soon, so it has to wait.
+	StatsAdd("kills", 1);
+	now += FLUSH_INTERVAL - 1;
+	StatsUpdate();
+	StatsCounts(&reports, &flushes, &calls);
+	if (reports - start_reports != 301)
+		fail("301 reports were made before the first flush, but %d were counted.", reports - start_reports);
+	if (flushes - start_flushes != 1 || calls - start_calls != 1)
+		fail("One flush and one backend call should have been made, not %d and %d.", flushes - start_flushes, calls - start_calls);
+	file.Open(save_path + STATS_FILE);
+	if (file.IntGet("Stats", "kills") != 200 || file.IntGet("Stats", "best") != 99 || fabs(file.FloatGet("Stats", "accuracy") - 0.99f) > TOLERANCE)
+		fail("After one flush the file should hold 200 kills, best of 99 and accuracy of 0.99, not %d, %d and %f.", file.IntGet("Stats", "kills"), file.IntGet("Stats", "best"), file.FloatGet("Stats", "accuracy"));
+	if (!file.BoolGet("Achievements", "ach_one"))
+		fail("The achievement wasn't written.");
+	now++;
+	StatsUpdate();
+	StatsCounts(&reports, &flushes, &calls);
+	if (flushes - start_flushes != 2)
+		fail("The second flush should go a second after the first.");
+	file.Open(save_path + STATS_FILE);
+	if (file.IntGet("Stats", "kills") != 201)
+		fail("After the second flush the file should hold 201 kills, not %d.", file.IntGet("Stats", "kills"));
+	StatsTerm();
+}
+
+int main(int argc, char** argv)
+{
+	int             runs;
+	unsigned long   seed;
+	int             reports, flushes;
+
+	runs = argc > 1 ? atoi(argv[1]) : DEFAULT_RUNS;
+	seed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+	if (runs < 1) {
+		printf("usage: %s [runs] [seed]\n", argv[0]);
+		return 1;
+	}
+	save_path = (temp_directory_path() / unique_path("stats_test_%%%%%%%%")).string() + "/";
+	create_directories(save_path);
+	now = 0;
+	test_merge();
+	reports = flushes = 0;
+	for (int r = 1; r <= runs; r++) {
+		RandomStream  random = RandomStream(seed).Split(r);
+
+		test_run(random, r, &reports, &flushes);
+	}
+	remove_all(save_path);
+	printf("Stats: %d runs of %d frames, %d reports merged into %d flushes.\n", runs, FRAMES, reports, flushes);
+	if (failures) {
+		printf("%d failures.\n", failures);
+		return 1;
+	}
+	printf("All passed.\n");
+	return 0;
+}
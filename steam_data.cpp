@@ -3,6 +3,7 @@
 #include "player.h"
 #include "numstr.h"
 #include "menu.h"
+#include "stats.h"
 
 #ifdef CMAKE_BUILD
 #include "steam_api.h"
@@ -41,36 +42,29 @@ bool SteamUserValid()
 	return (m_pSteamUserStats != nullptr && EnvAchievementsEnabled());
 }
 
-//Achievements
+//Achievements and stats go through the stats service, which batches them
+//up and works without Steam too
 void GiveAchievement(const char* ach_id)
 {
-	if (SteamUserValid())
-	{
-		m_pSteamUserStats->SetAchievement(ach_id);
-		m_pSteamUserStats->StoreStats();
-	}
+	StatsAchievement(ach_id);
+	StatsStore();
 }
 
 void SteamIndicateAchievementProgress(const char* ach_id, const int cur, const int max)
 {
-	if (SteamUserValid())
-	{
-		m_pSteamUserStats->IndicateAchievementProgress(ach_id, cur, max);
-		m_pSteamUserStats->StoreStats();
-	}
+	StatsProgress(ach_id, cur, max);
+	StatsStore();
 }
 
 //Stat tracking
 void SteamSetStat(const char* stat_id, const int value)
 {
-	if (SteamUserValid())
-		m_pSteamUserStats->SetStat(stat_id, value);
+	StatsSet(stat_id, value);
 }
 
 void SteamSetStat(const char* stat_id, const float value)
 {
-	if (SteamUserValid())
-		m_pSteamUserStats->SetStat(stat_id, value);
+	StatsSet(stat_id, value);
 }
 
 void SteamUpdateAvgRate(const char* stat_id, const float value, const float session_length)
@@ -81,25 +75,13 @@ void SteamUpdateAvgRate(const char* stat_id, const float value, const float sess
 
 void SteamSync()
 {
-	if (SteamUserValid())
-		m_pSteamUserStats->StoreStats();
+	StatsStore();
 }
 
 template <typename T, typename U>
 bool SteamCheckAch(const T val, const char* ach_id, const U quantity)
 {
-	bool ach_unlocked = false;
-	if (SteamUserValid())
-	{
-		m_pSteamUserStats->GetAchievement(ach_id, &ach_unlocked);
-		if (!ach_unlocked && val >= quantity)
-		{
-			m_pSteamUserStats->SetAchievement(ach_id);
-			ach_unlocked = true;
-		}
-	}
-
-	return ach_unlocked;
+	return StatsCheckAch(ach_id, (long)val, (long)quantity);
 }
 
 const char* SteamDisplayName()
@@ -110,49 +92,55 @@ const char* SteamDisplayName()
 	return "Player";
 }
 
-//Player stats are synced to steam
+static const char* trivia_stat_name(PlayerTrivia index)
+{
+	switch (index)
+	{
+	case TRIVIA_DAMAGE_TAKEN:       return "DamageTaken";
+	case TRIVIA_DAMAGE_DEALT:       return "DamageDealt";
+	case TRIVIA_XP_GATHERED:        return "MoneyGathered";
+	case TRIVIA_BULLETS_FIRED:      return "BulletsFired";
+	case TRIVIA_KILLS:              return "EnemiesKilled";
+	case TRIVIA_DEATHS:             return "Deaths";
+	case TRIVIA_CM_TRAVELED:        return "DistanceMoved";
+	case TRIVIA_PLAYTIME:           return "PlayTime";
+	case TRIVIA_MISSILES_DESTROYED: return "MissilesDestroyed";
+	case TRIVIA_MISSILES_EVADED:    return "MissilesEvaded";
+	default: return nullptr;
+	}
+}
+
+//Player stats are synced to steam. Only the change is sent, and the stats
+//service adds it to the lifetime total. Achievements for this stat are
+//checked once per update, not on every change.
+void PlayerStats::TriviaChanged(PlayerTrivia index, long change)
+{
+	const char* stat_name = trivia_stat_name(index);
+
+	if (stat_name != nullptr)
+		StatsAdd(stat_name, (int)change);
+	_trivia_dirty |= 1 << index;
+}
+
 //The achievement checks made here are for "within a single game" only
 void PlayerStats::TriviaCheckAch(PlayerTrivia index)
 {
-	int old_value = 0;
-	std::string stat_name;
 	bool sync = false;
 
 	switch (index)
 	{
-	case TRIVIA_DAMAGE_TAKEN:       stat_name = "DamageTaken"; break;
-	case TRIVIA_DAMAGE_DEALT:       stat_name = "DamageDealt"; break;
 	case TRIVIA_XP_GATHERED:
-		stat_name = "MoneyGathered";
 		sync |= SteamCheckAch(_trivia[index], "ach_money_10k", 10000);
 		sync |= SteamCheckAch(_trivia[index], "ach_money_100k", 100000);
 		break;
-	case TRIVIA_BULLETS_FIRED:      stat_name = "BulletsFired"; break;
 	case TRIVIA_KILLS:
-		stat_name = "EnemiesKilled";
 		sync |= SteamCheckAch(_trivia[index], "ach_kill_500", 500);
 		sync |= SteamCheckAch(_trivia[index], "ach_kill_1000", 1000);
 		sync |= SteamCheckAch(_trivia[index], "ach_kill_2000", 2000);
 		break;
-	case TRIVIA_DEATHS:             stat_name = "Deaths"; break;
-	case TRIVIA_CM_TRAVELED:        stat_name = "DistanceMoved"; break;
-	case TRIVIA_PLAYTIME:           stat_name = "PlayTime"; break;
-	case TRIVIA_MISSILES_DESTROYED: stat_name = "MissilesDestroyed"; break;
-	case TRIVIA_MISSILES_EVADED:    stat_name = "MissilesEvaded"; break;
 	default: break;
 	}
 
-	//std::string avg_stat_name = "Avg" + stat_name;
-	//Add accurate session length here
-	//double session_length = 1;
-
-	if (SteamUserValid()) {
-		if (m_pSteamUserStats->GetStat(stat_name.c_str(), &old_value))
-		{
-			m_pSteamUserStats->SetStat(stat_name.c_str(), (int32)(_trivia[index] + old_value));
-			//m_pSteamUserStats->UpdateAvgRateStat(avg_stat_name.c_str(), (float)_trivia[index], session_length);
-		}
-	}
 	if (sync)
 		SteamSync();
 }
@@ -171,46 +159,40 @@ void PlayerStats::ScoreCheckAch()
 void PlayerStats::WorldCheckAch(int world_index, int zone_index)
 {
 	using namespace pyrodactyl;
-	bool ach_unlocked = false;
 
-	if (SteamUserValid())
+	if (world_index > 0)
 	{
-		if (world_index > 0)
+		std::string ach_id = "ach_lv_";
+
+		if (world_index < 2)
+			ach_id += NumberToString<int>(world_index);
+		else if (world_index == 2)
+			ach_id += "invalid";
+		else
+			ach_id += NumberToString<int>(world_index - 1);
+
+		//This is the achievement for completing various levels
+		if (!StatsAchieved(ach_id.c_str()))
 		{
-			std::string ach_id = "ach_lv_";
-
-			if (world_index < 2)
-				ach_id += NumberToString<int>(world_index);
-			else if (world_index == 2)
-				ach_id += "invalid";
-			else
-				ach_id += NumberToString<int>(world_index - 1);
-
-			//This is the achievement for completing various levels
-			m_pSteamUserStats->GetAchievement(ach_id.c_str(), &ach_unlocked);
-			if (!ach_unlocked)
-			{
-				m_pSteamUserStats->SetAchievement(ach_id.c_str());
-				ach_unlocked = true;
-				SteamSync();
-			}
+			StatsAchievement(ach_id.c_str());
+			SteamSync();
 		}
+	}
 
-		//This checks the number of levels and zones since you lost your hat
-		//At certain points, it gives you achievements
-		if (_hat.wearing && _hat.level > -1 && _hat.zone > -1)
-		{
-			//Complete an entire level from start to finish without losing your hat
-			if (world_index > _hat.level && _hat.zone == 0)
-				m_pSteamUserStats->SetAchievement("ach_hattiquette");
+	//This checks the number of levels and zones since you lost your hat
+	//At certain points, it gives you achievements
+	if (_hat.wearing && _hat.level > -1 && _hat.zone > -1)
+	{
+		//Complete an entire level from start to finish without losing your hat
+		if (world_index > _hat.level && _hat.zone == 0)
+			StatsAchievement("ach_hattiquette");
 
-			//Complete a zone without getting hit
-			if (_hat.zone != zone_index)
-				m_pSteamUserStats->SetAchievement("ach_watch_the_hat");
+		//Complete a zone without getting hit
+		if (_hat.zone != zone_index)
+			StatsAchievement("ach_watch_the_hat");
 
-			if (world_index - _hat.level > 2)
-				m_pSteamUserStats->SetAchievement("ach_elite_hat");
-		}
+		if (world_index - _hat.level > 2)
+			StatsAchievement("ach_elite_hat");
 	}
 }
 
@@ -262,16 +244,13 @@ void PlayerStats::HatCheckAch()
 void PlayerStats::WinCheckAch()
 {
 	//This is called when you win the game
-	if (SteamUserValid())
-	{
-		//We got one guaranteed achievement to give (win game)
-		m_pSteamUserStats->SetAchievement("ach_lv_7");
+	//We got one guaranteed achievement to give (win game)
+	StatsAchievement("ach_lv_7");
 
-		//If the player managed to not get hit in the entire game, give them this achievement
-		//you win, you beautiful bastard
-		if (_hat.wearing && _hat.level == 0 && _hat.zone == 0)
-			m_pSteamUserStats->SetAchievement("ach_hardest_hat");
-	}
+	//If the player managed to not get hit in the entire game, give them this achievement
+	//you win, you beautiful bastard
+	if (_hat.wearing && _hat.level == 0 && _hat.zone == 0)
+		StatsAchievement("ach_hardest_hat");
 
 	SteamSync();
 }
@@ -10,6 +10,8 @@
 
 #include "master.h"
 
+#include <stdarg.h>
+
 /*-----------------------------------------------------------------------------
 
 -----------------------------------------------------------------------------*/
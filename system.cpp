@@ -21,6 +21,7 @@
 #include "game.h"
 
 #define SETTINGS_INI     "settings.ini"
+#define SETTINGS_DELAY   1000 //Milliseconds to gather setting changes before writing them out.
 
 class Controller
 {
@@ -82,6 +83,10 @@ static int                resolution_index;
 static int                current_controller;
 static vector<Controller> controllers;
 static vector<int>        joystick_map;
+static iniFile            config;
+static bool               config_open;
+static bool               config_pending;
+static long               config_save;
 
 /*-----------------------------------------------------------------------------
 
@@ -103,13 +108,27 @@ void controllers_enumerate()
 
 static void ini_update()
 {
-	iniFile   ini;
+	iniFile&  ini = SystemConfig();
 
-	ini.Open(SystemConfigFile());
 	ini.IntSet("Window", "Width", screen_size.x);
 	ini.IntSet("Window", "Height", screen_size.y);
 }
 
+//Settings changes are held in memory and written out once they've had
+//a moment to settle, so dragging a slider doesn't rewrite the file every frame.
+static void config_update()
+{
+	if (!config_open || !config.Dirty())
+		return;
+	if (!config_pending) {
+		config_pending = true;
+		config_save = SystemTick() + SETTINGS_DELAY;
+		return;
+	}
+	if (SystemTick() >= config_save)
+		SystemConfigSave();
+}
+
 /*-----------------------------------------------------------------------------
 
 -----------------------------------------------------------------------------*/
@@ -120,9 +139,8 @@ void SystemCreate(bool valid_check)
 	GLcoord2    win_size;
 	bool        fullscreen;
 	bool        skip_sanity;
-	iniFile     ini;
+	iniFile&    ini = SystemConfig();
 
-	ini.Open(SystemConfigFile());
 	win_size.x = max(ini.IntGet("Window", "Width"), 640);
 	win_size.y = max(ini.IntGet("Window", "Height"), 480);
 	skip_sanity = ini.BoolGet("Window", "SkipSanity");
@@ -167,9 +185,8 @@ void SystemCreate(bool valid_check)
 void SystemSizeWindow()
 {
 	GLcoord2    win_size;
-	iniFile     ini;
+	iniFile&    ini = SystemConfig();
 
-	ini.Open(SystemConfigFile());
 	win_size.x = max(ini.IntGet("Window", "Width"), 640);
 	win_size.y = max(ini.IntGet("Window", "Height"), 480);
 
@@ -240,12 +257,29 @@ string SystemConfigFile()
 	return SystemSavePath() + SETTINGS_INI;
 }
 
+//The settings file is parsed once and shared by everyone who reads or writes it.
+iniFile& SystemConfig()
+{
+	if (!config_open) {
+		config.Open(SystemConfigFile());
+		config.Defer(true);
+		config_open = true;
+	}
+	return config;
+}
+
+void SystemConfigSave()
+{
+	config_pending = false;
+	if (config_open)
+		config.Save();
+}
+
 void SystemResolutionSet(int index)
 {
 	resolution_index = index;
-	iniFile     ini;
+	iniFile&    ini = SystemConfig();
 
-	ini.Open(SystemConfigFile());
 	ini.IntSet("Window", "Width", resolution_size[index].x);
 	ini.IntSet("Window", "Height", resolution_size[index].y);
 	Console("Changing to mode %d: %d x %d", index, resolution_size[index].x, resolution_size[index].y);
@@ -283,6 +317,7 @@ void SystemUpdate()
 {
 	SDL_Event event;
 
+	config_update();
 	//joystick_check();
 	//Why is this here? "Mouse up" isn't a key. Why does removing this break the game?
 	InputKeyUp(INPUT_MOUSE_MOVED);
@@ -448,6 +483,11 @@ GLcoord2 SystemMouse()
 	return mouse_pos;
 }
 
+void SystemMouseSet(GLcoord2 pos)
+{
+	mouse_pos = pos;
+}
+
 GLcoord2 SystemSize()
 {
 	return screen_size;
@@ -1,10 +1,13 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+class iniFile&   SystemConfig();
 string          SystemConfigFile();
+void            SystemConfigSave();
 void            SystemInit();
 void            SystemGrab();
 GLcoord2        SystemMouse();
+void            SystemMouseSet(GLcoord2 pos);
 int             SystemResolutionIndex();
 void            SystemResolutionSet(int index);
 GLcoord2				SystemResolution (int i);
@@ -14,7 +17,9 @@ string          SystemSavePath();
 GLcoord2        SystemSize();
 void            SystemSwapBuffers();
 void            SystemTerm();
+#ifndef WORLDGEN_HEADLESS
 void            SystemThread(char* name, int (SDLCALL *fn)(void *), void *data);
+#endif
 long            SystemTick();
 int             SystemTime();
 void            SystemUpdate();
@@ -11,8 +11,10 @@
 #include "master.h"
 
 #include "file.h"
+#include "gpu.h"
 #include "resource.h"
 #include "texture.h"
+#include "watch.h"
 
 #define FAIL_SIZE       32
 #define DEFAULT_SIZE    8
@@ -70,6 +72,7 @@ void Texture::ImageLoad(const char* filename)
 	ilEnable(IL_ORIGIN_SET);
 	ilOriginFunc(IL_ORIGIN_LOWER_LEFT);
 	location = ResourceLocation(filename, RESOURCE_TEXTURE);
+	_location = location;
 	ok = ilLoadImage(location.c_str());
 	if (!ok) {
 		Console("%s not found.", filename);
@@ -95,6 +98,15 @@ void Texture::Load()
 	//gluBuild2DMipmaps(GL_TEXTURE_2D, 4, _size.x, _size.y, GL_RGBA, GL_UNSIGNED_BYTE, _buffer);
 }
 
+//Throw out the pixels we have and go back to the disk for new ones.
+void Texture::Reload()
+{
+	if (_buffer)
+		delete[] _buffer;
+	_buffer = NULL;
+	Load();
+}
+
 void Texture::FilterApply()
 {
 	Bind();
@@ -105,6 +117,7 @@ void Texture::FilterApply()
 void Texture::Bind()
 {
 	glBindTexture(GL_TEXTURE_2D, _glid);
+	GpuForget();
 }
 
 Texture::Texture(string name)
@@ -116,17 +129,34 @@ Texture::Texture(string name)
 	Load();
 }
 
+//A texture built in memory rather than loaded from disk.
+Texture::Texture(string name, GLcoord2 size, const char* buffer)
+{
+	_glid = 0;
+	_buffer = NULL;
+	_name = name;
+	SetPixels(size, buffer);
+}
+
+//Take a copy of the given RGBA pixels and send them to the card.
+void Texture::SetPixels(GLcoord2 size, const char* buffer)
+{
+	if (_buffer)
+		delete[] _buffer;
+	_size = size;
+	_buffer = new char[_size.x * _size.y * 4];
+	memcpy(_buffer, buffer, _size.x * _size.y * 4);
+	Load();
+}
+
 /*-----------------------------------------------------------------------------
 
 -----------------------------------------------------------------------------*/
 
 void TexturePush(unsigned id)
 {
-	int     prev_texture;
-
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
-	texture_stack.push_back((unsigned)prev_texture);
-	glBindTexture(GL_TEXTURE_2D, id);
+	texture_stack.push_back(GpuTextureGet());
+	GpuTexture(id);
 }
 
 void TexturePop()
@@ -135,7 +165,15 @@ void TexturePop()
 
 	id = texture_stack[texture_stack.size() - 1];
 	texture_stack.pop_back();
-	glBindTexture(GL_TEXTURE_2D, id);
+	GpuTexture(id);
+}
+
+static void texture_changed(string filename)
+{
+	for (unsigned i = 0; i < library.size(); i++) {
+		if (library[i]->Location() == filename)
+			library[i]->Reload();
+	}
 }
 
 /*
@@ -154,6 +192,25 @@ Texture* TextureFromName(string name)
 	}
 	t = new Texture(name);
 	library.push_back(t);
+	WatchFile(t->Location(), texture_changed);
+	return t;
+}
+
+//Like TextureFromName, but the pixels come from the caller. Asking for the
+//same name again replaces the pixels. The library keeps its own copy, so
+//these survive losing the context just like the ones from disk.
+Texture* TextureFromBuffer(string name, GLcoord2 size, const char* buffer)
+{
+	Texture* t;
+
+	for (unsigned i = 0; i < library.size(); i++) {
+		if (!stricmp(library[i]->Name().c_str(), name.c_str())) {
+			library[i]->SetPixels(size, buffer);
+			return library[i];
+		}
+	}
+	t = new Texture(name, size, buffer);
+	library.push_back(t);
 	return t;
 }
 
@@ -183,11 +240,17 @@ void TextureUpdate()
 {
 	if (!validate_needed)
 		return;
-	Console ("Reloading %d textures...", library.size ());
 	validate_needed = false;
+	//A resize usually keeps the same context, and our textures with it. Only
+	//re-upload the ones the driver actually lost. We still have the pixels,
+	//so this never touches the disk.
+	int reloaded = 0;
 	for (unsigned i = 0; i < library.size(); i++) {
-		//if (glIsTexture(library[i]->Id()))
-			//continue;
+		if (glIsTexture(library[i]->Id()))
+			continue;
 		library[i]->Load();
+		reloaded++;
 	}
+	if (reloaded)
+		Console ("Restored %d of %d textures.", reloaded, library.size ());
 }
\ No newline at end of file
@@ -6,6 +6,7 @@ class Texture
 private:
 	string          _name;
 	string          _filename;
+	string          _location;
 	GLcoord2        _size;
 	unsigned        _glid;
 	char*           _buffer;
@@ -15,16 +16,21 @@ private:
 
 public:
 	Texture(string name);
+	Texture(string name, GLcoord2 size, const char* buffer);
 
-	void            Bind();
+	void            Bind();   //For loading. Drawing binds through GpuTexture ().
 	const char*     Data() { return _buffer; }
 	void            Destroy();
 	unsigned        Id() { return _glid; }
 	void            Load();
+	string          Location() { return _location; }
 	string          Name() { return _name; }
+	void            Reload();
+	void            SetPixels(GLcoord2 size, const char* buffer);
 	GLcoord2        Size() { return _size; }
 };
 
+Texture*  TextureFromBuffer(string name, GLcoord2 size, const char* buffer);
 Texture*  TextureFromName(string name);
 Texture*  TextureFromName(char* name);
 void      TextureUpdate();
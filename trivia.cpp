@@ -14,6 +14,7 @@
 
 #include "audio.h"
 #include "game.h"
+#include "gpu.h"
 #include "interface.h"
 #include "player.h"
 #include "random.h"
@@ -139,42 +140,42 @@ static void do_trivia_build(vector<string> str)
 	size.y += line_height;
 	size /= 2;
 	trivia_render_list = RenderListCompile(TRIVIA_ID);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	color = GLrgba();
 	//GLrgbaUnique (trivia_current)
 	color.alpha = 0.75f;
-	glColor4fv(&color.red);
-	glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
+	GpuColor4fv(&color.red);
+	GpuTexture(SpriteMapTexture());
 	uv = SpriteMapLookup(SPRITE_FADE);
-	glBegin(GL_QUADS);
-	glTexCoord2fv(&uv->uv[0].x);  glVertex2i(-size.x, -size.y);
-	glTexCoord2fv(&uv->uv[1].x);  glVertex2i(size.x, -size.y);
-	glTexCoord2fv(&uv->uv[2].x);  glVertex2i(size.x, size.y);
-	glTexCoord2fv(&uv->uv[3].x);  glVertex2i(-size.x, size.y);
-	glEnd();
-	glBlendFunc(GL_ONE, GL_ONE);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2fv(&uv->uv[0].x);  GpuVertex2i(-size.x, -size.y);
+	GpuTexCoord2fv(&uv->uv[1].x);  GpuVertex2i(size.x, -size.y);
+	GpuTexCoord2fv(&uv->uv[2].x);  GpuVertex2i(size.x, size.y);
+	GpuTexCoord2fv(&uv->uv[3].x);  GpuVertex2i(-size.x, size.y);
+	GpuEnd();
+	GpuBlend(GL_ONE, GL_ONE);
 	uv = SpriteMapLookup(SPRITE_GLOW);
-	glBegin(GL_QUADS);
-	glTexCoord2fv(&uv->uv[0].x);  glVertex2i(-size.x, -size.y);
-	glTexCoord2fv(&uv->uv[1].x);  glVertex2i(size.x, -size.y);
-	glTexCoord2fv(&uv->uv[2].x);  glVertex2i(size.x, size.y);
-	glTexCoord2fv(&uv->uv[3].x);  glVertex2i(-size.x, size.y);
-	glEnd();
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2fv(&uv->uv[0].x);  GpuVertex2i(-size.x, -size.y);
+	GpuTexCoord2fv(&uv->uv[1].x);  GpuVertex2i(size.x, -size.y);
+	GpuTexCoord2fv(&uv->uv[2].x);  GpuVertex2i(size.x, size.y);
+	GpuTexCoord2fv(&uv->uv[3].x);  GpuVertex2i(-size.x, size.y);
+	GpuEnd();
 
 	color = GLrgba();
-	glColor3fv(&color.red);
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glBegin(GL_LINE_STRIP);
-	glVertex2i(-size.x, -size.y);
-	glVertex2i(size.x, -size.y);
-	glVertex2i(size.x, size.y);
-	glVertex2i(-size.x, size.y);
-	glVertex2i(-size.x, -size.y);
-	glEnd();
+	GpuColor3fv(&color.red);
+	GpuTexture(0);
+	GpuBegin(GL_LINE_STRIP);
+	GpuVertex2i(-size.x, -size.y);
+	GpuVertex2i(size.x, -size.y);
+	GpuVertex2i(size.x, size.y);
+	GpuVertex2i(-size.x, size.y);
+	GpuVertex2i(-size.x, -size.y);
+	GpuEnd();
 
 	//glColor3fv (&color.red);
-	glColor3f(1, 1, 1);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuColor3f(1, 1, 1);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	for (unsigned i = 0; i < str.size(); i++) {
 		int     width;
 
@@ -288,9 +289,9 @@ void TriviaRender()
 	pos.x += pos.z;//Position box midway between camera and right edge of screen.
 	scale = (float)(trivia_expire_time - GameTick ()) / TRIVIA_EXPIRE;
 	TexturePush (0);
-	glDisable (GL_DEPTH_TEST);
-	glDisable (GL_STENCIL_TEST);
-	glBlendFunc	(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDisable (GL_DEPTH_TEST);
+	GpuDisable (GL_STENCIL_TEST);
+	GpuBlend	(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glPushMatrix ();
 	glTranslatef (pos.x, pos.y, 0);
 	glScalef (scale * TRIVIA_SCALE, TRIVIA_SCALE, TRIVIA_SCALE);
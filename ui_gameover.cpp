@@ -1,5 +1,6 @@
 #include "master.h"
 #include "ui_gameover.h"
+#include "LayoutCache.h"
 #include "player.h"
 #include "random.h"
 
@@ -7,7 +8,7 @@ using namespace pyrodactyl;
 
 void GameOverMenu::Init(const char* filename)
 {
-	XMLDoc layout_doc(filename);
+	const XMLDoc &layout_doc = LayoutDoc(filename);
 	if (layout_doc.ready())
 	{
 		rapidxml::xml_node<char> *node = layout_doc.Doc()->first_node("game_over");
@@ -1,5 +1,6 @@
 #include "master.h"
 #include "ui_hatshop.h"
+#include "LayoutCache.h"
 #include "world.h"
 #include "random.h"
 
@@ -20,7 +21,7 @@ bidiiter random_unique(bidiiter begin, bidiiter end, size_t num_random) {
 
 void HatShopMenu::Init()
 {
-	XMLDoc layout_doc("core/data/ui_hat.xml");
+	const XMLDoc &layout_doc = LayoutDoc("core/data/ui_hat.xml");
 	if (layout_doc.ready())
 	{
 		rapidxml::xml_node<char> *node = layout_doc.Doc()->first_node("store");
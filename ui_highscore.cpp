@@ -1,5 +1,6 @@
 #include "master.h"
 #include "ui_highscore.h"
+#include "LayoutCache.h"
 #include "steam_data.h"
 
 using namespace pyrodactyl;
@@ -18,7 +19,7 @@ void HighScoreMenu::AddScore(const HighScoreData &h)
 //-----------------------------------------------------------------------------
 void HighScoreMenu::Init()
 {
-	XMLDoc layout_doc("core/data/ui_score.xml");
+	const XMLDoc &layout_doc = LayoutDoc("core/data/ui_score.xml");
 	if (layout_doc.ready())
 	{
 		rapidxml::xml_node<char> *node = layout_doc.Doc()->first_node("score");
@@ -1,14 +1,16 @@
 #include "master.h"
 #include "ui_mainmenu.h"
+#include "LayoutCache.h"
 #include "file.h"
 #include "game.h"
+#include "gpu.h"
 #include "env.h"
 
 using namespace pyrodactyl;
 
 void MainMenu::Init()
 {
-	XMLDoc layout_doc("core/data/ui_layout.xml");
+	const XMLDoc &layout_doc = LayoutDoc("core/data/ui_layout.xml");
 	if (layout_doc.ready())
 	{
 		rapidxml::xml_node<char> *node = layout_doc.Doc()->first_node("ui");
@@ -74,14 +76,14 @@ void MainMenu::Draw(const bool game_running)
 		GLvector2 size = RenderViewportSize();
 		GLrgba col = gTextManager.GetColor(col_pause);
 
-		glBindTexture(GL_TEXTURE_2D, 0);
-		glBegin(GL_QUADS);
-		glColor4f(col.red, col.green, col.blue, col.alpha);
-		glVertex3f(0, 0, 0);
-		glVertex3f(size.x, 0, 0);
-		glVertex3f(size.x, size.y, 0);
-		glVertex3f(0, size.y, 0);
-		glEnd();
+		GpuTexture(0);
+		GpuBegin(GL_QUADS);
+		GpuColor4f(col.red, col.green, col.blue, col.alpha);
+		GpuVertex3f(0, 0, 0);
+		GpuVertex3f(size.x, 0, 0);
+		GpuVertex3f(size.x, size.y, 0);
+		GpuVertex3f(0, size.y, 0);
+		GpuEnd();
 
 		if (state == STATE_NORMAL)
 			bg_pause.Draw();
@@ -1,5 +1,6 @@
 #include "master.h"
 #include "ui_opt.h"
+#include "LayoutCache.h"
 #include "env.h"
 #include "system.h"
 #include "steam_data.h"
@@ -9,7 +10,7 @@ using namespace pyrodactyl;
 
 void OptionMenu::Init()
 {
-	XMLDoc layout_doc("core/data/ui_settings.xml");
+	const XMLDoc &layout_doc = LayoutDoc("core/data/ui_settings.xml");
 	if (layout_doc.ready())
 	{
 		rapidxml::xml_node<char> *node = layout_doc.Doc()->first_node("settings");
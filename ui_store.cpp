@@ -1,5 +1,6 @@
 #include "master.h"
 #include "ui_store.h"
+#include "LayoutCache.h"
 #include "projectile.h"
 #include "world.h"
 #include "fx.h"
@@ -20,7 +21,7 @@ StoreMenu::StoreMenu()
 
 void StoreMenu::Init()
 {
-	XMLDoc layout_doc("core/data/ui_store.xml");
+	const XMLDoc &layout_doc = LayoutDoc("core/data/ui_store.xml");
 	if (layout_doc.ready())
 	{
 		rapidxml::xml_node<char> *node = layout_doc.Doc()->first_node("store");
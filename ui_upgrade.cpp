@@ -1,12 +1,13 @@
 #include "master.h"
 #include "ui_upgrade.h"
+#include "LayoutCache.h"
 #include "world.h"
 
 using namespace pyrodactyl;
 
 void UpgradeMenu::Init()
 {
-	XMLDoc layout_doc("core/data/ui_upgrade.xml");
+	const XMLDoc &layout_doc = LayoutDoc("core/data/ui_upgrade.xml");
 	if (layout_doc.ready())
 	{
 		rapidxml::xml_node<char> *node = layout_doc.Doc()->first_node("upgrade");
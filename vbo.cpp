@@ -10,6 +10,7 @@
   -----------------------------------------------------------------------------*/
 
 #include "master.h"
+#include "gpu.h"
 #include "vbo.h"
 
 // VBO Extension Definitions, From glext.h
@@ -30,6 +31,8 @@ VBO::VBO()
 	_use_normal = 0;
 	_size_color = 0;
 	_polygon = 0;
+	_flat = false;
+	_depth = 0.0f;
 }
 
 VBO::~VBO()
@@ -67,6 +70,7 @@ void VBO::Create(int polygon, int index_count, int vert_count, unsigned* index_l
 	if (!index_count || !vert_count)
 		return;
 	_polygon = polygon;
+	_flat = false;
 	_use_color = color_list != NULL;
 	_use_normal = normal_list != NULL;
 	_size_vertex = sizeof(GLvector) * vert_count;
@@ -130,6 +134,74 @@ void VBO::Create(GLmesh* m)
 	Create(GL_TRIANGLES, m->_index.size(), m->Vertices(), &m->_index[0], &m->_vertex[0], normal_list, color_list, &m->_uv[0]);
 }
 
+//Flat meshes are already interleaved and packed, so the vertex array goes
+//straight to the card in one call with no repacking.
+void VBO::Create(GLflatMesh* m)
+{
+	if (_id_vertex)
+		glDeleteBuffersARB(1, &_id_vertex);
+	if (_id_index)
+		glDeleteBuffersARB(1, &_id_index);
+	_id_vertex = 0;
+	_id_index = 0;
+	_ready = false;
+	if (m->_index.empty())
+		return;
+	_flat = true;
+	_polygon = GL_TRIANGLES;
+	_depth = m->_depth;
+	_use_color = m->_use_color;
+	_use_normal = false;
+	_size_buffer = sizeof(GLflatVertex) * m->Vertices();
+	glGenBuffersARB(1, &_id_vertex);
+	glBindBufferARB(GL_ARRAY_BUFFER, _id_vertex);
+	glBufferDataARB(GL_ARRAY_BUFFER, _size_buffer, &m->_vertex[0], GL_STATIC_DRAW_ARB);
+	glBindBufferARB(GL_ARRAY_BUFFER, 0);
+	glGenBuffersARB(1, &_id_index);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER, _id_index);
+	glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER, m->_index.size() * sizeof(unsigned), &m->_index[0], GL_STATIC_DRAW_ARB);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER, 0);
+	_index_count = m->_index.size();
+	_ready = true;
+}
+
+//The UVs are 16-bit integers, which OpenGL won't normalize for us through
+//the fixed-function pointers. We scale them back down with the texture
+//matrix instead, and lift the mesh to its depth with the modelview.
+void VBO::RenderFlat()
+{
+	glBindBufferARB(GL_ARRAY_BUFFER, _id_vertex);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	if (_use_color)
+		glEnableClientState(GL_COLOR_ARRAY);
+	else
+		glDisableClientState(GL_COLOR_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(GLflatVertex), (void*)offsetof(GLflatVertex, x));
+	if (_use_color)
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(GLflatVertex), (void*)offsetof(GLflatVertex, color));
+	glTexCoordPointer(2, GL_UNSIGNED_SHORT, sizeof(GLflatVertex), (void*)offsetof(GLflatVertex, uv));
+	glMatrixMode(GL_TEXTURE);
+	glPushMatrix();
+	glLoadIdentity();
+	glScalef(1.0f / GLFLAT_UV_SCALE, 1.0f / GLFLAT_UV_SCALE, 1.0f);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glTranslatef(0.0f, 0.0f, _depth);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER, _id_index);
+	GpuDrawElements(_polygon, _index_count, GL_UNSIGNED_INT, 0);
+	glPopMatrix();
+	glMatrixMode(GL_TEXTURE);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (_use_color)
+		glDisableClientState(GL_COLOR_ARRAY);
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
 void VBO::Render()
 {
 	if (!_ready)
@@ -144,6 +216,10 @@ void VBO::Render()
 	return;
 	}
 	*/
+	if (_flat) {
+		RenderFlat();
+		return;
+	}
 	// bind VBOs for vertex array and index array
 	glBindBufferARB(GL_ARRAY_BUFFER, _id_vertex);
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -165,7 +241,7 @@ void VBO::Render()
 	//Draw it
 	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER, _id_index); // for indices
 	glEnableClientState(GL_VERTEX_ARRAY);             // activate vertex coords array
-	glDrawElements(_polygon, _index_count, GL_UNSIGNED_INT, 0);
+	GpuDrawElements(_polygon, _index_count, GL_UNSIGNED_INT, 0);
 	glDisableClientState(GL_VERTEX_ARRAY);            // deactivate vertex array
 	// bind with 0, so, switch back to normal pointer operation
 	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
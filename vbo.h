@@ -15,12 +15,17 @@ class VBO
 	bool      _ready;
 	bool      _use_color;
 	bool      _use_normal;
+	bool      _flat;
+	float     _depth;
+
+	void      RenderFlat();
 
 public:
 	VBO();
 	~VBO();
 	void      Create(int polygon, int index_count, int vert_count, unsigned* index_list, GLvector* vert_list, GLvector* normal_list, GLrgba* color_list, GLvector2* uv_list);
 	void      Create(GLmesh* m);
+	void      Create(GLflatMesh* m);
 	void      Clear();
 	void      Render();
 	bool      Ready();
@@ -16,6 +16,7 @@
 #include "collision.h"
 #include "env.h"
 #include "entity.h"
+#include "gpu.h"
 #include "hud.h"
 #include "player.h"
 #include "render.h"
@@ -91,9 +92,9 @@ void VisibleUpdate()
 void VisibleInvert(bool invert)
 { 
 	if (invert)
-		glStencilFunc(GL_EQUAL, 1, 0xFF);
+		GpuStencilFunc(GL_EQUAL, 1, 0xFF);
 	else
-		glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
+		GpuStencilFunc(GL_NOTEQUAL, 1, 0xFF);
 }
 
 void VisibleRenderCone(float intensity, float depth)
@@ -109,18 +110,18 @@ void VisibleRenderCone(float intensity, float depth)
 
 	if (PlayerIgnore())
 		return;
-	glEnable (GL_BLEND);
-	glBlendFunc (GL_ONE, GL_ONE);
-	glEnable (GL_TEXTURE_2D);
-  glBindTexture (GL_TEXTURE_2D, SpriteMapTexture ());
+	GpuEnable (GL_BLEND);
+	GpuBlend (GL_ONE, GL_ONE);
+	GpuEnable (GL_TEXTURE_2D);
+  GpuTexture (SpriteMapTexture ());
   if (EnvValueb (ENV_SHADOWS))
-    glEnable (GL_STENCIL_TEST);
-  glDepthMask (false);
-	glDisable (GL_DEPTH_TEST);
+    GpuEnable (GL_STENCIL_TEST);
+  GpuDepthMask (false);
+	GpuDisable (GL_DEPTH_TEST);
 
 	radius = Player()->VisionRadius() * 7;
 	light = WorldLampColor()*intensity;
-	glColor4fv(&light.red);
+	GpuColor4fv(&light.red);
 	origin = PlayerHead();
 	offset.x = PlayerAim().x - origin.x;
   offset.y = PlayerAim ().y - origin.y;
@@ -134,62 +135,62 @@ void VisibleRenderCone(float intensity, float depth)
   corner1.z = depth;
   corner2.z = depth;
 
-	glBegin(GL_TRIANGLES);
-	glTexCoord2fv(&uv->uv[0].x);
-	glVertex3fv(&origin.x);
-	glTexCoord2fv(&uv->uv[3].x);
-	glVertex3fv(&corner1.x);
-	glTexCoord2fv(&uv->uv[3].x);
-	glVertex3fv(&corner2.x);
-	glEnd();
-	glDepthMask(true);
-	glEnable (GL_DEPTH_TEST);
+	GpuBegin(GL_TRIANGLES);
+	GpuTexCoord2fv(&uv->uv[0].x);
+	GpuVertex3fv(&origin.x);
+	GpuTexCoord2fv(&uv->uv[3].x);
+	GpuVertex3fv(&corner1.x);
+	GpuTexCoord2fv(&uv->uv[3].x);
+	GpuVertex3fv(&corner2.x);
+	GpuEnd();
+	GpuDepthMask(true);
+	GpuEnable (GL_DEPTH_TEST);
 }
 
 void VisibleRender()
 {
 	//Draw our extruded quads onto the stencil buffer WITHOUT drawing to screen.
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glColorMask(false, false, false, false);
-	glDepthMask(false);
-	glBegin(GL_QUADS);
+	GpuTexture(0);
+	GpuColorMask(false, false, false, false);
+	GpuDepthMask(false);
+	GpuBegin(GL_QUADS);
 	for (unsigned i = 0; i < quads.size(); i++) {
 		for (unsigned j = 0; j < 4; j++)
-			glVertex3f(quads[i].corner[j].x, quads[i].corner[j].y, 0.16f);
+			GpuVertex3f(quads[i].corner[j].x, quads[i].corner[j].y, 0.16f);
 	}
-	glEnd();
-	glColorMask(true, true, true, true);
-	glDepthMask(true);
+	GpuEnd();
+	GpuColorMask(true, true, true, true);
+	GpuDepthMask(true);
 }
 
 void VisibleRenderLOS ()
 {
 	//Show the line segments and extruded quads in debug view.
-	glDisable (GL_STENCIL_TEST);
-	glDisable (GL_DEPTH_TEST);
-	glColor3f (1, 1, 0);
-	glBindTexture (GL_TEXTURE_2D, 0);
-	glEnable (GL_BLEND);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin (GL_LINES);
+	GpuDisable (GL_STENCIL_TEST);
+	GpuDisable (GL_DEPTH_TEST);
+	GpuColor3f (1, 1, 0);
+	GpuTexture (0);
+	GpuEnable (GL_BLEND);
+	GpuBlend (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBegin (GL_LINES);
 	for (unsigned i = 0; i < lines.size (); i++) {
 		GLrgba c = GLrgbaUnique (i);
-		glColor3fv (&c.red);
-		glVertex3f (lines[i].start.x, lines[i].start.y, 0.1f);
-		glVertex3f (lines[i].end.x, lines[i].end.y, 0.1f);
+		GpuColor3fv (&c.red);
+		GpuVertex3f (lines[i].start.x, lines[i].start.y, 0.1f);
+		GpuVertex3f (lines[i].end.x, lines[i].end.y, 0.1f);
 	}
-	glEnd ();
-	glDepthMask (false);
-	glEnable (GL_DEPTH_TEST);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glColor4f (0.5f, 0.0f, 0.0f, 0.2f);
-	glBegin (GL_QUADS);
+	GpuEnd ();
+	GpuDepthMask (false);
+	GpuEnable (GL_DEPTH_TEST);
+	GpuBlend (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuColor4f (0.5f, 0.0f, 0.0f, 0.2f);
+	GpuBegin (GL_QUADS);
 	for (unsigned i = 0; i < quads.size (); i++) {
 		for (unsigned j = 0; j < 4; j++)
-			glVertex3f (quads[i].corner[j].x, quads[i].corner[j].y, 0.16f);
+			GpuVertex3f (quads[i].corner[j].x, quads[i].corner[j].y, 0.16f);
 	}
-	glEnd ();
-	glEnable (GL_STENCIL_TEST);
-	glDepthMask (true);
+	GpuEnd ();
+	GpuEnable (GL_STENCIL_TEST);
+	GpuDepthMask (true);
 
 }
\ No newline at end of file
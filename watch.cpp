@@ -0,0 +1,242 @@
+/*-----------------------------------------------------------------------------
+
+  Watch.cpp
+
+  Keeps an eye on data files and reloads them when they change on disk.
+  Modules register the files they loaded along with a function to reload
+  them. On Linux we ask the kernel (inotify) to tell us when a directory
+  changes. Everywhere else we poll the modification times twice a second.
+
+  Either way, nothing is reloaded the moment it changes. Changes are queued
+  and handed out in WatchUpdate (), which the main loop calls at a point
+  where it's safe to swap out textures and game data.
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#if defined(__linux__)
+#define WATCH_INOTIFY
+#include <sys/inotify.h>
+#endif
+
+#include "console.h"
+#include "system.h"
+#include "watch.h"
+
+#define POLL_INTERVAL     500
+#define EVENT_BUFFER      4096
+
+struct WatchEntry
+{
+	string          filename;
+	string          key;
+	WatchCallback   callback;
+	time_t          stamp;
+	bool            polled;
+};
+
+static vector<WatchEntry> entry;
+static vector<string>     pending;
+static int                next_poll;
+
+#ifdef WATCH_INOTIFY
+
+struct WatchDir
+{
+	int             wd;
+	string          path;
+};
+
+static int                notify = -1;
+static vector<WatchDir>   dir;
+
+#endif
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//The same file can be named with either slash, or with a leading "./".
+//Reduce them all to one form so we can compare them.
+static string key_from_filename(string filename)
+{
+	for (unsigned i = 0; i < filename.size(); i++) {
+		if (filename[i] == '\\')
+			filename[i] = '/';
+	}
+	while (filename.compare(0, 2, "./") == 0)
+		filename.erase(0, 2);
+	return filename;
+}
+
+static time_t stamp_from_key(const string& key)
+{
+	boost::system::error_code   error;
+	time_t                      stamp;
+
+	stamp = last_write_time(path(key), error);
+	if (error)
+		return 0;
+	return stamp;
+}
+
+static void queue(const string& key)
+{
+	for (unsigned i = 0; i < pending.size(); i++) {
+		if (pending[i] == key)
+			return;
+	}
+	pending.push_back(key);
+}
+
+#ifdef WATCH_INOTIFY
+
+//Start listening to the directory holding this file, if we aren't already.
+//Returns false if the kernel won't let us, in which case we'll poll it.
+static bool listen(const string& key)
+{
+	string    path;
+	size_t    slash;
+	int       wd;
+
+	if (notify < 0)
+		return false;
+	slash = key.find_last_of('/');
+	path = slash == string::npos ? "." : key.substr(0, slash);
+	for (unsigned i = 0; i < dir.size(); i++) {
+		if (dir[i].path == path)
+			return true;
+	}
+	wd = inotify_add_watch(notify, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (wd < 0) {
+		Console("Watch: Unable to watch %s.", path.c_str());
+		return false;
+	}
+	WatchDir  d;
+
+	d.wd = wd;
+	d.path = path;
+	dir.push_back(d);
+	return true;
+}
+
+static void do_events()
+{
+	char      buffer[EVENT_BUFFER] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	ssize_t   length;
+
+	if (notify < 0)
+		return;
+	//The descriptor is non-blocking, so this stops as soon as the kernel has
+	//nothing more for us.
+	while ((length = read(notify, buffer, sizeof(buffer))) > 0) {
+		for (char* p = buffer; p < buffer + length; ) {
+			const inotify_event*  e = (const inotify_event*)p;
+
+			p += sizeof(inotify_event) + e->len;
+			if (!e->len)
+				continue;
+			for (unsigned i = 0; i < dir.size(); i++) {
+				if (dir[i].wd != e->wd)
+					continue;
+				if (dir[i].path == ".")
+					queue(e->name);
+				else
+					queue(dir[i].path + "/" + e->name);
+				break;
+			}
+		}
+	}
+}
+
+#else
+
+static bool listen(const string&) { return false; }
+static void do_events() {}
+
+#endif
+
+static void do_poll()
+{
+	time_t    stamp;
+
+	if (SystemTick() < next_poll)
+		return;
+	next_poll = SystemTick() + POLL_INTERVAL;
+	for (unsigned i = 0; i < entry.size(); i++) {
+		if (!entry[i].polled)
+			continue;
+		stamp = stamp_from_key(entry[i].key);
+		if (stamp != entry[i].stamp)
+			queue(entry[i].key);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+void WatchInit()
+{
+#ifdef WATCH_INOTIFY
+	notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notify < 0)
+		Console("WatchInit: inotify unavailable. Polling for changes instead.");
+#endif
+}
+
+void WatchTerm()
+{
+#ifdef WATCH_INOTIFY
+	if (notify >= 0)
+		close(notify);
+	notify = -1;
+	dir.clear();
+#endif
+	entry.clear();
+	pending.clear();
+}
+
+//Ask for callback to be run whenever the given file changes. Registering the
+//same file and callback twice is harmless, so loaders can call this every
+//time they run.
+void WatchFile(string filename, WatchCallback callback)
+{
+	WatchEntry  e;
+
+	e.key = key_from_filename(filename);
+	for (unsigned i = 0; i < entry.size(); i++) {
+		if (entry[i].key == e.key && entry[i].callback == callback)
+			return;
+	}
+	e.filename = filename;
+	e.callback = callback;
+	e.stamp = stamp_from_key(e.key);
+	e.polled = !listen(e.key);
+	entry.push_back(e);
+}
+
+void WatchUpdate()
+{
+	vector<string>  changed;
+
+	do_events();
+	do_poll();
+	if (pending.empty())
+		return;
+	//Callbacks might load more files and register them, so work from a copy
+	//of the queue and walk the entries by index.
+	changed.swap(pending);
+	for (unsigned c = 0; c < changed.size(); c++) {
+		for (unsigned i = 0; i < entry.size(); i++) {
+			if (entry[i].key != changed[c])
+				continue;
+			entry[i].stamp = stamp_from_key(entry[i].key);
+			Console("Watch: Reloading %s", entry[i].filename.c_str());
+			entry[i].callback(entry[i].filename);
+		}
+	}
+}
@@ -0,0 +1,12 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+//Called with the filename exactly as it was passed to WatchFile.
+typedef void (*WatchCallback)(string filename);
+
+void          WatchFile(string filename, WatchCallback callback);
+void          WatchInit();
+void          WatchTerm();
+void          WatchUpdate();
+
+#endif // WATCH_H
@@ -15,8 +15,10 @@
 #include "camera.h"
 #include "collision.h"
 #include "entity.h"
+#include "flowfield.h"
 #include "env.h"
 #include "game.h"
+#include "gpu.h"
 #include "main.h"
 #include "map.h"
 #include "menu.h"
@@ -107,35 +109,35 @@ static void do_red_fade(float fade)
 	if (fade <= 0.0f)
 		return;
 	size = RenderViewportSize();
-	glBlendFunc(GL_DST_COLOR, GL_SRC_COLOR);
-	glDisable(GL_TEXTURE_2D);
-	glColor3f(1.0f, 1.0f - fade, 1.0f - fade);
-	glBegin(GL_QUADS);
-	glVertex2d(0, 0);
-	glVertex2d(size.x, 0);
-	glVertex2d(size.x, size.y);
-	glVertex2d(0, size.y);
-	glEnd();
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_TEXTURE_2D);
+	GpuBlend(GL_DST_COLOR, GL_SRC_COLOR);
+	GpuDisable(GL_TEXTURE_2D);
+	GpuColor3f(1.0f, 1.0f - fade, 1.0f - fade);
+	GpuBegin(GL_QUADS);
+	GpuVertex2d(0, 0);
+	GpuVertex2d(size.x, 0);
+	GpuVertex2d(size.x, size.y);
+	GpuVertex2d(0, size.y);
+	GpuEnd();
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuEnable(GL_TEXTURE_2D);
 }
 
 static void draw_fade(float opacity)
 {
 	if (!fade_state)
 		return;
-	glDisable(GL_STENCIL_TEST);
-	glDisable(GL_TEXTURE_2D);
-
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glColor4f(0, 0, 0, opacity);
-	glBegin(GL_QUADS);
-	glVertex3f(-100, -100, DEPTH_OVERLAY);
-	glVertex3f(100, -100, DEPTH_OVERLAY);
-	glVertex3f(100, 100, DEPTH_OVERLAY);
-	glVertex3f(-100, 100, DEPTH_OVERLAY);
-	glEnd();
-	glEnable(GL_TEXTURE_2D);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuDisable(GL_TEXTURE_2D);
+
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuColor4f(0, 0, 0, opacity);
+	GpuBegin(GL_QUADS);
+	GpuVertex3f(-100, -100, DEPTH_OVERLAY);
+	GpuVertex3f(100, -100, DEPTH_OVERLAY);
+	GpuVertex3f(100, 100, DEPTH_OVERLAY);
+	GpuVertex3f(-100, 100, DEPTH_OVERLAY);
+	GpuEnd();
+	GpuEnable(GL_TEXTURE_2D);
 }
 
 //The player has changed zones. Load in the new one and prepare it for play.
@@ -248,6 +250,8 @@ static void do_zone(int zone)
 	const Motif*	mot = current_map.RandomMotif();
 
 	mot = current_zone.Init(&current_map.Zones()->at(zone), mot, chosen_doors);
+	FlowFieldClear();
+	CollisionClear();
 	if (!mot->_texture_fore.empty())
 		tx_front = TextureFromName(mot->_texture_fore);
 	else
@@ -385,6 +389,8 @@ void WorldSetMotif(int index)
 	z.zone_id = 0;
 	doors.push_back(z);
 	current_zone.Init(&current_map.Zones()->at(current_zone_index), current_map.GetMotif(index), doors);
+	FlowFieldClear();
+	CollisionClear();
 	EntityClear();
 	current_zone.Activate(false);
 	fade_start = GameTick();
@@ -447,6 +453,8 @@ short WorldCellShape(GLvector2 point)
 	return current_zone.CellShape(GLcoord2((int)point.x, (int)point.y));
 }
 
+GLcoord2 WorldCellSize() { return current_zone.CellSize(); }
+
 bool WorldCellEmpty(GLvector2 point)
 {
 	return current_zone.CellShape(GLcoord2((int)point.x, (int)point.y)) == 0;
@@ -497,6 +505,7 @@ void WorldUpdate()
 	dust.Update();
 	sky_flash *= 0.95f;
 	boss_updated = false;
+	FlowFieldUpdate();
 	EntityUpdate();
 	boss_active = boss_updated;
 	camera = CameraPosition();
@@ -546,24 +555,26 @@ void WorldRender()
 	//If the game isn't running, just clear the screen.
 	if (!GameRunning()) {
 		glClearColor(0, 0, 0, 1.0f);
-		glStencilMask(0xff);
+		GpuStencilMask(0xff);
 		glClearStencil(0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-		glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glDepthMask(false);
-		glDisable(GL_DEPTH_TEST);
-		glEnable(GL_TEXTURE_2D);
+		GpuTexture(SpriteMapTexture());
+		GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GpuDepthMask(false);
+		GpuDisable(GL_DEPTH_TEST);
+		GpuEnable(GL_TEXTURE_2D);
 		return;
 	}
 	//Position the camera, clear the buffers, get ready to draw.
 	eye = CameraPosition();
+	//Sort out what's on screen once, for all of the passes below.
+	EntityCull();
 	GLrgba color_sky = current_zone.Color(COLOR_SKY);
 	glClearColor(color_sky.red, color_sky.green, color_sky.blue, 1.0f);
-	glStencilMask(0xff);
+	GpuStencilMask(0xff);
 	glClearStencil(0);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-	glStencilMask(0x0);
+	GpuStencilMask(0x0);
 	glLoadIdentity();
 	glScalef(1, -1, 1);
 	float desired_tilt = PlayerMomentum().x * 20.0f;
@@ -573,59 +584,62 @@ void WorldRender()
 		glRotatef(current_tilt, 0.0f, 0.0f, 1.0f);
 	glTranslatef(-eye.x, -eye.y, -eye.z);
 
-	glDisable(GL_STENCIL_TEST);
-	glDisable(GL_CULL_FACE);
-	glDepthFunc(GL_LEQUAL);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuDisable(GL_CULL_FACE);
+	GpuDepthFunc(GL_LEQUAL);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	//Draw the glowing aura around the player,
 	RenderQuad(GLvector2(eye.x, eye.y), SPRITE_GLOW, GLrgba(1, 1, 1), eye.z * 2 * RenderAspect(), 0, DEPTH_FX_GLOW, true);
 	RenderQuads();
 
 	//We render the avatar's line of sight vision to get the imprint on the stencil buffer.
+	GpuPass("Stencil");
 	RenderStencilImprint(STENCIL_OCCLUSION);
 	VisibleRender();
 	RenderStencilMask(0, STENCIL_OCCLUSION);
 
 	//Imprint the lamp cone on the stencil buffer.
-	glEnable(GL_TEXTURE_2D);
+	GpuEnable(GL_TEXTURE_2D);
 	RenderStencilImprint(STENCIL_LAMP);
 	RenderWrite(false);
-	glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
+	GpuTexture(SpriteMapTexture());
 	VisibleRenderCone(0.15f, DEPTH_FX_GLOW);
 	RenderStencilMask(0, STENCIL_OCCLUSION);
 	RenderWrite(true);
 
 	//Draw the scrolling background texture.
-	glBindTexture(GL_TEXTURE_2D, tx_sky->Id());
-	glEnable(GL_TEXTURE_2D);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuPass("Background");
+	GpuTexture(tx_sky->Id());
+	GpuEnable(GL_TEXTURE_2D);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	current_zone.RenderSky();
 
 	//Draw the outer walls in the distance.
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	current_zone.Render(PAGE_LAYER_OUTER, tx_back2->Id());
 	VisibleRenderCone(0.15f, DEPTH_UNIT_GLOW);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	current_zone.Render(PAGE_LAYER_INNER, tx_back1->Id());
-	glBlendFunc(GL_ONE, GL_ONE);
-	glDepthMask(false);
+	GpuBlend(GL_ONE, GL_ONE);
+	GpuDepthMask(false);
 	current_zone.Render(PAGE_LAYER_GLOW, tx_front->Id());
-	glDepthMask(true);
-	glEnable(GL_STENCIL_TEST);
-	glEnable(GL_DEPTH_TEST);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
-	glDisable(GL_STENCIL_TEST);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDepthMask(true);
+	GpuEnable(GL_STENCIL_TEST);
+	GpuEnable(GL_DEPTH_TEST);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	GpuTexture(SpriteMapTexture());
+	GpuDisable(GL_STENCIL_TEST);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	if (EnvValueb(ENV_SHADOWS))
-		glEnable(GL_STENCIL_TEST);
-	glEnable(GL_DEPTH_TEST);
+		GpuEnable(GL_STENCIL_TEST);
+	GpuEnable(GL_DEPTH_TEST);
 
 	//Draw dust particles.
-	glEnable(GL_STENCIL_TEST);
-	glDepthMask(false);
+	GpuPass("Dust");
+	GpuEnable(GL_STENCIL_TEST);
+	GpuDepthMask(false);
 	//Draw them ONLY in the players light cone, according to lamp color.
 	RenderStencilMask(STENCIL_LAMP, STENCIL_LAMP | STENCIL_OCCLUSION);
 	dust.Render(current_zone.Color(COLOR_LAMP));
@@ -635,50 +649,54 @@ void WorldRender()
 	dust.Render(current_zone.Color(COLOR_SKY));
 	RenderQuads();///Flush the current queue before we change the render settings.
 
-	glDepthMask(true);
+	GpuDepthMask(true);
 
+	GpuPass("Robots");
 	if (current_zone.Blind())
 		RenderStencilMask(STENCIL_LAMP, STENCIL_LAMP | STENCIL_OCCLUSION);
 	EntityRenderRobots(false);
 	RenderQuads();///Flush the current queue before we change the render settings.
-	glDisable(GL_STENCIL_TEST);//The player can ALWAYS see themselves!
+	GpuDisable(GL_STENCIL_TEST);//The player can ALWAYS see themselves!
 	PlayerRender();
 
-	glDepthMask(true);
+	GpuDepthMask(true);
 	VisibleRenderCone(0.15f, DEPTH_FX);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//Doors are visible through walls, since they are kinda walls themselves.
-	glDisable(GL_STENCIL_TEST);
-	glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
-	glDepthMask(true);
+	GpuPass("Entities");
+	GpuDisable(GL_STENCIL_TEST);
+	GpuTexture(SpriteMapTexture());
+	GpuDepthMask(true);
 	EntityDeviceRender(true);
-	glDepthMask(true);
+	GpuDepthMask(true);
 	//Now render the various entities.
 	RenderStencilMask(0, STENCIL_OCCLUSION);
-	glEnable(GL_STENCIL_TEST);
+	GpuEnable(GL_STENCIL_TEST);
 	EntityDeviceRender(false);
 	EntityRenderFx();
 	RenderQuads();///Flush the current queue before we change the render settings.
 	if (Player()->Ability(ABILITY_SCANNER)) {
 		if (current_zone.Blind())
-			glStencilFunc(GL_NOTEQUAL, STENCIL_LAMP, STENCIL_OCCLUSION | STENCIL_LAMP);
+			GpuStencilFunc(GL_NOTEQUAL, STENCIL_LAMP, STENCIL_OCCLUSION | STENCIL_LAMP);
 		else
-			glStencilFunc(GL_EQUAL, STENCIL_OCCLUSION, STENCIL_OCCLUSION);
+			GpuStencilFunc(GL_EQUAL, STENCIL_OCCLUSION, STENCIL_OCCLUSION);
 		//glStencilFunc (GL_NOTEQUAL, STENCIL_LAMP, STENCIL_LAMP);
 		EntityRenderRobots(true);
 		RenderQuads();///Flush the current queue before we change the render settings.
 	}
 	VisibleInvert(false);
+	GpuPass("Particles");
 	ParticleRender();
 	current_zone.Render(PAGE_LAYER_DEBUG, SpriteMapTexture());
-	glDepthMask(false);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_STENCIL_TEST);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuDepthMask(false);
+	GpuDisable(GL_DEPTH_TEST);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GpuPass("Foreground");
 	current_zone.Render(PAGE_LAYER_MAIN, tx_front->Id());
 	if (!EnvValueb(ENV_BBOX))
 		current_zone.Render(PAGE_LAYER_DEBUG, tx_front->Id());
-	glBindTexture(GL_TEXTURE_2D, SpriteMapTexture());
+	GpuTexture(SpriteMapTexture());
 
 	draw_fade(fade_value);
 	TriviaRender();
@@ -734,6 +752,7 @@ void WorldMapSet(int index, int zone)
 	Player()->WorldCheckAch(current_map_index, current_zone_index);
 }
 
+//NULL anywhere off the path of the current zone.
 const class Page* WorldPage(GLcoord2 pos)
 {
 	return current_zone.PageGet(pos);
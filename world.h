@@ -17,6 +17,7 @@ void              WorldBossSet(BossInfo bi);
 GLbbox2           WorldBounds();
 
 bool              WorldCellEmpty(GLvector2 point);
+GLcoord2          WorldCellSize();
 bool              WorldCellSolid(GLcoord2 world);
 short             WorldCellShape(GLvector2 point);
 void							WorldFinalBossKill ();
@@ -0,0 +1,175 @@
+/*-----------------------------------------------------------------------------
+
+  Worldgen_bench.cpp
+
+  Command line driver for the worldgen library. Generates a batch of zones
+  for each seed and reports how fast that went, how much memory it took, and
+  a hash of everything generated. The hash for a seed shouldn't change unless
+  level generation does, so it doubles as a check that an optimization
+  didn't change the levels.
+
+  Run it from the game folder, so it can find the maps.
+
+  usage: worldgen_bench [zones per seed] [seeds] [rooms per zone]
+
+  Good Robot
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include <algorithm>
+#include <chrono>
+#if defined(_WIN32)
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "page_layout.h"
+#include "random.h"
+#include "zone_layout.h"
+
+#define DEFAULT_ZONES     50
+#define DEFAULT_SEEDS     4
+#define DEFAULT_LENGTH    8
+//Only picks the tile art, but it draws random numbers so it changes the hash.
+#define TILE_VARIANTS     4
+#define EXIT_DOORS        2
+#define FNV_OFFSET        14695981039346656037ULL
+#define FNV_PRIME         1099511628211ULL
+
+typedef unsigned long long  uint64;
+
+class BenchZone : public ZoneLayout
+{
+	PageLayout*   PageCreate() { return new PageLayout; }
+};
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+static uint64 hash_bytes(uint64 hash, const void* data, size_t size)
+{
+	const unsigned char*  c = (const unsigned char*)data;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= c[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+static uint64 hash_zone(uint64 hash, BenchZone* z)
+{
+	for (int room = 0; room < z->RoomCount(); room++) {
+		GLcoord2          grid = z->RoomPage(room);
+		PageLayout*       p = z->LayoutPage(grid);
+		vector<DoorInfo>  doors = p->DoorList();
+		GLvector2         landing = p->Landing();
+		GLvector2         machine = p->Machine();
+		int               slots = p->SpawnSlots();
+		unsigned char     solid;
+
+		hash = hash_bytes(hash, &grid, sizeof(grid));
+		hash = hash_bytes(hash, p->Pattern(), strlen(p->Pattern()));
+		for (int x = 0; x < PAGE_SIZE; x++) {
+			for (int y = 0; y < PAGE_SIZE; y++) {
+				solid = p->Solid(x, y) ? 1 : 0;
+				hash = hash_bytes(hash, &solid, 1);
+			}
+		}
+		hash = hash_bytes(hash, &landing, sizeof(landing));
+		hash = hash_bytes(hash, &machine, sizeof(machine));
+		hash = hash_bytes(hash, &slots, sizeof(slots));
+		for (unsigned i = 0; i < doors.size(); i++) {
+			hash = hash_bytes(hash, &doors[i].position, sizeof(doors[i].position));
+			hash = hash_bytes(hash, &doors[i].facing, sizeof(doors[i].facing));
+		}
+	}
+	return hash;
+}
+
+//Every map in the levels folder, in a fixed order so runs are comparable.
+static vector<string> find_patterns()
+{
+	vector<string>              patterns;
+	boost::system::error_code   error;
+
+	for (directory_iterator it(LEVELS_DIR, error), end; !error && it != end; ++it) {
+		if (it->path().extension() == LEVELS_EXT)
+			patterns.push_back(it->path().stem().string());
+	}
+	sort(patterns.begin(), patterns.end());
+	return patterns;
+}
+
+//Peak memory use of the process so far, in kilobytes.
+static long peak_kb()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS   pmc;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return 0;
+	return (long)(pmc.PeakWorkingSetSize / 1024);
+#else
+	struct rusage   usage;
+
+	if (getrusage(RUSAGE_SELF, &usage))
+		return 0;
+#if defined(__APPLE__)
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+int main(int argc, char** argv)
+{
+	int             zones, seeds, length;
+	vector<string>  patterns;
+	BenchZone*      z;
+	uint64          hash, total_hash;
+	double          seconds;
+
+	zones = argc > 1 ? atoi(argv[1]) : DEFAULT_ZONES;
+	seeds = argc > 2 ? atoi(argv[2]) : DEFAULT_SEEDS;
+	length = argc > 3 ? atoi(argv[3]) : DEFAULT_LENGTH;
+	if (zones < 1 || seeds < 1 || length < 2) {
+		printf("usage: %s [zones per seed] [seeds] [rooms per zone, at least 2]\n", argv[0]);
+		return 1;
+	}
+	patterns = find_patterns();
+	if (patterns.empty()) {
+		printf("No maps found in %s. Run this from the game folder.\n", LEVELS_DIR);
+		return 1;
+	}
+	printf("Generating %d zones of %d rooms for each of %d seeds, from %d maps.\n", zones, length, seeds, (int)patterns.size());
+	z = new BenchZone;
+	total_hash = FNV_OFFSET;
+	auto start = std::chrono::steady_clock::now();
+	for (int seed = 1; seed <= seeds; seed++) {
+		RandomStream  world(seed);
+
+		hash = FNV_OFFSET;
+		for (int i = 0; i < zones; i++) {
+			z->Layout(world.Split(i), length, patterns, EXIT_DOORS, TILE_VARIANTS);
+			hash = hash_zone(hash, z);
+		}
+		printf("  seed %d: %016llx\n", seed, hash);
+		total_hash = hash_bytes(total_hash, &hash, sizeof(hash));
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	delete z;
+	printf("%d zones in %.3f seconds: %.1f zones/second, %.3f ms/zone.\n", zones * seeds, seconds, (zones * seeds) / seconds, (seconds * 1000.0) / (zones * seeds));
+	printf("Peak memory: %ld KB\n", peak_kb());
+	printf("Content hash: %016llx\n", total_hash);
+	return 0;
+}
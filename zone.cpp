@@ -14,6 +14,7 @@ Good Robot
 #include "env.h"
 #include "entity.h"
 #include "fxmachine.h"
+#include "gpu.h"
 #include "map.h"
 #include "page.h"
 #include "player.h"
@@ -21,25 +22,33 @@ Good Robot
 #include "world.h"
 #include "zone.h"
 
-/*-----------------------------------------------------------------------------
+//The sky reaches at least this many pages past the zone in every direction.
+#define ZONE_SKY_PAGES      15
 
------------------------------------------------------------------------------*/
+//How far back each layer of level geometry sits.
+static const float  layer_depth[PAGE_LAYER_COUNT] =
+{
+	DEPTH_BG_FAR,       //PAGE_LAYER_OUTER
+	DEPTH_BG_NEAR,      //PAGE_LAYER_INNER
+	DEPTH_LEVEL,        //PAGE_LAYER_MAIN
+	DEPTH_LEVEL_GLOW,   //PAGE_LAYER_GLOW
+	DEPTH_LEVEL,        //PAGE_LAYER_DEBUG
+};
 
-class ZonePath
+//Which of the motif colors tints each layer.
+static const int    layer_color[PAGE_LAYER_COUNT] =
 {
-	vector<GLcoord2>  _path;
-	GLcoord2          _min;
-	GLcoord2          _max;
-	GLcoord2          _current;
-
-	bool              IsValid(GLcoord2 consider);
-	GLcoord2          Direction(int d);
-	void              Push(GLcoord2);
-	vector<GLcoord2>  Panic(int length);
-public:
-	vector<GLcoord2>  Plot(int length);
+	COLOR_BACKGROUND2,  //PAGE_LAYER_OUTER
+	COLOR_BACKGROUND1,  //PAGE_LAYER_INNER
+	COLOR_FOREGROUND,   //PAGE_LAYER_MAIN
+	COLOR_LIGHT,        //PAGE_LAYER_GLOW
+	COLOR_FOREGROUND,   //PAGE_LAYER_DEBUG
 };
 
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
 struct SpecialZoneIndex
 {
 	int mob_index;
@@ -70,159 +79,14 @@ bool IsSpecialMob(std::vector<SpecialZoneIndex> &special, const int &mob_index)
 	return false;
 }
 
-bool ZonePath::IsValid(GLcoord2 t)
-{
-	//Make sure this position is touching at least ONE edge of our bounding box,
-	//or else this room could end up spiraling in and trapping itself.
-	if (t.x != _min.x && t.x != _max.x && t.y != _min.y && t.y != _max.y)
-		return false;
-	//Make sure we're not going to land on an existing spot
-	for (unsigned i = 0; i < _path.size(); i++) {
-		if (_path[i] == t)
-			return false;
-	}
-	return true;
-}
-
-void ZonePath::Push(GLcoord2 n)
-{
-	_path.push_back(n);
-	_min.x = min(_min.x, n.x);
-	_min.y = min(_min.y, n.y);
-	_max.x = max(_max.x, n.x);
-	_max.y = max(_max.y, n.y);
-	_current = n;
-}
-
-GLcoord2 ZonePath::Direction(int d)
-{
-	d %= 4;
-	if (d < 0)
-		d = 4 + d;
-	if (d == 0) return GLcoord2(0, -1);//Up
-	if (d == 1) return GLcoord2(1, 0);//Right
-	if (d == 2) return GLcoord2(0, 1);//Down
-	return GLcoord2(-1, 0);//Left
-}
-
-vector<GLcoord2> ZonePath::Panic(int length)
-{
-	vector<GLcoord2>  path;
-
-	for (unsigned i = 0; i < length; i++) {
-		path.push_back(GLcoord2(i, 0));
-	}
-	return path;
-}
-
-vector<GLcoord2> ZonePath::Plot(int length)
-{
-	int   dir;
-	int   fails;
-	bool  turn_right;
-
-	_max = _min = GLcoord2(0, 0);
-	Push(GLcoord2(0, 0));
-	dir = RandomVal(4);
-	turn_right = RandomVal(2) == 0;
-	fails = 0;
-
-	while (_path.size() < length) {
-		GLcoord2  consider;
-
-		consider = _current + Direction(dir);
-		if (IsValid(consider)) {
-			Push(consider);
-			fails = 0;
-			turn_right = !turn_right;
-			dir = RandomVal(4);
-		}
-		else {
-			dir += turn_right ? 1 : -1;
-			fails++;
-		}
-		//We might spiral in and get stuck somewhere where this IS no good move...
-		if (fails > 4)
-			return Panic(length);
-	}
-	//Normalize the grid so all map points are in positive numbers.
-	for (unsigned i = 0; i < _path.size(); i++) {
-		_path[i].x -= _min.x;
-		_path[i].y -= _min.y;
-	}
-	return _path;
-}
-
 /*-----------------------------------------------------------------------------
 
 -----------------------------------------------------------------------------*/
 
-std::string Zone::Pattern(int index)
-{
-	std::string result;
-
-	if (index == 0 || index == _path.size() - 1)
-		result = "doors";
-	else
-		result = _zone_info._patterns[RandomVal(_zone_info._patterns.size())];
-
-	return result;
-}
-
-int Zone::Connection(int index)
-{
-	int   result;
-
-	result = CONNECT_NONE;
-	//return result;
-	if (index > 0) {
-		if (_path[index - 1].x < _path[index].x)
-			result |= CONNECT_LEFT;
-		if (_path[index - 1].x > _path[index].x)
-			result |= CONNECT_RIGHT;
-		if (_path[index - 1].y > _path[index].y)
-			result |= CONNECT_DOWN;
-		if (_path[index - 1].y < _path[index].y)
-			result |= CONNECT_UP;
-	}
-	if (index < _path.size() - 1) {
-		if (_path[index + 1].x < _path[index].x)
-			result |= CONNECT_LEFT;
-		if (_path[index + 1].x > _path[index].x)
-			result |= CONNECT_RIGHT;
-		if (_path[index + 1].y > _path[index].y)
-			result |= CONNECT_DOWN;
-		if (_path[index + 1].y < _path[index].y)
-			result |= CONNECT_UP;
-	}
-	if (_path[index].x == 0)
-		result |= DOORS_LEFT;
-	if (_path[index].x == _grid_max.x)
-		result |= DOORS_RIGHT;
-	if (_path[index].y == 0)
-		result |= DOORS_UP;
-	if (_path[index].y == _grid_max.y)
-		result |= DOORS_DOWN;
-	return result;
-}
-
-GLvector2 Zone::RoomPosition(int room) const
-{
-	GLcoord2    local;
-
-	local = _path[room];
-	return GLvector2((float)local.x * PAGE_SIZE, (float)local.y  * PAGE_SIZE) + GLvector2(PAGE_HALF, PAGE_HALF);
-}
-
 const Motif* Zone::Init(ZoneInfo* zi, const struct Motif* motif_ptr, vector<ZoneExitDoor> exits)
 {
-	//	GLmesh              temp_mesh[PAGE_LAYER_COUNT];
-	GLcoord2            local;
-	ZonePath            zp;
 	const struct Motif* motif;
 
-	_bbox.Clear();
-	_path.clear();
 	_zone_info = *zi;
 	_exits = exits;
 	for (int l = 0; l < PAGE_LAYER_COUNT; l++)
@@ -240,20 +104,6 @@ const Motif* Zone::Init(ZoneInfo* zi, const struct Motif* motif_ptr, vector<Zone
 	else //Nope, just use the one given.
 		motif = motif_ptr;
 
-	_grid_min = GLcoord2(MAX_ZONE_SIZE, MAX_ZONE_SIZE);
-	_grid_max = GLcoord2(0, 0);
-	_path.push_back(GLcoord2(1, 0));
-	_path.push_back(GLcoord2(0, 0));
-	_path.push_back(GLcoord2(0, 1));
-	_path.push_back(GLcoord2(1, 1));
-	_path.push_back(GLcoord2(2, 1));
-	_path = zp.Plot(zi->_length);
-	//Set up the bounding rectangle and uv values for the background image.
-	_sky_box.Clear();
-	_sky_box.ContainPoint(GLvector2(-MAX_ZONE_SIZE, -MAX_ZONE_SIZE)*PAGE_SIZE);
-	_sky_box.ContainPoint(GLvector2(MAX_ZONE_SIZE + 1, MAX_ZONE_SIZE + 1)*PAGE_SIZE);
-	_sky_uv.x = MAX_ZONE_SIZE * 2 + 1;
-	_sky_uv.y = MAX_ZONE_SIZE * 2 + 1;
 	_wall_damage = motif->_wall_damage;
 	_blind = motif->_blind;
 	//Pull our colors out of the given motif.
@@ -262,87 +112,62 @@ const Motif* Zone::Init(ZoneInfo* zi, const struct Motif* motif_ptr, vector<Zone
 	}
 	_fog = motif->_fog;
 	_machines = motif->_machines;
-	//Clear the grid.
-	for (int y = 0; y < MAX_ZONE_SIZE; y++) {
-		for (int x = 0; x < MAX_ZONE_SIZE; x++) {
-			_page[x][y].Init(GLcoord2(x, y), -1, 0, "invalid", 0);
-		}
-	}
-	//Inventory the screens and figure out the dimensions of our gamespace.
-	for (unsigned i = 0; i < _path.size(); i++) {
-		local = _path[i];
-		//Keep track of how much of our grid we're using.
-		_grid_min.x = min(_grid_min.x, local.x);
-		_grid_min.y = min(_grid_min.y, local.y);
-		_grid_max.x = max(_grid_max.x, local.x);
-		_grid_max.y = max(_grid_max.y, local.y);
-		_cell_size.x = _grid_max.x * PAGE_SIZE + PAGE_SIZE;
-		_cell_size.y = _grid_max.y * PAGE_SIZE + PAGE_SIZE;
-	}
-	//Now place the gameplay screens, replacing the solid mass we just made.
-	for (unsigned i = 0; i < _path.size(); i++) {
-		int doors;
-
-		local = _path[i];
-		doors = 0;
-		//The first room will have a locked door for the "entrance".
-		if (i == 0) {
-			_enter_page = local;
-			doors = 1;
-		}
-		//The last room will have all the exits requested when we were initialized.
-		if (i == _path.size() - 1) {
-			_exit_page = local;
-			doors = _exits.size();
-		}
-		//Fill this page with data.
-		_page[local.x][local.y].Init(local, i, Connection(i), Pattern(i), doors);
-		_bbox.ContainPoint(GLvector2(1, 1) + local*PAGE_SIZE);
-		_bbox.ContainPoint(GLvector2(1, 1) + GLvector2(local*PAGE_SIZE) + GLvector2(PAGE_SIZE - 2, PAGE_SIZE - 2));
-	}
-	//Procedurally generate each screen to fill in our grid of marching squares.
-	for (int y = _grid_min.y; y <= _grid_max.y; y++) {
-		for (int x = _grid_min.x; x <= _grid_max.x; x++) {
-			_page[x][y].BuildPattern();
-		}
-	}
-	//Build the mesh for each page, and add that mesh to the zone mesh.
-	for (int l = 0; l < PAGE_LAYER_COUNT; l++)
+	//Plot the rooms and fill in their cells. Each zone gets a stream of its
+	//own, so nothing that happens in play changes how it's built.
+	Layout(RandomStream(RandomChannel(RANDOM_WORLD).Val()), zi->_length, zi->_patterns, _exits.size(), Env().tile_variants);
+	//Set up the bounding rectangle and uv values for the background image.
+	//Zones can be any size now, so make sure the sky covers this one.
+	int       sky = max(ZONE_SKY_PAGES, max(GridSize().x, GridSize().y));
+
+	_sky_box.Clear();
+	_sky_box.ContainPoint(GLvector2((float)-sky, (float)-sky)*PAGE_SIZE);
+	_sky_box.ContainPoint(GLvector2((float)sky + 1, (float)sky + 1)*PAGE_SIZE);
+	_sky_uv.x = (float)(sky * 2 + 1);
+	_sky_uv.y = (float)(sky * 2 + 1);
+	//Each page writes its geometry straight onto the zone meshes. Reserve
+	//room for about a quad per cell, plus one for each blank page in the
+	//border added below. Debug has no geometry of its own.
+	GLcoord2  grid = _grid_max - _grid_min + GLcoord2(1, 1);
+
+	for (int l = 0; l < PAGE_LAYER_COUNT; l++) {
 		_mesh[l].Clear();
+		_mesh[l]._depth = layer_depth[l];
+		if (l != PAGE_LAYER_DEBUG)
+			_mesh[l].Reserve(grid.x * grid.y * PAGE_SIZE * PAGE_SIZE + (grid.x + grid.y + 2) * 2);
+	}
+	//Pages off the path are solid filler. They're built here, used, and
+	//thrown away, since nothing needs them after they have geometry.
+	Page    p;
+
 	for (int y = _grid_min.y; y <= _grid_max.y; y++) {
 		for (int x = _grid_min.x; x <= _grid_max.x; x++) {
-			_page[x][y].BuildMesh(this);
-			for (int l = 0; l < PAGE_LAYER_COUNT; l++)
-				_mesh[l] += _page[x][y].Mesh((ePageLayer)l);
+			if (PageGet(GLcoord2(x, y))) {
+				PageGet(GLcoord2(x, y))->BuildMesh(this, _mesh);
+				continue;
+			}
+			p.Init(GLcoord2(x, y), -1, 0, "invalid", 0);
+			p.BuildFiller(Env().tile_variants);
+			p.BuildMesh(this, _mesh);
 		}
 	}
 	//Add a buffer of blank pages on the top and bottom edge of the zone.
-	Page    p;
 
 	for (int x = _grid_min.x - 1; x <= _grid_max.x + 1; x++) {
 		p.Init(GLcoord2(x, _grid_min.y - 1), -1, 0, "solid", 0);
-		p.BuildPattern();
-		p.BuildMesh(this);
-		for (int l = 0; l < PAGE_LAYER_COUNT; l++)
-			_mesh[l] += p.Mesh((ePageLayer)l);
+		p.BuildPattern(PageRandom(GLcoord2(x, _grid_min.y - 1)), Env().tile_variants);
+		p.BuildMesh(this, _mesh);
 		p.Init(GLcoord2(x, _grid_max.y + 1), -1, 0, "solid", 0);
-		p.BuildPattern();
-		p.BuildMesh(this);
-		for (int l = 0; l < PAGE_LAYER_COUNT; l++)
-			_mesh[l] += p.Mesh((ePageLayer)l);
+		p.BuildPattern(PageRandom(GLcoord2(x, _grid_max.y + 1)), Env().tile_variants);
+		p.BuildMesh(this, _mesh);
 	}
 	//Add a buffer of blank pages on the left and right edge of the zone.
 	for (int y = _grid_min.y; y <= _grid_max.y; y++) {
 		p.Init(GLcoord2(_grid_min.x - 1, y), -1, 0, "solid", 0);
-		p.BuildPattern();
-		p.BuildMesh(this);
-		for (int l = 0; l < PAGE_LAYER_COUNT; l++)
-			_mesh[l] += p.Mesh((ePageLayer)l);
+		p.BuildPattern(PageRandom(GLcoord2(_grid_min.x - 1, y)), Env().tile_variants);
+		p.BuildMesh(this, _mesh);
 		p.Init(GLcoord2(_grid_max.x + 1, y), -1, 0, "solid", 0);
-		p.BuildPattern();
-		p.BuildMesh(this);
-		for (int l = 0; l < PAGE_LAYER_COUNT; l++)
-			_mesh[l] += p.Mesh((ePageLayer)l);
+		p.BuildPattern(PageRandom(GLcoord2(_grid_max.x + 1, y)), Env().tile_variants);
+		p.BuildMesh(this, _mesh);
 	}
 	Compile();
 	return motif;
@@ -362,37 +187,34 @@ void Zone::RenderSky()
 
 	color_sky = Color(COLOR_SKY);
 	shadow = color_sky * Fog();
-	_sky_uv.x = MAX_ZONE_SIZE * 2 + 1;
-	_sky_uv.y = MAX_ZONE_SIZE * 2 + 1;
 	//Draw the entire sky, darkened.
-	glColor3fv(&shadow.red);
-	glDisable(GL_STENCIL_TEST);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0, _sky_uv.y);          glVertex3f(_sky_box.pmin.x, _sky_box.pmin.y, DEPTH_SKY);
-	glTexCoord2f(_sky_uv.x, _sky_uv.y);  glVertex3f(_sky_box.pmax.x, _sky_box.pmin.y, DEPTH_SKY);
-	glTexCoord2f(_sky_uv.x, 0);          glVertex3f(_sky_box.pmax.x, _sky_box.pmax.y, DEPTH_SKY);
-	glTexCoord2f(0, 0);                  glVertex3f(_sky_box.pmin.x, _sky_box.pmax.y, DEPTH_SKY);
-	glEnd();
+	GpuColor3fv(&shadow.red);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2f(0, _sky_uv.y);          GpuVertex3f(_sky_box.pmin.x, _sky_box.pmin.y, DEPTH_SKY);
+	GpuTexCoord2f(_sky_uv.x, _sky_uv.y);  GpuVertex3f(_sky_box.pmax.x, _sky_box.pmin.y, DEPTH_SKY);
+	GpuTexCoord2f(_sky_uv.x, 0);          GpuVertex3f(_sky_box.pmax.x, _sky_box.pmax.y, DEPTH_SKY);
+	GpuTexCoord2f(0, 0);                  GpuVertex3f(_sky_box.pmin.x, _sky_box.pmax.y, DEPTH_SKY);
+	GpuEnd();
 	//Mask out the parts the player can't see and draw it again in full brightness.
 	if (EnvValueb(ENV_SHADOWS))
-		glEnable(GL_STENCIL_TEST);
-	glColor3fv(&color_sky.red);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0, _sky_uv.y);          glVertex3f(_sky_box.pmin.x, _sky_box.pmin.y, DEPTH_SKY);
-	glTexCoord2f(_sky_uv.x, _sky_uv.y);  glVertex3f(_sky_box.pmax.x, _sky_box.pmin.y, DEPTH_SKY);
-	glTexCoord2f(_sky_uv.x, 0);          glVertex3f(_sky_box.pmax.x, _sky_box.pmax.y, DEPTH_SKY);
-	glTexCoord2f(0, 0);                  glVertex3f(_sky_box.pmin.x, _sky_box.pmax.y, DEPTH_SKY);
-	glEnd();
+		GpuEnable(GL_STENCIL_TEST);
+	GpuColor3fv(&color_sky.red);
+	GpuBegin(GL_QUADS);
+	GpuTexCoord2f(0, _sky_uv.y);          GpuVertex3f(_sky_box.pmin.x, _sky_box.pmin.y, DEPTH_SKY);
+	GpuTexCoord2f(_sky_uv.x, _sky_uv.y);  GpuVertex3f(_sky_box.pmax.x, _sky_box.pmin.y, DEPTH_SKY);
+	GpuTexCoord2f(_sky_uv.x, 0);          GpuVertex3f(_sky_box.pmax.x, _sky_box.pmax.y, DEPTH_SKY);
+	GpuTexCoord2f(0, 0);                  GpuVertex3f(_sky_box.pmin.x, _sky_box.pmax.y, DEPTH_SKY);
+	GpuEnd();
 }
 
 void Zone::Render(ePageLayer layer, unsigned texture)
 {
 	GLrgba    color;
 	GLrgba    shadow;
-	int       color_index;
 
-	glDisable(GL_STENCIL_TEST);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	GpuDisable(GL_STENCIL_TEST);
+	GpuTexture(texture);
 	if (layer == PAGE_LAYER_OUTER && !EnvValueb(ENV_RENDER_BACKGROUND))
 		return;
 	if (layer == PAGE_LAYER_INNER && !EnvValueb(ENV_RENDER_BACKGROUND))
@@ -407,30 +229,21 @@ void Zone::Render(ePageLayer layer, unsigned texture)
 			return;
 		for (unsigned room = 0; room < _path.size(); room += 1) {
 			GLcoord2            local = _path[room];
-			_page[local.x][local.y].RenderDebug();
+			PageGet(local)->RenderDebug();
 		}
-		glColor3f(1, 1, 0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GpuColor3f(1, 1, 0);
+		GpuTexture(0);
 		if (EnvValueb(ENV_BBOX))
 			_bbox.Render();
 		return;
 	}
-	if (layer == PAGE_LAYER_OUTER)
-		color_index = COLOR_BACKGROUND2;
-	else if (layer == PAGE_LAYER_INNER)
-		color_index = COLOR_BACKGROUND1;
-	else if (layer == PAGE_LAYER_GLOW)
-		color_index = COLOR_LIGHT;
-	else
-		color_index = COLOR_FOREGROUND;
-
-	color = _color_layer[color_index];
+	color = _color_layer[layer_color[layer]];
 	shadow = color * _fog;
-	glColor3fv(&shadow.red);
+	GpuColor3fv(&shadow.red);
 	_vbo[layer].Render();
 	if (layer != PAGE_LAYER_MAIN)
-		glEnable(GL_STENCIL_TEST);
-	glColor3fv(&color.red);
+		GpuEnable(GL_STENCIL_TEST);
+	GpuColor3fv(&color.red);
 	_vbo[layer].Render();
 }
 
@@ -438,21 +251,26 @@ bool Zone::CellSolid(GLcoord2 world)
 {
 	GLcoord2  local;
 	int       row, column;
+	Page*     p;
 
 	if (world.x < 1 || world.y < 1 || world.x >= _cell_size.x || world.y >= _cell_size.y)
 		return true;
-	world.x = clamp(world.x, 0, (MAX_ZONE_SIZE * PAGE_SIZE) - 1);
-	world.y = clamp(world.y, 0, (MAX_ZONE_SIZE * PAGE_SIZE) - 1);
 	local.x = world.x % PAGE_SIZE;
 	local.y = world.y % PAGE_SIZE;
 	row = (int)world.y / PAGE_SIZE;
 	column = (int)world.x / PAGE_SIZE;
-	return _page[column][row].Solid(local.x, local.y);
+	p = PageGet(GLcoord2(column, row));
+	//Anywhere off the path is solid.
+	if (!p)
+		return true;
+	return p->Solid(local.x, local.y);
 }
 
 short Zone::CellShape(GLcoord2 world)
 {
 	int       row, column;
+	Page*     p;
+	short     shape;
 
 	if (world.x < 0)
 		return 9;
@@ -462,11 +280,23 @@ short Zone::CellShape(GLcoord2 world)
 		return 6;
 	if (world.y >= _cell_size.y)
 		return 12;
-	world.x = clamp(world.x, 0, (MAX_ZONE_SIZE * PAGE_SIZE) - 1);
-	world.y = clamp(world.y, 0, (MAX_ZONE_SIZE * PAGE_SIZE) - 1);
 	row = (int)world.y / PAGE_SIZE;
 	column = (int)world.x / PAGE_SIZE;
-	return _page[column][row].Shape(world.x, world.y);
+	p = PageGet(GLcoord2(column, row));
+	if (p)
+		return p->Shape(world.x, world.y);
+	//No page here, so work it out from the neighbors. Only the edges
+	//next to the path can be anything but solid.
+	shape = 0;
+	if (CellSolid(GLcoord2(world.x, world.y)))
+		shape |= 1;
+	if (CellSolid(GLcoord2(world.x + 1, world.y)))
+		shape |= 2;
+	if (CellSolid(GLcoord2(world.x + 1, world.y + 1)))
+		shape |= 4;
+	if (CellSolid(GLcoord2(world.x, world.y + 1)))
+		shape |= 8;
+	return shape;
 }
 
 bool Zone::PlaceMachine(GLcoord2 page, string name, GLvector2& location)
@@ -482,7 +312,7 @@ bool Zone::PlaceMachine(GLcoord2 page, string name, GLvector2& location)
 	if (m_info == NULL)
 		return false;
 	//Find a spot in this page where this machine can be placed.
-	cell = _page[page.x][page.y].MachineLocation(m_info->Mount(), m_info->Size());
+	cell = PageGet(page)->MachineLocation(m_info->Mount(), m_info->Size());
 	//If we didn't find a suitable mount location...
 	if (cell == GLcoord2())
 		return false;
@@ -516,7 +346,7 @@ void Zone::Activate(bool final_zone)
 	Page*								p;
 
 	//Add the fake entrance door.
-	p = &_page[_enter_page.x][_enter_page.y];
+	p = PageGet(_enter_page);
 	door_list = p->DoorList();
 	d = new fxDoor;
 	d->Init(door_list[0].position, door_list[0].facing, SPRITE_DOOR_LOCKED, 0, true);
@@ -524,7 +354,7 @@ void Zone::Activate(bool final_zone)
 	//First door is our entry point.
 	_entry = DoorLanding(door_list[0].position, door_list[0].facing);
 	//Add the exits.
-	p = &_page[_exit_page.x][_exit_page.y];
+	p = PageGet(_exit_page);
 	door_list = p->DoorList();
 	//These two arrays SHOULD be the same size...
 	for (unsigned i = 0; i < door_list.size(); i++) {
@@ -545,10 +375,8 @@ void Zone::Activate(bool final_zone)
 		int                 rand_index;
 		bool                has_factory = false;
 		bool                factory_forbidden = false;
-		Page*               p;
 		GLvector2           ignore;
 
-		p = &_page[local.x][local.y];
 		//First room gets the respawn station and hat machine.
 		if (room == 0) {
 			PlaceMachine(local, "Spawner", _respawn);
@@ -632,14 +460,14 @@ void Zone::Activate(bool final_zone)
 						//If the room has a factory, then stick the bots into the spawn queue for
 						//the factory to "create" later. If not, then spawn the bots right now.
 						if (room_has_factory[room] && _zone_info._mobs[m].from_machine)
-							_page[local.x][local.y].RobotsPush(_zone_info._mobs[m].type_index);
+							PageGet(local)->RobotsPush(_zone_info._mobs[m].type_index);
 						else {
-							b.Init(_page[local.x][local.y].Spawn(), _zone_info._mobs[m].type_index);
+							b.Init(PageGet(local)->Spawn(), _zone_info._mobs[m].type_index);
 							EntityRobotAdd(b);
 						}
 					}
 				}
-			_page[local.x][local.y].RobotsRandomize();
+			PageGet(local)->RobotsRandomize();
 		}
 
 	//Add the robots to special rooms
@@ -660,14 +488,14 @@ void Zone::Activate(bool final_zone)
 			//If the room has a factory, then stick the bots into the spawn queue for
 			//the factory to "create" later. If not, then spawn the bots right now.
 			if (room_has_factory[room] && _zone_info._mobs[m].from_machine)
-				_page[local.x][local.y].RobotsPush(_zone_info._mobs[m].type_index);
+				PageGet(local)->RobotsPush(_zone_info._mobs[m].type_index);
 			else {
-				b.Init(_page[local.x][local.y].Spawn(), _zone_info._mobs[m].type_index);
+				b.Init(PageGet(local)->Spawn(), _zone_info._mobs[m].type_index);
 				EntityRobotAdd(b);
 			}
 		}
 
-		_page[local.x][local.y].RobotsRandomize();
+		PageGet(local)->RobotsRandomize();
 	}
 	SpawnersCheck ();
 	//And done.
@@ -679,7 +507,7 @@ void Zone::SpawnersCheck ()
 	_spawners_empty = true;
 	for (unsigned room = 1; room < _path.size () - 1; room++) {
 		GLcoord2  local = _path[room];
-		if (_page[local.x][local.y].RobotsCount ()) {
+		if (PageGet(local)->RobotsCount ()) {
 			_spawners_empty = false;
 			return;
 		}
@@ -688,7 +516,7 @@ void Zone::SpawnersCheck ()
 
 int Zone::RobotSpawnId(GLcoord2 page)
 {
-	int		robot_id = _page[page.x][page.y].RobotsPop ();
+	int		robot_id = PageGet(page)->RobotsPop ();
 
 	//See if we're out of robots to spawn.
 	SpawnersCheck ();
@@ -697,20 +525,20 @@ int Zone::RobotSpawnId(GLcoord2 page)
 
 int Zone::RobotSpawnCount(GLcoord2 page) const
 {
-	return _page[page.x][page.y].RobotsCount();
+	return PageGet(page)->RobotsCount();
 }
 
 int Zone::RobotSpawnCount(int room) const
 {
 	GLcoord2 page = _path[room];
-	return _page[page.x][page.y].RobotsCount();
+	return PageGet(page)->RobotsCount();
 }
 
 int Zone::RoomFromPosition(GLvector2 pos) const
 {
 	for (unsigned room = 1; room < _path.size(); room++) {
 		GLcoord2    local = _path[room];
-		if (_page[local.x][local.y].Contains(pos))
+		if (PageGet(local)->Contains(pos))
 			return room;
 	}
 	return 0;
@@ -3,8 +3,8 @@
 
 #include "map.h"
 #include "page.h"
+#include "zone_layout.h"
 
-#define MAX_ZONE_SIZE       15
 #define ZONE_NEXT_LEVEL     -1
 
 struct ZoneExitDoor
@@ -13,23 +13,15 @@ struct ZoneExitDoor
 	int                       zone_id;
 };
 
-class Zone
+class Zone : public ZoneLayout
 {
 	GLvector2                 _entry;
 	GLvector2                 _respawn;
-	class Page                _page[MAX_ZONE_SIZE][MAX_ZONE_SIZE];
-	GLbbox2                   _bbox;
-	GLcoord2                  _grid_min;
-	GLcoord2                  _grid_max;
-	GLcoord2                  _enter_page;
-	GLcoord2                  _exit_page;
-	GLcoord2                  _cell_size;
-	vector<GLcoord2>          _path;                      //The coords of each page that forms our linear tunnel.
 	vector<ZoneExitDoor>      _exits;
 	vector<string>            _machines;
 	GLrgba                    _color_layer[COLOR_COUNT];
 	float                     _fog;
-	GLmesh										_mesh[PAGE_LAYER_COUNT];
+	GLflatMesh                _mesh[PAGE_LAYER_COUNT];
 	VBO                       _vbo[PAGE_LAYER_COUNT];
 	struct ZoneInfo           _zone_info;
   int                       _wall_damage;
@@ -40,30 +32,26 @@ class Zone
 	GLvector2                 _sky_uv;
 
 	void											SpawnersCheck ();
-	int                       Connection(int index);
 	///Returns the INSIDE spot beside the door.
 	GLvector2                 DoorLanding(GLvector2 position, DoorFacing direction);
-	std::string               Pattern(int index);
 	bool                      PlaceMachine(GLcoord2 page, string name, GLvector2& location);
+	PageLayout*               PageCreate() { return new Page; }
 
 public:
 	void                      Activate(bool final_zone);
 	bool											Blind () { return _blind; }
-	GLbbox2                   Bounds() const { return _bbox; }
 	GLrgba                    Color(enum MapColor c) { return _color_layer[c]; }
 	void											Compile ();
 	bool											SpawnersEmpty () { return _spawners_empty; }
 	float                     Fog () { return _fog; }
 	const Motif*              Init (struct ZoneInfo* zone, const struct Motif* motif, vector<ZoneExitDoor> exits);
-  Page*											PageGet (GLcoord2 p) { return &_page[p.x][p.y];  }
+  Page*											PageGet (GLcoord2 p) const { return (Page*)LayoutPage(p);  }
 	void                      Render(ePageLayer layer, unsigned texture_id);
 	void                      RenderSky();
 	int                       RobotSpawnId(GLcoord2 page);
 	int                       RobotSpawnCount(GLcoord2 page) const;
 	int                       RobotSpawnCount (int room) const;
 	int                       RoomFromPosition(GLvector2) const;
-	int                       RoomCount() const { return _path.size(); }
-	GLvector2                 RoomPosition(int room) const;
 	bool                      CellSolid(GLcoord2 pos);
 	short                     CellShape(GLcoord2 pos);
 	GLvector2                 Entry() { return _entry; }
@@ -0,0 +1,283 @@
+/*-----------------------------------------------------------------------------
+
+  Zone_layout.cpp
+
+  Plots the path of rooms through a zone and fills in their cells. This is
+  the part of level generation that doesn't care how the result is drawn or
+  what lives in it, so it can be run (and timed) without the game.
+
+  Good Robot
+  (c) 2015 Pyrodactyl
+
+  -----------------------------------------------------------------------------*/
+
+#include "master.h"
+
+#include "page_layout.h"
+#include "random.h"
+#include "zone_layout.h"
+
+class ZonePath
+{
+	vector<GLcoord2>  _path;
+	GLcoord2          _min;
+	GLcoord2          _max;
+	GLcoord2          _current;
+
+	bool              IsValid(GLcoord2 consider);
+	GLcoord2          Direction(int d);
+	void              Push(GLcoord2);
+	vector<GLcoord2>  Panic(int length);
+public:
+	vector<GLcoord2>  Plot(int length, RandomStream& random);
+};
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+bool ZonePath::IsValid(GLcoord2 t)
+{
+	//Make sure this position is touching at least ONE edge of our bounding box,
+	//or else this room could end up spiraling in and trapping itself.
+	if (t.x != _min.x && t.x != _max.x && t.y != _min.y && t.y != _max.y)
+		return false;
+	//Make sure we're not going to land on an existing spot
+	for (unsigned i = 0; i < _path.size(); i++) {
+		if (_path[i] == t)
+			return false;
+	}
+	return true;
+}
+
+void ZonePath::Push(GLcoord2 n)
+{
+	_path.push_back(n);
+	_min.x = min(_min.x, n.x);
+	_min.y = min(_min.y, n.y);
+	_max.x = max(_max.x, n.x);
+	_max.y = max(_max.y, n.y);
+	_current = n;
+}
+
+GLcoord2 ZonePath::Direction(int d)
+{
+	d %= 4;
+	if (d < 0)
+		d = 4 + d;
+	if (d == 0) return GLcoord2(0, -1);//Up
+	if (d == 1) return GLcoord2(1, 0);//Right
+	if (d == 2) return GLcoord2(0, 1);//Down
+	return GLcoord2(-1, 0);//Left
+}
+
+vector<GLcoord2> ZonePath::Panic(int length)
+{
+	vector<GLcoord2>  path;
+
+	for (unsigned i = 0; i < length; i++) {
+		path.push_back(GLcoord2(i, 0));
+	}
+	return path;
+}
+
+vector<GLcoord2> ZonePath::Plot(int length, RandomStream& random)
+{
+	int   dir;
+	int   fails;
+	bool  turn_right;
+
+	_max = _min = GLcoord2(0, 0);
+	Push(GLcoord2(0, 0));
+	dir = random.Val(4);
+	turn_right = random.Val(2) == 0;
+	fails = 0;
+
+	while (_path.size() < length) {
+		GLcoord2  consider;
+
+		consider = _current + Direction(dir);
+		if (IsValid(consider)) {
+			Push(consider);
+			fails = 0;
+			turn_right = !turn_right;
+			dir = random.Val(4);
+		}
+		else {
+			dir += turn_right ? 1 : -1;
+			fails++;
+		}
+		//We might spiral in and get stuck somewhere where this IS no good move...
+		if (fails > 4)
+			return Panic(length);
+	}
+	//Normalize the grid so all map points are in positive numbers.
+	for (unsigned i = 0; i < _path.size(); i++) {
+		_path[i].x -= _min.x;
+		_path[i].y -= _min.y;
+	}
+	return _path;
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+std::string ZoneLayout::Pattern(int index)
+{
+	std::string result;
+
+	if (index == 0 || index == _path.size() - 1)
+		result = "doors";
+	else
+		result = _patterns[_random.Val(_patterns.size())];
+
+	return result;
+}
+
+int ZoneLayout::Connection(int index)
+{
+	int   result;
+
+	result = CONNECT_NONE;
+	//return result;
+	if (index > 0) {
+		if (_path[index - 1].x < _path[index].x)
+			result |= CONNECT_LEFT;
+		if (_path[index - 1].x > _path[index].x)
+			result |= CONNECT_RIGHT;
+		if (_path[index - 1].y > _path[index].y)
+			result |= CONNECT_DOWN;
+		if (_path[index - 1].y < _path[index].y)
+			result |= CONNECT_UP;
+	}
+	if (index < _path.size() - 1) {
+		if (_path[index + 1].x < _path[index].x)
+			result |= CONNECT_LEFT;
+		if (_path[index + 1].x > _path[index].x)
+			result |= CONNECT_RIGHT;
+		if (_path[index + 1].y > _path[index].y)
+			result |= CONNECT_DOWN;
+		if (_path[index + 1].y < _path[index].y)
+			result |= CONNECT_UP;
+	}
+	if (_path[index].x == 0)
+		result |= DOORS_LEFT;
+	if (_path[index].x == _grid_max.x)
+		result |= DOORS_RIGHT;
+	if (_path[index].y == 0)
+		result |= DOORS_UP;
+	if (_path[index].y == _grid_max.y)
+		result |= DOORS_DOWN;
+	return result;
+}
+
+GLvector2 ZoneLayout::RoomPosition(int room) const
+{
+	GLcoord2    local;
+
+	local = _path[room];
+	return GLvector2((float)local.x * PAGE_SIZE, (float)local.y  * PAGE_SIZE) + GLvector2(PAGE_HALF, PAGE_HALF);
+}
+
+/*-----------------------------------------------------------------------------
+
+-----------------------------------------------------------------------------*/
+
+//The random numbers for building the page at the given spot. This is the
+//same for a given spot no matter how much has been drawn from the zone.
+RandomStream ZoneLayout::PageRandom(GLcoord2 page) const
+{
+	return _random.Split(((unsigned long long)(unsigned)page.x << 32) | (unsigned)page.y);
+}
+
+ZoneLayout::~ZoneLayout()
+{
+	for (unsigned i = 0; i < _page.size(); i++)
+		delete _page[i];
+	for (unsigned i = 0; i < _spare.size(); i++)
+		delete _spare[i];
+}
+
+PageLayout* ZoneLayout::LayoutPage(GLcoord2 page) const
+{
+	if (page.x < 0 || page.y < 0 || page.x >= _grid_size.x || page.y >= _grid_size.y)
+		return NULL;
+	return _page[page.x + page.y * _grid_size.x];
+}
+
+PageLayout* ZoneLayout::PageAdd(GLcoord2 page)
+{
+	PageLayout*   p;
+
+	if (_spare.empty()) {
+		p = PageCreate();
+	} else {
+		p = _spare.back();
+		_spare.pop_back();
+	}
+	_page[page.x + page.y * _grid_size.x] = p;
+	return p;
+}
+
+void ZoneLayout::Layout(RandomStream random, int length, const vector<string>& patterns, int exit_doors, int tile_variants)
+{
+	GLcoord2            local;
+	ZonePath            zp;
+
+	_random = random;
+	_bbox.Clear();
+	_patterns = patterns;
+	//Hang on to the pages from last time. Most zones are about the same length.
+	for (unsigned i = 0; i < _page.size(); i++) {
+		if (_page[i])
+			_spare.push_back(_page[i]);
+	}
+	_page.clear();
+	_path = zp.Plot(length, _random);
+	//Inventory the screens and figure out the dimensions of our gamespace.
+	_grid_min = _grid_max = _path[0];
+	for (unsigned i = 0; i < _path.size(); i++) {
+		local = _path[i];
+		//Keep track of how much of our grid we're using.
+		_grid_min.x = min(_grid_min.x, local.x);
+		_grid_min.y = min(_grid_min.y, local.y);
+		_grid_max.x = max(_grid_max.x, local.x);
+		_grid_max.y = max(_grid_max.y, local.y);
+	}
+	_grid_size = _grid_max + GLcoord2(1, 1);
+	_cell_size = _grid_size * PAGE_SIZE;
+	_page.assign(_grid_size.x * _grid_size.y, NULL);
+	//Now place the gameplay screens. Everything else is left as solid mass.
+	for (unsigned i = 0; i < _path.size(); i++) {
+		int doors;
+
+		local = _path[i];
+		doors = 0;
+		//The first room will have a locked door for the "entrance".
+		if (i == 0) {
+			_enter_page = local;
+			doors = 1;
+		}
+		//The last room will have all the exits requested.
+		if (i == _path.size() - 1) {
+			_exit_page = local;
+			doors = exit_doors;
+		}
+		//Fill this page with data.
+		PageAdd(local)->Init(local, i, Connection(i), Pattern(i), doors);
+		_bbox.ContainPoint(GLvector2(1, 1) + local*PAGE_SIZE);
+		_bbox.ContainPoint(GLvector2(1, 1) + GLvector2(local*PAGE_SIZE) + GLvector2(PAGE_SIZE - 2, PAGE_SIZE - 2));
+	}
+	//Procedurally generate each screen to fill in our grid of marching squares.
+	//Each page draws from its own stream, so they don't depend on each other
+	//or on the order they're built in.
+	for (int y = _grid_min.y; y <= _grid_max.y; y++) {
+		for (int x = _grid_min.x; x <= _grid_max.x; x++) {
+			PageLayout*   p = LayoutPage(GLcoord2(x, y));
+
+			if (p)
+				p->BuildPattern(PageRandom(GLcoord2(x, y)), tile_variants);
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef ZONE_LAYOUT_H
+#define ZONE_LAYOUT_H
+
+#include "page_layout.h"
+#include "random.h"
+
+//The rooms of a zone: where they sit on the grid, how they join up, and the
+//cells of each one. Only the pages on the path are kept. Everything else on
+//the grid is solid, and LayoutPage () returns NULL for it. Whoever derives
+//from this decides what kind of page to make, through PageCreate ().
+class ZoneLayout
+{
+	vector<PageLayout*>       _page;                      //One per grid spot, x + y * _grid_size.x. NULL off the path.
+	vector<PageLayout*>       _spare;                     //Pages from the last zone, to be reused by the next.
+
+	PageLayout*               PageAdd(GLcoord2 page);
+
+protected:
+	GLbbox2                   _bbox;
+	GLcoord2                  _grid_min;
+	GLcoord2                  _grid_max;
+	GLcoord2                  _enter_page;
+	GLcoord2                  _exit_page;
+	GLcoord2                  _cell_size;
+	GLcoord2                  _grid_size;
+	vector<GLcoord2>          _path;                      //The coords of each page that forms our linear tunnel.
+	vector<string>            _patterns;
+	RandomStream              _random;                    //Where this zone's random numbers come from.
+
+	int                       Connection(int index);
+	std::string               Pattern(int index);
+	virtual PageLayout*       PageCreate() = 0;
+
+public:
+	virtual ~ZoneLayout();
+	GLbbox2                   Bounds() const { return _bbox; }
+	GLcoord2                  CellSize() const { return _cell_size; }
+	GLcoord2                  GridSize() const { return _grid_size; }
+	void                      Layout(RandomStream random, int length, const vector<string>& patterns, int exit_doors, int tile_variants);
+	PageLayout*               LayoutPage(GLcoord2 page) const;
+	RandomStream              PageRandom(GLcoord2 page) const;
+	int                       RoomCount() const { return _path.size(); }
+	GLcoord2                  RoomPage(int room) const { return _path[room]; }
+	GLvector2                 RoomPosition(int room) const;
+};
+
+#endif // ZONE_LAYOUT_H